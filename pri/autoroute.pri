@@ -21,8 +21,12 @@ src/autoroute/checker.h  \
 src/autoroute/binpacking/Rect.h  \
 src/autoroute/binpacking/GuillotineBinPack.h  \
 src/autoroute/mazerouter/mazerouter.h  \
+src/autoroute/mazerouter/gridsearch.h  \
+src/autoroute/mazerouter/obstaclecache.h  \
 src/autoroute/zoomcontrols.h \
 src/autoroute/drc.h \
+src/autoroute/drcvector.h \
+src/autoroute/pixelcollide.h \
 
 SOURCES += \
 src/autoroute/autorouter.cpp \
@@ -32,5 +36,9 @@ src/autoroute/checker.cpp  \
 src/autoroute/binpacking/Rect.cpp  \
 src/autoroute/binpacking/GuillotineBinPack.cpp  \
 src/autoroute/mazerouter/mazerouter.cpp  \
+src/autoroute/mazerouter/gridsearch.cpp  \
+src/autoroute/mazerouter/obstaclecache.cpp  \
 src/autoroute/zoomcontrols.cpp \
 src/autoroute/drc.cpp \
+src/autoroute/drcvector.cpp \
+src/autoroute/pixelcollide.cpp \
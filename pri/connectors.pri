@@ -19,6 +19,8 @@ src/connectors/bus.h \
 src/connectors/busshared.h \
 src/connectors/connector.h \
 src/connectors/connectoritem.h \
+src/connectors/connectoritemgraph.h \
+src/connectors/netconnectivity.h \
 src/connectors/nonconnectoritem.h \
 src/connectors/connectorshared.h \
 src/connectors/ercdata.h \
@@ -31,6 +33,8 @@ src/connectors/bus.cpp \
 src/connectors/busshared.cpp \
 src/connectors/connector.cpp \
 src/connectors/connectoritem.cpp \
+src/connectors/connectoritemgraph.cpp \
+src/connectors/netconnectivity.cpp \
 src/connectors/nonconnectoritem.cpp \
 src/connectors/connectorshared.cpp \
 src/connectors/ercdata.cpp \
@@ -33,6 +33,7 @@ HEADERS += \
     src/items/paletteitembase.h \
     src/items/partfactory.h \
     src/items/partlabel.h \
+    src/items/partsvgcache.h \
     src/items/perfboard.h \
     src/items/pinheader.h \
     src/items/propertydef.h \
@@ -73,6 +74,7 @@ SOURCES += \
     src/items/paletteitembase.cpp \
     src/items/partfactory.cpp \
     src/items/partlabel.cpp \
+    src/items/partsvgcache.cpp \
     src/items/perfboard.cpp \
     src/items/pinheader.cpp \
     src/items/propertydef.cpp \
@@ -22,9 +22,11 @@ HEADERS += \
     src/referencemodel/sqlitereferencemodel.h \
     src/referencemodel/referencemodel.h \
     src/referencemodel/serviceiconfetcher.h \
+    src/referencemodel/sqlbatchinserter.h \
 
 
 SOURCES += \
     src/referencemodel/sqlitereferencemodel.cpp \
     src/referencemodel/serviceiconfetcher.cpp \
+    src/referencemodel/sqlbatchinserter.cpp \
 
@@ -15,9 +15,11 @@
 HEADERS += \
 	src/sketch/renderthing.h \
     src/sketch/fgraphicsscene.h \
+    src/sketch/itemgrid.h \
     src/sketch/breadboardsketchwidget.h \
     src/sketch/infographicsview.h \
     src/sketch/pcbsketchwidget.h \
+    src/sketch/routingnetcache.h \
     src/sketch/schematicsketchwidget.h \
     src/sketch/sketchwidget.h \
     src/sketch/welcomeview.h \
@@ -29,9 +31,11 @@ HEADERS += \
 SOURCES += \
 	src/sketch/renderthing.cpp \
     src/sketch/fgraphicsscene.cpp \
+    src/sketch/itemgrid.cpp \
     src/sketch/breadboardsketchwidget.cpp \
     src/sketch/infographicsview.cpp \
     src/sketch/pcbsketchwidget.cpp \
+    src/sketch/routingnetcache.cpp \
     src/sketch/schematicsketchwidget.cpp \
     src/sketch/sketchwidget.cpp \
     src/sketch/welcomeview.cpp \
@@ -17,6 +17,7 @@ HEADERS += src/svg/svgfilesplitter.h \
     src/svg/svgpathgrammar_p.h \
     src/svg/svgpathlexer.h \
     src/svg/svgpathrunner.h \
+    src/svg/svgpathscanner.h \
     src/svg/svg2gerber.h \
     src/svg/svgflattener.h \
     src/svg/gerbergenerator.h \
@@ -31,6 +32,8 @@ HEADERS += src/svg/svgfilesplitter.h \
     src/svg/gedaelementgrammar_p.h \
     src/svg/gedaelementlexer.h \
     src/svg/clipperhelpers.h \
+    src/svg/svgrasterizer.h \
+    src/svg/svgstreamrewriter.h \
     $$PWD/../src/svg/svgtext.h
 
 SOURCES += src/svg/svgfilesplitter.cpp \
@@ -38,6 +41,7 @@ SOURCES += src/svg/svgfilesplitter.cpp \
     src/svg/svgpathgrammar.cpp \
     src/svg/svgpathlexer.cpp \
     src/svg/svgpathrunner.cpp \
+    src/svg/svgpathscanner.cpp \
     src/svg/svg2gerber.cpp \
     src/svg/svgflattener.cpp \
     src/svg/gerbergenerator.cpp \
@@ -51,4 +55,6 @@ SOURCES += src/svg/svgfilesplitter.cpp \
     src/svg/gedaelementparser.cpp \
     src/svg/gedaelementgrammar.cpp \
     src/svg/gedaelementlexer.cpp \
+    src/svg/svgrasterizer.cpp \
+    src/svg/svgstreamrewriter.cpp \
     $$PWD/../src/svg/svgtext.cpp
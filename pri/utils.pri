@@ -40,6 +40,7 @@ src/utils/folderutils.h \
 src/utils/graphicsutils.h \
 src/utils/graphutils.h \
 src/utils/ratsnestcolors.h \
+src/utils/ratsnestgraph.h \
 src/utils/schematicrectconstants.h \
 src/utils/s2s.h \
 src/utils/textutils.h \
@@ -69,6 +70,7 @@ src/utils/folderutils.cpp \
 src/utils/graphicsutils.cpp \
 src/utils/graphutils.cpp \
 src/utils/ratsnestcolors.cpp \
+src/utils/ratsnestgraph.cpp \
 src/utils/schematicrectconstants.cpp \
 src/utils/s2s.cpp \
 src/utils/textutils.cpp \
@@ -31,6 +31,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QProgressDialog>
 #include <QUndoCommand>
 
+#include <atomic>
+
 #include "../viewgeometry.h"
 #include "../viewlayer.h"
 #include "../connectors/connectoritem.h"
@@ -92,9 +94,9 @@ Q_SIGNALS:
 protected:
 	PCBSketchWidget * m_sketchWidget = nullptr;
 	QList< QList<ConnectorItem*>* > m_allPartConnectorItems;
-	bool m_cancelled = false;
+	std::atomic<bool> m_cancelled{false};			// read by MazeRouter ordering workers
 	bool m_cancelTrace = false;
-	bool m_stopTracing = false;
+	std::atomic<bool> m_stopTracing{false};
 	bool m_useBest = false;
 	bool m_bothSidesNow = false;
 	int m_maximumProgressPart = 0;
@@ -19,6 +19,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "drc.h"
+#include "drcvector.h"
+#include "pixelcollide.h"
 #include "../connectors/svgidlayer.h"
 #include "../sketch/pcbsketchwidget.h"
 #include "../debugdialog.h"
@@ -31,7 +33,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../viewlayer.h"
 #include "../processeventblocker.h"
 #include "src/items/wire.h"
+#include "../svg/clipperhelpers.h"
 
+#include <clipper.hpp>
+#include <limits>
 #include <qmath.h>
 #include <QApplication>
 #include <QMessageBox>
@@ -44,6 +49,16 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QLabel>
 #include <QListWidget>
 #include <QRadioButton>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSvgRenderer>
+#include <QMutex>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <cstring>
+
+using namespace ClipperLib;
 
 ///////////////////////////////////////////
 //
@@ -61,38 +76,6 @@ const QString DRC::Net = "net";
 
 const uchar DRC::BitTable[] = { 128, 64, 32, 16, 8, 4, 2, 1 };
 
-bool pixelsCollide(QImage * image1, QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points) {
-	bool result = false;
-	const uchar * bits1 = image1->constScanLine(0);
-	const uchar * bits2 = image2->constScanLine(0);
-	int bytesPerLine = image1->bytesPerLine();
-	for (int y = y1; y < y2; y++) {
-		int offset = y * bytesPerLine;
-		for (int x = x1; x < x2; x++) {
-			//QRgb p1 = image1->pixel(x, y);
-			//if (p1 == 0xffffffff) continue;
-
-			//QRgb p2 = image2->pixel(x, y);
-			//if (p2 == 0xffffffff) continue;
-
-			int byteOffset = (x >> 3) + offset;
-			uchar mask = DRC::BitTable[x & 7];
-
-			if ((*(bits1 + byteOffset) & mask) != 0) continue;
-			if ((*(bits2 + byteOffset) & mask) != 0) continue;
-
-			image3->setPixel(x, y, clr);
-			//DebugDialog::debug(QString("p1:%1 p2:%2").arg(p1, 0, 16).arg(p2, 0, 16));
-			result = true;
-			if (points.count() < 1000) {
-				points.append(QPointF(x, y));
-			}
-		}
-	}
-
-	return result;
-}
-
 QStringList getNames(CollidingThing * collidingThing) {
 	QStringList names;
 	QList<ItemBase *> itemBases;
@@ -119,6 +102,104 @@ void allGs(QDomElement & element) {
 	}
 }
 
+void combineSingletons(QList< QList<ConnectorItem *> > & equis, QList< QList<ConnectorItem *> > & singletons) {
+	// we are checking all the singletons at once
+	// but the DRC will miss it if any of them overlap each other
+
+	while (singletons.count() > 0) {
+		QList<ConnectorItem *> combined;
+		QList<ConnectorItem *> singleton = singletons.takeFirst();
+		ItemBase * chief = singleton.at(0)->attachedTo()->layerKinChief();
+		combined.append(singleton);
+		for (int ix = singletons.count() - 1; ix >= 0; ix--) {
+			QList<ConnectorItem *> candidate = singletons.at(ix);
+			if (candidate.at(0)->attachedTo()->layerKinChief() == chief) {
+				combined.append(candidate);
+				singletons.removeAt(ix);
+			}
+		}
+
+		equis.append(combined);
+	}
+}
+
+LayerList copperLayerIDs(ViewLayer::ViewLayerPlacement viewLayerPlacement) {
+	LayerList viewLayerIDs = ViewLayer::copperLayers(viewLayerPlacement);
+	viewLayerIDs.removeOne(ViewLayer::GroundPlane0);
+	viewLayerIDs.removeOne(ViewLayer::GroundPlane1);
+	return viewLayerIDs;
+}
+
+QHash<ConnectorItem *, QRectF> netRects(const QList<ConnectorItem *> & equi, const LayerList & viewLayerIDs) {
+	QHash<ConnectorItem *, QRectF> rects;
+	QList<Wire *> wires;
+	Q_FOREACH (ConnectorItem * equ, equi) {
+		if (viewLayerIDs.contains(equ->attachedToViewLayerID())) {
+			if (equ->attachedToItemType() == ModelPart::Wire) {
+				Wire * wire = qobject_cast<Wire *>(equ->attachedTo());
+				if (!wires.contains(wire)) {
+					wires.append(wire);
+					// could break diagonal wires into a series of rects
+					rects.insert(equ, wire->sceneBoundingRect());
+				}
+			}
+			else {
+				rects.insert(equ, equ->sceneBoundingRect());
+			}
+		}
+	}
+
+	return rects;
+}
+
+struct NetCheckWorker {
+	QDomDocument * masterDoc;
+	QImage * plusImage;
+	QImage * minusImage;
+	QImage * displayImage;
+};
+
+struct NetChecks {
+	QVector<NetCheck> netChecks;
+	QVector<bool> finished;				// guarded by mutex
+	QMutex mutex;
+	QAtomicInt next;
+	QRectF boardRect;
+	QRectF sourceRes;
+	ViewLayer::ViewLayerPlacement viewLayerPlacement;
+	double keepoutMils;
+	double dpi;
+};
+
+///////////////////////////////////////////////
+
+Paths vectorOverlap(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, const VectorCopper & vectorCopper) {
+	QList<QDomElement> net;
+	QList<QDomElement> alsoNet;
+	QList<QDomElement> notNet;
+	Markers markers;
+	markers.outID = DRC::AlsoNet;
+	markers.inTerminalID = markers.inSvgID = markers.inSvgAndID = markers.inNoID = DRC::Net;
+	DRC::splitNetPrep(masterDoc, equi, markers, net, alsoNet, notNet, true);
+
+	QList<int> netIndexes;
+	QSet<int> otherIndexes;
+	Q_FOREACH (QDomElement element, net) {
+		bool ok;
+		int ix = element.attribute("drcindex").toInt(&ok);
+		if (ok) netIndexes << ix;
+		element.removeAttribute("net");
+	}
+	Q_FOREACH (QDomElement element, alsoNet + notNet) {
+		bool ok;
+		int ix = element.attribute("drcindex").toInt(&ok);
+		if (ok) otherIndexes << ix;
+		element.removeAttribute("net");
+	}
+
+	return vectorCopper.overlap(netIndexes, otherIndexes);
+}
+
 ///////////////////////////////////////////////
 
 DRCResultsDialog::DRCResultsDialog(const QString & message, const QStringList & messages, const QList<CollidingThing *> & collidingThings,
@@ -214,6 +295,8 @@ void DRCResultsDialog::releasedSlot(QListWidgetItem * item) {
 
 const QString DRC::KeepoutSettingName("DRC_Keepout");
 const double DRC::KeepoutDefaultMils = 10;
+const QString DRC::EngineSettingName("DRC_Engine");
+const QString DRC::VectorEngine("vector");
 
 ///////////////////////////////////////////////
 
@@ -233,6 +316,9 @@ DRC::DRC(PCBSketchWidget * sketchWidget, ItemBase * board) :
     m_maxProgress(0)
 {
 	CancelledMessage = tr("DRC was cancelled.");
+
+	QSettings settings;
+	m_vector = settings.value(EngineSettingName).toString() == VectorEngine;
 }
 
 DRC::~DRC()
@@ -357,18 +443,34 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	QSize imgSize(qCeil(sourceRes.width()), qCeil(sourceRes.height()));
 
-	m_plusImage = new QImage(imgSize, QImage::Format_Mono);
-	m_plusImage->fill(0xffffffff);
-
-	m_minusImage = new QImage(imgSize, QImage::Format_Mono);
-	m_minusImage->fill(0);
-
 	m_displayImage = new QImage(imgSize, QImage::Format_Indexed8);
 	m_displayImage->setColor(0, 0);
 	m_displayImage->setColor(1, 0x80ff0000);
 	m_displayImage->setColor(2, 0xffffff00);
 	m_displayImage->fill(0);
 
+	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
+	layerSpecs << ViewLayer::NewBottom;
+	if (bothSidesNow) layerSpecs << ViewLayer::NewTop;
+
+	if (m_vector) {
+		// the display image is only used for highlighting; the checks themselves are done on polygons
+		combineSingletons(equis, singletons);
+		if (!startVector(message, messages, collidingThings, equis, layerSpecs, keepoutMils, dpi, progress)) {
+			return false;
+		}
+
+		checkHoles(messages, collidingThings,  dpi);
+		checkCopperBoth(messages, collidingThings, dpi);
+		return true;
+	}
+
+	m_plusImage = new QImage(imgSize, QImage::Format_Mono);
+	m_plusImage->fill(0xffffffff);
+
+	m_minusImage = new QImage(imgSize, QImage::Format_Mono);
+	m_minusImage->fill(0);
+
 	if (!makeBoard(m_minusImage, sourceRes)) {
 		message = tr("Fritzing error: unable to render board svg.");
 		return false;
@@ -376,10 +478,6 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	extendBorder(1, m_minusImage);   // since the resolution = keepout, extend by 1
 
-	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
-	layerSpecs << ViewLayer::NewBottom;
-	if (bothSidesNow) layerSpecs << ViewLayer::NewTop;
-
 	int emptyMasterCount = 0;
 	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
 		if (viewLayerPlacement == ViewLayer::NewTop) {
@@ -388,9 +486,7 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 		}
 		else Q_EMIT wantBottomVisible();
 
-		LayerList viewLayerIDs = ViewLayer::copperLayers(viewLayerPlacement);
-		viewLayerIDs.removeOne(ViewLayer::GroundPlane0);
-		viewLayerIDs.removeOne(ViewLayer::GroundPlane1);
+		LayerList viewLayerIDs = copperLayerIDs(viewLayerPlacement);
 		RenderThing renderThing;
 		renderThing.printerScale = GraphicsUtils::SVGDPI;
 		renderThing.blackOnly = true;
@@ -457,26 +553,298 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	}
 
-	// we are checking all the singletons at once
-	// but the DRC will miss it if any of them overlap each other
+	combineSingletons(equis, singletons);
 
-	while (singletons.count() > 0) {
-		QList<ConnectorItem *> combined;
-		QList<ConnectorItem *> singleton = singletons.takeFirst();
-		ItemBase * chief = singleton.at(0)->attachedTo()->layerKinChief();
-		combined.append(singleton);
-		for (int ix = singletons.count() - 1; ix >= 0; ix--) {
-			QList<ConnectorItem *> candidate = singletons.at(ix);
-			if (candidate.at(0)->attachedTo()->layerKinChief() == chief) {
-				combined.append(candidate);
-				singletons.removeAt(ix);
+	int index = 0;
+	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
+		if (viewLayerPlacement == ViewLayer::NewTop) Q_EMIT wantTopVisible();
+		else Q_EMIT wantBottomVisible();
+
+		QDomDocument * masterDoc = m_masterDocs.value(viewLayerPlacement, nullptr);
+		if (masterDoc == nullptr) continue;
+
+		if (!checkNets(masterDoc, equis, viewLayerPlacement, sourceRes, keepoutMils, dpi, index, progress, messages, collidingThings)) {
+			message = CancelledMessage;
+			return false;
+		}
+	}
+	checkHoles(messages, collidingThings,  dpi);
+	checkCopperBoth(messages, collidingThings, dpi);
+
+	return true;
+}
+
+bool DRC::checkNets(QDomDocument * masterDoc, QList< QList<ConnectorItem *> > & equis, ViewLayer::ViewLayerPlacement viewLayerPlacement, QRectF & sourceRes, double keepoutMils, double dpi, int & index, int & progress, QStringList & messages, QList<CollidingThing *> & collidingThings) {
+	// each net is split and checked by a pool of workers, each with its own copy of the master doc and its own plus/minus images;
+	// results are reported back here in net order
+	LayerList viewLayerIDs = copperLayerIDs(viewLayerPlacement);
+
+	NetChecks checks;
+	checks.boardRect = m_board->sceneBoundingRect();
+	checks.sourceRes = sourceRes;
+	checks.viewLayerPlacement = viewLayerPlacement;
+	checks.keepoutMils = keepoutMils;
+	checks.dpi = dpi;
+	int netCount = 0;
+	Q_FOREACH (QList<ConnectorItem *> equi, equis) {
+		NetCheck netCheck;
+		netCheck.index = -1;
+		Q_FOREACH (ConnectorItem * equ, equi) {
+			if (viewLayerIDs.contains(equ->attachedToViewLayerID())) {
+				netCheck.index = index++;
+				break;
 			}
 		}
+		if (netCheck.index >= 0) {
+			// scene geometry and connector ids are only read here on the gui thread
+			netCheck.ids = splitNetIDs(equi, true);
+			QHash<ConnectorItem *, QRectF> rects = netRects(equi, viewLayerIDs);
+			Q_FOREACH (ConnectorItem * equ, rects.keys()) {
+				netCheck.connectorItems << equ;
+				netCheck.rects << rects.value(equ);
+			}
+			netCount++;
+		}
+		checks.netChecks << netCheck;
+		checks.finished << (netCheck.index < 0);
+	}
 
-		equis.append(combined);
+	QSize imgSize = m_displayImage->size();
+	int workerCount = qMax(1, qMin(QThread::idealThreadCount(), netCount));
+	QList<NetCheckWorker *> workers;
+	QList< QFuture<void> > futures;
+	for (int i = 0; i < workerCount && netCount > 0; i++) {
+		auto * worker = new NetCheckWorker;
+		worker->masterDoc = new QDomDocument(masterDoc->cloneNode(true).toDocument());
+		worker->plusImage = new QImage(imgSize, QImage::Format_Mono);
+		worker->minusImage = new QImage(imgSize, QImage::Format_Mono);
+		worker->displayImage = new QImage(imgSize, QImage::Format_Indexed8);
+		worker->displayImage->setColorTable(m_displayImage->colorTable());
+		worker->displayImage->fill(0);
+		workers << worker;
+		futures << QtConcurrent::run([this, &checks, worker]() {
+			checkNetsAux(&checks, worker);
+		});
+	}
+
+	int reported = 0;
+	while (reported < checks.netChecks.count()) {
+		bool finished;
+		checks.mutex.lock();
+		finished = checks.finished.at(reported);
+		checks.mutex.unlock();
+		if (!finished) {
+			if (m_cancelled) break;
+
+			ProcessEventBlocker::processEvents(50);
+			continue;
+		}
+
+		NetCheck & netCheck = checks.netChecks[reported++];
+		if (netCheck.index < 0) {
+			progress++;
+			continue;
+		}
+
+		Q_FOREACH (NetHit hit, netCheck.hits) {
+			for (int y = 0; y < hit.display.height(); y++) {
+				const uchar * from = hit.display.constScanLine(y);
+				uchar * to = m_displayImage->scanLine(y + hit.origin.y()) + hit.origin.x();
+				for (int x = 0; x < hit.display.width(); x++) {
+					if (from[x] != 0) to[x] = from[x];
+				}
+			}
+
+			CollidingThing * collidingThing = findItemsAt(hit.atPixels, m_board, viewLayerIDs, keepoutMils, dpi, false, hit.connectorItem);
+			QStringList names = getNames(collidingThing);
+			QString name0 = names.at(0);
+			QString msg = tr("%1 is overlapping (%2 layer)")
+						  .arg(name0)
+						  .arg(viewLayerPlacement == ViewLayer::NewTop ? ItemBase::TranslatedPropertyNames.value("top") : ItemBase::TranslatedPropertyNames.value("bottom"))
+						  ;
+			messages << msg;
+			collidingThings << collidingThing;
+			Q_EMIT setProgressMessage(msg);
+			updateDisplay();
+		}
+
+		Q_EMIT setProgressValue(progress++);
+
+		ProcessEventBlocker::processEvents();
+		if (m_cancelled) break;
+	}
+
+	// workers look at m_cancelled before every net, so this wait is at most one net long
+	Q_FOREACH (QFuture<void> future, futures) {
+		future.waitForFinished();
+	}
+	Q_FOREACH (NetCheckWorker * worker, workers) {
+		delete worker->masterDoc;
+		delete worker->plusImage;
+		delete worker->minusImage;
+		delete worker->displayImage;
+		delete worker;
+	}
+
+	return !m_cancelled;
+}
+
+void DRC::checkNetsAux(NetChecks * checks, NetCheckWorker * worker) {
+	const QRectF & boardRect = checks->boardRect;
+	double dpi = checks->dpi;
+	while (!m_cancelled) {
+		int ix = checks->next.fetchAndAddRelaxed(1);
+		if (ix >= checks->netChecks.count()) break;
+
+		NetCheck & netCheck = checks->netChecks[ix];
+		if (netCheck.index < 0) continue;
+
+		// we have a net;
+		worker->plusImage->fill(0xffffffff);
+		worker->minusImage->fill(0xffffffff);
+		splitNet(worker->masterDoc, netCheck.ids, worker->minusImage, worker->plusImage, checks->sourceRes, checks->viewLayerPlacement, netCheck.index, checks->keepoutMils);
+
+		for (int i = 0; i < netCheck.connectorItems.count(); i++) {
+			QRectF rect = netCheck.rects.at(i).intersected(boardRect);
+			double l = (rect.left() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
+			double t = (rect.top() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
+			double r = (rect.right() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
+			double b = (rect.bottom() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
+			//DebugDialog::debug(QString("l:%1 t:%2 r:%3 b:%4").arg(l).arg(t).arg(r).arg(b));
+			NetHit hit;
+			if (pixelsCollide(worker->plusImage, worker->minusImage, worker->displayImage, l, t, r, b, 1 /* 0x80ff0000 */, hit.atPixels)) {
+
+#ifndef QT_NO_DEBUG
+				worker->plusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collidePlus%1_%2.png").arg(checks->viewLayerPlacement).arg(netCheck.index));
+				worker->minusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collideMinus%1_%2.png").arg(checks->viewLayerPlacement).arg(netCheck.index));
+#endif
+
+				// hand the marked pixels over and leave the worker's display image clean for the next net
+				QRect pixelRect = QRect(QPoint((int) l, (int) t), QPoint((int) r - 1, (int) b - 1)).intersected(worker->displayImage->rect());
+				hit.connectorItem = netCheck.connectorItems.at(i);
+				hit.origin = pixelRect.topLeft();
+				hit.display = worker->displayImage->copy(pixelRect);
+				for (int y = pixelRect.top(); y <= pixelRect.bottom(); y++) {
+					memset(worker->displayImage->scanLine(y) + pixelRect.left(), 0, pixelRect.width());
+				}
+				netCheck.hits << hit;
+			}
+		}
+
+		QMutexLocker locker(&checks->mutex);
+		checks->finished[ix] = true;
+	}
+}
+
+bool DRC::startVector(QString & message, QStringList & messages, QList<CollidingThing *> & collidingThings, QList< QList<ConnectorItem *> > & equis, const QList<ViewLayer::ViewLayerPlacement> & layerSpecs, double keepoutMils, double dpi, int & progress) {
+	QRectF boardRect = m_board->sceneBoundingRect();
+	QSize deviceSize(qCeil(boardRect.width() * VectorDPI / GraphicsUtils::SVGDPI), qCeil(boardRect.height() * VectorDPI / GraphicsUtils::SVGDPI));
+	double keepout = keepoutMils * VectorDPI / 1000;
+
+	RenderThing renderThing;
+	renderThing.printerScale = GraphicsUtils::SVGDPI;
+	renderThing.blackOnly = true;
+	renderThing.dpi = GraphicsUtils::StandardFritzingDPI;
+	renderThing.hideTerminalPoints = renderThing.selectedItems = renderThing.renderBlocker = false;
+
+	LayerList boardLayerIDs;
+	boardLayerIDs << ViewLayer::Board;
+	QString boardSvg = m_sketchWidget->renderToSVG(renderThing, m_board, boardLayerIDs);
+	if (boardSvg.isEmpty()) {
+		message = tr("Fritzing error: unable to render board svg.");
+		return false;
+	}
+
+	Paths board;
+	{
+		CopperPaintDevice boardDevice(deviceSize);
+		QSvgRenderer renderer(boardSvg.toUtf8());
+		QPainter painter;
+		painter.begin(&boardDevice);
+		renderer.render(&painter);
+		painter.end();
+		Clipper cp;
+		Q_FOREACH (Paths paths, boardDevice.copper()) {
+			cp.AddPaths(paths, ptSubject, true);
+		}
+		cp.Execute(ctUnion, board, pftNonZero, pftNonZero);
+	}
+
+	QHash<ViewLayer::ViewLayerPlacement, VectorCopper> vectorCoppers;
+	int emptyMasterCount = 0;
+	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
+		if (viewLayerPlacement == ViewLayer::NewTop) Q_EMIT wantTopVisible();
+		else Q_EMIT wantBottomVisible();
+
+		LayerList viewLayerIDs = copperLayerIDs(viewLayerPlacement);
+		QString master = m_sketchWidget->renderToSVG(renderThing, m_board, viewLayerIDs);
+		if (master.isEmpty()) {
+			if (++emptyMasterCount == layerSpecs.count()) {
+				message = tr("No traces or connectors to check");
+				return false;
+			}
+
+			progress++;
+			continue;
+		}
+
+		auto * masterDoc = new QDomDocument();
+		m_masterDocs.insert(viewLayerPlacement, masterDoc);
+
+		QString errorStr;
+		int errorLine;
+		int errorColumn;
+		if (!masterDoc->setContent(master, &errorStr, &errorLine, &errorColumn)) {
+			message = tr("Unexpected SVG rendering failure--contact fritzing.org");
+			return false;
+		}
+
+		QDomElement root = masterDoc->documentElement();
+		int count = tagCopper(root);
+
+		VectorCopper & vectorCopper = vectorCoppers[viewLayerPlacement];
+		vectorCopper.render(masterDoc->toByteArray(), count, deviceSize, keepout);
+		Paths allGrown;
+		Q_FOREACH (Paths grown, vectorCopper.grown) {
+			allGrown.insert(allGrown.end(), grown.begin(), grown.end());
+		}
+
+		ProcessEventBlocker::processEvents();
+		if (m_cancelled) {
+			message = CancelledMessage;
+			return false;
+		}
+
+		Paths outside;
+		Clipper cp;
+		cp.AddPaths(allGrown, ptSubject, true);
+		cp.AddPaths(board, ptClip, true);
+		cp.Execute(ctDifference, outside, pftNonZero, pftNonZero);
+		removeNoise(outside);
+		if (!outside.empty()) {
+			QList<QPolygonF> polygons = clipperToScene(outside, boardRect.topLeft());
+			QList<QPointF> atPixels;
+			markPolygons(polygons, dpi, atPixels);
+			CollidingThing * collidingThing = findItemsAt(atPixels, m_board, viewLayerIDs, keepoutMils, dpi, true, nullptr);
+			collidingThing->atPolygons = polygons;
+			QString msg = tr("Too close to a border (%1 layer)")
+						  .arg(viewLayerPlacement == ViewLayer::NewTop ? ItemBase::TranslatedPropertyNames.value("top") : ItemBase::TranslatedPropertyNames.value("bottom"))
+						  ;
+			Q_EMIT setProgressMessage(msg);
+			messages << msg;
+			collidingThings << collidingThing;
+			updateDisplay();
+		}
+
+		Q_EMIT setProgressValue(progress++);
+
+		ProcessEventBlocker::processEvents();
+		if (m_cancelled) {
+			message = CancelledMessage;
+			return false;
+		}
 	}
 
-	int index = 0;
 	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
 		if (viewLayerPlacement == ViewLayer::NewTop) Q_EMIT wantTopVisible();
 		else Q_EMIT wantBottomVisible();
@@ -484,9 +852,8 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 		QDomDocument * masterDoc = m_masterDocs.value(viewLayerPlacement, nullptr);
 		if (masterDoc == nullptr) continue;
 
-		LayerList viewLayerIDs = ViewLayer::copperLayers(viewLayerPlacement);
-		viewLayerIDs.removeOne(ViewLayer::GroundPlane0);
-		viewLayerIDs.removeOne(ViewLayer::GroundPlane1);
+		LayerList viewLayerIDs = copperLayerIDs(viewLayerPlacement);
+		const VectorCopper & vectorCopper = vectorCoppers[viewLayerPlacement];
 
 		Q_FOREACH (QList<ConnectorItem *> equi, equis) {
 			bool inLayer = false;
@@ -501,51 +868,21 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 				continue;
 			}
 
-			// we have a net;
-			m_plusImage->fill(0xffffffff);
-			m_minusImage->fill(0xffffffff);
-			splitNet(masterDoc, equi, m_minusImage, m_plusImage, sourceRes, viewLayerPlacement, index++, keepoutMils);
-
-			QHash<ConnectorItem *, QRectF> rects;
-			QList<Wire *> wires;
-			Q_FOREACH (ConnectorItem * equ, equi) {
-				if (viewLayerIDs.contains(equ->attachedToViewLayerID())) {
-					if (equ->attachedToItemType() == ModelPart::Wire) {
-						Wire * wire = qobject_cast<Wire *>(equ->attachedTo());
-						if (!wires.contains(wire)) {
-							wires.append(wire);
-							// could break diagonal wires into a series of rects
-							rects.insert(equ, wire->sceneBoundingRect());
-						}
-					}
-					else {
-						rects.insert(equ, equ->sceneBoundingRect());
-					}
-				}
-			}
-
-			ProcessEventBlocker::processEvents();
-			if (m_cancelled) {
-				message = CancelledMessage;
-				return false;
-			}
-
-			Q_FOREACH (ConnectorItem * equ, rects.keys()) {
-				QRectF rect = rects.value(equ).intersected(boardRect);
-				double l = (rect.left() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
-				double t = (rect.top() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
-				double r = (rect.right() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
-				double b = (rect.bottom() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
-				//DebugDialog::debug(QString("l:%1 t:%2 r:%3 b:%4").arg(l).arg(t).arg(r).arg(b));
-				QList<QPointF> atPixels;
-				if (pixelsCollide(m_plusImage, m_minusImage, m_displayImage, l, t, r, b, 1 /* 0x80ff0000 */, atPixels)) {
-
-#ifndef QT_NO_DEBUG
-					m_plusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collidePlus%1_%2.png").arg(viewLayerPlacement).arg(index));
-					m_minusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collideMinus%1_%2.png").arg(viewLayerPlacement).arg(index));
-#endif
-
+			Paths overlap = vectorOverlap(masterDoc, equi, vectorCopper);
+			if (!overlap.empty()) {
+				QHash<ConnectorItem *, QRectF> rects = netRects(equi, viewLayerIDs);
+				Q_FOREACH (ConnectorItem * equ, rects.keys()) {
+					Paths rect;
+					rect.push_back(sceneToClipper(rects.value(equ).intersected(boardRect), boardRect.topLeft()));
+					Paths hits = intersectCopper(overlap, rect);
+					removeNoise(hits);
+					if (hits.empty()) continue;
+
+					QList<QPolygonF> polygons = clipperToScene(hits, boardRect.topLeft());
+					QList<QPointF> atPixels;
+					markPolygons(polygons, dpi, atPixels);
 					CollidingThing * collidingThing = findItemsAt(atPixels, m_board, viewLayerIDs, keepoutMils, dpi, false, equ);
+					collidingThing->atPolygons = polygons;
 					QStringList names = getNames(collidingThing);
 					QString name0 = names.at(0);
 					QString msg = tr("%1 is overlapping (%2 layer)")
@@ -568,12 +905,23 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 			}
 		}
 	}
-	checkHoles(messages, collidingThings,  dpi);
-	checkCopperBoth(messages, collidingThings, dpi);
 
 	return true;
 }
 
+void DRC::markPolygons(const QList<QPolygonF> & polygons, double dpi, QList<QPointF> & atPixels) {
+	// rasterize the overlaps into the display image so the results dialog can highlight them
+	QRectF boardRect = m_board->sceneBoundingRect();
+	double scale = dpi / GraphicsUtils::SVGDPI;
+	QTransform toPixels = QTransform::fromScale(scale, scale);
+	toPixels.translate(-boardRect.left(), -boardRect.top());
+	QList<QPolygonF> pixels;
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		pixels << toPixels.map(polygon);
+	}
+	fillPolygons(pixels, m_displayImage, 1 /* 0x80ff0000 */, atPixels);
+}
+
 bool DRC::makeBoard(QImage * image, QRectF & sourceRes) {
 	LayerList viewLayerIDs;
 	viewLayerIDs << ViewLayer::Board;
@@ -612,7 +960,7 @@ bool DRC::makeBoard(QImage * image, QRectF & sourceRes) {
 	return true;
 }
 
-void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils) {
+void DRC::splitNet(QDomDocument * masterDoc, const SplitNetIDs & ids, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils) {
 	// deal with connectors on the same part, even though they are not on the same net
 	// in other words, make sure there are no overlaps of connectors on the same part
 	QList<QDomElement> net;
@@ -621,7 +969,7 @@ void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QIma
 	Markers markers;
 	markers.outID = AlsoNet;
 	markers.inTerminalID = markers.inSvgID = markers.inSvgAndID = markers.inNoID = Net;
-	splitNetPrep(masterDoc, equi, markers, net, alsoNet, notNet, true);
+	splitNetPrep(masterDoc, ids, markers, net, alsoNet, notNet, true);
 	Q_FOREACH (QDomElement element, notNet) element.setTagName("g");
 	Q_FOREACH (QDomElement element, alsoNet) element.setTagName("g");
 	Q_FOREACH (QDomElement element, net) {
@@ -671,17 +1019,19 @@ void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QIma
 
 void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, const Markers & markers, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection)
 {
-	QMultiHash<QString, QString> partSvgIDs;
-	QMultiHash<QString, QString> partTerminalIDs;
-	QHash<QString, QString> bothIDs;
-	QMultiHash<QString, ItemBase *> itemBases;
-	QSet<QString> wireIDs;
+	splitNetPrep(masterDoc, splitNetIDs(equi, checkIntersection), markers, net, alsoNet, notNet, checkIntersection);
+}
+
+SplitNetIDs DRC::splitNetIDs(const QList<ConnectorItem *> & equi, bool checkIntersection)
+{
+	SplitNetIDs ids;
+	QHash<QString, ItemBase *> itemBases;
 	Q_FOREACH (ConnectorItem * equ, equi) {
 		ItemBase * itemBase = equ->attachedTo();
 		if (itemBase == nullptr) continue;
 
 		if (itemBase->itemType() == ModelPart::Wire) {
-			wireIDs.insert(QString::number(itemBase->id()));
+			ids.wireIDs.insert(QString::number(itemBase->id()));
 		}
 
 		if (equ->connector() == nullptr) {
@@ -693,14 +1043,43 @@ void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi,
 
 		QString sid = QString::number(itemBase->id());
 		SvgIdLayer * svgIdLayer = equ->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-		partSvgIDs.insert(sid, svgIdLayer->m_svgId);
+		ids.partSvgIDs.insert(sid, svgIdLayer->m_svgId);
 		if (!svgIdLayer->m_terminalId.isEmpty()) {
-			partTerminalIDs.insert(sid, svgIdLayer->m_terminalId);
-			bothIDs.insert(sid + svgIdLayer->m_svgId, svgIdLayer->m_terminalId);
+			ids.partTerminalIDs.insert(sid, svgIdLayer->m_terminalId);
+			ids.bothIDs.insert(sid + svgIdLayer->m_svgId, svgIdLayer->m_terminalId);
 		}
+		// the last connector seen decides which layer's pins the part is split by
 		itemBases.insert(sid, itemBase);
 	}
 
+	if (!checkIntersection) return ids;
+
+	Q_FOREACH (QString sid, itemBases.keys()) {
+		ItemBase * itemBase = itemBases.value(sid);
+		QStringList svgIDs = ids.partSvgIDs.values(sid);
+		QStringList terminalIDs = ids.partTerminalIDs.values(sid);
+		QStringList notSvgIDs;
+		QStringList notTerminalIDs;
+		Q_FOREACH (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
+			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+			if (!svgIDs.contains(svgIdLayer->m_svgId)) {
+				notSvgIDs.append(svgIdLayer->m_svgId);
+			}
+			if (!svgIdLayer->m_terminalId.isEmpty()) {
+				if (!terminalIDs.contains(svgIdLayer->m_terminalId)) {
+					notTerminalIDs.append(svgIdLayer->m_terminalId);
+				}
+			}
+		}
+		ids.notSvgIDs.insert(sid, notSvgIDs);
+		ids.notTerminalIDs.insert(sid, notTerminalIDs);
+	}
+
+	return ids;
+}
+
+void DRC::splitNetPrep(QDomDocument * masterDoc, const SplitNetIDs & ids, const Markers & markers, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection)
+{
 	QList<QDomElement> todo;
 	todo << masterDoc->documentElement();
 	bool firstTime = true;
@@ -723,16 +1102,16 @@ void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi,
 
 		QString partID = element.attribute("partID");
 		if (!partID.isEmpty()) {
-			QStringList svgIDs = partSvgIDs.values(partID);
-			QStringList terminalIDs = partTerminalIDs.values(partID);
+			QStringList svgIDs = ids.partSvgIDs.values(partID);
+			QStringList terminalIDs = ids.partTerminalIDs.values(partID);
 			if (svgIDs.count() == 0) {
 				markSubs(element, NotNet);
 			}
-			else if (wireIDs.contains(partID)) {
+			else if (ids.wireIDs.contains(partID)) {
 				markSubs(element, Net);
 			}
 			else {
-				splitSubs(masterDoc, element, partID, markers, svgIDs, terminalIDs, itemBases.values(partID), bothIDs, checkIntersection);
+				splitSubs(masterDoc, element, partID, markers, svgIDs, terminalIDs, ids.notSvgIDs.value(partID), ids.notTerminalIDs.value(partID), ids.bothIDs, checkIntersection);
 			}
 		}
 
@@ -769,29 +1148,12 @@ void DRC::markSubs(QDomElement & root, const QString & mark) {
 	}
 }
 
-void DRC::splitSubs(QDomDocument * doc, QDomElement & root, const QString & partID, const Markers & markers, const QStringList & svgIDs, const QStringList & terminalIDs, const QList<ItemBase *> & itemBases, QHash<QString, QString> & bothIDs, bool checkIntersection)
+void DRC::splitSubs(QDomDocument * doc, QDomElement & root, const QString & partID, const Markers & markers, const QStringList & svgIDs, const QStringList & terminalIDs, const QStringList & notSvgIDs, const QStringList & notTerminalIDs, const QHash<QString, QString> & bothIDs, bool checkIntersection)
 {
 	//QString string;
 	//QTextStream stream(&string);
 	//root.save(stream, 0);
 
-	QStringList notSvgIDs;
-	QStringList notTerminalIDs;
-	if (checkIntersection && itemBases.count() > 0) {
-		ItemBase * itemBase = itemBases.at(0);
-		Q_FOREACH (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
-			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-			if (!svgIDs.contains(svgIdLayer->m_svgId)) {
-				notSvgIDs.append(svgIdLayer->m_svgId);
-			}
-			if (!svgIdLayer->m_terminalId.isEmpty()) {
-				if (!terminalIDs.contains(svgIdLayer->m_terminalId)) {
-					notTerminalIDs.append(svgIdLayer->m_terminalId);
-				}
-			}
-		}
-	}
-
 	// split subelements of a part into separate nets
 	QList<QDomElement> todo;
 	QList<QDomElement> netElements;
@@ -31,6 +31,12 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QRadioButton>
 #include <QListWidgetItem>
 #include <QPointer>
+#include <QPolygonF>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+#include <atomic>
 
 #include "../svg/svgfilesplitter.h"
 #include "../viewlayer.h"
@@ -38,6 +44,32 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 struct CollidingThing {
 	QPointer<class NonConnectorItem> nonConnectorItem;
 	QList<QPointF> atPixels;
+	QList<QPolygonF> atPolygons;		// exact overlap outlines in scene coordinates; only filled by the vector engine
+};
+
+struct NetHit {
+	class ConnectorItem * connectorItem;
+	QList<QPointF> atPixels;
+	QPoint origin;
+	QImage display;					// the colliding pixels, cropped to the connector's rect
+};
+
+// ids of the svg elements belonging to a net, collected on the gui thread so workers never touch the scene
+struct SplitNetIDs {
+	QMultiHash<QString, QString> partSvgIDs;
+	QMultiHash<QString, QString> partTerminalIDs;
+	QHash<QString, QString> bothIDs;
+	QSet<QString> wireIDs;
+	QHash<QString, QStringList> notSvgIDs;			// per part, only filled when checking intersections
+	QHash<QString, QStringList> notTerminalIDs;
+};
+
+struct NetCheck {
+	SplitNetIDs ids;
+	QList<class ConnectorItem *> connectorItems;
+	QList<QRectF> rects;			// one per connectorItem, in scene coordinates
+	int index;						// -1 when the net has nothing on the layer being checked
+	QList<NetHit> hits;
 };
 
 struct Markers {
@@ -63,6 +95,8 @@ public:
 
 public:
 	static void splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, const Markers &, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection);
+	static void splitNetPrep(QDomDocument * masterDoc, const SplitNetIDs &, const Markers &, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection);
+	static SplitNetIDs splitNetIDs(const QList<ConnectorItem *> & equi, bool checkIntersection);
 	static void extendBorder(double keepoutImagePixels, QImage * image);
 
 public Q_SLOTS:
@@ -84,12 +118,18 @@ public:
 	static const uchar BitTable[];
 	static const QString KeepoutSettingName;
 	static const double KeepoutDefaultMils;
+	static const QString EngineSettingName;
+	static const QString VectorEngine;
 
 protected:
 	bool makeBoard(QImage *, QRectF & sourceRes);
-	void splitNet(QDomDocument *, QList<ConnectorItem *> &, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils);
+	void splitNet(QDomDocument *, const SplitNetIDs &, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils);
+	bool checkNets(QDomDocument * masterDoc, QList< QList<ConnectorItem *> > & equis, ViewLayer::ViewLayerPlacement, QRectF & sourceRes, double keepoutMils, double dpi, int & index, int & progress, QStringList & messages, QList<CollidingThing *> &);
+	void checkNetsAux(struct NetChecks *, struct NetCheckWorker *);
 	void updateDisplay();
 	bool startAux(QString & message, QStringList & messages, QList<CollidingThing *> &, double keepoutMils);
+	bool startVector(QString & message, QStringList & messages, QList<CollidingThing *> &, QList< QList<ConnectorItem *> > & equis, const QList<ViewLayer::ViewLayerPlacement> &, double keepoutMils, double dpi, int & progress);
+	void markPolygons(const QList<QPolygonF> &, double dpi, QList<QPointF> & atPixels);
 	CollidingThing * findItemsAt(QList<QPointF> &, ItemBase * board, const LayerList & viewLayerIDs, double keepout, double dpi, bool skipHoles, ConnectorItem * already);
 	void checkHoles(QStringList & messages, QList<CollidingThing *> & collidingThings, double dpi);
 	void checkCopperBoth(QStringList & messages, QList<CollidingThing *> & collidingThings, double dpi);
@@ -97,7 +137,7 @@ protected:
 
 protected:
 	static void markSubs(QDomElement & root, const QString & mark);
-	static void splitSubs(QDomDocument *, QDomElement & root, const QString & partID, const Markers &, const QStringList & svgIDs,  const QStringList & terminalIDs, const QList<ItemBase *> &, QHash<QString, QString> & both, bool checkIntersection);
+	static void splitSubs(QDomDocument *, QDomElement & root, const QString & partID, const Markers &, const QStringList & svgIDs,  const QStringList & terminalIDs, const QStringList & notSvgIDs, const QStringList & notTerminalIDs, const QHash<QString, QString> & both, bool checkIntersection);
 
 protected:
 	PCBSketchWidget * m_sketchWidget;
@@ -108,8 +148,9 @@ protected:
 	QImage * m_displayImage;
 	QGraphicsPixmapItem * m_displayItem;
 	QHash<ViewLayer::ViewLayerPlacement, QDomDocument *> m_masterDocs;
-	bool m_cancelled;
+	std::atomic<bool> m_cancelled;
 	int m_maxProgress;
+	bool m_vector;
 };
 
 class DRCResultsDialog : public QDialog
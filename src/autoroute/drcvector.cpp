@@ -0,0 +1,392 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "drcvector.h"
+#include "../utils/graphicsutils.h"
+#include "../utils/textutils.h"
+#include "../svg/clipperhelpers.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPainterPathStroker>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace ClipperLib;
+
+int colorIndex(const QColor & color) {
+	// untagged (black) drawing ends up at -1
+	return (int) (color.rgb() & 0xffffff) - 1;
+}
+
+class CopperPaintEngine : public QPaintEngine
+{
+public:
+	CopperPaintEngine() : QPaintEngine((QPaintEngine::PaintEngineFeatures) (QPaintEngine::AllFeatures
+			& ~QPaintEngine::PatternBrush
+			& ~QPaintEngine::PerspectiveTransform
+			& ~QPaintEngine::ConicalGradientFill
+			& ~QPaintEngine::PorterDuff)) {
+	}
+
+	bool begin(QPaintDevice *) override {
+		return true;
+	}
+
+	bool end() override {
+		return true;
+	}
+
+	void updateState(const QPaintEngineState &) override {
+	}
+
+	void drawPixmap(const QRectF &, const QPixmap &, const QRectF &) override {
+	}
+
+	void drawPath(const QPainterPath & path) override {
+		addShape(path, true);
+	}
+
+	void drawPolygon(const QPointF * points, int pointCount, PolygonDrawMode mode) override;
+
+	QPaintEngine::Type type() const override {
+		return User;
+	}
+
+public:
+	QHash<int, Paths> copper;
+
+protected:
+	void addShape(const QPainterPath &, bool fill);
+	void addPaths(int index, const Paths &, PolyFillType);
+};
+
+void CopperPaintEngine::drawPolygon(const QPointF * points, int pointCount, PolygonDrawMode mode) {
+	if (pointCount <= 0) return;
+
+	QPainterPath path(points[0]);
+	for (int i = 1; i < pointCount; i++) {
+		path.lineTo(points[i]);
+	}
+	if (mode != QPaintEngine::PolylineMode) {
+		path.closeSubpath();
+	}
+	path.setFillRule(mode == QPaintEngine::OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+	addShape(path, mode != QPaintEngine::PolylineMode);
+}
+
+void CopperPaintEngine::addShape(const QPainterPath & path, bool fill) {
+	QTransform matrix = state->transform();
+	if (fill && state->brush().style() != Qt::NoBrush) {
+		addPaths(colorIndex(state->brush().color()), polygonsToClipper(path.toSubpathPolygons(), matrix), path.fillRule() == Qt::OddEvenFill ? pftEvenOdd : pftNonZero);
+	}
+	if (state->pen().style() != Qt::NoPen && state->pen().widthF() > 0) {
+		QPainterPath stroke = QPainterPathStroker(state->pen()).createStroke(path);
+		addPaths(colorIndex(state->pen().color()), polygonsToClipper(stroke.toFillPolygons(), matrix), pftNonZero);
+	}
+}
+
+void CopperPaintEngine::addPaths(int index, const Paths & paths, PolyFillType fillType) {
+	Paths & bucket = copper[index];
+	Clipper cp;
+	cp.AddPaths(bucket, ptSubject, true);
+	cp.AddPaths(paths, ptClip, true);
+	cp.Execute(ctUnion, bucket, pftNonZero, fillType);
+}
+
+///////////////////////////////////////////////
+
+CopperPaintDevice::CopperPaintDevice(QSize size) : m_size(size), m_engine(new CopperPaintEngine) {
+}
+
+CopperPaintDevice::~CopperPaintDevice() {
+	delete m_engine;
+}
+
+QPaintEngine * CopperPaintDevice::paintEngine() const {
+	return m_engine;
+}
+
+const QHash<int, Paths> & CopperPaintDevice::copper() const {
+	return m_engine->copper;
+}
+
+int CopperPaintDevice::metric(QPaintDevice::PaintDeviceMetric metric) const {
+	switch (metric) {
+	case PdmWidth:
+		return m_size.width();
+	case PdmHeight:
+		return m_size.height();
+	case PdmWidthMM:
+		return qRound(m_size.width() * 25.4 / VectorDPI);
+	case PdmHeightMM:
+		return qRound(m_size.height() * 25.4 / VectorDPI);
+	case PdmDepth:
+		return 1;
+	case PdmNumColors:
+		return 2;
+	case PdmDpiX:
+	case PdmDpiY:
+	case PdmPhysicalDpiX:
+	case PdmPhysicalDpiY:
+		return (int) VectorDPI;
+	case PdmDevicePixelRatio:
+		return 1;
+	default:
+		return QPaintDevice::metric(metric);
+	}
+}
+
+///////////////////////////////////////////////
+
+void CopperIndex::insert(int index, const QRect & bounds) {
+	for (int cy = cell(bounds.top()); cy <= cell(bounds.bottom()); cy++) {
+		for (int cx = cell(bounds.left()); cx <= cell(bounds.right()); cx++) {
+			m_cells[key(cx, cy)].append(index);
+		}
+	}
+}
+
+QSet<int> CopperIndex::candidates(const QRect & bounds) const {
+	QSet<int> result;
+	for (int cy = cell(bounds.top()); cy <= cell(bounds.bottom()); cy++) {
+		for (int cx = cell(bounds.left()); cx <= cell(bounds.right()); cx++) {
+			Q_FOREACH (int index, m_cells.value(key(cx, cy))) {
+				result.insert(index);
+			}
+		}
+	}
+	return result;
+}
+
+int CopperIndex::cell(int coordinate) {
+	return qFloor(coordinate / (double) VectorCellSize);
+}
+
+quint64 CopperIndex::key(int cx, int cy) {
+	return (((quint64) (quint32) cy) << 32) | (quint32) cx;
+}
+
+///////////////////////////////////////////////
+
+void VectorCopper::render(const QByteArray & svg, int count, const QSize & deviceSize, double keepout) {
+	copper.fill(Paths(), count);
+	grown.fill(Paths(), count);
+
+	CopperPaintDevice copperDevice(deviceSize);
+	QSvgRenderer renderer(svg);
+	QPainter painter;
+	painter.begin(&copperDevice);
+	renderer.render(&painter);
+	painter.end();
+
+	for (int ix = 0; ix < count; ix++) {
+		Paths paths = copperDevice.copper().value(ix);
+		if (paths.empty()) continue;
+
+		copper[ix] = paths;
+		grown[ix] = growCopper(paths, keepout);
+		index.insert(ix, pathsBounds(grown.at(ix)));
+	}
+}
+
+Paths VectorCopper::overlap(const QList<int> & netIndexes, const QSet<int> & otherIndexes) const {
+	Paths result;
+	Q_FOREACH (int ix, netIndexes) {
+		if (ix < 0 || ix >= copper.count()) continue;
+
+		const Paths & netCopper = copper.at(ix);
+		if (netCopper.empty()) continue;
+
+		Q_FOREACH (int other, index.candidates(pathsBounds(netCopper))) {
+			if (!otherIndexes.contains(other)) continue;
+
+			Paths sect = intersectCopper(netCopper, grown.at(other));
+			result.insert(result.end(), sect.begin(), sect.end());
+		}
+	}
+
+	return result;
+}
+
+///////////////////////////////////////////////
+
+QRect pathsBounds(const Paths & paths) {
+	cInt left = std::numeric_limits<cInt>::max();
+	cInt top = std::numeric_limits<cInt>::max();
+	cInt right = std::numeric_limits<cInt>::min();
+	cInt bottom = std::numeric_limits<cInt>::min();
+	for (const Path & path : paths) {
+		for (const IntPoint & p : path) {
+			left = qMin(left, p.X);
+			top = qMin(top, p.Y);
+			right = qMax(right, p.X);
+			bottom = qMax(bottom, p.Y);
+		}
+	}
+	if (left > right) return QRect();
+
+	return QRect(QPoint((int) left, (int) top), QPoint((int) right, (int) bottom));
+}
+
+Paths growCopper(const Paths & paths, double delta) {
+	ClipperOffset co(2, VectorArcTolerance);
+	co.AddPaths(paths, jtRound, etClosedPolygon);
+	Paths result;
+	co.Execute(result, delta);
+	return result;
+}
+
+Paths intersectCopper(const Paths & subject, const Paths & clip) {
+	Clipper cp;
+	cp.AddPaths(subject, ptSubject, true);
+	cp.AddPaths(clip, ptClip, true);
+	Paths result;
+	cp.Execute(ctIntersection, result, pftNonZero, pftNonZero);
+	return result;
+}
+
+void removeNoise(Paths & paths) {
+	Paths result;
+	for (const Path & path : paths) {
+		if (qAbs(Area(path)) >= VectorMinArea) {
+			result.push_back(path);
+		}
+	}
+	paths.swap(result);
+}
+
+QList<QPolygonF> clipperToScene(const Paths & paths, const QPointF & origin) {
+	QList<QPolygonF> polygons;
+	double scale = GraphicsUtils::SVGDPI / VectorDPI;
+	for (const Path & path : paths) {
+		QPolygonF polygon;
+		for (const IntPoint & p : path) {
+			polygon << QPointF(p.X * scale + origin.x(), p.Y * scale + origin.y());
+		}
+		polygons << polygon;
+	}
+	return polygons;
+}
+
+Path sceneToClipper(const QRectF & rect, const QPointF & origin) {
+	double scale = VectorDPI / GraphicsUtils::SVGDPI;
+	QPolygonF polygon(rect.translated(-origin));
+	return polygonToClipper(polygon, QTransform::fromScale(scale, scale));
+}
+
+static QString inheritedAttribute(const QDomElement & element, const QString & name) {
+	QDomElement ancestor = element;
+	while (!ancestor.isNull()) {
+		if (ancestor.hasAttribute(name)) return ancestor.attribute(name);
+		ancestor = ancestor.parentNode().toElement();
+	}
+	return QString();
+}
+
+int tagCopper(QDomElement & root) {
+	int count = 0;
+	QList<QDomElement> todo;
+	TextUtils::fixStyleAttribute(root);
+	QDomElement child = root.firstChildElement();
+	while (!child.isNull()) {
+		todo << child;
+		child = child.nextSiblingElement();
+	}
+	while (!todo.isEmpty()) {
+		// parents come off the list before their children, so inherited values are plain attributes by the time they are read
+		QDomElement element = todo.takeFirst();
+		TextUtils::fixStyleAttribute(element);
+		child = element.firstChildElement();
+		while (!child.isNull()) {
+			todo << child;
+			child = child.nextSiblingElement();
+		}
+		if (element.tagName() == "g") continue;
+
+		QString color = QString("#%1").arg(count + 1, 6, 16, QChar('0'));
+		element.setAttribute("drcindex", count++);
+
+		QString stroke = inheritedAttribute(element, "stroke");
+		QString strokeWidth = inheritedAttribute(element, "stroke-width");
+		bool ok;
+		double width = strokeWidth.toDouble(&ok);
+		bool stroked = !stroke.isEmpty() && stroke != "none" && (strokeWidth.isEmpty() || !ok || width > 0);
+		if (stroked) {
+			element.setAttribute("stroke", color);
+			if (!strokeWidth.isEmpty()) element.setAttribute("stroke-width", strokeWidth);
+		}
+		else {
+			element.setAttribute("stroke", "none");
+		}
+
+		bool filled = inheritedAttribute(element, "fill") != "none";
+		element.setAttribute("fill", filled ? color : "none");
+	}
+
+	return count;
+}
+
+void fillPolygons(const QList<QPolygonF> & polygons, QImage * image, uint clr, QList<QPointF> & points) {
+	QVector<double> crossings;
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		QRect bounds = polygon.boundingRect().toAlignedRect().intersected(image->rect());
+		if (bounds.isEmpty()) continue;
+
+		bool gotOne = false;
+		for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+			// where the edges cross this row's pixel centers; pairs of crossings enclose the inside (odd-even)
+			double cy = y + 0.5;
+			crossings.clear();
+			for (int i = 0; i < polygon.count(); i++) {
+				QPointF a = polygon.at(i);
+				QPointF b = polygon.at((i + 1) % polygon.count());
+				if ((a.y() <= cy) == (b.y() <= cy)) continue;
+
+				crossings << a.x() + ((cy - a.y()) * (b.x() - a.x()) / (b.y() - a.y()));
+			}
+			std::sort(crossings.begin(), crossings.end());
+
+			uchar * line = image->scanLine(y);
+			for (int i = 0; i + 1 < crossings.count(); i += 2) {
+				int x1 = qMax(bounds.left(), qFloor(crossings.at(i) - 0.5) + 1);
+				int x2 = qMin(bounds.right(), qCeil(crossings.at(i + 1) - 0.5) - 1);
+				if (x2 < x1) continue;
+
+				memset(line + x1, clr, x2 - x1 + 1);
+				gotOne = true;
+				for (int x = x1; x <= x2 && points.count() < 1000; x++) {
+					points.append(QPointF(x, y));
+				}
+			}
+		}
+		if (!gotOne) {
+			// thinner than a pixel: mark it anyway
+			QPoint p = bounds.center();
+			image->setPixel(p, clr);
+			points.append(p);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef DRCVECTOR_H
+#define DRCVECTOR_H
+
+#include <QByteArray>
+#include <QDomElement>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPaintDevice>
+#include <QPolygonF>
+#include <QRect>
+#include <QSet>
+#include <QSize>
+#include <QVector>
+
+#include <clipper.hpp>
+
+///////////////////////////////////////////////
+//
+//	vector DRC
+//
+//	Each copper element of the master svg is tagged with a unique color, and the svg is rendered once
+//	into a paint device which sorts what it is given into Clipper polygons by color.  Overlaps are then
+//	found by intersecting each net element with the keepout-grown copper of its neighbors.
+
+static const double VectorDPI = 100000;					// clipper units per inch: one unit is 0.01 mil
+static const double VectorArcTolerance = 10;			// 0.1 mil
+static const double VectorMinArea = 100;				// overlaps smaller than 0.1 x 0.1 mil are rounding noise
+static const int VectorCellSize = VectorDPI / 10;		// spatial index cells are 0.1 inch square
+
+class CopperPaintDevice : public QPaintDevice
+{
+public:
+	CopperPaintDevice(QSize size);
+	~CopperPaintDevice();
+
+	QPaintEngine * paintEngine() const override;
+	const QHash<int, ClipperLib::Paths> & copper() const;
+
+protected:
+	int metric(QPaintDevice::PaintDeviceMetric metric) const override;
+
+protected:
+	QSize m_size;
+	class CopperPaintEngine * m_engine;
+};
+
+class CopperIndex
+{
+public:
+	void insert(int index, const QRect & bounds);
+	QSet<int> candidates(const QRect & bounds) const;
+
+protected:
+	static int cell(int coordinate);
+	static quint64 key(int cx, int cy);
+
+protected:
+	QHash<quint64, QList<int> > m_cells;
+};
+
+struct VectorCopper {
+	QVector<ClipperLib::Paths> copper;		// each tagged svg element at its real size
+	QVector<ClipperLib::Paths> grown;		// the same copper grown by the keepout
+	CopperIndex index;						// over the bounds of the grown copper
+
+	// render an svg tagged by tagCopper() with count elements; keepout is in clipper units
+	void render(const QByteArray & svg, int count, const QSize & deviceSize, double keepout);
+	// where the net's copper comes within the keepout of the other copper
+	ClipperLib::Paths overlap(const QList<int> & netIndexes, const QSet<int> & otherIndexes) const;
+};
+
+int colorIndex(const QColor & color);
+QRect pathsBounds(const ClipperLib::Paths & paths);
+ClipperLib::Paths growCopper(const ClipperLib::Paths & paths, double delta);
+ClipperLib::Paths intersectCopper(const ClipperLib::Paths & subject, const ClipperLib::Paths & clip);
+void removeNoise(ClipperLib::Paths & paths);
+QList<QPolygonF> clipperToScene(const ClipperLib::Paths & paths, const QPointF & origin);
+ClipperLib::Path sceneToClipper(const QRectF & rect, const QPointF & origin);
+
+// Give each non-<g> element under root its own color, and record the color index in a "drcindex" attribute.
+// Fill and stroke in style attributes are moved to plain attributes first, and only painted fills and strokes are recolored.
+int tagCopper(QDomElement & root);
+
+// Sets the pixels whose centers are inside any of the polygons to clr in the Format_Indexed8 image, a row at a time,
+// and appends the first 1000 to points.  A polygon too thin to cover a pixel center still marks the one under its middle.
+void fillPolygons(const QList<QPolygonF> & polygons, QImage * image, uint clr, QList<QPointF> & points);
+
+#endif
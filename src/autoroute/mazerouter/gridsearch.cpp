@@ -0,0 +1,776 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "gridsearch.h"
+#include "../../debugdialog.h"
+
+#include <algorithm>
+
+static void seedRects(std::priority_queue<GridPoint> queue, QRect rects[2]) {
+	rects[0] = rects[1] = QRect();
+	while (!queue.empty()) {
+		const GridPoint & gp = queue.top();
+		rects[gp.z] |= QRect(gp.x, gp.y, 1, 1);
+		queue.pop();
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool GridPoint::operator<(const GridPoint& other) const {
+	// make sure lower cost is first
+	return qCost > other.qCost;
+}
+////////////////////////////////////////////////////////////////////
+
+static constexpr int GridTileShift = 6;
+static constexpr int GridTileSize = 1 << GridTileShift;		// 64 x 64 cells per tile
+static constexpr int GridTileMask = GridTileSize - 1;
+static constexpr int GridTileCells = GridTileSize * GridTileSize;
+static constexpr int GridTileBitWords = GridTileCells / 64;
+
+struct GridTile {
+	quint64 boardObstacles[GridTileBitWords] = { 0 };
+	quint64 partObstacles[GridTileBitWords] = { 0 };
+	std::unique_ptr<quint16[]> narrow;
+	std::unique_ptr<quint32[]> wide;
+};
+
+// packs a GridValue into a 16- or 32-bit word: the top few codes are the special values
+// (GridSource, GridTarget, etc.), the top bit is GridSourceFlag, the rest is the cost
+template <typename T> struct GridWord {
+	static constexpr T Max = std::numeric_limits<T>::max();
+	static constexpr T SourceFlag = (Max >> 1) + 1;
+	static constexpr T FirstSpecial = Max - T(GridBoardObstacle - GridTempObstacle);
+	static constexpr GridValue CostLimit = SourceFlag - (Max - FirstSpecial) - 1;
+
+	static bool encode(GridValue value, T & word) {
+		if (value >= GridTempObstacle) {
+			word = Max - T(GridBoardObstacle - value);
+			return true;
+		}
+
+		GridValue cost = value & ~GridSourceFlag;
+		if (cost >= CostLimit) return false;
+
+		word = T(cost);
+		if (value & GridSourceFlag) word |= SourceFlag;
+		return true;
+	}
+
+	static GridValue decode(T word) {
+		if (word >= FirstSpecial) return GridBoardObstacle - (Max - word);
+
+		GridValue value = word & T(~SourceFlag);
+		if (word & SourceFlag) value |= GridSourceFlag;
+		return value;
+	}
+};
+
+Grid::Grid(int sx, int sy, int sz) :
+	x(sx), y(sy), z(sz),
+	m_tilesX((sx + GridTileSize - 1) >> GridTileShift),
+	m_tilesY((sy + GridTileSize - 1) >> GridTileShift)
+{
+	m_tiles.resize(m_tilesX * m_tilesY * sz);
+}
+
+bool Grid::contains(int sx, int sy, int sz) const {
+	return sx >= 0 && sy >= 0 && sz >= 0 && sx < x && sy < y && sz < z;
+}
+
+int Grid::tileIndex(int sx, int sy, int sz) const {
+	return (sz * m_tilesY * m_tilesX) + ((sy >> GridTileShift) * m_tilesX) + (sx >> GridTileShift);
+}
+
+GridValue Grid::at(int sx, int sy, int sz) const {
+	Q_ASSERT (sx < x);
+	Q_ASSERT (sy < y);
+	Q_ASSERT (sz < z);
+	const GridTile * tile = m_tiles[tileIndex(sx, sy, sz)].get();
+	if (tile == nullptr) return 0;
+
+	int cell = ((sy & GridTileMask) << GridTileShift) | (sx & GridTileMask);
+	quint64 bit = 1ULL << (cell & 63);
+	if (tile->boardObstacles[cell >> 6] & bit) return GridBoardObstacle;
+	if (tile->partObstacles[cell >> 6] & bit) return GridPartObstacle;
+
+	if (m_wide) {
+		return tile->wide ? GridWord<quint32>::decode(tile->wide[cell]) : 0;
+	}
+
+	return tile->narrow ? GridWord<quint16>::decode(tile->narrow[cell]) : 0;
+}
+
+void Grid::setAt(int sx, int sy, int sz, GridValue value) {
+	Q_ASSERT (sx < x);
+	Q_ASSERT (sy < y);
+	Q_ASSERT (sz < z);
+	std::unique_ptr<GridTile> & slot = m_tiles[tileIndex(sx, sy, sz)];
+	if (!slot) {
+		if (value == 0) return;
+
+		slot.reset(new GridTile);
+	}
+
+	GridTile * tile = slot.get();
+	int cell = ((sy & GridTileMask) << GridTileShift) | (sx & GridTileMask);
+	quint64 bit = 1ULL << (cell & 63);
+	tile->boardObstacles[cell >> 6] &= ~bit;
+	tile->partObstacles[cell >> 6] &= ~bit;
+	if (value == GridBoardObstacle) {
+		tile->boardObstacles[cell >> 6] |= bit;
+		value = 0;
+	}
+	else if (value == GridPartObstacle) {
+		tile->partObstacles[cell >> 6] |= bit;
+		value = 0;
+	}
+
+	setWord(tile, cell, value);
+}
+
+void Grid::setWord(GridTile * tile, int cell, GridValue value) {
+	if (m_wide) {
+		if (!tile->wide) {
+			if (value == 0) return;
+
+			tile->wide.reset(new quint32[GridTileCells]());
+		}
+
+		quint32 word = 0;
+		if (!GridWord<quint32>::encode(value, word)) {
+			// a cost this large means something has gone badly wrong
+			Q_ASSERT(false);
+			GridWord<quint32>::encode((value & GridSourceFlag) | (GridWord<quint32>::CostLimit - 1), word);
+		}
+		tile->wide[cell] = word;
+		return;
+	}
+
+	if (!tile->narrow) {
+		if (value == 0) return;
+
+		tile->narrow.reset(new quint16[GridTileCells]());
+	}
+
+	quint16 word = 0;
+	if (!GridWord<quint16>::encode(value, word)) {
+		widen();
+		setWord(tile, cell, value);
+		return;
+	}
+	tile->narrow[cell] = word;
+}
+
+void Grid::widen() {
+	for (std::unique_ptr<GridTile> & tile : m_tiles) {
+		if (!tile || !tile->narrow) continue;
+
+		tile->wide.reset(new quint32[GridTileCells]);
+		for (int i = 0; i < GridTileCells; i++) {
+			GridWord<quint32>::encode(GridWord<quint16>::decode(tile->narrow[i]), tile->wide[i]);
+		}
+		tile->narrow.reset();
+	}
+	m_wide = true;
+}
+
+QList<QPoint> Grid::init(int sx, int sy, int sz, int width, int height, const QImage & image, GridValue value, bool collectPoints) {
+	QList<QPoint> points;
+	const uchar * bits1 = image.constScanLine(0);
+	int bytesPerLine = image.bytesPerLine();
+	for (int iy = sy; iy < sy + height; iy++) {
+		int offset = iy * bytesPerLine;
+		for (int ix = sx; ix < sx + width; ix++) {
+			int byteOffset = (ix >> 3) + offset;
+			uchar mask = DRC::BitTable[ix & 7];
+
+			//if (routeNumber > 40) {
+			//    DebugDialog::debug(QString("image %1 %2, %3").arg(image.width()).arg(image.height()).arg(image.isNull()));
+			//    DebugDialog::debug(QString("init point %1 %2 %3").arg(ix).arg(iy).arg(sz));
+			//    DebugDialog::debug(QString("init grid %1 %2 %3, %4").arg(x).arg(y).arg(z).arg((long) data, 0, 16));
+			//}
+			if ((*(bits1 + byteOffset)) & mask) continue;
+
+			//if (routeNumber > 40) DebugDialog::debug("after mask");
+
+			setAt(ix, iy, sz, value);
+			//if (routeNumber > 40)
+			//    DebugDialog::debug("set");
+			if (collectPoints) {
+				points.append(QPoint(ix, iy));
+			}
+		}
+	}
+
+	return points;
+}
+
+
+QList<QPoint> Grid::init4(int sx, int sy, int sz, int width, int height, const QImage * image, GridValue value, bool collectPoints) {
+	// pixels are 4 x 4 bits
+	QList<QPoint> points;
+	const uchar * bits1 = image->constScanLine(0);
+	int bytesPerLine = image->bytesPerLine();
+	for (int iy = sy; iy < sy + height; iy++) {
+		int offset = iy * bytesPerLine * 4;
+		for (int ix = sx; ix < sx + width; ix++) {
+			int byteOffset = (ix >> 1) + offset;
+			uchar mask = ix & 1 ? 0x0f : 0xf0;
+
+			if ((*(bits1 + byteOffset) & mask) != mask) ;
+			else if ((*(bits1 + byteOffset + bytesPerLine) & mask) != mask) ;
+			else if ((*(bits1 + byteOffset + bytesPerLine + bytesPerLine) & mask) != mask) ;
+			else if ((*(bits1 + byteOffset + bytesPerLine + bytesPerLine + bytesPerLine) & mask) != mask) ;
+			else continue;  // "pixel" is all white
+
+			setAt(ix, iy, sz, value);
+			if (collectPoints) {
+				points.append(QPoint(ix, iy));
+			}
+		}
+	}
+
+	return points;
+}
+
+void Grid::copy(int fromIndex, int toIndex) {
+	int tilesPerLayer = m_tilesX * m_tilesY;
+	for (int i = 0; i < tilesPerLayer; i++) {
+		const std::unique_ptr<GridTile> & from = m_tiles[(fromIndex * tilesPerLayer) + i];
+		std::unique_ptr<GridTile> & to = m_tiles[(toIndex * tilesPerLayer) + i];
+		if (!from) {
+			to.reset();
+			continue;
+		}
+
+		if (!to) to.reset(new GridTile);
+		std::copy_n(from->boardObstacles, GridTileBitWords, to->boardObstacles);
+		std::copy_n(from->partObstacles, GridTileBitWords, to->partObstacles);
+		if (from->narrow) {
+			if (!to->narrow) to->narrow.reset(new quint16[GridTileCells]);
+			std::copy_n(from->narrow.get(), GridTileCells, to->narrow.get());
+		}
+		else to->narrow.reset();
+		if (from->wide) {
+			if (!to->wide) to->wide.reset(new quint32[GridTileCells]);
+			std::copy_n(from->wide.get(), GridTileCells, to->wide.get());
+		}
+		else to->wide.reset();
+	}
+}
+
+void Grid::clear() {
+	// keep the tiles themselves, since the next net touches the same area, but drop the cost words
+	for (std::unique_ptr<GridTile> & tile : m_tiles) {
+		if (!tile) continue;
+
+		std::fill_n(tile->boardObstacles, GridTileBitWords, 0);
+		std::fill_n(tile->partObstacles, GridTileBitWords, 0);
+		tile->narrow.reset();
+		tile->wide.reset();
+	}
+}
+
+void Grid::clearCosts() {
+	// everything except board and part obstacles goes back to zero
+	for (std::unique_ptr<GridTile> & tile : m_tiles) {
+		if (!tile) continue;
+
+		if (tile->narrow) std::fill_n(tile->narrow.get(), GridTileCells, 0);
+		if (tile->wide) std::fill_n(tile->wide.get(), GridTileCells, 0);
+	}
+}
+
+qint64 Grid::bytesAllocated() const {
+	qint64 bytes = m_tiles.size() * sizeof(std::unique_ptr<GridTile>);
+	for (const std::unique_ptr<GridTile> & tile : m_tiles) {
+		if (!tile) continue;
+
+		bytes += sizeof(GridTile);
+		if (tile->narrow) bytes += GridTileCells * sizeof(quint16);
+		if (tile->wide) bytes += GridTileCells * sizeof(quint32);
+	}
+	return bytes;
+}
+
+Grid::~Grid() = default;
+
+////////////////////////////////////////////////////////////////////
+
+GridSearch::GridSearch(Grid * grid, CostFunction costFunction, bool bothSides, int halfGridViaSize, const std::function<bool()> & stopRequested) :
+	m_grid(grid),
+	m_costFunction(costFunction),
+	m_bothSides(bothSides),
+	m_halfGridViaSize(halfGridViaSize),
+	m_stopRequested(stopRequested)
+{
+}
+
+const SearchStats & GridSearch::stats() const {
+	return m_stats;
+}
+
+QList<GridPoint> GridSearch::route(SearchThing & routeThing, int & viaCount)
+{
+	//DebugDialog::debug(QString("start route() %1").arg(routeNumber++));
+	viaCount = 0;
+	GridPoint done;
+	bool result = false;
+	if (routeThing.aStar) {
+		seedRects(routeThing.sourceQ, routeThing.sourceRects);
+		seedRects(routeThing.targetQ, routeThing.targetRects);
+	}
+	m_stats.searches++;
+	while (!routeThing.sourceQ.empty() && !routeThing.targetQ.empty()) {
+		GridPoint gp = routeThing.sourceQ.top();
+		GridPoint gpt = routeThing.targetQ.top();
+		if (gpt.qCost < gp.qCost) {
+			gp = gpt;
+			routeThing.targetQ.pop();
+			routeThing.targetValue = GridSource;
+			routeThing.sourceValue = GridTarget;
+		}
+		else {
+			routeThing.sourceQ.pop();
+			routeThing.targetValue = GridTarget;
+			routeThing.sourceValue = GridSource;
+		}
+
+		if (gp.flags & GridPointDone) {
+			done = gp;
+			result = true;
+			break;
+		}
+
+		if (routeThing.aStar) {
+			// skip stale queue entries for cells that were since reached more cheaply
+			GridValue val = m_grid->at(gp.x, gp.y, gp.z);
+			if (val < GridTempObstacle && (val & ~GridSourceFlag) < gp.baseCost) continue;
+		}
+
+		expand(gp, routeThing);
+		if (m_stopRequested && m_stopRequested()) {
+			break;
+		}
+	}
+
+	//DebugDialog::debug(QString("routing result %1").arg(result));
+
+	QList<GridPoint> points;
+	if (!result) {
+		//updateDisplay(m_grid, 0);
+		//DebugDialog::debug(QString("done routing no points"));
+		return points;
+	}
+	done.baseCost = std::numeric_limits<GridValue>::max();  // make sure this is the largest value for either traceback
+	QList<GridPoint> sourcePoints = traceBack(done, m_grid, viaCount, GridTarget, GridSource);      // trace back to source
+	QList<GridPoint> targetPoints = traceBack(done, m_grid, viaCount, GridSource, GridTarget);      // trace back to target
+	if (sourcePoints.count() == 0 || targetPoints.count() == 0) {
+		DebugDialog::debug("traceback zero points");
+		return points;
+	}
+	else {
+		targetPoints.takeFirst();           // redundant point
+		Q_FOREACH (GridPoint gp, targetPoints) points.prepend(gp);
+		points.append(sourcePoints);
+	}
+
+	m_grid->clearCosts();
+
+	//DebugDialog::debug(QString("done with route() %1").arg(points.count()));
+
+	return points;
+}
+
+QList<GridPoint> GridSearch::traceBack(GridPoint gridPoint, const Grid * grid, int & viaCount, GridValue sourceValue, GridValue targetValue) {
+	//DebugDialog::debug(QString("traceback %1 %2 %3").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z));
+	QList<GridPoint> points;
+	points << gridPoint;
+	while (true) {
+		if (gridPoint.baseCost == targetValue) {
+			// done
+			break;
+		}
+
+		// can only be one neighbor with lower value
+		GridPoint next = traceBackOne(gridPoint, grid, -1, 0, 0, sourceValue, targetValue);
+		if (next.baseCost == GridBoardObstacle) {
+			next = traceBackOne(gridPoint, grid, 1, 0, 0, sourceValue, targetValue);
+			if (next.baseCost == GridBoardObstacle) {
+				next = traceBackOne(gridPoint, grid, 0, -1, 0, sourceValue, targetValue);
+				if (next.baseCost == GridBoardObstacle) {
+					next = traceBackOne(gridPoint, grid, 0, 1, 0, sourceValue, targetValue);
+					if (next.baseCost == GridBoardObstacle) {
+						next = traceBackOne(gridPoint, grid, 0, 0, -1, sourceValue, targetValue);
+						if (next.baseCost == GridBoardObstacle) {
+							next = traceBackOne(gridPoint, grid, 0, 0, 1, sourceValue, targetValue);
+							if (next.baseCost == GridBoardObstacle) {
+								// traceback failed--is this possible?
+								points.clear();
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		//if (grid->at(next.x - 1, next.y, next.z) != GridObstacle) next.flags |= GridPointWest;
+		//if (grid->at(next.x + 1, next.y, next.z) != GridObstacle) next.flags |= GridPointEast;
+		//if (grid->at(next.x, next.y - 1, next.z) != GridObstacle) next.flags |= GridPointNorth;
+		//if (grid->at(next.x, next.y + 1, next.z) != GridObstacle) next.flags |= GridPointSouth;
+		points << next;
+		if (next.z != gridPoint.z) viaCount++;
+		gridPoint = next;
+	}
+
+	/*
+	QString costs("costs ");
+	foreach (GridPoint gridPoint, points) {
+	    costs += QString::number(gridPoint.baseCost) + " ";
+	}
+	DebugDialog::debug(costs);
+	*/
+
+	return points;
+}
+
+GridPoint GridSearch::traceBackOne(GridPoint & gridPoint, const Grid * grid, int dx, int dy, int dz, GridValue sourceValue, GridValue targetValue) {
+	GridPoint next;
+	next.baseCost = GridBoardObstacle;
+
+	next.x = gridPoint.x + dx;
+	if (next.x < 0 || next.x >= grid->x) {
+		return next;
+	}
+
+	next.y = gridPoint.y + dy;
+	if (next.y < 0 || next.y >= grid->y) {
+		return next;
+	}
+
+	next.z = gridPoint.z + dz;
+	if (next.z < 0 || next.z >= grid->z) {
+		return next;
+	}
+
+	GridValue nextval = grid->at(next.x, next.y, next.z);
+	if (nextval == GridBoardObstacle || nextval == GridPartObstacle || nextval == sourceValue || nextval == 0 || nextval == GridTempObstacle) return next;
+	if (nextval == targetValue) {
+		// done!
+		next.baseCost = targetValue;
+		return next;
+	}
+
+	if (targetValue == GridSource) {
+		if ((nextval & GridSourceFlag) == 0) return next;
+		nextval ^= GridSourceFlag;
+	}
+	else {
+		if (nextval & GridSourceFlag) return next;
+	}
+
+	if (nextval < gridPoint.baseCost) {
+		next.baseCost = nextval;
+	}
+	return next;
+}
+
+void GridSearch::expand(GridPoint & gridPoint, SearchThing & routeThing)
+{
+	m_stats.expansions++;
+
+	//static bool debugit = false;
+	//if (routeNumber > 41 && routeThing.pq.size() > 8200) debugit = true;
+
+	//if (debugit) {
+	//    DebugDialog::debug(QString("expand %1 %2 %3, %4").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(routeThing.pq.size()));
+	//}
+	if (gridPoint.x > 0) expandOne(gridPoint, routeThing, -1, 0, 0, false);
+	if (gridPoint.x < m_grid->x - 1) expandOne(gridPoint, routeThing, 1, 0, 0, false);
+	if (gridPoint.y > 0) expandOne(gridPoint, routeThing, 0, -1, 0, false);
+	if (gridPoint.y < m_grid->y - 1) expandOne(gridPoint, routeThing, 0, 1, 0, false);
+	if (m_bothSides) {
+		if (gridPoint.z > 0) expandOne(gridPoint, routeThing, 0, 0, -1, true);
+		if (gridPoint.z < m_grid->z - 1) expandOne(gridPoint, routeThing, 0, 0, 1, true);
+	}
+	//if (debugit) {
+	//    DebugDialog::debug("expand done");
+	//}
+}
+
+void GridSearch::expandOne(GridPoint & gridPoint, SearchThing & routeThing, int dx, int dy, int dz, bool crossLayer) {
+	GridPoint next;
+	next.x = gridPoint.x + dx;
+	next.y = gridPoint.y + dy;
+	next.z = gridPoint.z + dz;
+
+	//DebugDialog::debug(QString("expand one %1,%2,%3 cl:%4").arg(next.x).arg(next.y).arg(next.z).arg(crossLayer));
+
+	bool writeable = false;
+	bool avoid = false;
+	GridValue nextval = m_grid->at(next.x, next.y, next.z);
+	if (nextval == GridPartObstacle || nextval == GridBoardObstacle || nextval == routeThing.sourceValue || nextval == GridTempObstacle) {
+		//DebugDialog::debug("exit expand one");
+		return;
+	}
+
+	if (nextval == routeThing.targetValue) {
+		//DebugDialog::debug("found grid target");
+		next.flags |= GridPointDone;
+	}
+	else if (nextval == 0) {
+		writeable = true;
+	}
+	else if (nextval == GridAvoid) {
+		bool contains = true;
+		for (int i = 1; i <= 3; i++) {
+			if (!routeThing.avoids.contains(((next.y - (i * dy)) * m_grid->x) + next.x - (i * dx))) {
+				contains = false;
+				break;
+			}
+		}
+
+		if (contains) {
+			// do not allow more than 3 in a row in the same direction?
+			return;
+		}
+		avoid = writeable = true;
+		if (dx == 0) {
+			if (next.x > 0 && m_grid->at(next.x - 1, next.y, next.z) == GridAvoid) {
+				m_grid->setAt(next.x - 1, next.y, next.z, GridTempObstacle);
+			}
+			if (next.x < m_grid->x - 1 && m_grid->at(next.x + 1, next.y, next.z) == GridAvoid) {
+				m_grid->setAt(next.x + 1, next.y, next.z, GridTempObstacle);
+			}
+		}
+		else {
+			if (next.y > 0 && m_grid->at(next.x, next.y - 1, next.z) == GridAvoid) {
+				m_grid->setAt(next.x, next.y - 1, next.z, GridTempObstacle);
+			}
+			if (next.y < m_grid->y - 1 && m_grid->at(next.x, next.y + 1, next.z) == GridAvoid) {
+				m_grid->setAt(next.x, next.y + 1, next.z, GridTempObstacle);
+			}
+		}
+	}
+	else {
+		// already been here: see if source and target expansions have intersected
+		bool ownSide = (routeThing.sourceValue == GridSource) ? (nextval & GridSourceFlag) != 0 : (nextval & GridSourceFlag) == 0;
+		if (ownSide) {
+			// A* treats the grid as its closed set: reopen a cell only when reaching it more cheaply.
+			// The cell's GridAvoid marking was overwritten by its cost, so look it up in avoids
+			if (!routeThing.aStar) return;
+
+			avoid = !crossLayer && next.z == 0 && routeThing.avoids.contains((next.y * m_grid->x) + next.x);
+			GridValue cost = gridPoint.baseCost + (crossLayer ? ViaCost : (avoid ? AvoidCost : 0)) + 1;
+			if ((nextval & ~GridSourceFlag) <= cost) return;
+
+			writeable = true;
+		}
+		else {
+			next.flags |= GridPointDone;
+		}
+	}
+
+	// any way to skip viaWillFit or put it off until actually needed?
+	if (crossLayer) {
+		if (!viaWillFit(next, m_grid)) return;
+
+		// only way to cross layers is with a via
+		//QPointF center = getPixelCenter(next, m_maxRect.topLeft(), m_gridPixels);
+		//DebugDialog::debug(QString("via will fit %1,%2,%3 %4,%5").arg(next.x).arg(next.y).arg(next.z).arg(center.x()).arg(center.y()));
+	}
+
+	next.baseCost = gridPoint.baseCost;
+	if (crossLayer) {
+		next.baseCost += ViaCost;
+	}
+	else if (avoid) {
+		next.baseCost += AvoidCost;
+	}
+	next.baseCost++;
+
+
+	/*
+	int increment = 5;
+	// assume because of obstacles around the board that we can never be off grid from (next.x, next.y)
+	switch(grid->at(next.x - 1, next.y, next.z)) {
+	    case GridObstacle:
+	    case GridSource:
+	    case GridTarget:
+	        increment--;
+	    default:
+	        break;
+	}
+	switch(grid->at(next.x + 1, next.y, next.z)) {
+	    case GridObstacle:
+	    case GridSource:
+	    case GridTarget:
+	        increment--;
+	    default:
+	        break;
+	}
+	switch(grid->at(next.x, next.y - 1, next.z)) {
+	    case GridObstacle:
+	    case GridSource:
+	    case GridTarget:
+	        increment--;
+	    default:
+	        break;
+	}
+	switch(grid->at(next.x, next.y + 1, next.z)) {
+	    case GridObstacle:
+	    case GridSource:
+	    case GridTarget:
+	        increment--;
+	    default:
+	        break;
+	}
+	next.cost += increment;
+	*/
+
+
+	pushNext(next, routeThing, nextval == routeThing.targetValue);
+
+	if (writeable) {
+		GridValue flag = (routeThing.sourceValue == GridSource) ? GridSourceFlag : 0;
+		m_grid->setAt(next.x, next.y, next.z, next.baseCost | flag);
+		if (routeThing.aStar && nextval == 0 && dz == 0) {
+			jump(next, routeThing, dx, dy);
+		}
+	}
+
+	//DebugDialog::debug("done expand one");
+
+
+	//if (routeThing.searchForJumper) {
+	//    updateDisplay(next);
+	//}
+}
+
+void GridSearch::pushNext(GridPoint & next, SearchThing & routeThing, bool atTarget) {
+	if (atTarget) {
+		next.qCost = next.baseCost;
+	}
+	else {
+		double d = (m_costFunction)(QPoint(next.x, next.y), (routeThing.sourceValue == GridSource) ? routeThing.gridTargetPoint : routeThing.gridSourcePoint);
+		next.qCost = next.baseCost + (routeThing.aStar ? heuristic(next, routeThing) : d);
+		if (routeThing.sourceValue == GridSource) {
+			if (d < routeThing.bestDistanceToTarget) {
+				//DebugDialog::debug(QString("best d target %1, %2,%3").arg(d).arg(next.x).arg(next.y));
+				routeThing.bestDistanceToTarget = d;
+				routeThing.bestLocationToTarget = next;
+			}
+		}
+		else {
+			if (d < routeThing.bestDistanceToSource) {
+				//DebugDialog::debug(QString("best d source %1, %2,%3").arg(d).arg(next.x).arg(next.y));
+				routeThing.bestDistanceToSource = d;
+				routeThing.bestLocationToSource = next;
+			}
+		}
+	}
+
+	// can think about pushing multiple points here
+	//DebugDialog::debug(QString("pushing next %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
+	m_stats.pushes++;
+	if (routeThing.sourceValue == GridSource) routeThing.sourceQ.push(next);
+	else routeThing.targetQ.push(next);
+}
+
+double GridSearch::heuristic(const GridPoint & gridPoint, const SearchThing & routeThing) const {
+	// Manhattan distance to the bounding rect of the other side's seeds; one grid step costs at least 1,
+	// and reaching a layer with no seeds costs at least one via, so this never overestimates
+	const QRect * rects = (routeThing.sourceValue == GridSource) ? routeThing.targetRects : routeThing.sourceRects;
+	double best = std::numeric_limits<double>::max();
+	for (int z = 0; z < 2; z++) {
+		const QRect & r = rects[z];
+		if (r.isNull()) continue;
+
+		int dx = qMax(0, qMax(r.left() - gridPoint.x, gridPoint.x - r.right()));
+		int dy = qMax(0, qMax(r.top() - gridPoint.y, gridPoint.y - r.bottom()));
+		double h = dx + dy;
+		if (z != gridPoint.z) h += ViaCost + 1;
+		best = qMin(best, h);
+	}
+
+	return (best == std::numeric_limits<double>::max()) ? 0 : best;
+}
+
+void GridSearch::jump(GridPoint & from, SearchThing & routeThing, int dx, int dy) {
+	// jump-point style fast path: on open copper, walk straight ahead without queueing every cell,
+	// stopping where a side opens up or closes, where the run lines up with the other side's seeds,
+	// or after MaxJumpLength cells.  Cells along the way still get their cost, so traceBack() works.
+	const QRect & rect = (routeThing.sourceValue == GridSource) ? routeThing.targetRects[from.z] : routeThing.sourceRects[from.z];
+	if (rect.isNull()) return;	// a via will be needed; keep every cell as a via candidate
+
+	GridValue flag = (routeThing.sourceValue == GridSource) ? GridSourceFlag : 0;
+	GridPoint current = from;
+	int steps = 0;
+	while (steps < MaxJumpLength) {
+		int nx = current.x + dx;
+		int ny = current.y + dy;
+		if (nx < 1 || ny < 1 || nx >= m_grid->x - 1 || ny >= m_grid->y - 1) break;
+		if (m_grid->at(nx, ny, current.z) != 0) break;
+		if (dx != 0) {
+			if (nx >= rect.left() && nx <= rect.right()) break;
+			if (m_grid->at(nx, ny - 1, current.z) != 0 || m_grid->at(nx, ny + 1, current.z) != 0) break;
+		}
+		else {
+			if (ny >= rect.top() && ny <= rect.bottom()) break;
+			if (m_grid->at(nx - 1, ny, current.z) != 0 || m_grid->at(nx + 1, ny, current.z) != 0) break;
+		}
+
+		current.x = nx;
+		current.y = ny;
+		current.baseCost++;
+		m_grid->setAt(nx, ny, current.z, current.baseCost | flag);
+		steps++;
+	}
+
+	if (steps == 0) return;
+
+	m_stats.jumps++;
+	m_stats.jumpedCells += steps;
+	current.flags = 0;
+	pushNext(current, routeThing, false);
+}
+
+bool GridSearch::viaWillFit(GridPoint & gridPoint, const Grid * grid) const {
+	for (int y = -m_halfGridViaSize; y <= m_halfGridViaSize; y++) {
+		int py = y + gridPoint.y;
+		if (py < 0) return false;
+		if (py >= grid->y) return false;
+
+		for (int x = -m_halfGridViaSize; x <= m_halfGridViaSize; x++) {
+			int px = x + gridPoint.x;
+			if (px < 0) return false;
+			if (px >= grid->x) return false;
+
+			for (int z = 0; z < grid->z; z++) {
+				GridValue val = grid->at(px, py, z);
+				if (val == GridPartObstacle || val == GridBoardObstacle || val == GridSource || val == GridTarget || val == GridTempObstacle || val == GridAvoid) return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,169 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef GRIDSEARCH_H
+#define GRIDSEARCH_H
+
+#include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSet>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+typedef quint64 GridValue;
+
+static constexpr GridValue GridBoardObstacle = std::numeric_limits<GridValue>::max();
+static constexpr GridValue GridPartObstacle = GridBoardObstacle - 1;
+static constexpr GridValue GridSource = GridBoardObstacle - 2;
+static constexpr GridValue GridTarget = GridBoardObstacle - 3;
+static constexpr GridValue GridAvoid = GridBoardObstacle - 4;
+static constexpr GridValue GridTempObstacle = GridBoardObstacle - 5;
+static constexpr GridValue GridSourceFlag = (GridBoardObstacle / 2) + 1;
+
+static constexpr uint ViaCost = 2000;
+static constexpr uint AvoidCost = 7;
+
+static constexpr uchar GridPointDone = 1;
+
+static constexpr int MaxJumpLength = 64;		// grid cells
+
+struct GridPoint {
+	int x, y, z;
+	GridValue baseCost = 0;
+	double qCost = 0.0;
+	uchar flags = 0;
+
+	bool operator<(const GridPoint&) const;
+	GridPoint(QPoint p, int zed) : x(p.x()), y(p.y()), z(zed) { }
+	constexpr GridPoint() : x(0), y(0), z(0) { }
+};
+
+// counters for comparing search strategies
+struct SearchStats {
+	qint64 searches = 0;
+	qint64 expansions = 0;
+	qint64 pushes = 0;
+	qint64 jumps = 0;
+	qint64 jumpedCells = 0;
+
+	void add(const SearchStats & other) {
+		searches += other.searches;
+		expansions += other.expansions;
+		pushes += other.pushes;
+		jumps += other.jumps;
+		jumpedCells += other.jumpedCells;
+	}
+};
+
+struct GridTile;
+
+// The grid is split into square tiles which are only allocated once something is written to them.
+// Board and part obstacles are kept as bitmaps; everything else (costs, source, target, etc.)
+// goes into 16-bit words, which are widened to 32 bits the first time a cost does not fit.
+// at() and setAt() still speak GridValue, so the router itself is unaware of the packing.
+struct Grid {
+	int x = 0;
+	int y = 0;
+	int z = 0;
+
+	Grid(int x, int y, int layers);
+	~Grid();
+
+	GridValue at(int x, int y, int z) const;
+	void setAt(int x, int y, int z, GridValue value);
+	QList<QPoint> init(int x, int y, int z, int width, int height, const QImage &, GridValue value, bool collectPoints);
+	QList<QPoint> init4(int x, int y, int z, int width, int height, const QImage *, GridValue value, bool collectPoints);
+	void clear();
+	void clearCosts();
+	void copy(int fromIndex, int toIndex);
+	bool contains(int x, int y, int z) const;
+	qint64 bytesAllocated() const;
+
+protected:
+	int tileIndex(int x, int y, int z) const;
+	void setWord(GridTile *, int cell, GridValue value);
+	void widen();
+
+protected:
+	int m_tilesX = 0;
+	int m_tilesY = 0;
+	bool m_wide = false;
+	std::vector< std::unique_ptr<GridTile> > m_tiles;
+};
+
+// the part of a route that the search itself reads and writes
+struct SearchThing {
+	std::priority_queue<GridPoint> sourceQ;
+	std::priority_queue<GridPoint> targetQ;
+	QPoint gridSourcePoint;
+	QPoint gridTargetPoint;
+	GridValue sourceValue;
+	GridValue targetValue;
+	double bestDistanceToTarget;
+	double bestDistanceToSource;
+	GridPoint bestLocationToTarget;
+	GridPoint bestLocationToSource;
+	QSet<int> avoids;
+	bool aStar = false;
+	QRect sourceRects[2];		// bounding rects of the seed points per layer, for the A* heuristic
+	QRect targetRects[2];
+};
+
+typedef double (*CostFunction)(const QPoint & p1, const QPoint & p2);
+
+// Grows source and target wavefronts over a grid until they meet, then traces the path back.
+// The default mode orders cells by cost plus distance and never revisits one; the A* mode
+// reopens a cell whenever it is reached more cheaply and may skip along open runs.
+class GridSearch
+{
+public:
+	GridSearch(Grid *, CostFunction, bool bothSides, int halfGridViaSize, const std::function<bool()> & stopRequested = nullptr);
+
+	QList<GridPoint> route(SearchThing &, int & viaCount);
+	const SearchStats & stats() const;
+
+	static QList<GridPoint> traceBack(GridPoint, const Grid *, int & viaCount, GridValue sourceValue, GridValue targetValue);
+
+protected:
+	void expand(GridPoint &, SearchThing &);
+	void expandOne(GridPoint &, SearchThing &, int dx, int dy, int dz, bool crossLayer);
+	void pushNext(GridPoint &, SearchThing &, bool atTarget);
+	double heuristic(const GridPoint &, const SearchThing &) const;
+	void jump(GridPoint & from, SearchThing &, int dx, int dy);
+	bool viaWillFit(GridPoint &, const Grid * grid) const;
+
+	static GridPoint traceBackOne(GridPoint &, const Grid *, int dx, int dy, int dz, GridValue sourceValue, GridValue targetValue);
+
+protected:
+	Grid * m_grid;
+	CostFunction m_costFunction;
+	bool m_bothSides;
+	int m_halfGridViaSize;
+	std::function<bool()> m_stopRequested;
+	SearchStats m_stats;
+};
+
+#endif
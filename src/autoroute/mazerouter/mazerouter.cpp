@@ -74,9 +74,11 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QApplication>
 #include <QMessageBox>
 #include <QSettings>
+#include <QtConcurrentRun>
 
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
 
 //////////////////////////////////////
 
@@ -87,21 +89,11 @@ static constexpr int OptimizeFactor = 2;
 static QString CancelledMessage;
 
 static constexpr int DefaultMaxCycles = 100;
-
-static constexpr GridValue GridBoardObstacle = std::numeric_limits<GridValue>::max();
-static constexpr GridValue GridPartObstacle = GridBoardObstacle - 1;
-static constexpr GridValue GridSource = GridBoardObstacle - 2;
-static constexpr GridValue GridTarget = GridBoardObstacle - 3;
-static constexpr GridValue GridAvoid = GridBoardObstacle - 4;
-static constexpr GridValue GridTempObstacle = GridBoardObstacle - 5;
-static constexpr GridValue GridSourceFlag = (GridBoardObstacle / 2) + 1;
+static constexpr int DefaultParallelOrderings = 1;		// 1 means route one ordering at a time on the GUI thread
 
 static constexpr uint Layer1Cost = 100;
 static constexpr uint CrossLayerCost = 100;
-static constexpr uint ViaCost = 2000;
-static constexpr uint AvoidCost = 7;
 
-static constexpr uchar GridPointDone = 1;
 static constexpr uchar GridPointStepYPlus = 2;
 static constexpr uchar GridPointStepYMinus = 4;
 static constexpr uchar GridPointStepXPlus = 8;
@@ -273,6 +265,7 @@ bool schematicJumperWillFitAux(GridPoint & gridPoint, const Grid * grid, int hal
 		for (int x = xl; x <= xr; x++) {
 			if (x < 0) return false;
 			if (x >= grid->x) return false;
+			if (!grid->contains(gridPoint.x + x, gridPoint.y + y, 0)) return false;
 
 			GridValue val = grid->at(gridPoint.x + x, gridPoint.y + y, 0);
 			if (val == GridPartObstacle || val == GridBoardObstacle || val == GridSource || val == GridTarget || val == GridAvoid|| val == GridTempObstacle) {
@@ -312,107 +305,6 @@ void initMarkers(Markers & markers, bool pcbType) {
 
 ////////////////////////////////////////////////////////////////////
 
-bool GridPoint::operator<(const GridPoint& other) const {
-	// make sure lower cost is first
-	return qCost > other.qCost;
-}
-////////////////////////////////////////////////////////////////////
-
-Grid::Grid(int sx, int sy, int sz) :
-	data(new GridValue[sx * sy * sz]()), // initialize to zero
-	x(sx), y(sy), z(sz) { }
-
-GridValue Grid::at(int sx, int sy, int sz) const {
-    Q_ASSERT (sx < x);
-    Q_ASSERT (sy < y);
-    Q_ASSERT (sz < z);
-	return *(data + (sz * y * x) + (sy * x) + sx);
-}
-
-void Grid::setAt(int sx, int sy, int sz, GridValue value) {
-    Q_ASSERT (sx < x);
-    Q_ASSERT (sy < y);
-    Q_ASSERT (sz < z);
-	*(data + (sz * y * x) + (sy * x) + sx) = value;
-}
-
-QList<QPoint> Grid::init(int sx, int sy, int sz, int width, int height, const QImage & image, GridValue value, bool collectPoints) {
-	QList<QPoint> points;
-	const uchar * bits1 = image.constScanLine(0);
-	int bytesPerLine = image.bytesPerLine();
-	for (int iy = sy; iy < sy + height; iy++) {
-		int offset = iy * bytesPerLine;
-		for (int ix = sx; ix < sx + width; ix++) {
-			int byteOffset = (ix >> 3) + offset;
-			uchar mask = DRC::BitTable[ix & 7];
-
-			//if (routeNumber > 40) {
-			//    DebugDialog::debug(QString("image %1 %2, %3").arg(image.width()).arg(image.height()).arg(image.isNull()));
-			//    DebugDialog::debug(QString("init point %1 %2 %3").arg(ix).arg(iy).arg(sz));
-			//    DebugDialog::debug(QString("init grid %1 %2 %3, %4").arg(x).arg(y).arg(z).arg((long) data, 0, 16));
-			//}
-			if ((*(bits1 + byteOffset)) & mask) continue;
-
-			//if (routeNumber > 40) DebugDialog::debug("after mask");
-
-			setAt(ix, iy, sz, value);
-			//if (routeNumber > 40)
-			//    DebugDialog::debug("set");
-			if (collectPoints) {
-				points.append(QPoint(ix, iy));
-			}
-		}
-	}
-
-	return points;
-}
-
-
-QList<QPoint> Grid::init4(int sx, int sy, int sz, int width, int height, const QImage * image, GridValue value, bool collectPoints) {
-	// pixels are 4 x 4 bits
-	QList<QPoint> points;
-	const uchar * bits1 = image->constScanLine(0);
-	int bytesPerLine = image->bytesPerLine();
-	for (int iy = sy; iy < sy + height; iy++) {
-		int offset = iy * bytesPerLine * 4;
-		for (int ix = sx; ix < sx + width; ix++) {
-			int byteOffset = (ix >> 1) + offset;
-			uchar mask = ix & 1 ? 0x0f : 0xf0;
-
-			if ((*(bits1 + byteOffset) & mask) != mask) ;
-			else if ((*(bits1 + byteOffset + bytesPerLine) & mask) != mask) ;
-			else if ((*(bits1 + byteOffset + bytesPerLine + bytesPerLine) & mask) != mask) ;
-			else if ((*(bits1 + byteOffset + bytesPerLine + bytesPerLine + bytesPerLine) & mask) != mask) ;
-			else continue;  // "pixel" is all white
-
-			setAt(ix, iy, sz, value);
-			if (collectPoints) {
-				points.append(QPoint(ix, iy));
-			}
-		}
-	}
-
-	return points;
-}
-
-void Grid::copy(int fromIndex, int toIndex) {
-	memcpy(((uchar *) data) + toIndex * x * y * sizeof(GridValue), ((uchar *) data) + fromIndex * x * y * sizeof(GridValue), x * y * sizeof(GridValue));
-}
-
-void Grid::clear() {
-	// memset can be very dangerous, clear out memory this way
-	std::fill_n(data, x * y * z, 0);
-}
-
-Grid::~Grid() {
-	if (data) {
-		delete [] data;
-		data = nullptr;
-	}
-}
-
-////////////////////////////////////////////////////////////////////
-
 
 void Score::setOrdering(const NetOrdering & _ordering) {
 	reorderNet = -1;
@@ -436,6 +328,28 @@ void Score::setOrdering(const NetOrdering & _ordering) {
 	//printOrder("new  ", ordering.order);
 }
 
+bool Score::betterThan(const Score & other) const {
+	if (other.ordering.order.count() == 0) return true;
+	if (totalRoutedCount > other.totalRoutedCount) return true;
+
+	return (totalRoutedCount == other.totalRoutedCount && totalViaCount < other.totalViaCount);
+}
+
+bool hasOrdering(const QList<NetOrdering> & allOrderings, const QList<int> & order) {
+	Q_FOREACH (NetOrdering ordering, allOrderings) {
+		bool gotOne = true;
+		for (int j = 0; j < order.count(); j++) {
+			if (order.at(j) != ordering.order.at(j)) {
+				gotOne = false;
+				break;
+			}
+		}
+		if (gotOne) return true;
+	}
+
+	return false;
+}
+
 ////////////////////////////////////////////////////////////////////
 
 static constexpr long IDs[] = { 1452191, 9781580, 9781600, 9781620, 9781640, 9781660, 9781680, 9781700 };
@@ -489,6 +403,10 @@ QList<ConnectorItem *> ConnectionThing::values(ConnectorItem * s) {
 
 ////////////////////////////////////////////////////////////////////
 
+const QString MazeRouter::ParallelOrderingsName("cmrouter/parallelorderings");
+const QString MazeRouter::SearchModeName("cmrouter/searchmode");
+const QString MazeRouter::AStarSearchMode("astar");
+
 MazeRouter::MazeRouter(PCBSketchWidget * sketchWidget, QGraphicsItem * board, bool adjustIf) :
     Autorouter(sketchWidget),
     m_keepoutMils(0.0),
@@ -507,13 +425,18 @@ MazeRouter::MazeRouter(PCBSketchWidget * sketchWidget, QGraphicsItem * board, bo
     m_grid(nullptr),
     m_cleanupCount(0),
     m_netLabelIndex(-1),
-    m_commandCount(0)
+    m_commandCount(0),
+    m_parallelOrderings(DefaultParallelOrderings),
+    m_aStar(false),
+    m_master(nullptr)
 {
 
 	CancelledMessage = tr("Autorouter was cancelled.");
 
 	QSettings settings;
 	m_maxCycles = settings.value(MaxCyclesName, DefaultMaxCycles).toInt();
+	m_parallelOrderings = qMax(1, settings.value(ParallelOrderingsName, DefaultParallelOrderings).toInt());
+	m_aStar = settings.value(SearchModeName).toString() == AStarSearchMode;
 
 	m_bothSidesNow = sketchWidget->routeBothSides();
 	m_pcbType = sketchWidget->autorouteTypePCB();
@@ -563,10 +486,60 @@ MazeRouter::MazeRouter(PCBSketchWidget * sketchWidget, QGraphicsItem * board, bo
 	}
 }
 
+MazeRouter::MazeRouter(const MazeRouter * master) :
+    Autorouter(master->m_sketchWidget),
+    m_viewLayerIDs(master->m_viewLayerIDs),
+    m_keepoutMils(master->m_keepoutMils),
+    m_keepoutGrid(master->m_keepoutGrid),
+    m_keepoutGridInt(master->m_keepoutGridInt),
+    m_halfGridViaSize(master->m_halfGridViaSize),
+    m_halfGridJumperSize(master->m_halfGridJumperSize),
+    m_gridPixels(master->m_gridPixels),
+    m_standardWireWidth(master->m_standardWireWidth),
+    m_boardImage(master->m_boardImage),
+    m_spareImage(nullptr),
+    m_spareImage2(nullptr),
+    m_temporaryBoard(false),
+    m_costFunction(master->m_costFunction),
+    m_jumperWillFitFunction(master->m_jumperWillFitFunction),
+    m_grid(nullptr),
+    m_cleanupCount(0),
+    m_netLabelIndex(-1),
+    m_commandCount(0),
+    m_parallelOrderings(1),
+    m_aStar(master->m_aStar),
+    m_master(master)
+{
+	// a worker shares the (read-only) board image with its master, but gets its own grid,
+	// scratch image and master documents since routeNets() scribbles on all three.
+	// It has no display images, so it never touches the scene.
+	m_bothSidesNow = master->m_bothSidesNow;
+	m_pcbType = master->m_pcbType;
+	m_board = master->m_board;
+	m_maxRect = master->m_maxRect;
+	m_keepoutPixels = master->m_keepoutPixels;
+	m_maxCycles = master->m_maxCycles;
+
+	m_grid = new Grid(master->m_grid->x, master->m_grid->y, master->m_grid->z);
+	m_spareImage = new QImage(master->m_spareImage->size(), QImage::Format_Mono);
+	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, master->m_masterDocs.keys()) {
+		QDomDocument * masterDoc = master->m_masterDocs.value(viewLayerPlacement);
+		auto * doc = new QDomDocument(masterDoc->cloneNode(true).toDocument());
+		m_masterDocs.insert(viewLayerPlacement, doc);
+		int z = viewLayerPlacement == ViewLayer::NewBottom ? 0 : 1;
+		m_obstacleCaches[z] = master->m_obstacleCaches[z];
+		m_obstacleCaches[z].bind(doc);
+	}
+}
+
 MazeRouter::~MazeRouter()
 {
     /// @todo replace explicit deletes with std::shared_ptr and std::unique_ptr
     /// where it makes sense.
+	if (m_master) {
+		// board image belongs to the master
+		m_boardImage = nullptr;
+	}
 	Q_FOREACH (QDomDocument * doc, m_masterDocs) {
 		delete doc;
 	}
@@ -688,6 +661,7 @@ void MazeRouter::start()
 		}
 
 		net->pinsWithin = findPinsWithin(net->net);
+		net->splitNetIDs = DRC::splitNetIDs(*(net->net), true);
 		netList.nets << net;
 		totalToRoute += net->net->count() - 1;
 	}
@@ -715,12 +689,6 @@ void MazeRouter::start()
 	QSizeF gridSize(m_maxRect.width() / m_gridPixels, m_maxRect.height() / m_gridPixels);
 	QSize boardImageSize(qCeil(gridSize.width()), qCeil(gridSize.height()));
 	m_grid = new Grid(boardImageSize.width(), boardImageSize.height(), m_bothSidesNow ? 2 : 1);
-	if (!m_grid->data) {
-		QMessageBox::information(nullptr, QObject::tr("Fritzing"), "Out of memory--unable to proceed");
-		restoreOriginalState(parentCommand);
-		cleanUpNets(netList);
-		return;
-	}
 
 	m_boardImage = new QImage(boardImageSize.width() * 4, boardImageSize.height() * 4, QImage::Format_Mono);
 	m_spareImage = new QImage(boardImageSize.width() * 4, boardImageSize.height() * 4, QImage::Format_Mono);
@@ -754,6 +722,15 @@ void MazeRouter::start()
 		return;
 	}
 
+	Q_FOREACH (ViewLayer::ViewLayerPlacement viewLayerPlacement, m_masterDocs.keys()) {
+		initObstacleCache(viewLayerPlacement, QRectF(QPointF(0, 0), gridSize * 4), m_spareImage->size());
+	}
+	if (m_cancelled || m_stopTracing) {
+		restoreOriginalState(parentCommand);
+		cleanUpNets(netList);
+		return;
+	}
+
 	QList<NetOrdering> allOrderings;
 	allOrderings << initialOrdering;
 	Score bestScore;
@@ -768,17 +745,45 @@ void MazeRouter::start()
 		Q_EMIT setCycleMessage(tr("round %1 of:").arg(run + 1));
 		Q_EMIT setProgressValue(run);
 		ProcessEventBlocker::processEvents();
-		currentScore.setOrdering(allOrderings.at(run));
-		currentScore.anyUnrouted = false;
-		routeNets(netList, false, currentScore, gridSize, allOrderings);
-		if (bestScore.ordering.order.count() == 0) {
-			bestScore = currentScore;
+		if (m_parallelOrderings > 1) {
+			// evaluate the next few orderings at once, then merge them back in ordering order,
+			// replaying each run's moveBack() calls against the real list of orderings.
+			// The list therefore grows exactly as it would in serial mode, and the outcome
+			// depends neither on the batch size nor on thread scheduling
+			QList<OrderingRun> runs;
+			routeOrderings(netList, currentScore, gridSize, allOrderings, run, runs);
+			for (int i = 0; i < runs.count(); i++) {
+				const OrderingRun & orderingRun = runs.at(i);
+				if (replayMoveBacks(orderingRun, allOrderings)) {
+					currentScore = orderingRun.score;
+				}
+				else {
+					// an earlier run in this batch proposed the ordering this one would have,
+					// so serial mode would have taken a different turn here: route it serially
+					currentScore.setOrdering(allOrderings.at(run));
+					currentScore.anyUnrouted = false;
+					routeNets(netList, false, currentScore, gridSize, allOrderings);
+				}
+				if (currentScore.betterThan(bestScore)) {
+					bestScore = currentScore;
+				}
+				if (!bestScore.anyUnrouted || i == runs.count() - 1) break;
+
+				run++;
+			}
+
+			initTraceDisplay();
+			Q_FOREACH (Trace trace, currentScore.traces) {
+				displayTrace(trace);
+			}
+			updateDisplay(0);
+			if (m_bothSidesNow) updateDisplay(1);
 		}
 		else {
-			if (currentScore.totalRoutedCount > bestScore.totalRoutedCount) {
-				bestScore = currentScore;
-			}
-			else if (currentScore.totalRoutedCount == bestScore.totalRoutedCount && currentScore.totalViaCount < bestScore.totalViaCount) {
+			currentScore.setOrdering(allOrderings.at(run));
+			currentScore.anyUnrouted = false;
+			routeNets(netList, false, currentScore, gridSize, allOrderings);
+			if (currentScore.betterThan(bestScore)) {
 				bestScore = currentScore;
 			}
 		}
@@ -788,6 +793,13 @@ void MazeRouter::start()
 	Q_EMIT disableButtons();
 
 	//DebugDialog::debug("done running");
+#ifndef QT_NO_DEBUG
+	DebugDialog::debug(QString("maze grid %1 x %2 x %3 using %4 bytes").arg(m_grid->x).arg(m_grid->y).arg(m_grid->z).arg(m_grid->bytesAllocated()));
+#endif
+	DebugDialog::debug(QString("maze search (%1): %2 searches, %3 expansions, %4 pushes, %5 jumps over %6 cells")
+	                   .arg(m_aStar ? "A*" : "wavefront")
+	                   .arg(m_searchStats.searches).arg(m_searchStats.expansions).arg(m_searchStats.pushes)
+	                   .arg(m_searchStats.jumps).arg(m_searchStats.jumpedCells));
 
 
 	if (m_cancelled) {
@@ -875,6 +887,82 @@ void MazeRouter::start()
 
 }
 
+bool MazeRouter::stopRequested() const {
+	if (m_master) return m_master->stopRequested();
+
+	return m_cancelled || m_stopTracing;
+}
+
+void MazeRouter::routeOrderings(NetList & netList, const Score & startScore, const QSizeF gridSize, const QList<NetOrdering> & allOrderings, int firstRun, QList<OrderingRun> & runs)
+{
+	int runCount = qMin(m_parallelOrderings, qMin(m_maxCycles, (int) allOrderings.count()) - firstRun);
+
+	primeConnectorGeometry(netList);
+
+	QList<MazeRouter *> workers;
+	for (int i = 0; i < runCount; i++) {
+		OrderingRun orderingRun;
+		orderingRun.score = startScore;
+		orderingRun.score.setOrdering(allOrderings.at(firstRun + i));
+		orderingRun.score.anyUnrouted = false;
+		orderingRun.allOrderings = allOrderings;
+		runs.append(orderingRun);
+		workers.append(new MazeRouter(this));
+	}
+
+	// runs is not resized from here on, so each worker can hang on to its own element
+	QList< QFuture<bool> > futures;
+	for (int i = 0; i < runCount; i++) {
+		MazeRouter * worker = workers.at(i);
+		OrderingRun * orderingRun = &runs[i];
+		futures.append(QtConcurrent::run([worker, &netList, orderingRun, gridSize]() {
+			bool result = worker->routeNets(netList, false, orderingRun->score, gridSize, orderingRun->allOrderings);
+			orderingRun->moveBacks = worker->m_moveBacks;
+			return result;
+		}));
+	}
+
+	Q_FOREACH (QFuture<bool> future, futures) {
+		while (!future.isFinished()) {
+			ProcessEventBlocker::processEvents(200);
+		}
+	}
+
+	Q_FOREACH (MazeRouter * worker, workers) {
+		m_searchStats.add(worker->m_searchStats);
+	}
+	qDeleteAll(workers);
+}
+
+void MazeRouter::primeConnectorGeometry(NetList & netList) {
+	// QGraphicsItem computes scene transforms lazily and caches them;
+	// compute them here on the GUI thread so the workers only ever read from the scene
+	Q_FOREACH (Net * net, netList.nets) {
+		Q_FOREACH (QList<ConnectorItem *> subnet, net->subnets) {
+			Q_FOREACH (ConnectorItem * connectorItem, subnet) {
+				connectorItem->sceneAdjustedTerminalPoint(nullptr);
+				connectorItem->sceneBoundingRect();
+				if (connectorItem->attachedTo()) {
+					connectorItem->attachedTo()->sceneBoundingRect();
+					// also filled lazily, from childItems()
+					connectorItem->attachedTo()->cachedConnectorItems();
+				}
+			}
+		}
+	}
+}
+
+void MazeRouter::initObstacleCache(ViewLayer::ViewLayerPlacement viewLayerPlacement, const QRectF & renderRect, const QSize & imageSize) {
+	QDomDocument * masterDoc = m_masterDocs.value(viewLayerPlacement);
+	if (masterDoc == nullptr) return;
+
+	// an empty cache (say the document has <defs>) means every net renders the whole document
+	m_obstacleCaches[viewLayerPlacement == ViewLayer::NewBottom ? 0 : 1].init(masterDoc, renderRect, imageSize, [this]() {
+		ProcessEventBlocker::processEvents();
+		return !(m_cancelled || m_stopTracing);
+	});
+}
+
 int MazeRouter::findPinsWithin(QList<ConnectorItem *> * net) {
 	auto count = 0;
 	QRectF r;
@@ -991,13 +1079,14 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 	routeThing.r4 = QRectF(QPointF(0, 0), gridSize * 4);
 	routeThing.layerSpecs << ViewLayer::NewBottom;
 	if (m_bothSidesNow) routeThing.layerSpecs << ViewLayer::NewTop;
+	routeThing.aStar = m_aStar;
 
 	auto result = true;
 
 	initTraceDisplay();
 	auto previousTraces = false;
 	Q_FOREACH (int netIndex, currentScore.ordering.order) {
-		if (m_cancelled || m_stopTracing) {
+		if (stopRequested()) {
 			return false;
 		}
 
@@ -1080,7 +1169,7 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 
 			Markers markers;
 			initMarkers(markers, m_pcbType);
-			DRC::splitNetPrep(masterDoc, *(net->net), markers, routeThing.netElements[z].net, routeThing.netElements[z].alsoNet, routeThing.netElements[z].notNet, true);
+			DRC::splitNetPrep(masterDoc, net->splitNetIDs, markers, routeThing.netElements[z].net, routeThing.netElements[z].alsoNet, routeThing.netElements[z].notNet, true);
 			Q_FOREACH (QDomElement element, routeThing.netElements[z].net) {
 				element.setTagName("g");
 			}
@@ -1091,12 +1180,18 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 			//QString after = masterDoc->toString();
 
 			//DebugDialog::debug("obstacles from board");
-			m_spareImage->fill(0xffffffff);
-			ItemBase::renderOne(masterDoc, m_spareImage, routeThing.r4);
+			QList<QDomElement> changed(routeThing.netElements[z].net);
+			changed.append(routeThing.netElements[z].alsoNet);
+			const QImage * obstacles = m_obstacleCaches[z].render(changed, routeThing.r4);
+			if (obstacles == nullptr) {
+				m_spareImage->fill(0xffffffff);
+				ItemBase::renderOne(masterDoc, m_spareImage, routeThing.r4);
+				obstacles = m_spareImage;
+			}
 #ifndef QT_NO_DEBUG
-			//m_spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/obstacles%1_%2.png").arg(netIndex, 2, 10, QChar('0')).arg(viewLayerPlacement));
+			//obstacles->save(FolderUtils::getUserDataStorePath("") + QString("/obstacles%1_%2.png").arg(netIndex, 2, 10, QChar('0')).arg(viewLayerPlacement));
 #endif
-			m_grid->init4(0, 0, z, m_grid->x, m_grid->y, m_spareImage, GridPartObstacle, false);
+			m_grid->init4(0, 0, z, m_grid->x, m_grid->y, obstacles, GridPartObstacle, false);
 			//DebugDialog::debug("obstacles from board done");
 
 			prepSourceAndTarget(masterDoc, routeThing, subnets, z, viewLayerPlacement);
@@ -1155,7 +1250,7 @@ bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, R
 	//DebugDialog::debug(QString("jumper d %1, %2").arg(routeThing.bestDistanceToSource).arg(routeThing.bestDistanceToTarget));
 
 	newTrace.gridPoints = route(routeThing, viaCount);
-	if (m_cancelled || m_stopTracing) {
+	if (stopRequested()) {
 		return false;
 	}
 
@@ -1277,26 +1372,17 @@ bool MazeRouter::moveBack(Score & currentScore, int index, QList<NetOrdering> &
 
 	QList<int> order(currentScore.ordering.order);
 	//printOrder("start", order);
+	if (m_master) {
+		// remembered so the master can replay this call against its own list of orderings
+		m_moveBacks.append(index);
+	}
+
 	int netIndex = order.takeAt(index);
 	//printOrder("minus", order);
 	for (int i = index - 1; i >= 0; i--) {
-		bool done = true;
 		order.insert(i, netIndex);
 		//printOrder("plus ", order);
-		Q_FOREACH (NetOrdering ordering, allOrderings) {
-			bool gotOne = true;
-			for (int j = 0; j < order.count(); j++) {
-				if (order.at(j) != ordering.order.at(j)) {
-					gotOne = false;
-					break;
-				}
-			}
-			if (gotOne) {
-				done = false;
-				break;
-			}
-		}
-		if (done == true) {
+		if (!hasOrdering(allOrderings, order)) {
 			NetOrdering newOrdering;
 			newOrdering.order = order;
 			allOrderings.append(newOrdering);
@@ -1325,6 +1411,20 @@ bool MazeRouter::moveBack(Score & currentScore, int index, QList<NetOrdering> &
 	return false;
 }
 
+bool MazeRouter::replayMoveBacks(const OrderingRun & orderingRun, QList<NetOrdering> & allOrderings) {
+	// a worker only saw the orderings that existed when its batch started. Every moveBack()
+	// but the last one returned false (otherwise the run would have stopped there), and the
+	// last one returned true exactly when the run stopped to reorder. Replay them and report
+	// whether the real list gives the same answers, i.e. whether the run went as in serial mode
+	Score score = orderingRun.score;
+	for (int i = 0; i < orderingRun.moveBacks.count(); i++) {
+		bool expected = (i == orderingRun.moveBacks.count() - 1) && orderingRun.score.reorderNet >= 0;
+		if (moveBack(score, orderingRun.moveBacks.at(i), allOrderings) != expected) return false;
+	}
+
+	return true;
+}
+
 void MazeRouter::prepSourceAndTarget(QDomDocument * masterDoc, RouteThing & routeThing, QList< QList<ConnectorItem *> > & subnets, int z, ViewLayer::ViewLayerPlacement viewLayerPlacement)
 {
 	Q_FOREACH (QDomElement element, routeThing.netElements[z].notNet) {
@@ -1473,7 +1573,10 @@ QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLaye
 	int x2 = qCeil((itemsBoundingRect.right() - m_maxRect.left()) / m_gridPixels);
 	int y2 = qCeil((itemsBoundingRect.bottom() - m_maxRect.top()) / m_gridPixels);
 
-	ItemBase::renderOne(masterDoc, m_spareImage, renderRect);
+	// only elements of this net can be showing at this point
+	if (!m_obstacleCaches[z].renderElements(netElements, m_spareImage, renderRect)) {
+		ItemBase::renderOne(masterDoc, m_spareImage, renderRect);
+	}
 #ifndef QT_NO_DEBUG
 	//static int rsi = 0;
 	//m_spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/rendersource%1_%2.png").arg(rsi++,3,10,QChar('0')).arg(z));
@@ -1544,7 +1647,7 @@ QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLaye
 		while (true) {
 			xo += dx;
 			yo += dy;
-			if (grid->at(xo, yo, z) != GridAvoid) break;
+			if (!grid->contains(xo, yo, z) || grid->at(xo, yo, z) != GridAvoid) break;
 
 			grid->setAt(xo, yo, z, 0);
 		}
@@ -1572,367 +1675,15 @@ QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLaye
 
 QList<GridPoint> MazeRouter::route(RouteThing & routeThing, int & viaCount)
 {
-	//DebugDialog::debug(QString("start route() %1").arg(routeNumber++));
-	viaCount = 0;
-	GridPoint done;
-	bool result = false;
-	while (!routeThing.sourceQ.empty() && !routeThing.targetQ.empty()) {
-		GridPoint gp = routeThing.sourceQ.top();
-		GridPoint gpt = routeThing.targetQ.top();
-		if (gpt.qCost < gp.qCost) {
-			gp = gpt;
-			routeThing.targetQ.pop();
-			routeThing.targetValue = GridSource;
-			routeThing.sourceValue = GridTarget;
-		}
-		else {
-			routeThing.sourceQ.pop();
-			routeThing.targetValue = GridTarget;
-			routeThing.sourceValue = GridSource;
-		}
-
-		if (gp.flags & GridPointDone) {
-			done = gp;
-			result = true;
-			break;
-		}
-
-		expand(gp, routeThing);
-		if (m_cancelled || m_stopTracing) {
-			break;
-		}
-	}
-
-	//DebugDialog::debug(QString("routing result %1").arg(result));
-
-	QList<GridPoint> points;
-	if (!result) {
-		//updateDisplay(m_grid, 0);
-		//DebugDialog::debug(QString("done routing no points"));
-		return points;
-	}
-	done.baseCost = std::numeric_limits<GridValue>::max();  // make sure this is the largest value for either traceback
-	QList<GridPoint> sourcePoints = traceBack(done, m_grid, viaCount, GridTarget, GridSource);      // trace back to source
-	QList<GridPoint> targetPoints = traceBack(done, m_grid, viaCount, GridSource, GridTarget);      // trace back to target
-	if (sourcePoints.count() == 0 || targetPoints.count() == 0) {
-		DebugDialog::debug("traceback zero points");
-		return points;
-	}
-	else {
-		targetPoints.takeFirst();           // redundant point
-		Q_FOREACH (GridPoint gp, targetPoints) points.prepend(gp);
-		points.append(sourcePoints);
-	}
-
-	clearExpansion(m_grid);
-
-	//DebugDialog::debug(QString("done with route() %1").arg(points.count()));
-
-	return points;
-}
-
-QList<GridPoint> MazeRouter::traceBack(GridPoint gridPoint, Grid * grid, int & viaCount, GridValue sourceValue, GridValue targetValue) {
-	//DebugDialog::debug(QString("traceback %1 %2 %3").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z));
-	QList<GridPoint> points;
-	points << gridPoint;
-	while (true) {
-		if (gridPoint.baseCost == targetValue) {
-			// done
-			break;
-		}
-
-		// can only be one neighbor with lower value
-		GridPoint next = traceBackOne(gridPoint, grid, -1, 0, 0, sourceValue, targetValue);
-		if (next.baseCost == GridBoardObstacle) {
-			next = traceBackOne(gridPoint, grid, 1, 0, 0, sourceValue, targetValue);
-			if (next.baseCost == GridBoardObstacle) {
-				next = traceBackOne(gridPoint, grid, 0, -1, 0, sourceValue, targetValue);
-				if (next.baseCost == GridBoardObstacle) {
-					next = traceBackOne(gridPoint, grid, 0, 1, 0, sourceValue, targetValue);
-					if (next.baseCost == GridBoardObstacle) {
-						next = traceBackOne(gridPoint, grid, 0, 0, -1, sourceValue, targetValue);
-						if (next.baseCost == GridBoardObstacle) {
-							next = traceBackOne(gridPoint, grid, 0, 0, 1, sourceValue, targetValue);
-							if (next.baseCost == GridBoardObstacle) {
-								// traceback failed--is this possible?
-								points.clear();
-								break;
-							}
-						}
-					}
-				}
-			}
-		}
-
-		//if (grid->at(next.x - 1, next.y, next.z) != GridObstacle) next.flags |= GridPointWest;
-		//if (grid->at(next.x + 1, next.y, next.z) != GridObstacle) next.flags |= GridPointEast;
-		//if (grid->at(next.x, next.y - 1, next.z) != GridObstacle) next.flags |= GridPointNorth;
-		//if (grid->at(next.x, next.y + 1, next.z) != GridObstacle) next.flags |= GridPointSouth;
-		points << next;
-		if (next.z != gridPoint.z) viaCount++;
-		gridPoint = next;
-	}
-
-	/*
-	QString costs("costs ");
-	foreach (GridPoint gridPoint, points) {
-	    costs += QString::number(gridPoint.baseCost) + " ";
-	}
-	DebugDialog::debug(costs);
-	*/
-
+	GridSearch search(m_grid, m_costFunction, m_bothSidesNow, m_halfGridViaSize, [this]() { return stopRequested(); });
+	QList<GridPoint> points = search.route(routeThing, viaCount);
+	m_searchStats.add(search.stats());
 	return points;
 }
 
-GridPoint MazeRouter::traceBackOne(GridPoint & gridPoint, Grid * grid, int dx, int dy, int dz, GridValue sourceValue, GridValue targetValue) {
-	GridPoint next;
-	next.baseCost = GridBoardObstacle;
-
-	next.x = gridPoint.x + dx;
-	if (next.x < 0 || next.x >= grid->x) {
-		return next;
-	}
-
-	next.y = gridPoint.y + dy;
-	if (next.y < 0 || next.y >= grid->y) {
-		return next;
-	}
-
-	next.z = gridPoint.z + dz;
-	if (next.z < 0 || next.z >= grid->z) {
-		return next;
-	}
-
-	GridValue nextval = grid->at(next.x, next.y, next.z);
-	if (nextval == GridBoardObstacle || nextval == GridPartObstacle || nextval == sourceValue || nextval == 0 || nextval == GridTempObstacle) return next;
-	if (nextval == targetValue) {
-		// done!
-		next.baseCost = targetValue;
-		return next;
-	}
-
-	if (targetValue == GridSource) {
-		if ((nextval & GridSourceFlag) == 0) return next;
-		nextval ^= GridSourceFlag;
-	}
-	else {
-		if (nextval & GridSourceFlag) return next;
-	}
-
-	if (nextval < gridPoint.baseCost) {
-		next.baseCost = nextval;
-	}
-	return next;
-}
-
-void MazeRouter::expand(GridPoint & gridPoint, RouteThing & routeThing)
-{
-	//static bool debugit = false;
-	//if (routeNumber > 41 && routeThing.pq.size() > 8200) debugit = true;
-
-	//if (debugit) {
-	//    DebugDialog::debug(QString("expand %1 %2 %3, %4").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(routeThing.pq.size()));
-	//}
-	if (gridPoint.x > 0) expandOne(gridPoint, routeThing, -1, 0, 0, false);
-	if (gridPoint.x < m_grid->x - 1) expandOne(gridPoint, routeThing, 1, 0, 0, false);
-	if (gridPoint.y > 0) expandOne(gridPoint, routeThing, 0, -1, 0, false);
-	if (gridPoint.y < m_grid->y - 1) expandOne(gridPoint, routeThing, 0, 1, 0, false);
-	if (m_bothSidesNow) {
-		if (gridPoint.z > 0) expandOne(gridPoint, routeThing, 0, 0, -1, true);
-		if (gridPoint.z < m_grid->z - 1) expandOne(gridPoint, routeThing, 0, 0, 1, true);
-	}
-	//if (debugit) {
-	//    DebugDialog::debug("expand done");
-	//}
-}
-
-void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int dx, int dy, int dz, bool crossLayer) {
-	GridPoint next;
-	next.x = gridPoint.x + dx;
-	next.y = gridPoint.y + dy;
-	next.z = gridPoint.z + dz;
-
-	//DebugDialog::debug(QString("expand one %1,%2,%3 cl:%4").arg(next.x).arg(next.y).arg(next.z).arg(crossLayer));
-
-	bool writeable = false;
-	bool avoid = false;
-	GridValue nextval = m_grid->at(next.x, next.y, next.z);
-	if (nextval == GridPartObstacle || nextval == GridBoardObstacle || nextval == routeThing.sourceValue || nextval == GridTempObstacle) {
-		//DebugDialog::debug("exit expand one");
-		return;
-	}
-
-	if (nextval == routeThing.targetValue) {
-		//DebugDialog::debug("found grid target");
-		next.flags |= GridPointDone;
-	}
-	else if (nextval == 0) {
-		writeable = true;
-	}
-	else if (nextval == GridAvoid) {
-		bool contains = true;
-		for (int i = 1; i <= 3; i++) {
-			if (!routeThing.avoids.contains(((next.y - (i * dy)) * m_grid->x) + next.x - (i * dx))) {
-				contains = false;
-				break;
-			}
-		}
-
-		if (contains) {
-			// do not allow more than 3 in a row in the same direction?
-			return;
-		}
-		avoid = writeable = true;
-		if (dx == 0) {
-			if (m_grid->at(next.x - 1, next.y, next.z) == GridAvoid) {
-				m_grid->setAt(next.x - 1, next.y, next.z, GridTempObstacle);
-			}
-			if (m_grid->at(next.x + 1, next.y, next.z) == GridAvoid) {
-				m_grid->setAt(next.x + 1, next.y, next.z, GridTempObstacle);
-			}
-		}
-		else {
-			if (m_grid->at(next.x, next.y - 1, next.z) == GridAvoid) {
-				m_grid->setAt(next.x, next.y - 1, next.z, GridTempObstacle);
-			}
-			if (m_grid->at(next.x, next.y + 1, next.z) == GridAvoid) {
-				m_grid->setAt(next.x, next.y + 1, next.z, GridTempObstacle);
-			}
-		}
-	}
-	else {
-		// already been here: see if source and target expansions have intersected
-		if (routeThing.sourceValue == GridSource) {
-			if (nextval & GridSourceFlag) return;
-
-			next.flags |= GridPointDone;
-		}
-		else {
-			if ((nextval & GridSourceFlag) == 0) return;
-
-			next.flags |= GridPointDone;
-		}
-	}
-
-	// any way to skip viaWillFit or put it off until actually needed?
-	if (crossLayer) {
-		if (!viaWillFit(next, m_grid)) return;
-
-		// only way to cross layers is with a via
-		//QPointF center = getPixelCenter(next, m_maxRect.topLeft(), m_gridPixels);
-		//DebugDialog::debug(QString("via will fit %1,%2,%3 %4,%5").arg(next.x).arg(next.y).arg(next.z).arg(center.x()).arg(center.y()));
-	}
-
-	next.baseCost = gridPoint.baseCost;
-	if (crossLayer) {
-		next.baseCost += ViaCost;
-	}
-	else if (avoid) {
-		next.baseCost += AvoidCost;
-	}
-	next.baseCost++;
-
-
-	/*
-	int increment = 5;
-	// assume because of obstacles around the board that we can never be off grid from (next.x, next.y)
-	switch(grid->at(next.x - 1, next.y, next.z)) {
-	    case GridObstacle:
-	    case GridSource:
-	    case GridTarget:
-	        increment--;
-	    default:
-	        break;
-	}
-	switch(grid->at(next.x + 1, next.y, next.z)) {
-	    case GridObstacle:
-	    case GridSource:
-	    case GridTarget:
-	        increment--;
-	    default:
-	        break;
-	}
-	switch(grid->at(next.x, next.y - 1, next.z)) {
-	    case GridObstacle:
-	    case GridSource:
-	    case GridTarget:
-	        increment--;
-	    default:
-	        break;
-	}
-	switch(grid->at(next.x, next.y + 1, next.z)) {
-	    case GridObstacle:
-	    case GridSource:
-	    case GridTarget:
-	        increment--;
-	    default:
-	        break;
-	}
-	next.cost += increment;
-	*/
-
-
-	if (nextval == routeThing.targetValue) {
-		next.qCost = next.baseCost;
-	}
-	else {
-		double d = (m_costFunction)(QPoint(next.x, next.y), (routeThing.sourceValue == GridSource) ? routeThing.gridTargetPoint : routeThing.gridSourcePoint);
-		next.qCost = next.baseCost + d;
-		if (routeThing.sourceValue == GridSource) {
-			if (d < routeThing.bestDistanceToTarget) {
-				//DebugDialog::debug(QString("best d target %1, %2,%3").arg(d).arg(next.x).arg(next.y));
-				routeThing.bestDistanceToTarget = d;
-				routeThing.bestLocationToTarget = next;
-			}
-		}
-		else {
-			if (d < routeThing.bestDistanceToSource) {
-				//DebugDialog::debug(QString("best d source %1, %2,%3").arg(d).arg(next.x).arg(next.y));
-				routeThing.bestDistanceToSource = d;
-				routeThing.bestLocationToSource = next;
-			}
-		}
-	}
-
-	// can think about pushing multiple points here
-	//DebugDialog::debug(QString("pushing next %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
-	if (routeThing.sourceValue == GridSource) routeThing.sourceQ.push(next);
-	else routeThing.targetQ.push(next);
-
-	if (writeable) {
-		GridValue flag = (routeThing.sourceValue == GridSource) ? GridSourceFlag : 0;
-		m_grid->setAt(next.x, next.y, next.z, next.baseCost | flag);
-	}
-
-	//DebugDialog::debug("done expand one");
-
-
-	//if (routeThing.searchForJumper) {
-	//    updateDisplay(next);
-	//}
-}
-
-bool MazeRouter::viaWillFit(GridPoint & gridPoint, Grid * grid) {
-	for (int y = -m_halfGridViaSize; y <= m_halfGridViaSize; y++) {
-		int py = y + gridPoint.y;
-		if (py < 0) return false;
-		if (py >= grid->y) return false;
-
-		for (int x = -m_halfGridViaSize; x <= m_halfGridViaSize; x++) {
-			int px = x + gridPoint.x;
-			if (px < 0) return false;
-			if (px >= grid->x) return false;
-
-			for (int z = 0; z < grid->z; z++) {
-				GridValue val = grid->at(px, py, z);
-				if (val == GridPartObstacle || val == GridBoardObstacle || val == GridSource || val == GridTarget || val == GridTempObstacle || val == GridAvoid) return false;
-			}
-		}
-	}
-	return true;
-}
-
 void MazeRouter::updateDisplay(int iz) {
+	if (m_displayImage[iz] == nullptr) return;		// worker routers have no display
+
 	QPixmap pixmap = QPixmap::fromImage(*m_displayImage[iz]);
 	if (m_displayItem[iz] == nullptr) {
 		m_displayItem[iz] = new QGraphicsPixmapItem(pixmap);
@@ -1953,6 +1704,8 @@ void MazeRouter::updateDisplay(int iz) {
 }
 
 void MazeRouter::updateDisplay(Grid * grid, int iz) {
+	if (m_displayImage[iz] == nullptr) return;
+
 	m_displayImage[iz]->fill(0);
 	for (int y = 0; y < grid->y; y++) {
 		for (int x = 0; x < grid->x; x++) {
@@ -1965,6 +1718,8 @@ void MazeRouter::updateDisplay(Grid * grid, int iz) {
 }
 
 void MazeRouter::updateDisplay(GridPoint & gridPoint) {
+	if (m_displayImage[gridPoint.z] == nullptr) return;
+
 	//static int counter = 0;
 	//if (counter++ % 2 == 0) {
 	uint color = getColor(m_grid->at(gridPoint.x, gridPoint.y, gridPoint.z));
@@ -1976,25 +1731,20 @@ void MazeRouter::updateDisplay(GridPoint & gridPoint) {
 }
 
 void MazeRouter::clearExpansion(Grid * grid) {
-	// TODO: keep a list of expansion points instead?
-
-	for (int z = 0; z < grid->z; z++) {
-		for (int y = 0; y < grid->y; y++) {
-			for (int x = 0; x < grid->x; x++) {
-				GridValue val = grid->at(x, y, z);
-				if (val == 0 || val == GridPartObstacle || val == GridBoardObstacle) ;
-				else grid->setAt(x, y, z, 0);
-			}
-		}
-	}
+	// obstacles live in the grid's bitmaps, so this only has to zero the cost words
+	grid->clearCosts();
 }
 
 void MazeRouter::initTraceDisplay() {
+	if (m_displayImage[0] == nullptr) return;
+
 	m_displayImage[0]->fill(0);
 	m_displayImage[1]->fill(0);
 }
 
 void MazeRouter::displayTrace(Trace & trace) {
+	if (m_displayImage[0] == nullptr) return;
+
 	if (trace.gridPoints.count() == 0) {
 		DebugDialog::debug("trace with no points");
 		return;
@@ -2088,6 +1838,8 @@ void MazeRouter::traceAvoids(QList<Trace> & traces, int netIndex, RouteThing & r
 		Q_FOREACH (GridPoint gridPoint, trace.gridPoints) {
 			for (int y = -m_keepoutGridInt; y <= m_keepoutGridInt; y++) {
 				for (int x = -m_keepoutGridInt; x <= m_keepoutGridInt; x++) {
+					if (!m_grid->contains(gridPoint.x + x, gridPoint.y + y, 0)) continue;
+
 					GridValue val = m_grid->at(gridPoint.x + x, gridPoint.y + y, 0);
 					if (val == GridPartObstacle || val == GridBoardObstacle || val == GridSource || val == GridTarget) continue;
 
@@ -2845,7 +2597,7 @@ void MazeRouter::routeJumper(int netIndex, RouteThing & routeThing, Score & curr
 		sourceTrace.flags = JumperStart;
 		if (gp1.flags & GridPointJumperLeft) sourceTrace.flags |= JumperLeft;
 		else if (gp1.flags & GridPointJumperRight) sourceTrace.flags |= JumperRight;
-		sourceTrace.gridPoints = traceBack(gp1, m_grid, sourceViaCount, GridTarget, GridSource);   // trace back to source
+		sourceTrace.gridPoints = GridSearch::traceBack(gp1, m_grid, sourceViaCount, GridTarget, GridSource);   // trace back to source
 	}
 
 	Trace destTrace;
@@ -2853,7 +2605,7 @@ void MazeRouter::routeJumper(int netIndex, RouteThing & routeThing, Score & curr
 	if (gp2.flags & GridPointJumperLeft) destTrace.flags |= JumperLeft;
 	else if (gp2.flags & GridPointJumperRight) destTrace.flags |= JumperRight;
 	int targetViaCount = 0;
-	destTrace.gridPoints = traceBack(gp2, m_grid, targetViaCount, GridSource, GridTarget);          // trace back to target
+	destTrace.gridPoints = GridSearch::traceBack(gp2, m_grid, targetViaCount, GridSource, GridTarget);          // trace back to target
 
 	if (routeBothEnds) {
 		insertTrace(sourceTrace, netIndex, currentScore, sourceViaCount, false);
@@ -3020,7 +2772,7 @@ void MazeRouter::optimizeTraces(QList<int> & order, QMultiHash<int, QList< QPoin
 			Markers markers;
 			initMarkers(markers, m_pcbType);
 			NetElements netElements;
-			DRC::splitNetPrep(masterDoc, *(net->net), markers, netElements.net, netElements.alsoNet, netElements.notNet, true);
+			DRC::splitNetPrep(masterDoc, net->splitNetIDs, markers, netElements.net, netElements.alsoNet, netElements.notNet, true);
 			Q_FOREACH (QDomElement element, netElements.net) {
 				element.setTagName("g");
 			}
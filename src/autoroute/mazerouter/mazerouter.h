@@ -34,22 +34,14 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPointer>
 
 #include <queue>
+#include <memory>
+#include <vector>
 
 #include "../../viewlayer.h"
 #include "../autorouter.h"
-
-typedef quint64 GridValue;
-
-struct GridPoint {
-	int x, y, z;
-	GridValue baseCost = 0;
-	double qCost = 0.0;
-	uchar flags = 0;
-
-	bool operator<(const GridPoint&) const;
-	GridPoint(QPoint p, int zed) : x(p.x()), y(p.y()), z(zed) { }
-	constexpr GridPoint() : x(0), y(0), z(0) { }
-};
+#include "../drc.h"
+#include "obstaclecache.h"
+#include "gridsearch.h"
 
 struct PointZ {
 	QPointF p;
@@ -61,6 +53,7 @@ struct PointZ {
 struct Net {
 	QList<class ConnectorItem *>* net = nullptr;
 	QList< QList<ConnectorItem *> > subnets;
+	SplitNetIDs splitNetIDs;		// collected on the gui thread, so ordering workers never read the scene
 	int pinsWithin = 0;
 	int id = 0;
 };
@@ -94,6 +87,13 @@ struct Score {
 
 	Score() = default;
 	void setOrdering(const NetOrdering &);
+	bool betterThan(const Score &) const;
+};
+
+struct OrderingRun {
+	Score score;
+	QList<NetOrdering> allOrderings;	// snapshot at the start of the batch plus anything moveBack() proposed
+	QList<int> moveBacks;				// ordering positions passed to moveBack(), in call order
 };
 
 struct Nearest {
@@ -103,24 +103,6 @@ struct Nearest {
 	ConnectorItem * jc = nullptr;
 };
 
-struct Grid {
-	/// @todo replace this with std::unique_ptr<GridValue[]>
-	GridValue * data = nullptr;
-	int x = 0;
-	int y = 0;
-	int z = 0;
-
-	Grid(int x, int y, int layers);
-    ~Grid();
-
-	GridValue at(int x, int y, int z) const;
-	void setAt(int x, int y, int z, GridValue value);
-	QList<QPoint> init(int x, int y, int z, int width, int height, const QImage &, GridValue value, bool collectPoints);
-	QList<QPoint> init4(int x, int y, int z, int width, int height, const QImage *, GridValue value, bool collectPoints);
-	void clear();
-	void copy(int fromIndex, int toIndex);
-};
-
 
 struct NetElements {
 	QList<QDomElement> net;
@@ -128,24 +110,13 @@ struct NetElements {
 	QList<QDomElement> notNet;
 };
 
-struct RouteThing {
+struct RouteThing : public SearchThing {
 	QRectF r;
 	QRectF r4;
 	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
 	Nearest nearest;
-	std::priority_queue<GridPoint> sourceQ;
-	std::priority_queue<GridPoint> targetQ;
-	QPoint gridSourcePoint;
-	QPoint gridTargetPoint;
-	GridValue sourceValue;
-	GridValue targetValue;
-	double bestDistanceToTarget;
-	double bestDistanceToSource;
-	GridPoint bestLocationToTarget;
-	GridPoint bestLocationToSource;
 	bool unrouted;
 	NetElements netElements[2];
-	QSet<int> avoids;
 };
 
 struct TraceThing {
@@ -170,7 +141,6 @@ struct ConnectionThing {
 };
 
 typedef bool (*JumperWillFitFunction)(GridPoint &, const Grid *, int halfSize);
-typedef double (*CostFunction)(const QPoint & p1, const QPoint & p2);
 
 ////////////////////////////////////
 
@@ -184,7 +154,18 @@ public:
 
 	void start();
 
+public:
+	static const QString ParallelOrderingsName;
+	static const QString SearchModeName;
+	static const QString AStarSearchMode;
+
 protected:
+	MazeRouter(const MazeRouter * master);
+
+	bool stopRequested() const;
+	void routeOrderings(NetList &, const Score & startScore, const QSizeF gridSize, const QList<NetOrdering> & allOrderings, int firstRun, QList<OrderingRun> & runs);
+	void primeConnectorGeometry(NetList &);
+	void initObstacleCache(ViewLayer::ViewLayerPlacement, const QRectF & renderRect, const QSize & imageSize);
 	void setUpWidths(double width);
 	int findPinsWithin(QList<ConnectorItem *> * net);
 	bool makeBoard(QImage *, double keepout, const QRectF & r);
@@ -195,17 +176,13 @@ protected:
 	void findNearestPair(QList< QList<ConnectorItem *> > & subnets, int i, QList<ConnectorItem *> & inet, Nearest &);
 	QList<QPoint> renderSource(QDomDocument * masterDoc, int z, ViewLayer::ViewLayerPlacement, Grid * grid, QList<QDomElement> & netElements, QList<ConnectorItem *> & subnet, GridValue value, bool clearElements, const QRectF & r);
 	QList<GridPoint> route(RouteThing &, int & viaCount);
-	void expand(GridPoint &, RouteThing &);
-	void expandOne(GridPoint &, RouteThing &, int dx, int dy, int dz, bool crossLayer);
-	bool viaWillFit(GridPoint &, Grid * grid);
-	QList<GridPoint> traceBack(GridPoint, Grid *, int & viaCount, GridValue sourceValue, GridValue targetValue);
-	GridPoint traceBackOne(GridPoint &, Grid *, int dx, int dy, int dz, GridValue sourceValue, GridValue targetValue);
 	void updateDisplay(int iz);
 	void updateDisplay(Grid *, int iz);
 	void updateDisplay(GridPoint &);
 	void clearExpansion(Grid * grid);
 	void prepSourceAndTarget(QDomDocument * masterdoc, RouteThing &, QList< QList<ConnectorItem *> > & subnets, int z, ViewLayer::ViewLayerPlacement);
 	bool moveBack(Score & currentScore, int index, QList<NetOrdering> & allOrderings);
+	bool replayMoveBacks(const OrderingRun &, QList<NetOrdering> & allOrderings);
 	void displayTrace(Trace &);
 	void initTraceDisplay();
 	void traceObstacles(QList<Trace> & traces, int netIndex, Grid * grid, int ikeepout);
@@ -256,9 +233,15 @@ protected:
 	JumperWillFitFunction m_jumperWillFitFunction;
 	uint m_traceColors[2] = { 0 };
 	Grid * m_grid;
+	ObstacleCache m_obstacleCaches[2];
 	int m_cleanupCount;
 	int m_netLabelIndex;
 	int m_commandCount;
+	int m_parallelOrderings;
+	QList<int> m_moveBacks;
+	bool m_aStar;
+	SearchStats m_searchStats;
+	const MazeRouter * m_master;		// non-null when this router is a worker evaluating an ordering off the GUI thread
 };
 
 #endif
@@ -0,0 +1,269 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "obstaclecache.h"
+
+#include <QDomNamedNodeMap>
+#include <QHash>
+#include <QPainter>
+#include <QSet>
+#include <QStringList>
+#include <QSvgRenderer>
+
+#include <algorithm>
+#include <cstring>
+
+static QByteArray fragmentSvg(const QDomElement & root, const QDomElement & fragment) {
+	// a copy of the <svg> element (attributes only) wrapped around a single top-level element
+	QDomDocument doc;
+	QDomNode svg = doc.importNode(root, false);
+	svg.appendChild(doc.importNode(fragment, true));
+	doc.appendChild(svg);
+	return doc.toByteArray();
+}
+
+static void renderFragment(const QByteArray & svg, QImage * image, const QPoint & offset, const QRectF & renderRect) {
+	QSvgRenderer renderer(svg);
+	QPainter painter;
+	painter.begin(image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	painter.translate(-offset);
+	renderer.render(&painter, renderRect);
+	painter.end();
+}
+
+static QRect blackBounds(const QImage & image) {
+	// byte-aligned bounding rect of the black (zero) pixels in a mono image
+	int bytes = (image.width() + 7) / 8;
+	int left = bytes, right = -1, top = -1, bottom = -1;
+	for (int y = 0; y < image.height(); y++) {
+		const uchar * line = image.constScanLine(y);
+		int first = 0;
+		while (first < bytes && line[first] == 0xff) first++;
+		if (first == bytes) continue;
+
+		int last = bytes - 1;
+		while (line[last] == 0xff) last--;
+		if (top < 0) top = y;
+		bottom = y;
+		left = qMin(left, first);
+		right = qMax(right, last);
+	}
+
+	if (top < 0) return QRect();
+
+	return QRect(left * 8, top, (right - left + 1) * 8, bottom - top + 1);
+}
+
+static void andRows(QImage & to, const QImage & from, const QRect & fromRect, const QRect & clip) {
+	// rects are byte aligned, so black (zero) bits simply accumulate with &=
+	QRect r = fromRect & clip;
+	if (r.isEmpty()) return;
+
+	int b0 = r.left() / 8;
+	int b1 = (r.right() + 1) / 8;
+	int offset = fromRect.left() / 8;
+	for (int y = r.top(); y <= r.bottom(); y++) {
+		uchar * dst = to.scanLine(y);
+		const uchar * src = from.constScanLine(y - fromRect.top());
+		for (int b = b0; b < b1; b++) {
+			dst[b] &= src[b - offset];
+		}
+	}
+}
+
+static void copyRows(QImage & to, const QImage & from, const QRect & r) {
+	int b0 = r.left() / 8;
+	int count = r.width() / 8;
+	for (int y = r.top(); y <= r.bottom(); y++) {
+		memcpy(to.scanLine(y) + b0, from.constScanLine(y) + b0, count);
+	}
+}
+
+static QString localName(const QString & tagName) {
+	int colon = tagName.indexOf(':');
+	return (colon < 0) ? tagName : tagName.mid(colon + 1);
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool ObstacleCache::isSplittable(const QDomElement & root) {
+	static const QStringList SharedTags = QStringList() << "defs" << "use" << "style" << "symbol" << "clipPath"
+	                                                    << "mask" << "pattern" << "marker" << "filter"
+	                                                    << "linearGradient" << "radialGradient";
+
+	QList<QDomElement> elements;
+	elements << root;
+	while (!elements.isEmpty()) {
+		QDomElement element = elements.takeLast();
+		if (SharedTags.contains(localName(element.tagName()))) return false;
+
+		QDomNamedNodeMap attributes = element.attributes();
+		for (int i = 0; i < attributes.count(); i++) {
+			QDomNode attribute = attributes.item(i);
+			QString value = attribute.nodeValue();
+			if (value.contains("url(")) return false;
+			if (localName(attribute.nodeName()) == "href" && value.trimmed().startsWith('#')) return false;
+		}
+
+		for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+			elements.append(child);
+		}
+	}
+
+	return true;
+}
+
+bool ObstacleCache::init(QDomDocument * masterDoc, const QRectF & renderRect, const QSize & imageSize, const std::function<bool()> & keepGoing) {
+	clear();
+
+	QDomElement root = masterDoc->documentElement();
+	if (!isSplittable(root)) return false;
+
+	m_base = QImage(imageSize, QImage::Format_Mono);
+	m_base.fill(0xffffffff);
+
+	QImage scratch(imageSize, QImage::Format_Mono);
+	for (QDomElement element = root.firstChildElement(); !element.isNull(); element = element.nextSiblingElement()) {
+		ObstacleFragment fragment;
+		fragment.element = element;
+		scratch.fill(0xffffffff);
+		renderFragment(fragmentSvg(root, element), &scratch, QPoint(0, 0), renderRect);
+		fragment.rect = blackBounds(scratch);
+		if (!fragment.rect.isEmpty()) {
+			fragment.image = QImage(fragment.rect.size(), QImage::Format_Mono);
+			fragment.image.fill(0xffffffff);
+			for (int y = 0; y < fragment.rect.height(); y++) {
+				memcpy(fragment.image.scanLine(y), scratch.constScanLine(y + fragment.rect.top()) + (fragment.rect.left() / 8), fragment.rect.width() / 8);
+			}
+			andRows(m_base, fragment.image, fragment.rect, fragment.rect);
+		}
+		m_fragments.append(fragment);
+
+		if (m_fragments.count() % 32 == 0 && keepGoing && !keepGoing()) {
+			clear();
+			return false;
+		}
+	}
+
+	m_current = m_base;
+	return true;
+}
+
+void ObstacleCache::bind(QDomDocument * masterDoc) {
+	// point a copied cache at the equivalent elements of a cloned master document
+	int index = 0;
+	QDomElement root = masterDoc->documentElement();
+	for (QDomElement element = root.firstChildElement(); !element.isNull() && index < m_fragments.count(); element = element.nextSiblingElement()) {
+		m_fragments[index++].element = element;
+	}
+}
+
+void ObstacleCache::clear() {
+	m_fragments.clear();
+	m_base = m_current = QImage();
+	m_dirty.clear();
+}
+
+bool ObstacleCache::isEmpty() const {
+	return m_fragments.isEmpty();
+}
+
+QList<int> ObstacleCache::fragmentIndexes(const QList<QDomElement> & elements) const {
+	if (m_fragments.isEmpty()) return QList<int>();
+
+	QDomNode root = m_fragments.first().element.parentNode();
+	QSet<int> indexes;
+	Q_FOREACH (QDomElement element, elements) {
+		// climb to the top-level element, then count its way back to the first one
+		QDomNode fragment = element;
+		while (!fragment.isNull() && fragment.parentNode() != root) {
+			fragment = fragment.parentNode();
+		}
+		if (fragment.isNull()) continue;
+
+		int index = 0;
+		for (QDomElement sibling = fragment.previousSiblingElement(); !sibling.isNull(); sibling = sibling.previousSiblingElement()) {
+			index++;
+		}
+		indexes.insert(index);
+	}
+
+	QList<int> result = indexes.values();
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+const QImage * ObstacleCache::render(const QList<QDomElement> & changed, const QRectF & renderRect) {
+	if (m_fragments.isEmpty()) return nullptr;
+
+	// put back whatever the previous net changed
+	Q_FOREACH (QRect r, m_dirty) {
+		copyRows(m_current, m_base, r);
+	}
+	m_dirty.clear();
+
+	QDomElement root = m_fragments.first().element.parentNode().toElement();
+	QHash<int, QImage> rerendered;
+	Q_FOREACH (int index, fragmentIndexes(changed)) {
+		if (index >= m_fragments.count()) continue;
+
+		const ObstacleFragment & fragment = m_fragments.at(index);
+		if (fragment.rect.isEmpty()) continue;
+
+		// hidden elements can only make a fragment smaller, so it still fits in its rect
+		QImage image(fragment.rect.size(), QImage::Format_Mono);
+		image.fill(0xffffffff);
+		renderFragment(fragmentSvg(root, fragment.element), &image, fragment.rect.topLeft(), renderRect);
+		rerendered.insert(index, image);
+		m_dirty.append(fragment.rect);
+	}
+
+	Q_FOREACH (QRect r, m_dirty) {
+		for (int y = r.top(); y <= r.bottom(); y++) {
+			memset(m_current.scanLine(y) + (r.left() / 8), 0xff, r.width() / 8);
+		}
+		for (int i = 0; i < m_fragments.count(); i++) {
+			const ObstacleFragment & fragment = m_fragments.at(i);
+			if (!fragment.rect.intersects(r)) continue;
+
+			andRows(m_current, rerendered.contains(i) ? rerendered.value(i) : fragment.image, fragment.rect, r);
+		}
+	}
+
+	return &m_current;
+}
+
+bool ObstacleCache::renderElements(const QList<QDomElement> & elements, QImage * image, const QRectF & renderRect) const {
+	if (m_fragments.isEmpty()) return false;
+
+	QDomElement root = m_fragments.first().element.parentNode().toElement();
+	Q_FOREACH (int index, fragmentIndexes(elements)) {
+		if (index >= m_fragments.count()) continue;
+
+		const ObstacleFragment & fragment = m_fragments.at(index);
+		if (fragment.rect.isEmpty()) continue;
+
+		renderFragment(fragmentSvg(root, fragment.element), image, QPoint(0, 0), renderRect);
+	}
+
+	return true;
+}
@@ -0,0 +1,74 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef OBSTACLECACHE_H
+#define OBSTACLECACHE_H
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+
+#include <functional>
+
+// one top-level element (part, trace, label) of a master document, rendered on its own
+struct ObstacleFragment {
+	QDomElement element;
+	QRect rect;				// in pixels; left edge and width are multiples of 8 so mono rows combine a byte at a time
+	QImage image;			// cropped to rect
+};
+
+// Obstacles for one layer: "everything except this net" is the base image with only the
+// fragments holding this net's elements re-rendered, instead of rasterizing the whole master document.
+// Fragment indexes are found from the elements' position in the document, so the document is never
+// marked up; it must keep the same top-level elements for as long as the cache is in use.
+class ObstacleCache
+{
+public:
+	// Returns false, leaving the cache empty, when the document cannot be rendered piece by piece
+	// or when keepGoing (asked every few fragments) returns false
+	bool init(QDomDocument * masterDoc, const QRectF & renderRect, const QSize & imageSize, const std::function<bool()> & keepGoing = nullptr);
+	void bind(QDomDocument * masterDoc);
+	void clear();
+	bool isEmpty() const;
+
+	// the base image with the fragments holding any of the changed elements re-rendered;
+	// nullptr when the cache is empty
+	const QImage * render(const QList<QDomElement> & changed, const QRectF & renderRect);
+	// render only the fragments holding any of the elements; false when the cache is empty
+	bool renderElements(const QList<QDomElement> & elements, QImage * image, const QRectF & renderRect) const;
+
+	// false if an element's rendering depends on something outside its own top-level element:
+	// <defs>, <use>, <style>, or a url(#id)/href reference
+	static bool isSplittable(const QDomElement & root);
+
+protected:
+	QList<int> fragmentIndexes(const QList<QDomElement> & elements) const;
+
+protected:
+	QList<ObstacleFragment> m_fragments;
+	QImage m_base;			// all fragments combined
+	QImage m_current;		// base with the current net's fragments re-rendered
+	QList<QRect> m_dirty;	// where current differs from base
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "pixelcollide.h"
+
+#include <QtAlgorithms>
+#include <cstring>
+
+static const int MaxCollisionPoints = 1000;
+
+static inline bool collideByte(uchar collisions, int byteIndex, uchar * displayLine, uint clr, int y, QList<QPointF> & points) {
+	if (collisions == 0) return false;
+
+	while (collisions != 0) {
+		int bit = qCountLeadingZeroBits(collisions);
+		collisions &= ~(0x80 >> bit);
+		int x = (byteIndex << 3) + bit;
+		displayLine[x] = (uchar) clr;
+		if (points.count() < MaxCollisionPoints) {
+			points.append(QPointF(x, y));
+		}
+	}
+
+	return true;
+}
+
+bool pixelsCollide(const QImage * image1, const QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points) {
+	Q_ASSERT(image1->format() == QImage::Format_Mono);
+	Q_ASSERT(image2->format() == QImage::Format_Mono);
+	Q_ASSERT(image3->format() == QImage::Format_Indexed8);
+
+	x1 = qMax(x1, 0);
+	y1 = qMax(y1, 0);
+	x2 = qMin(x2, qMin(image1->width(), image3->width()));
+	y2 = qMin(y2, qMin(image1->height(), image3->height()));
+	if (x1 >= x2 || y1 >= y2) return false;
+
+	// pixels are packed msb first, so the first and last bytes of the span may only be partly inside it
+	const int firstByte = x1 >> 3;
+	const int lastByte = (x2 - 1) >> 3;
+	const uchar firstMask = 0xff >> (x1 & 7);
+	const uchar lastMask = 0xff << (7 - ((x2 - 1) & 7));
+
+	bool result = false;
+	for (int y = y1; y < y2; y++) {
+		const uchar * line1 = image1->constScanLine(y);
+		const uchar * line2 = image2->constScanLine(y);
+		uchar * displayLine = image3->scanLine(y);
+
+		if (firstByte == lastByte) {
+			result |= collideByte(~(line1[firstByte] | line2[firstByte]) & firstMask & lastMask, firstByte, displayLine, clr, y, points);
+			continue;
+		}
+
+		result |= collideByte(~(line1[firstByte] | line2[firstByte]) & firstMask, firstByte, displayLine, clr, y, points);
+
+		// a collision is a bit that is 0 in both images, so a word that ORs to all ones has none
+		int b = firstByte + 1;
+		for (; b + 8 <= lastByte; b += 8) {
+			quint64 word1;
+			quint64 word2;
+			memcpy(&word1, line1 + b, sizeof(word1));
+			memcpy(&word2, line2 + b, sizeof(word2));
+			if ((word1 | word2) == ~Q_UINT64_C(0)) continue;
+
+			for (int i = 0; i < 8; i++) {
+				result |= collideByte(~(line1[b + i] | line2[b + i]), b + i, displayLine, clr, y, points);
+			}
+		}
+		for (; b < lastByte; b++) {
+			result |= collideByte(~(line1[b] | line2[b]), b, displayLine, clr, y, points);
+		}
+
+		result |= collideByte(~(line1[lastByte] | line2[lastByte]) & lastMask, lastByte, displayLine, clr, y, points);
+	}
+
+	return result;
+}
@@ -0,0 +1,32 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef PIXELCOLLIDE_H
+#define PIXELCOLLIDE_H
+
+#include <QImage>
+#include <QList>
+#include <QPointF>
+
+// Finds the pixels in [x1, x2) x [y1, y2) which are black (0) in both Format_Mono images.
+// Each hit is set to clr in the Format_Indexed8 display image, and the first 1000 are appended to points.
+bool pixelsCollide(const QImage * image1, const QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points);
+
+#endif
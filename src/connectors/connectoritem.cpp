@@ -204,16 +204,21 @@ parts editor support
 #include <QBrush>
 #include <QPen>
 #include <QColor>
+#include <algorithm>
 #include <limits>
+#include <QHash>
 #include <QSet>
+#include <QVector>
 #include <QToolTip>
 #include <QBitmap>
 #include <QApplication>
 #include <qmath.h>
 
 #include "../sketch/infographicsview.h"
+#include "../sketch/fgraphicsscene.h"
 #include "../debugdialog.h"
 #include "bus.h"
+#include "connectoritemgraph.h"
 #include "../items/wire.h"
 #include "../items/virtualwire.h"
 #include "../model/modelpart.h"
@@ -242,13 +247,30 @@ const QList<ConnectorItem *> ConnectorItem::emptyConnectorItemList;
 
 static double MAX_DOUBLE = std::numeric_limits<double>::max();
 
+static NetConnectivity * netConnectivity(ConnectorItem * connectorItem) {
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(connectorItem->scene());
+	return (fGraphicsScene == nullptr) ? nullptr : &fGraphicsScene->netConnectivity();
+}
+
 const QColor LegConnectorUnderColor = QColor("#8c8c8c"); // TODO: don't hardcode color
 
-bool wireLessThan(ConnectorItem * c1, ConnectorItem * c2)
+static QVector<double> stackingKey(QGraphicsItem * item)
+{
+	// z values from the top-level item down; a connector's own zValue is only relative to its part
+	QVector<double> key;
+	for (; item != nullptr; item = item->parentItem()) {
+		key.prepend(item->zValue());
+	}
+	return key;
+}
+
+typedef QHash<ConnectorItem *, QVector<double> > StackingKeys;
+
+static bool wireLessThan(ConnectorItem * c1, ConnectorItem * c2, const StackingKeys & stackingKeys)
 {
 	if (c1->connectorType() == c2->connectorType()) {
 		// if they're the same type return the topmost
-		return c1->zValue() > c2->zValue();
+		return stackingKeys.value(c2) < stackingKeys.value(c1);
 	}
 	if (c1->connectorType() == Connector::Female) {
 		// choose the female first
@@ -322,6 +344,12 @@ ConnectorItem::ConnectorItem( Connector * connector, ItemBase * attachedTo )
 	setAcceptHoverEvents(true);
 	this->setCursor((attachedTo && attachedTo->itemType() == ModelPart::Wire) ? *CursorMaster::BendpointCursor : *CursorMaster::MakeWireCursor);
 
+	// a parent already in a scene adds us from the QGraphicsItem constructor, before itemChange() is ours
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->addConnectorItem(this);
+	}
+
 	//DebugDialog::debug(QString("%1 attached to %2")
 	//.arg(this->connector()->connectorShared()->id())
 	//.arg(attachedTo->modelPartShared()->title()) );
@@ -339,6 +367,41 @@ ConnectorItem::~ConnectorItem() {
 
 	detach();
 	clearCurves();
+
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->removeConnectorItem(this);
+	}
+}
+
+QVariant ConnectorItem::itemChange(GraphicsItemChange change, const QVariant & value)
+{
+	if (change == QGraphicsItem::ItemSceneChange) {
+		auto * oldScene = qobject_cast<FGraphicsScene *>(scene());
+		auto * newScene = qobject_cast<FGraphicsScene *>(qvariant_cast<QGraphicsScene *>(value));
+		if (oldScene != newScene) {
+			if (oldScene != nullptr) oldScene->removeConnectorItem(this);
+			if (newScene != nullptr) newScene->addConnectorItem(this);
+		}
+	}
+	else if (change == QGraphicsItem::ItemPositionHasChanged || change == QGraphicsItem::ItemTransformHasChanged) {
+		// only rubber-band legs move independently of their part
+		auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+		if (fGraphicsScene != nullptr) {
+			fGraphicsScene->connectorItemChanged(this);
+		}
+	}
+
+	return NonConnectorItem::itemChange(change, value);
+}
+
+void ConnectorItem::setRect(const QRectF & rect)
+{
+	NonConnectorItem::setRect(rect);
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->connectorItemChanged(this);
+	}
 }
 
 void ConnectorItem::detach()
@@ -470,6 +533,8 @@ void ConnectorItem::connectTo(ConnectorItem * connected) {
 	if (m_connectedTo.contains(connected)) return;
 
 	m_connectedTo.append(connected);
+	NetConnectivity * nets = netConnectivity(this);
+	if (nets) nets->connected(this, connected);
 	//DebugDialog::debug(QString("connect to cc:%4 this:%1 to:%2 %3").arg((long) this, 0, 16).arg((long) connected, 0, 16).arg(connected->attachedTo()->modelPartShared()->title()).arg(m_connectedTo.count()) );
 	QList<ConnectorItem *> visited;
 	restoreColor(visited);
@@ -484,6 +549,8 @@ ConnectorItem * ConnectorItem::removeConnection(ItemBase * itemBase) {
 		if (m_connectedTo[i]->attachedTo() == itemBase) {
 			ConnectorItem * removed = m_connectedTo[i];
 			m_connectedTo.removeAt(i);
+			NetConnectivity * nets = netConnectivity(this);
+			if (nets) nets->disconnected(this, removed);
 			if (m_attachedTo) {
 				m_attachedTo->connectionChange(this, removed, false);
 			}
@@ -505,6 +572,8 @@ void ConnectorItem::removeConnection(ConnectorItem * connectedItem, bool emitCha
 	if (!connectedItem) return;
 
 	m_connectedTo.removeOne(connectedItem);
+	NetConnectivity * nets = netConnectivity(this);
+	if (nets) nets->disconnected(this, connectedItem);
 	QList<ConnectorItem *> visited;
 	restoreColor(visited);
 	if (emitChange) {
@@ -513,7 +582,11 @@ void ConnectorItem::removeConnection(ConnectorItem * connectedItem, bool emitCha
 }
 
 void ConnectorItem::tempConnectTo(ConnectorItem * item, bool applyColor) {
-	if (!m_connectedTo.contains(item)) m_connectedTo.append(item);
+	if (!m_connectedTo.contains(item)) {
+		m_connectedTo.append(item);
+		NetConnectivity * nets = netConnectivity(this);
+		if (nets) nets->connected(this, item);
+	}
 
 	if(applyColor) {
 		QList<ConnectorItem *> visited;
@@ -522,7 +595,10 @@ void ConnectorItem::tempConnectTo(ConnectorItem * item, bool applyColor) {
 }
 
 void ConnectorItem::tempRemove(ConnectorItem * item, bool applyColor) {
-	m_connectedTo.removeOne(item);
+	if (m_connectedTo.removeOne(item)) {
+		NetConnectivity * nets = netConnectivity(this);
+		if (nets) nets->disconnected(this, item);
+	}
 
 	if(applyColor) {
 		QList<ConnectorItem *> visited;
@@ -1199,6 +1275,11 @@ void ConnectorItem::writeOtherElements(QXmlStreamWriter & writer) {
 }
 
 bool ConnectorItem::wiredTo(ConnectorItem * target, ViewGeometry::WireFlags skipFlags) {
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr && target->scene() == fGraphicsScene) {
+		return fGraphicsScene->netConnectivity().sameNet(this, target, true, skipFlags);
+	}
+
 	QList<ConnectorItem *> connectorItems;
 	connectorItems.append(this);
 	collectEqualPotential(connectorItems, true, skipFlags);
@@ -1343,72 +1424,30 @@ void ConnectorItem::collectEqualPotential(
 		ViewGeometry::WireFlags skipFlags,
 		bool skipBuses)
 {
-	// take a local (temporary working) copy of the supplied list, and wipe the original
-	QList<ConnectorItem *> tempItems = connectorItems;
-	connectorItems.clear();
-
-	for (int i = 0; i < tempItems.count(); i++) {
-		ConnectorItem *connectorItem = tempItems[i];
-
-		Wire *fromWire = (connectorItem->attachedToItemType() == ModelPart::Wire)
-						 ? qobject_cast<Wire *>(connectorItem->attachedTo())
-						 : nullptr;
-		if (fromWire) {
-			if (fromWire->hasAnyFlag(skipFlags)) {
-				// don't add this kind of wire
-				continue;
-			}
-		} else {
-			if (crossLayers) {
-				ConnectorItem *crossConnectorItem = connectorItem->getCrossLayerConnectorItem();
-				if (crossConnectorItem) {
-					if (!tempItems.contains(crossConnectorItem)) {
-						tempItems.append(crossConnectorItem);
-					}
-				}
-			}
-		} // end else not (fromWire)
-
-		// this one's a keeper
-		connectorItems.append(connectorItem);
-
-		Q_FOREACH (ConnectorItem *cto, connectorItem->connectedToItems()) {
-			if (tempItems.contains(cto)) {
-				continue;
-			}
-
-			if ((skipFlags & ViewGeometry::NormalFlag)
-				&& (!fromWire)
-				&& (cto->attachedToItemType() != ModelPart::Wire)) {
-				// direct (part-to-part) connections not allowed
-				continue;
-			}
+	// connectors that all belong to one scene are answered from that scene's cached nets
+	if (!connectorItems.isEmpty()) {
+		auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(connectorItems.first()->scene());
+		Q_FOREACH (ConnectorItem * connectorItem, connectorItems) {
+			if (fGraphicsScene == nullptr) break;
+			if (connectorItem->scene() != fGraphicsScene) fGraphicsScene = nullptr;
+		}
+		if (fGraphicsScene != nullptr) {
+			fGraphicsScene->netConnectivity().collectEqualPotential(connectorItems, crossLayers, skipFlags, skipBuses);
+			return;
+		}
+	}
 
-			// add `approved` connected items to the list being processed
-			tempItems.append(cto);
-		} // end foreach (ConnectorItem *cto, connectorItem->connectedToItems())
+	collectEqualPotentialAux(connectorItems, crossLayers, skipFlags, skipBuses);
+}
 
-		// When the kept connector item is part of a bus, include all of the other
-		// connectors on the bus in the list being processed
-		if ((connectorItem->attachedToItemType() == ModelPart::Wire || !skipBuses)) {
-			QList<ConnectorItem *> busConnectedItems;
-			if (connectorItem->attachedTo()->busConnectorItems(connectorItem, busConnectedItems)) {
-#ifndef QT_NO_DEBUG
-				if (connectorItem->attachedToItemType() == ModelPart::Wire && busConnectedItems.count() != 2) {
-					connectorItem->debugInfo("bus is missing");
-					//busConnectedItems.clear();
-					//connectorItem->attachedTo()->busConnectorItems(bus, busConnectedItems);
-				}
-#endif
-				Q_FOREACH (ConnectorItem *busConnectedItem, busConnectedItems) {
-					if (!tempItems.contains(busConnectedItem)) {
-						tempItems.append(busConnectedItem);
-					}
-				}
-			}
-		}
-	} // end for (int i = 0; i < tempItems.count(); i++)
-} // end void ConnectorItem::collectEqualPotential(…)
+void ConnectorItem::collectEqualPotentialAux(
+		QList<ConnectorItem *> &connectorItems,
+		bool crossLayers,
+		ViewGeometry::WireFlags skipFlags,
+		bool skipBuses)
+{
+	ConnectorItemGraph().walk(connectorItems, crossLayers, skipFlags, skipBuses);
+}
 
 void ConnectorItem::collectParts(QList<ConnectorItem *> & connectorItems, QList<ConnectorItem *> & partsConnectors, bool includeSymbols, ViewLayer::ViewLayerPlacement viewLayerPlacement)
 {
@@ -1971,16 +2010,41 @@ double ConnectorItem::minDimension() {
 
 ConnectorItem * ConnectorItem::findConnectorUnder(bool useTerminalPoint, bool allowAlready, const QList<ConnectorItem *> & exclude, bool displayDragTooltip, ConnectorItem * other)
 {
-	QList<QGraphicsItem *> items = useTerminalPoint
-	                               ? this->scene()->items(this->sceneAdjustedTerminalPoint(nullptr))
-	                               : this->scene()->items(mapToScene(this->rect()));  // only wires use rect
+	QList<ConnectorItem *> items;
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(this->scene());
+	if (fGraphicsScene != nullptr) {
+		items = useTerminalPoint
+		        ? fGraphicsScene->connectorItemsAt(this->sceneAdjustedTerminalPoint(nullptr))
+		        : fGraphicsScene->connectorItemsIn(mapToScene(this->rect()));  // only wires use rect
+	}
+	else {
+		QList<QGraphicsItem *> sceneItems = useTerminalPoint
+		                                    ? this->scene()->items(this->sceneAdjustedTerminalPoint(nullptr))
+		                                    : this->scene()->items(mapToScene(this->rect()));
+		Q_FOREACH (QGraphicsItem * item, sceneItems) {
+			auto * connectorItemUnder = dynamic_cast<ConnectorItem *>(item);
+			if (connectorItemUnder) items.append(connectorItemUnder);
+		}
+	}
+
+	// the grid returns hits in insertion order; put them in stacking order like scene()->items() does.
+	// each key walks the item's parents, so build them once rather than twice per comparison
+	StackingKeys stackingKeys;
+	stackingKeys.reserve(items.count());
+	Q_FOREACH (ConnectorItem * connectorItemUnder, items) {
+		stackingKeys.insert(connectorItemUnder, stackingKey(connectorItemUnder));
+	}
+	std::stable_sort(items.begin(), items.end(), [&stackingKeys](ConnectorItem * a, ConnectorItem * b) {
+		return stackingKeys.value(b) < stackingKeys.value(a);
+	});
+
+	QSet<ConnectorItem *> excluded(exclude.begin(), exclude.end());
+
 	QList<ConnectorItem *> candidates;
 	// for the moment, take the topmost ConnectorItem that doesn't belong to me
-	Q_FOREACH (QGraphicsItem * item, items) {
-		auto * connectorItemUnder = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItemUnder) continue;
+	Q_FOREACH (ConnectorItem * connectorItemUnder, items) {
 		if (!connectorItemUnder->connector()) continue;  // shouldn't happen
-		if (attachedTo()->childItems().contains(connectorItemUnder)) continue;  // don't use own connectors
+		if (connectorItemUnder->parentItem() == attachedTo()) continue;  // don't use own connectors
 		if (!this->connectionIsAllowed(connectorItemUnder)) {
 			continue;
 		}
@@ -1994,7 +2058,7 @@ ConnectorItem * ConnectorItem::findConnectorUnder(bool useTerminalPoint, bool al
 				continue;  // already connected
 			}
 		}
-		if (exclude.contains(connectorItemUnder)) continue;
+		if (excluded.contains(connectorItemUnder)) continue;
 
 
 		candidates.append(connectorItemUnder);
@@ -2006,18 +2070,24 @@ ConnectorItem * ConnectorItem::findConnectorUnder(bool useTerminalPoint, bool al
 	}
 	else if (candidates.count() > 0) {
 		if (this->attachedToItemType() == ModelPart::Wire) {
-			std::sort(candidates.begin(), candidates.end(), [this](ConnectorItem *a, ConnectorItem *b) {
-				auto squaredDistanceTo = [this](ConnectorItem* other) {
-					return std::pow(this->sceneBoundingRect().center().x() - other->sceneBoundingRect().center().x(), 2) +
-						std::pow(this->sceneBoundingRect().center().y() - other->sceneBoundingRect().center().y(), 2);
-				};
-				if (a->zValue() == b->zValue()) {
-					return squaredDistanceTo(a) < squaredDistanceTo(b);
+			QPointF center = this->sceneBoundingRect().center();
+			QHash<ConnectorItem *, double> squaredDistances;
+			Q_FOREACH (ConnectorItem * connectorItemUnder, candidates) {
+				QPointF d = center - connectorItemUnder->sceneBoundingRect().center();
+				squaredDistances.insert(connectorItemUnder, (d.x() * d.x()) + (d.y() * d.y()));
+			}
+			std::stable_sort(candidates.begin(), candidates.end(), [&stackingKeys, &squaredDistances](ConnectorItem *a, ConnectorItem *b) {
+				QVector<double> aKey = stackingKeys.value(a);
+				QVector<double> bKey = stackingKeys.value(b);
+				if (aKey == bKey) {
+					return squaredDistances.value(a) < squaredDistances.value(b);
 				}
-				return a->zValue() > b->zValue();
+				return bKey < aKey;
 			});
 		} else {
-			std::sort(candidates.begin(), candidates.end(), wireLessThan);
+			std::stable_sort(candidates.begin(), candidates.end(), [&stackingKeys](ConnectorItem * a, ConnectorItem * b) {
+				return wireLessThan(a, b, stackingKeys);
+			});
 		}
 		candidate = candidates[0];
 	}
@@ -2488,6 +2558,11 @@ void ConnectorItem::killRubberBandLeg() {
 	m_rubberBandLeg = false;
 	m_legPolygon.clear();
 	clearCurves();
+
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->connectorItemChanged(this);
+	}
 }
 
 QPen ConnectorItem::legPen() const
@@ -117,6 +117,7 @@ public:
 	void setBigDot(bool);
 	bool isBigDot();
 	ConnectorItem * findConnectorUnder(bool useTerminalPoint, bool allowAlready, const QList<ConnectorItem *> & exclude, bool displayDragTooltip, ConnectorItem * other);
+	void setRect(const QRectF &);		// hides QGraphicsRectItem::setRect so the scene's connector index hears about it
 	ConnectorItem * releaseDrag();
 
 	// rubberBand leg functions
@@ -154,6 +155,7 @@ public:
 	void setGroundFillSeed(bool);
 
 protected:
+	QVariant itemChange(GraphicsItemChange change, const QVariant & value);
 	void hoverEnterEvent( QGraphicsSceneHoverEvent * event );
 	void hoverLeaveEvent( QGraphicsSceneHoverEvent * event );
 	void hoverMoveEvent( QGraphicsSceneHoverEvent * event );
@@ -238,6 +240,7 @@ protected:
 
 protected:
 	static void collectPart(ConnectorItem * connectorItem, QList<ConnectorItem *> & partsConnectors, ViewLayer::ViewLayerPlacement);
+	static void collectEqualPotentialAux(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses);
 
 public:
 	static void collectEqualPotential(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses = false);
@@ -0,0 +1,78 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "connectoritemgraph.h"
+#include "connectoritem.h"
+#include "../items/wire.h"
+
+bool ConnectorItemGraph::skipped(ConnectorItem * connectorItem, ViewGeometry::WireFlags skipFlags) const
+{
+	if (connectorItem->attachedToItemType() != ModelPart::Wire) return false;
+
+	auto * wire = qobject_cast<Wire *>(connectorItem->attachedTo());
+	return (wire != nullptr) && wire->hasAnyFlag(skipFlags);
+}
+
+void ConnectorItemGraph::collectNeighbors(ConnectorItem * connectorItem, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses, QList<ConnectorItem *> & neighbors) const
+{
+	Wire * fromWire = (connectorItem->attachedToItemType() == ModelPart::Wire)
+	                  ? qobject_cast<Wire *>(connectorItem->attachedTo())
+	                  : nullptr;
+	if (fromWire != nullptr && fromWire->hasAnyFlag(skipFlags)) return;
+
+	if (fromWire == nullptr && crossLayers) {
+		ConnectorItem * crossConnectorItem = connectorItem->getCrossLayerConnectorItem();
+		if (crossConnectorItem != nullptr) neighbors.append(crossConnectorItem);
+	}
+
+	Q_FOREACH (ConnectorItem * cto, connectorItem->connectedToItems()) {
+		if (cto == nullptr) continue;
+		if ((skipFlags & ViewGeometry::NormalFlag) && (fromWire == nullptr) && (cto->attachedToItemType() != ModelPart::Wire)) {
+			// direct (part-to-part) connections not allowed
+			continue;
+		}
+		if (skipped(cto, skipFlags)) continue;
+
+		neighbors.append(cto);
+	}
+
+	// When the connector item is part of a bus, the other connectors on the bus are reached as well
+	if (connectorItem->attachedToItemType() == ModelPart::Wire || !skipBuses) {
+		QList<ConnectorItem *> busConnectedItems;
+		if (connectorItem->attachedTo()->busConnectorItems(connectorItem, busConnectedItems)) {
+#ifndef QT_NO_DEBUG
+			if (connectorItem->attachedToItemType() == ModelPart::Wire && busConnectedItems.count() != 2) {
+				connectorItem->debugInfo("bus is missing");
+			}
+#endif
+			Q_FOREACH (ConnectorItem * busConnectedItem, busConnectedItems) {
+				if (busConnectedItem == connectorItem) continue;
+				if (skipped(busConnectedItem, skipFlags)) continue;
+
+				neighbors.append(busConnectedItem);
+			}
+		}
+	}
+}
+
+QList<ConnectorItem *> ConnectorItemGraph::connectorItems(ItemBase * itemBase) const
+{
+	return itemBase->cachedConnectorItems();
+}
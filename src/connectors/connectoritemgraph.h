@@ -0,0 +1,36 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef CONNECTORITEMGRAPH_H
+#define CONNECTORITEMGRAPH_H
+
+#include "netconnectivity.h"
+
+// NetGraph over real connector items: their connections, cross-layer twins and buses.
+
+class ConnectorItemGraph : public NetGraph
+{
+public:
+	bool skipped(ConnectorItem *, ViewGeometry::WireFlags skipFlags) const override;
+	void collectNeighbors(ConnectorItem *, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses, QList<ConnectorItem *> & neighbors) const override;
+	QList<ConnectorItem *> connectorItems(ItemBase *) const override;
+};
+
+#endif
@@ -0,0 +1,444 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "netconnectivity.h"
+
+#include <vector>
+
+static quint64 partitionKey(bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses) {
+	return (static_cast<quint64>(skipFlags.toInt()) << 2) | (crossLayers ? 2 : 0) | (skipBuses ? 1 : 0);
+}
+
+void NetGraph::walk(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses) const
+{
+	// take a local (temporary working) copy of the supplied list, and wipe the original
+	QList<ConnectorItem *> tempItems;
+	QSet<ConnectorItem *> queued;
+	Q_FOREACH (ConnectorItem * connectorItem, connectorItems) {
+		if (queued.contains(connectorItem)) continue;
+
+		queued.insert(connectorItem);
+		tempItems.append(connectorItem);
+	}
+	connectorItems.clear();
+
+	QList<ConnectorItem *> neighbors;
+	for (int i = 0; i < tempItems.count(); i++) {
+		ConnectorItem * connectorItem = tempItems.at(i);
+		if (skipped(connectorItem, skipFlags)) continue;
+
+		// this one's a keeper
+		connectorItems.append(connectorItem);
+
+		neighbors.clear();
+		collectNeighbors(connectorItem, crossLayers, skipFlags, skipBuses, neighbors);
+		Q_FOREACH (ConnectorItem * neighbor, neighbors) {
+			if (queued.contains(neighbor)) continue;
+
+			queued.insert(neighbor);
+			tempItems.append(neighbor);
+		}
+	}
+}
+
+NetConnectivity::NetConnectivity(const NetGraph & graph) : m_graph(graph)
+{
+}
+
+NetConnectivity::~NetConnectivity()
+{
+	qDeleteAll(m_partitions);
+}
+
+void NetConnectivity::addConnectorItem(ConnectorItem * connectorItem)
+{
+	if (m_connectorItems.contains(connectorItem)) return;
+
+	m_connectorItems.insert(connectorItem);
+	noteChanged(connectorItem);
+	Q_FOREACH (Partition * partition, m_partitions) {
+		if (m_graph.skipped(connectorItem, partition->skipFlags)) continue;
+
+		newNet(partition, QList<ConnectorItem *>() << connectorItem, false);
+		joinNeighbors(partition, connectorItem);
+
+		// the net may have been open only because this connector wasn't in the scene yet
+		int net = partition->netOf.value(connectorItem);
+		if (partition->open.contains(net)) partition->dirty.insert(net);
+	}
+}
+
+void NetConnectivity::removeConnectorItem(ConnectorItem * connectorItem)
+{
+	if (!m_connectorItems.remove(connectorItem)) return;
+
+	noteChanged(connectorItem);
+
+	Q_FOREACH (Partition * partition, m_partitions) {
+		int net = partition->netOf.value(connectorItem, -1);
+		if (net < 0) continue;
+
+		partition->netOf.remove(connectorItem);
+		QList<ConnectorItem *> & members = partition->members[net];
+		members.removeOne(connectorItem);
+		if (members.isEmpty()) {
+			partition->members.remove(net);
+			partition->dirty.remove(net);
+			partition->open.remove(net);
+		}
+		else {
+			// the connector may still be connected to the rest of the net, which then reaches outside the scene
+			partition->dirty.insert(net);
+		}
+	}
+}
+
+void NetConnectivity::connected(ConnectorItem * from, ConnectorItem * to)
+{
+	noteChanged(from);
+	noteChanged(to);
+	QList<ConnectorItem *> neighbors;
+	Q_FOREACH (Partition * partition, m_partitions) {
+		int net1 = partition->netOf.value(from, -1);
+		if (net1 < 0) continue;
+
+		// only if it is an edge collectNeighbors() follows
+		neighbors.clear();
+		m_graph.collectNeighbors(from, partition->crossLayers, partition->skipFlags, partition->skipBuses, neighbors);
+		if (!neighbors.contains(to)) continue;
+
+		if (!m_connectorItems.contains(to)) {
+			partition->open.insert(net1);
+			continue;
+		}
+
+		int net2 = partition->netOf.value(to, -1);
+		if (net2 < 0 || net1 == net2) continue;
+
+		merge(partition, net1, net2);
+	}
+}
+
+void NetConnectivity::disconnected(ConnectorItem * from, ConnectorItem * to)
+{
+	noteChanged(from);
+	noteChanged(to);
+	Q_FOREACH (Partition * partition, m_partitions) {
+		markDirty(partition, from);
+		markDirty(partition, to);
+	}
+}
+
+void NetConnectivity::busesChanged(ItemBase * itemBase)
+{
+	// buses can both join and split nets, so re-walk what the item touches and join what its buses join now
+	Q_FOREACH (ConnectorItem * connectorItem, m_graph.connectorItems(itemBase)) {
+		if (!m_connectorItems.contains(connectorItem)) continue;
+
+		noteChanged(connectorItem);
+		Q_FOREACH (Partition * partition, m_partitions) {
+			int net = partition->netOf.value(connectorItem, -1);
+			if (net < 0) continue;
+
+			partition->dirty.insert(net);
+			joinNeighbors(partition, connectorItem);
+		}
+	}
+}
+
+void NetConnectivity::invalidate()
+{
+	qDeleteAll(m_partitions);
+	m_partitions.clear();
+	m_changed.clear();
+	m_allChanged = true;
+}
+
+void NetConnectivity::collectEqualPotential(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses)
+{
+	Partition * partition = this->partition(crossLayers, skipFlags, skipBuses);
+
+	// same contents as the walk in ConnectorItem::collectEqualPotential(), seeds first
+	QList<ConnectorItem *> seeds = connectorItems;
+	connectorItems.clear();
+	QSet<int> nets;
+	QSet<ConnectorItem *> already;
+	Q_FOREACH (ConnectorItem * seed, seeds) {
+		if (already.contains(seed)) continue;
+
+		int net = cleanNet(partition, seed);
+		if (net < 0) continue;
+
+		if (partition->open.contains(net)) {
+			connectorItems = seeds;
+			m_graph.walk(connectorItems, crossLayers, skipFlags, skipBuses);
+			return;
+		}
+
+		already.insert(seed);
+		connectorItems.append(seed);
+		nets.insert(net);
+	}
+
+	Q_FOREACH (int net, nets) {
+		Q_FOREACH (ConnectorItem * connectorItem, partition->members.value(net)) {
+			if (already.contains(connectorItem)) continue;
+
+			already.insert(connectorItem);
+			connectorItems.append(connectorItem);
+		}
+	}
+}
+
+bool NetConnectivity::sameNet(ConnectorItem * connectorItem1, ConnectorItem * connectorItem2, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses)
+{
+	Partition * partition = this->partition(crossLayers, skipFlags, skipBuses);
+	int net1 = cleanNet(partition, connectorItem1);
+	if (net1 < 0) return false;
+
+	int net2 = cleanNet(partition, connectorItem2);
+	if (partition->open.contains(net1) || partition->open.contains(net2)) {
+		QList<ConnectorItem *> connectorItems;
+		connectorItems.append(connectorItem1);
+		m_graph.walk(connectorItems, crossLayers, skipFlags, skipBuses);
+		return connectorItems.contains(connectorItem2);
+	}
+
+	return net1 == net2;
+}
+
+bool NetConnectivity::contains(ConnectorItem * connectorItem) const
+{
+	return m_connectorItems.contains(connectorItem);
+}
+
+bool NetConnectivity::takeChanged(QSet<ConnectorItem *> & changed)
+{
+	bool allChanged = m_allChanged;
+	m_allChanged = false;
+	changed.unite(m_changed);
+	m_changed.clear();
+	return allChanged;
+}
+
+NetConnectivity::Partition * NetConnectivity::partition(bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses)
+{
+	quint64 key = partitionKey(crossLayers, skipFlags, skipBuses);
+	Partition * partition = m_partitions.value(key, nullptr);
+	if (partition != nullptr) return partition;
+
+	partition = new Partition;
+	partition->crossLayers = crossLayers;
+	partition->skipFlags = skipFlags;
+	partition->skipBuses = skipBuses;
+	build(partition);
+	m_partitions.insert(key, partition);
+	return partition;
+}
+
+void NetConnectivity::build(Partition * partition)
+{
+	QHash<ConnectorItem *, int> index;
+	QList<ConnectorItem *> nodes;
+	index.reserve(m_connectorItems.count());
+	nodes.reserve(m_connectorItems.count());
+	Q_FOREACH (ConnectorItem * connectorItem, m_connectorItems) {
+		if (m_graph.skipped(connectorItem, partition->skipFlags)) continue;
+
+		index.insert(connectorItem, nodes.count());
+		nodes.append(connectorItem);
+	}
+
+	std::vector<int> parent(nodes.count());
+	std::vector<int> size(nodes.count(), 1);
+	std::vector<bool> open(nodes.count(), false);
+	for (int i = 0; i < nodes.count(); i++) parent[i] = i;
+	auto find = [&parent](int i) {
+		while (parent[i] != i) {
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	};
+
+	QList<ConnectorItem *> neighbors;
+	for (int i = 0; i < nodes.count(); i++) {
+		neighbors.clear();
+		m_graph.collectNeighbors(nodes.at(i), partition->crossLayers, partition->skipFlags, partition->skipBuses, neighbors);
+		Q_FOREACH (ConnectorItem * neighbor, neighbors) {
+			int j = index.value(neighbor, -1);
+			if (j < 0) {
+				// outside the scene
+				open[i] = true;
+				continue;
+			}
+
+			int ri = find(i);
+			int rj = find(j);
+			if (ri == rj) continue;
+
+			if (size[ri] < size[rj]) std::swap(ri, rj);
+			parent[rj] = ri;
+			size[ri] += size[rj];
+		}
+	}
+
+	QHash<int, int> netOfRoot;
+	for (int i = 0; i < nodes.count(); i++) {
+		int root = find(i);
+		int net = netOfRoot.value(root, -1);
+		if (net < 0) {
+			net = partition->nextNet++;
+			netOfRoot.insert(root, net);
+		}
+		partition->members[net].append(nodes.at(i));
+		partition->netOf.insert(nodes.at(i), net);
+		if (open[i]) partition->open.insert(net);
+	}
+}
+
+int NetConnectivity::newNet(Partition * partition, const QList<ConnectorItem *> & connectorItems, bool dirty)
+{
+	int net = partition->nextNet++;
+	partition->members.insert(net, connectorItems);
+	Q_FOREACH (ConnectorItem * connectorItem, connectorItems) {
+		partition->netOf.insert(connectorItem, net);
+	}
+	if (dirty) partition->dirty.insert(net);
+	return net;
+}
+
+void NetConnectivity::merge(Partition * partition, int net1, int net2)
+{
+	// move the smaller net into the larger one
+	if (partition->members.value(net1).count() < partition->members.value(net2).count()) std::swap(net1, net2);
+
+	QList<ConnectorItem *> moving = partition->members.take(net2);
+	Q_FOREACH (ConnectorItem * connectorItem, moving) {
+		partition->netOf.insert(connectorItem, net1);
+	}
+	partition->members[net1].append(moving);
+	if (partition->dirty.remove(net2)) {
+		partition->dirty.insert(net1);
+	}
+	if (partition->open.remove(net2)) {
+		partition->open.insert(net1);
+	}
+}
+
+void NetConnectivity::joinNeighbors(Partition * partition, ConnectorItem * connectorItem)
+{
+	// merge the connector's net with everything it reaches in one step
+	QList<ConnectorItem *> neighbors;
+	m_graph.collectNeighbors(connectorItem, partition->crossLayers, partition->skipFlags, partition->skipBuses, neighbors);
+	Q_FOREACH (ConnectorItem * neighbor, neighbors) {
+		int net = partition->netOf.value(connectorItem);
+		if (!m_connectorItems.contains(neighbor)) {
+			partition->open.insert(net);
+			continue;
+		}
+
+		int other = partition->netOf.value(neighbor, -1);
+		if (other >= 0 && other != net) {
+			merge(partition, other, net);
+		}
+	}
+}
+
+void NetConnectivity::markDirty(Partition * partition, ConnectorItem * connectorItem)
+{
+	int net = partition->netOf.value(connectorItem, -1);
+	if (net >= 0) partition->dirty.insert(net);
+}
+
+int NetConnectivity::cleanNet(Partition * partition, ConnectorItem * connectorItem)
+{
+	int net = partition->netOf.value(connectorItem, -1);
+	if (net < 0) return net;
+
+	if (partition->dirty.contains(net)) {
+		resolve(partition, net);
+		net = partition->netOf.value(connectorItem, -1);
+	}
+	return net;
+}
+
+void NetConnectivity::noteChanged(ConnectorItem * connectorItem)
+{
+	if (m_allChanged) return;
+
+	m_changed.insert(connectorItem);
+	if (m_changed.count() > m_connectorItems.count()) {
+		// nobody is draining the list; a full pass is cheaper than tracking more
+		m_changed.clear();
+		m_allChanged = true;
+	}
+}
+
+void NetConnectivity::resolve(Partition * partition, int net)
+{
+	// a dirty net is a union of one or more real nets: walk it again from each member not yet reached
+	partition->dirty.remove(net);
+	partition->open.remove(net);
+	QList<ConnectorItem *> members = partition->members.take(net);
+	QSet<ConnectorItem *> reached;
+	QList<ConnectorItem *> neighbors;
+	Q_FOREACH (ConnectorItem * start, members) {
+		if (reached.contains(start)) continue;
+
+		QList<ConnectorItem *> component;
+		component.append(start);
+		reached.insert(start);
+		bool open = false;
+		for (int i = 0; i < component.count(); i++) {
+			neighbors.clear();
+			m_graph.collectNeighbors(component.at(i), partition->crossLayers, partition->skipFlags, partition->skipBuses, neighbors);
+			Q_FOREACH (ConnectorItem * neighbor, neighbors) {
+				if (reached.contains(neighbor)) continue;
+
+				int other = partition->netOf.value(neighbor, -1);
+				if (other < 0) {
+					// outside the scene
+					open = true;
+					continue;
+				}
+
+				if (other != net) {
+					// a connection we weren't told about; that net needs another look as well
+					QList<ConnectorItem *> & otherMembers = partition->members[other];
+					otherMembers.removeOne(neighbor);
+					if (otherMembers.isEmpty()) {
+						partition->members.remove(other);
+						partition->dirty.remove(other);
+						partition->open.remove(other);
+					}
+					else {
+						partition->dirty.insert(other);
+					}
+				}
+				reached.insert(neighbor);
+				component.append(neighbor);
+			}
+		}
+
+		int componentNet = newNet(partition, component, false);
+		if (open) partition->open.insert(componentNet);
+	}
+}
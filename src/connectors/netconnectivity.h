@@ -0,0 +1,107 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef NETCONNECTIVITY_H
+#define NETCONNECTIVITY_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include "../viewgeometry.h"
+
+class ConnectorItem;
+class ItemBase;
+
+// The connections nets are made of. NetConnectivity only ever reaches connectors through one of these,
+// so the scene's ConnectorItemGraph can be swapped for a stand-in.
+
+class NetGraph
+{
+public:
+	virtual ~NetGraph() {}
+
+	virtual bool skipped(ConnectorItem *, ViewGeometry::WireFlags skipFlags) const = 0;
+	// one step of the walk: the connectors the equal potential net reaches directly from this one
+	virtual void collectNeighbors(ConnectorItem *, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses, QList<ConnectorItem *> & neighbors) const = 0;
+	virtual QList<ConnectorItem *> connectorItems(ItemBase *) const = 0;
+
+	// everything reachable from the given connectors, seeds first, found without any caching
+	void walk(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses) const;
+};
+
+// Net membership for the connector items of one scene, cached per combination of the
+// ConnectorItem::collectEqualPotential() options. A partition is built with a union-find pass over the
+// scene's connectors, new connections merge nets in place, and anything that can split a net only
+// marks that net, which is re-walked the next time it is asked for. A net that reaches a connector
+// outside the scene is answered by walking it, since nothing reports changes out there.
+
+class NetConnectivity
+{
+public:
+	NetConnectivity(const NetGraph &);
+	~NetConnectivity();
+
+	void addConnectorItem(ConnectorItem *);
+	void removeConnectorItem(ConnectorItem *);
+	void connected(ConnectorItem *, ConnectorItem *);
+	void disconnected(ConnectorItem *, ConnectorItem *);
+	void busesChanged(ItemBase *);
+	void invalidate();
+
+	void collectEqualPotential(QList<ConnectorItem *> & connectorItems, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses);
+	bool sameNet(ConnectorItem *, ConnectorItem *, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses = false);
+	bool contains(ConnectorItem *) const;
+
+	// connectors whose net may have changed since the last call; true means assume every net did.
+	// the set can hold connectors that have since been deleted, so only use them as keys
+	bool takeChanged(QSet<ConnectorItem *> & changed);
+
+protected:
+	struct Partition {
+		bool crossLayers = false;
+		ViewGeometry::WireFlags skipFlags = ViewGeometry::NoFlag;
+		bool skipBuses = false;
+		QHash<ConnectorItem *, int> netOf;
+		QHash<int, QList<ConnectorItem *> > members;
+		QSet<int> dirty;
+		QSet<int> open;				// nets with a neighbor outside the scene
+		int nextNet = 0;
+	};
+
+	Partition * partition(bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses);
+	void build(Partition *);
+	int newNet(Partition *, const QList<ConnectorItem *> &, bool dirty);
+	void merge(Partition *, int net1, int net2);
+	void joinNeighbors(Partition *, ConnectorItem *);
+	void markDirty(Partition *, ConnectorItem *);
+	int cleanNet(Partition *, ConnectorItem *);
+	void resolve(Partition *, int net);
+	void noteChanged(ConnectorItem *);
+
+protected:
+	const NetGraph & m_graph;
+	QSet<ConnectorItem *> m_connectorItems;
+	QHash<quint64, Partition *> m_partitions;
+	QSet<ConnectorItem *> m_changed;
+	bool m_allChanged = true;
+};
+
+#endif
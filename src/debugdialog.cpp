@@ -24,7 +24,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "qevent.h"
 #include <QCoreApplication>
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QTextStream>
+#include <QThread>
 #include <QDir>
 #include <QtDebug>
 #include <QIcon>
@@ -105,6 +108,9 @@ bool DebugDialog::coloringEnabled = false;
 DebugDialog* DebugDialog::singleton = nullptr;
 QFile DebugDialog::m_file;
 
+// debug() is also called from worker threads (gerber export, parts parsing), so the log file is guarded
+static QMutex DebugMutex;
+
 #ifdef QT_NO_DEBUG
 bool DebugDialog::m_enabled = false;
 #else
@@ -224,13 +230,15 @@ void DebugDialog::debug(QString message, DebugLevel debugLevel, QObject * ancest
 
 	if (!m_enabled) return;
 
+	QMutexLocker locker(&DebugMutex);
 
-	if (singleton == nullptr) {
+	// the dialog is a widget, so only the gui thread may create it
+	if (singleton == nullptr && QCoreApplication::instance() != nullptr && QThread::currentThread() == QCoreApplication::instance()->thread()) {
 		new DebugDialog();
 		//singleton->show();
 	}
 
-	if (debugLevel < singleton->m_debugLevel) {
+	if (singleton != nullptr && debugLevel < singleton->m_debugLevel) {
 		return;
 	}
 
@@ -262,8 +270,10 @@ void DebugDialog::debug(QString message, DebugLevel debugLevel, QObject * ancest
 		out << message << "\n";
 		m_file.close();
 	}
-	auto* de = new DebugEvent(message, debugLevel, ancestor);
-	QCoreApplication::postEvent(singleton, de);
+	if (singleton != nullptr) {
+		auto* de = new DebugEvent(message, debugLevel, ancestor);
+		QCoreApplication::postEvent(singleton, de);
+	}
 }
 
 void DebugDialog::hideDebug() {
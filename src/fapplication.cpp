@@ -52,6 +52,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "installedfonts.h"
 #include "items/pinheader.h"
 #include "items/partfactory.h"
+#include "items/partsvgcache.h"
 #include "items/propertydef.h"
 #include "dialogs/recoverydialog.h"
 #include "processeventblocker.h"
@@ -81,7 +82,6 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QMultiHash>
-#include <QTemporaryFile>
 #include <QDir>
 #include <QMetaType>
 
@@ -323,36 +323,13 @@ ReferenceModel * RegenerateDatabaseThread::referenceModel() const {
 }
 
 void RegenerateDatabaseThread::run() {
-	QTemporaryFile file(QString("%1/XXXXXX.db").arg(QDir::tempPath()));
-	QString fileName;
-	if (file.open()) {
-		fileName = file.fileName();
-		file.close();
-	}
-	else {
-		m_error = tr("Unable to open temporary file") + " (" + fileName + ")";
-		return;
-	}
-
-	bool ok = ((FApplication *) qApp)->loadReferenceModel(fileName, true, m_referenceModel);
+	// the database is built next to m_dbFileName and renamed over it once complete,
+	// so a failed or interrupted build leaves the existing parts.db in place
+	bool ok = ((FApplication *) qApp)->loadReferenceModel(m_dbFileName, true, m_referenceModel);
 	if (!ok) {
 		m_error = tr("Database failure") + "\n" + m_referenceModel->error();
 		return;
 	}
-
-	if (QFile::exists(m_dbFileName)) {
-		ok = QFile::remove(m_dbFileName);
-		if (!ok) {
-			m_error = tr("Unable to replace the existing database file %1").arg(m_dbFileName);
-			return;
-		}
-	}
-
-	ok = QFile::copy(fileName, m_dbFileName);
-	if (!ok) {
-		m_error = tr("Unable to copy database file %1").arg(m_dbFileName);
-		return;
-	}
 }
 
 ////////////////////////////////////////////////////
@@ -1149,7 +1126,6 @@ void FApplication::runDatabaseService()
 	DebugDialog::setEnabled(true);
 
 	QString partsDB = m_outputFolder;  // m_outputFolder is actually a full path ending in ".db"
-	QFile::remove(partsDB);
 	loadReferenceModel(partsDB, true);
 }
 
@@ -2228,6 +2204,8 @@ void FApplication::regeneratePartsDatabase() {
 		return;
 	}
 
+	PartSvgCache::clear();
+
 	auto * fileProgressDialog = new FileProgressDialog(tr("Regenerating parts database..."), 0, nullptr);
 	// these don't seem very accurate (i.e. when progress is at 100%, there is still a lot of work pending)
 	// so we are leaving progress indeterminate at present
@@ -2241,6 +2219,10 @@ void FApplication::regeneratePartsDatabaseAux(QDialog * progressDialog) {
 	ReferenceModel * referenceModel = new CurrentReferenceModel();
 	QDir dir = FolderUtils::getAppPartsSubFolder("");
 	QString dbPath = dir.absoluteFilePath("parts.db");
+	if (m_referenceModel != nullptr) {
+		// parts.db is replaced at the end, which fails on some platforms while it is still open
+		m_referenceModel->closePartsDatabase();
+	}
 	auto *thread = new RegenerateDatabaseThread(dbPath, progressDialog, referenceModel);
 	connect(thread, SIGNAL(finished()), this, SLOT(regenerateDatabaseFinished()));
 	FMessageBox::BlockMessages = true;
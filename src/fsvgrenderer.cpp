@@ -31,6 +31,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QCoreApplication>
 #include <QtGlobal>
 #include <QFileInfo>
+#include <QDataStream>
 #include <QtSvgWidgets/QGraphicsSvgItem>
 
 #include <qnumeric.h>
@@ -68,6 +69,92 @@ void FSvgRenderer::cleanup() {
 
 }
 
+FSvgRenderer * FSvgRenderer::share(const QByteArray & loaded) {
+	// loaded must be what loadSvg returned; detach() reloads it
+	m_sharedContents = loaded;
+	return retain();
+}
+
+FSvgRenderer * FSvgRenderer::retain() {
+	m_refCount++;
+	return this;
+}
+
+bool FSvgRenderer::isShared() const {
+	return m_refCount > 1;
+}
+
+void FSvgRenderer::release(FSvgRenderer * renderer) {
+	if (renderer == nullptr) return;
+
+	if (--renderer->m_refCount <= 0) {
+		delete renderer;
+	}
+}
+
+FSvgRenderer * FSvgRenderer::detach() const {
+	// an unshared copy, for an item that is about to change its own image
+	auto * renderer = new FSvgRenderer();
+	renderer->QSvgRenderer::load(m_sharedContents);
+	renderer->m_filename = m_filename;
+	renderer->m_defaultSizeF = m_defaultSizeF;
+	Q_FOREACH (QString id, m_connectorInfoHash.keys()) {
+		renderer->m_connectorInfoHash.insert(id, new ConnectorInfo(*m_connectorInfoHash.value(id)));
+	}
+	Q_FOREACH (QString id, m_nonConnectorInfoHash.keys()) {
+		renderer->m_nonConnectorInfoHash.insert(id, new ConnectorInfo(*m_nonConnectorInfoHash.value(id)));
+	}
+	return renderer;
+}
+
+static QDataStream & operator<<(QDataStream & stream, const ConnectorInfo & info) {
+	stream << info.gotCircle << info.radius << info.strokeWidth << info.matrix << info.terminalMatrix
+		<< info.legMatrix << info.legColor << info.legLine << info.legStrokeWidth << info.gotPath;
+	return stream;
+}
+
+static QDataStream & operator>>(QDataStream & stream, ConnectorInfo & info) {
+	stream >> info.gotCircle >> info.radius >> info.strokeWidth >> info.matrix >> info.terminalMatrix
+		>> info.legMatrix >> info.legColor >> info.legLine >> info.legStrokeWidth >> info.gotPath;
+	return stream;
+}
+
+static void saveConnectorInfoHash(QDataStream & stream, const QHash<QString, ConnectorInfo *> & hash) {
+	stream << (qint32) hash.count();
+	Q_FOREACH (QString id, hash.keys()) {
+		stream << id << *hash.value(id);
+	}
+}
+
+static bool loadConnectorInfoHash(QDataStream & stream, QHash<QString, ConnectorInfo *> & hash) {
+	qint32 count;
+	stream >> count;
+	for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+		QString id;
+		auto * connectorInfo = new ConnectorInfo();
+		stream >> id >> *connectorInfo;
+		hash.insert(id, connectorInfo);
+	}
+	return stream.status() == QDataStream::Ok;
+}
+
+void FSvgRenderer::saveCached(QDataStream & stream) const {
+	// the parsed connector info that loadSvg would otherwise rebuild from a DOM; see PartSvgCache
+	saveConnectorInfoHash(stream, m_connectorInfoHash);
+	saveConnectorInfoHash(stream, m_nonConnectorInfoHash);
+}
+
+bool FSvgRenderer::loadCached(QByteArray & cleanContents, const QString & filename, QDataStream & stream) {
+	// cleanContents must be what loadSvg returned when the info was saved
+	if (finalLoad(cleanContents, filename).isEmpty()) return false;
+
+	m_sharedContents = cleanContents;		// the image cache holds the only reference so far
+
+	clearConnectorInfoHash(m_connectorInfoHash);
+	clearConnectorInfoHash(m_nonConnectorInfoHash);
+	return loadConnectorInfoHash(stream, m_connectorInfoHash) && loadConnectorInfoHash(stream, m_nonConnectorInfoHash);
+}
+
 QByteArray FSvgRenderer::loadSvg(const QString & filename) {
 	LoadInfo loadInfo(filename);
 	return loadSvg(loadInfo);
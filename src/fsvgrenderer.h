@@ -27,6 +27,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDomDocument>
 #include <QTransform>
 #include <QStringList>
+#include <QDataStream>
 
 #include "viewlayer.h"
 
@@ -79,8 +80,15 @@ public:
 	QSizeF defaultSizeF();
 	bool setUpConnector(class SvgIdLayer * svgIdLayer, bool ignoreTerminalPoint, ViewLayer::ViewLayerPlacement);
 	QList<SvgIdLayer *> setUpNonConnectors(ViewLayer::ViewLayerPlacement);
+	FSvgRenderer * share(const QByteArray & loaded);
+	FSvgRenderer * retain();
+	bool isShared() const;
+	FSvgRenderer * detach() const;
+	void saveCached(QDataStream &) const;
+	bool loadCached(QByteArray & cleanContents, const QString & filename, QDataStream &);
 
 public:
+	static void release(FSvgRenderer *);
 	static void cleanup();
 	static QSizeF parseForWidthAndHeight(QXmlStreamReader &);
 	static QPixmap * getPixmap(QSvgRenderer * renderer, QSize size);
@@ -110,6 +118,8 @@ protected:
 	QSizeF m_defaultSizeF;
 	QHash<QString, ConnectorInfo *> m_connectorInfoHash;
 	QHash<QString, ConnectorInfo *> m_nonConnectorInfoHash;
+	int m_refCount = 1;
+	QByteArray m_sharedContents;
 
 public:
 	static QString NonConnectorName;
@@ -26,9 +26,11 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../connectors/connectoritem.h"
 #include "../sketch/infographicsview.h"
 #include "sketch/sketchwidget.h"
+#include "../sketch/fgraphicsscene.h"
 #include "../connectors/connector.h"
 #include "../connectors/bus.h"
 #include "partlabel.h"
+#include "partsvgcache.h"
 #include "../layerattributes.h"
 #include "../fsvgrenderer.h"
 #include "../svg/svgfilesplitter.h"
@@ -57,6 +59,33 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 /////////////////////////////////
 
+struct ImageCacheEntry {
+	QByteArray bytes;							// one view layer of the part svg, flipped and split, before any local modifications
+	bool hasText = true;
+	FSvgRenderer * renderer = nullptr;			// shared by every instance that makes no local modifications
+	QByteArray loaded;
+	QString diskKey;							// content-based key into PartSvgCache
+	bool rendererSaved = false;					// PartSvgCache already holds the renderer
+};
+
+static QHash<QString, ImageCacheEntry *> ImageCache;
+
+static QString layerCacheKey(const LayerAttributes & layerAttributes) {
+	return QString("%1|%2|%3|%4")
+	       .arg(layerAttributes.viewID)
+	       .arg(layerAttributes.viewLayerID)
+	       .arg(layerAttributes.viewLayerPlacement)
+	       .arg((int) layerAttributes.orientation);
+}
+
+static QString imageCacheKey(ModelPart * modelPart, const QString & filename, const LayerAttributes & layerAttributes) {
+	// the modification time keeps the cache honest when the parts editor rewrites a part's svg
+	return QString("%1|%2|%3|%4")
+	       .arg(modelPart->moduleID(), filename)
+	       .arg(QFileInfo(filename).lastModified().toMSecsSinceEpoch())
+	       .arg(layerCacheKey(layerAttributes));
+}
+
 static QRegularExpression NumberMatcher;
 static QHash<QString, double> NumberMatcherValues;
 
@@ -145,9 +174,7 @@ ItemBase::~ItemBase() {
 		m_modelPart->removeViewItem(this);
 	}
 
-	if (m_fsvgRenderer != nullptr) {
-		delete m_fsvgRenderer;
-	}
+	FSvgRenderer::release(m_fsvgRenderer);
 
 	//m_simItem is a child of this object, it gets delated by the destructor
 	m_simItem = nullptr;
@@ -1228,10 +1255,34 @@ QVariant ItemBase::itemChange(QGraphicsItem::GraphicsItemChange change, const QV
 		}
 	}
 
+	if (change == QGraphicsItem::ItemPositionHasChanged || change == QGraphicsItem::ItemTransformHasChanged) {
+		auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+		if (fGraphicsScene != nullptr) {
+			fGraphicsScene->itemGeometryChanged(this);
+		}
+	}
+
 	return QGraphicsSvgItem::itemChange(change, value);
 }
 
+void ItemBase::busesChanged() {
+	// busConnectorItems() answers differently now, so cached nets have to be told
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->netConnectivity().busesChanged(this);
+	}
+}
+
 void ItemBase::cleanup() {
+	flushImageCache();
+}
+
+void ItemBase::flushImageCache() {
+	Q_FOREACH (ImageCacheEntry * entry, ImageCache.values()) {
+		FSvgRenderer::release(entry->renderer);
+		delete entry;
+	}
+	ImageCache.clear();
 }
 
 const QList<ItemBase *> & ItemBase::layerKin() {
@@ -1386,49 +1437,66 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 		break;
 	}
 
-	QDomDocument flipDoc;
-	getFlipDoc(modelPart, filename, layerAttributes.viewLayerID, layerAttributes.viewLayerPlacement, flipDoc, layerAttributes.orientation);
-	QByteArray bytesToLoad;
-	if (layerAttributes.viewLayerID == ViewLayer::Schematic) {
-		bytesToLoad = SvgFileSplitter::hideText(filename);
-	}
-	else if (layerAttributes.viewLayerID == ViewLayer::SchematicText) {
-		bool hasText = false;
-		bytesToLoad = SvgFileSplitter::showText(filename, hasText);
-		if (!hasText) {
-			return nullptr;
-		}
-	}
-	else if ((layerAttributes.viewID != ViewLayer::IconView) && modelPartShared->hasMultipleLayers(layerAttributes.viewID)) {
-		QString layerName = ViewLayer::viewLayerXmlNameFromID(layerAttributes.viewLayerID);
-		// need to treat create "virtual" svg file for each layer
-		SvgFileSplitter svgFileSplitter;
-		bool result;
-		if (flipDoc.isNull()) {
-			result = svgFileSplitter.split(filename, layerName);
+	QString cacheKey = imageCacheKey(modelPart, filename, layerAttributes);
+	ImageCacheEntry * entry = ImageCache.value(cacheKey, nullptr);
+	bool persist = false;
+	if (entry == nullptr) {
+		entry = new ImageCacheEntry;
+		ImageCache.insert(cacheKey, entry);
+		entry->diskKey = PartSvgCache::key(modelPart->moduleID(), filename, layerCacheKey(layerAttributes));
+		if (PartSvgCache::load(entry->diskKey, filename, entry->bytes, entry->hasText, entry->loaded, entry->renderer)) {
+			entry->rendererSaved = (entry->renderer != nullptr);
 		}
 		else {
-			QString f = flipDoc.toString();
-			result = svgFileSplitter.splitString(f, layerName);
-		}
-		if (result) {
-			bytesToLoad = svgFileSplitter.byteArray();
+			persist = true;
+			QDomDocument flipDoc;
+			getFlipDoc(modelPart, filename, layerAttributes.viewLayerID, layerAttributes.viewLayerPlacement, flipDoc, layerAttributes.orientation);
+			if (layerAttributes.viewLayerID == ViewLayer::Schematic) {
+				entry->bytes = SvgFileSplitter::hideText(filename);
+			}
+			else if (layerAttributes.viewLayerID == ViewLayer::SchematicText) {
+				entry->hasText = false;
+				entry->bytes = SvgFileSplitter::showText(filename, entry->hasText);
+			}
+			else if ((layerAttributes.viewID != ViewLayer::IconView) && modelPartShared->hasMultipleLayers(layerAttributes.viewID)) {
+				QString layerName = ViewLayer::viewLayerXmlNameFromID(layerAttributes.viewLayerID);
+				// need to treat create "virtual" svg file for each layer
+				SvgFileSplitter svgFileSplitter;
+				bool result;
+				if (flipDoc.isNull()) {
+					result = svgFileSplitter.split(filename, layerName);
+				}
+				else {
+					QString f = flipDoc.toString();
+					result = svgFileSplitter.splitString(f, layerName);
+				}
+				if (result) {
+					entry->bytes = svgFileSplitter.byteArray();
+				}
+			}
+			else {
+				// only one layer, just load it directly
+				if (flipDoc.isNull()) {
+					QFile file(filename);
+					file.open(QFile::ReadOnly);
+					entry->bytes = file.readAll();
+				}
+				else {
+					entry->bytes = flipDoc.toByteArray();
+				}
+			}
+			if (!entry->hasText) {
+				PartSvgCache::save(entry->diskKey, entry->bytes, entry->hasText, QByteArray(), nullptr);
+			}
 		}
 	}
-	else {
-		// only one layer, just load it directly
-		if (flipDoc.isNull()) {
-			QFile file(filename);
-			file.open(QFile::ReadOnly);
-			bytesToLoad = file.readAll();
-		}
-		else {
-			bytesToLoad = flipDoc.toByteArray();
-		}
+
+	if (!entry->hasText) {
+		return nullptr;
 	}
 
-	auto * newRenderer = new FSvgRenderer();
-	QByteArray resultBytes;
+	QByteArray bytesToLoad = entry->bytes;
+	bool modified = false;
 	if (!bytesToLoad.isEmpty()) {
 		if (makeLocalModifications(bytesToLoad, filename)) {
 			if (layerAttributes.viewLayerID == ViewLayer::Schematic) {
@@ -1439,7 +1507,28 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 				bytesToLoad = SvgFileSplitter::showText2(bytesToLoad, hasText);
 			}
 		}
+		// makeLocalModifications doesn't always report a change, so compare
+		modified = (bytesToLoad != entry->bytes);
+	}
 
+	if (persist && modified) {
+		// no shareable renderer to save yet; keep the preprocessed bytes for next time
+		PartSvgCache::save(entry->diskKey, entry->bytes, entry->hasText, QByteArray(), nullptr);
+	}
+
+	if (!modified && entry->renderer != nullptr) {
+		// an unmodified instance of a part already on screen: share its renderer and connector info
+		layerAttributes.setLoaded(entry->loaded);
+		layerAttributes.setFilename(entry->renderer->filename());
+		if (layerAttributes.createShape) {
+			createShape(layerAttributes);
+		}
+		return entry->renderer->retain();
+	}
+
+	auto * newRenderer = new FSvgRenderer();
+	QByteArray resultBytes;
+	if (!bytesToLoad.isEmpty()) {
 		loadInfo.filename = filename;
 		resultBytes = newRenderer->loadSvg(bytesToLoad, loadInfo);
 	}
@@ -1458,6 +1547,16 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 	//DebugDialog::debug(QString("set up image elapsed (3) %1").arg(t.elapsed()) );
 
 	if (newRenderer != nullptr) {
+		if (!modified) {
+			// whichever unmodified instance creates the shared renderer saves it, even if an earlier,
+			// locally modified instance is the one that preprocessed the svg
+			entry->renderer = newRenderer->share(resultBytes);
+			entry->loaded = resultBytes;
+			if (!entry->rendererSaved) {
+				PartSvgCache::save(entry->diskKey, entry->bytes, entry->hasText, resultBytes, newRenderer);
+				entry->rendererSaved = true;
+			}
+		}
 		layerAttributes.setFilename(newRenderer->filename());
 		if (layerAttributes.createShape) {
 			createShape(layerAttributes);
@@ -2144,7 +2243,7 @@ FSvgRenderer * ItemBase::fsvgRenderer() const {
 void ItemBase::setSharedRendererEx(FSvgRenderer * newRenderer) {
 	if (newRenderer != m_fsvgRenderer) {
 		setSharedRenderer(newRenderer);  // original renderer is deleted if it is not shared
-		if (m_fsvgRenderer != nullptr) delete m_fsvgRenderer;
+		FSvgRenderer::release(m_fsvgRenderer);
 		m_fsvgRenderer = newRenderer;
 	}
 	else {
@@ -2158,6 +2257,13 @@ bool ItemBase::reloadRenderer(const QString & svg, bool fastLoad) {
 	if (!svg.isEmpty()) {
 		//DebugDialog::debug(svg);
 		prepareGeometryChange();
+		if (m_fsvgRenderer != nullptr && m_fsvgRenderer->isShared()) {
+			// other instances of this part are drawn by the same renderer, so take a private copy before changing it
+			FSvgRenderer * renderer = m_fsvgRenderer->detach();
+			setSharedRenderer(renderer);
+			FSvgRenderer::release(m_fsvgRenderer);
+			m_fsvgRenderer = renderer;
+		}
 		bool result = fastLoad ? fsvgRenderer()->fastLoad(svg.toUtf8()) : fsvgRenderer()->loadSvgString(svg.toUtf8());
 		if (result) {
 			update();
@@ -2295,6 +2401,8 @@ void ItemBase::addSubpart(ItemBase * sub)
 	sub->debugInfo("\t");
 	m_subparts.append(sub);
 	sub->setSuperpart(this);
+	busesChanged();
+	sub->busesChanged();
 }
 
 void ItemBase::removeSubpart(ItemBase * sub)
@@ -2303,6 +2411,8 @@ void ItemBase::removeSubpart(ItemBase * sub)
 	sub->debugInfo("\t");
 	m_subparts.removeAll(sub);
 	sub->setSuperpart(nullptr);
+	busesChanged();
+	sub->busesChanged();
 }
 
 void ItemBase::setSuperpart(ItemBase * super) {
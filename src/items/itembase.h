@@ -355,6 +355,7 @@ protected:
 	virtual bool makeLocalModifications(QByteArray & svg, const QString & filename);
 	void updateHidden();
 	virtual void createShape(LayerAttributes & layerAttributes);
+	void busesChanged();
 
 protected:
 	static bool getFlipDoc(ModelPart * modelPart, const QString & filename, ViewLayer::ViewLayerID viewLayerID, ViewLayer::ViewLayerPlacement, QDomDocument &, Qt::Orientations);
@@ -418,6 +419,7 @@ public:
 public:
 	static void initNames();
 	static void cleanup();
+	static void flushImageCache();
 	static ItemBase * extractTopLevelItemBase(QGraphicsItem * thing);
 	static QString translatePropertyName(const QString & key);
 	static void setReferenceModel(ReferenceModel *);
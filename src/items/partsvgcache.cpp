@@ -0,0 +1,167 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "partsvgcache.h"
+#include "../debugdialog.h"
+#include "../fsvgrenderer.h"
+#include "../utils/folderutils.h"
+#include "../version/version.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+const quint32 PartSvgCache::Magic = 0x46535643;		// "FSVC"
+const qint32 PartSvgCache::Version = 2;				// bump whenever svg preprocessing or ConnectorInfo changes
+const qint64 PartSvgCache::MaxBytes = 256 * 1024 * 1024;
+qint64 PartSvgCache::CacheBytes = -1;				// not counted yet
+
+QString PartSvgCache::key(const QString & moduleID, const QString & filename, const QString & attributes) {
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return QString();
+
+	QByteArray hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+	return QString("%1|%2|%3").arg(moduleID, QString::fromLatin1(hash.toHex()), attributes);
+}
+
+QString PartSvgCache::cacheFolder() {
+	return FolderUtils::getTopLevelUserDataStorePath() + "/svgcache";
+}
+
+QString PartSvgCache::cachePath(const QString & key) {
+	QByteArray hash = QCryptographicHash::hash(QString("%1|%2|%3").arg(Version).arg(Version::versionString(), key).toUtf8(), QCryptographicHash::Sha1);
+	return cacheFolder() + "/" + QString::fromLatin1(hash.toHex()) + ".fsvc";
+}
+
+bool PartSvgCache::load(const QString & key, const QString & filename, QByteArray & bytes, bool & hasText, QByteArray & loaded, FSvgRenderer * & renderer) {
+	if (key.isEmpty()) return false;
+
+	QString path = cachePath(key);
+	QFile file(path);
+	if (!file.open(QFile::ReadOnly)) return false;
+
+	QDataStream stream(&file);
+	quint32 magic;
+	qint32 version;
+	QString cachedKey;
+	stream >> magic >> version >> cachedKey;
+	if (stream.status() != QDataStream::Ok || magic != Magic || version != Version || cachedKey != key) {
+		file.close();
+		file.remove();
+		return false;
+	}
+
+	QByteArray compressed;
+	bool cachedHasText;
+	bool hasRenderer;
+	stream >> cachedHasText >> compressed >> hasRenderer;
+	if (stream.status() != QDataStream::Ok) return false;
+
+	bytes = qUncompress(compressed);
+	hasText = cachedHasText;
+	touch(path);
+	if (!hasRenderer) return true;
+
+	// the renderer takes the svg's current path; the one it was saved under may be long gone
+	stream >> compressed;
+	if (stream.status() != QDataStream::Ok) return true;
+
+	QByteArray cleanContents = qUncompress(compressed);
+	auto * cached = new FSvgRenderer();
+	if (!cached->loadCached(cleanContents, filename, stream)) {
+		DebugDialog::debug(QString("unable to restore cached renderer for %1").arg(filename));
+		delete cached;
+		return true;
+	}
+
+	loaded = cleanContents;
+	renderer = cached;
+	return true;
+}
+
+void PartSvgCache::save(const QString & key, const QByteArray & bytes, bool hasText, const QByteArray & loaded, const FSvgRenderer * renderer) {
+	if (key.isEmpty()) return;
+
+	QDir().mkpath(cacheFolder());
+
+	QString path = cachePath(key);
+	QSaveFile file(path);
+	if (!file.open(QFile::WriteOnly)) return;
+
+	QDataStream stream(&file);
+	stream << Magic << Version << key;
+	stream << hasText << qCompress(bytes) << (renderer != nullptr);
+	if (renderer != nullptr) {
+		stream << qCompress(loaded);
+		renderer->saveCached(stream);
+	}
+
+	if (stream.status() != QDataStream::Ok) {
+		file.cancelWriting();
+		return;
+	}
+
+	if (!file.commit()) return;
+
+	if (CacheBytes < 0) {
+		prune();
+	}
+	else {
+		// overwriting an entry overcounts, which only makes the next prune come a little early
+		CacheBytes += QFileInfo(path).size();
+		if (CacheBytes > MaxBytes) prune();
+	}
+}
+
+void PartSvgCache::touch(const QString & path) {
+	// the modification time doubles as the last use, for prune()
+	QFile file(path);
+	if (file.open(QFile::ReadWrite)) {
+		file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+	}
+}
+
+void PartSvgCache::prune() {
+	QDir dir(cacheFolder());
+	QFileInfoList entries = dir.entryInfoList(QStringList("*.fsvc"), QDir::Files, QDir::Time | QDir::Reversed);
+	qint64 total = 0;
+	Q_FOREACH (QFileInfo entry, entries) {
+		total += entry.size();
+	}
+
+	// oldest first; leave some room so the next few saves don't prune again
+	Q_FOREACH (QFileInfo entry, entries) {
+		if (total <= MaxBytes * 3 / 4) break;
+		if (QFile::remove(entry.filePath())) {
+			total -= entry.size();
+		}
+	}
+
+	CacheBytes = total;
+}
+
+void PartSvgCache::clear() {
+	FolderUtils::rmdir(cacheFolder());
+	CacheBytes = -1;
+}
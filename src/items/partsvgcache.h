@@ -0,0 +1,59 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef PARTSVGCACHE_H
+#define PARTSVGCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+class FSvgRenderer;
+
+class PartSvgCache
+{
+	// Keeps the preprocessed svg for one view layer of a part--and, for instances without local modifications,
+	// the cleaned svg plus its parsed connector info--in the user data store, so that a later session can
+	// set up the part without parsing its svg into a DOM again.
+	// Entries are keyed by the svg's content, since parts from a .fzz are unpacked to a new folder on every open,
+	// and the least recently used ones are dropped once the folder grows past MaxBytes.
+
+public:
+	static QString key(const QString & moduleID, const QString & filename, const QString & attributes);
+	static bool load(const QString & key, const QString & filename, QByteArray & bytes, bool & hasText, QByteArray & loaded, FSvgRenderer * & renderer);
+	static void save(const QString & key, const QByteArray & bytes, bool hasText, const QByteArray & loaded, const FSvgRenderer * renderer);
+	static void clear();
+
+protected:
+	static QString cacheFolder();
+	static QString cachePath(const QString & key);
+	static void touch(const QString & path);
+	static void prune();
+
+public:
+	static const quint32 Magic;
+	static const qint32 Version;
+	static const qint64 MaxBytes;
+
+protected:
+	static qint64 CacheBytes;
+
+};
+
+#endif // PARTSVGCACHE_H
@@ -576,7 +576,7 @@ void Stripboard::reinitBuses(bool triggerUndo)
 	modelPart()->clearBuses();
 	modelPart()->initBuses();
 	modelPart()->setLocalProp("buses",  busPropertyString);
-
+	busesChanged();
 
 
 	QList<ConnectorItem *> visited2;
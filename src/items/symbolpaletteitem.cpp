@@ -268,6 +268,7 @@ void SymbolPaletteItem::setLabel(const QString & label) {
 	Q_FOREACH (ConnectorItem * connectorItem, cachedConnectorItems()) {
 		LocalNetLabels.insert(label, connectorItem);
 	}
+	busesChanged();
 
 	QTransform  transform = untransform();
 
@@ -306,6 +307,7 @@ void SymbolPaletteItem::setVoltage(double v) {
 			}
 		}
 	}
+	busesChanged();
 
 	if (m_viewID == ViewLayer::SchematicView) {
 		if (m_voltageReference || m_isNetLabel) {
@@ -183,6 +183,7 @@ TraceWire * TraceWire::getTrace(ConnectorItem * connectorItem)
 
 void TraceWire::setSchematic(bool schematic) {
 	m_viewGeometry.setSchematicTrace(schematic);
+	wireFlagsChanged();
 }
 
 bool TraceWire::stickyEnabled()
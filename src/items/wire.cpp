@@ -63,6 +63,7 @@ later:
 
 #include "../debugdialog.h"
 #include "../sketch/infographicsview.h"
+#include "../sketch/fgraphicsscene.h"
 #include "../connectors/connectoritem.h"
 #include "../connectors/svgidlayer.h"
 #include "../fsvgrenderer.h"
@@ -159,6 +160,7 @@ Wire::Wire( ModelPart * modelPart, ViewLayer::ViewID viewID,  const ViewGeometry
 	m_partLabel = initLabel ? new PartLabel(this, nullptr, nullptr) : nullptr;
 	m_canChainMultiple = false;
 	setFlag(QGraphicsItem::ItemIsSelectable, true );
+	setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);		// keeps the scene's connector index current
 	m_connectorHover = nullptr;
 	m_opacity = 1.0;
 	m_ignoreSelectionChange = false;
@@ -1206,6 +1208,7 @@ void Wire::setRouted(bool routed) {
 
 void Wire::setRatsnest(bool ratsnest) {
 	m_viewGeometry.setRatsnest(ratsnest);
+	wireFlagsChanged();
 }
 
 void Wire::setAutoroutable(bool ar) {
@@ -1218,6 +1221,7 @@ bool Wire::getAutoroutable() {
 
 void Wire::setNormal(bool normal) {
 	m_viewGeometry.setNormal(normal);
+	wireFlagsChanged();
 }
 
 bool Wire::getNormal() {
@@ -1403,6 +1407,15 @@ Wire * Wire::findTraced(ViewGeometry::WireFlags flags, QList<ConnectorItem *>  &
 
 void Wire::setWireFlags(ViewGeometry::WireFlags wireFlags) {
 	m_viewGeometry.setWireFlags(wireFlags);
+	wireFlagsChanged();
+}
+
+void Wire::wireFlagsChanged() {
+	// nets skip wires by flag, so a wire already in a scene can move connectors between nets
+	auto * fGraphicsScene = qobject_cast<FGraphicsScene *>(scene());
+	if (fGraphicsScene != nullptr) {
+		fGraphicsScene->netConnectivity().invalidate();
+	}
 }
 
 double Wire::opacity() {
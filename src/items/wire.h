@@ -208,6 +208,7 @@ protected:
 	virtual void setColorFromElement(QDomElement & element);
 	void checkVisibility(ConnectorItem * onMe, ConnectorItem * onIt, bool connect);
 	void setConnectorDimensionsAux(ConnectorItem *, double width, double height);
+	void wireFlagsChanged();
 	bool isBendpoint(ConnectorItem * connectorItem);
 	QPainterPath shapeAux(double width) const;
 	void hoverLeaveEvent( QGraphicsSceneHoverEvent * event );
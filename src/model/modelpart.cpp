@@ -61,6 +61,14 @@ ModelPart::ModelPart(QDomDocument & domDocument, const QString & path, ItemType
 	m_modelPartShared->addOwner(this);
 }
 
+ModelPart::ModelPart(ModelPartShared * modelPartShared, ItemType type)
+	: QObject()
+{
+	commonInit(type);
+	m_modelPartShared = modelPartShared;
+	m_modelPartShared->addOwner(this);
+}
+
 void ModelPart::commonInit(ItemType type) {
 	m_type = type;
 	m_locationFlags = QFlags<LocationFlag>();
@@ -458,6 +466,7 @@ void ModelPart::initBuses() {
 }
 
 const QHash<QString, QPointer<Connector> > & ModelPart::connectors() {
+	if (m_modelPartShared) m_modelPartShared->ensureHydrated();	// parts from the database get their connectors on first use
 	return m_connectorHash;
 }
 
@@ -574,14 +583,17 @@ const QHash<QString,QString> & ModelPart::properties() const {
 }
 
 Connector * ModelPart::getConnector(const QString & id) {
+	if (m_modelPartShared) m_modelPartShared->ensureHydrated();
 	return m_connectorHash.value(id);
 }
 
 const QHash<QString, QPointer<Bus> > & ModelPart::buses() {
+	if (m_modelPartShared) m_modelPartShared->ensureHydrated();
 	return  m_busHash;
 }
 
 Bus * ModelPart::bus(const QString & busID) {
+	if (m_modelPartShared) m_modelPartShared->ensureHydrated();
 	return m_busHash.value(busID);
 }
 
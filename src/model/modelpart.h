@@ -74,6 +74,7 @@ public:
 
 public:
 	ModelPart(QDomDocument &, const QString& path, ItemType type);
+	ModelPart(ModelPartShared *, ItemType type);
 	ModelPart(ItemType type = ModelPart::Unknown);
 	~ModelPart();
 
@@ -374,10 +374,12 @@ void ModelPartShared::setModuleID(QString moduleID) {
 }
 
 const QList< QPointer<ConnectorShared> > ModelPartShared::connectorsShared() {
+	ensureHydrated();
 	return m_connectorSharedHash.values();
 }
 
 void ModelPartShared::setConnectorsShared(QList< QPointer<ConnectorShared> > connectors) {
+	ensureHydrated();
 	for (auto & connector : connectors) {
 		ConnectorShared* cs = connector;
 		m_connectorSharedHash[cs->id()] = cs;
@@ -389,6 +391,7 @@ void ModelPartShared::setConnectorsInitialized(bool init) {
 }
 
 void ModelPartShared::initConnectors() {
+	ensureHydrated();
 	if (m_connectorsInitialized)
 		return;
 
@@ -453,14 +456,18 @@ void ModelPartShared::initConnectors() {
 }
 
 ConnectorShared * ModelPartShared::getConnectorShared(const QString & id) {
+	ensureHydrated();
 	return m_connectorSharedHash.value(id);
 }
 
 bool ModelPartShared::ignoreTerminalPoints() {
+	ensureHydrated();
 	return m_ignoreTerminalPoints;
 }
 
 void ModelPartShared::copy(ModelPartShared* other) {
+	ensureHydrated();
+	other->ensureHydrated();
 	setAuthor(other->author());
 	setConnectorsShared(other->connectorsShared());
 	setDate(other->date());
@@ -511,14 +518,17 @@ void ModelPartShared::setFlippedSMD(bool f) {
 }
 
 bool ModelPartShared::flippedSMD() {
+	ensureHydrated();
 	return m_flippedSMD;
 }
 
 bool ModelPartShared::needsCopper1() {
+	ensureHydrated();
 	return m_needsCopper1;
 }
 
 void ModelPartShared::connectorIDs(ViewLayer::ViewID viewID, ViewLayer::ViewLayerID viewLayerID, QStringList & connectorIDs, QStringList & terminalIDs, QStringList & legIDs) {
+	ensureHydrated();
 	Q_FOREACH (ConnectorShared * connectorShared, m_connectorSharedHash.values()) {
 		SvgIdLayer * svgIdLayer = connectorShared->fullPinInfo(viewID, viewLayerID);
 		if (svgIdLayer == nullptr) {
@@ -533,6 +543,7 @@ void ModelPartShared::connectorIDs(ViewLayer::ViewID viewID, ViewLayer::ViewLaye
 }
 
 void ModelPartShared::flipSMDAnd() {
+	ensureHydrated();
 	if (this->path().startsWith(ResourcePath)) {
 		// assume resources are set up exactly as intended
 		//DebugDialog::debug(QString("skip flip %1").arg(path()));
@@ -609,6 +620,7 @@ void ModelPartShared::flipSMDAnd() {
 }
 
 bool ModelPartShared::hasViewFor(ViewLayer::ViewID viewID) const {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID, NULL);
 	if (viewImage == nullptr) return false;
 
@@ -616,6 +628,7 @@ bool ModelPartShared::hasViewFor(ViewLayer::ViewID viewID) const {
 }
 
 bool ModelPartShared::hasViewFor(ViewLayer::ViewID viewID, ViewLayer::ViewLayerID viewLayerID) const {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID, NULL);
 	if (viewImage == nullptr) return false;
 
@@ -624,6 +637,7 @@ bool ModelPartShared::hasViewFor(ViewLayer::ViewID viewID, ViewLayer::ViewLayerI
 }
 
 QString ModelPartShared::hasBaseNameFor(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID, NULL);
 	if (viewImage == nullptr) return "";
 
@@ -660,6 +674,7 @@ void ModelPartShared::setFritzingVersion(const QString & fv) {
 }
 
 void ModelPartShared::setViewImage(ViewImage * viewImage) {
+	ensureHydrated();
 	ViewImage * old = m_viewImages.value(viewImage->viewID);
 	if (old) delete old;
 	m_viewImages.insert(viewImage->viewID, viewImage);
@@ -668,10 +683,12 @@ void ModelPartShared::setViewImage(ViewImage * viewImage) {
 }
 
 const QList<ViewImage *> ModelPartShared::viewImages() {
+	ensureHydrated();
 	return m_viewImages.values();
 }
 
 QString ModelPartShared::imageFileName(ViewLayer::ViewID viewID, ViewLayer::ViewLayerID viewLayerID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return "";
 
@@ -684,6 +701,7 @@ QString ModelPartShared::imageFileName(ViewLayer::ViewID viewID, ViewLayer::View
 }
 
 QString ModelPartShared::imageFileName(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return "";
 
@@ -691,6 +709,7 @@ QString ModelPartShared::imageFileName(ViewLayer::ViewID viewID) {
 }
 
 void ModelPartShared::setImageFileName(ViewLayer::ViewID viewID, const QString & filename) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return;
 
@@ -698,6 +717,7 @@ void ModelPartShared::setImageFileName(ViewLayer::ViewID viewID, const QString &
 }
 
 bool ModelPartShared::hasViewID(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return false;
 
@@ -705,6 +725,7 @@ bool ModelPartShared::hasViewID(ViewLayer::ViewID viewID) {
 }
 
 bool ModelPartShared::hasMultipleLayers(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return false;
 
@@ -731,6 +752,7 @@ LayerList ModelPartShared::viewLayers(ViewLayer::ViewID viewID) const {
 }
 
 LayerList ModelPartShared::viewLayersAux(ViewLayer::ViewID viewID, qulonglong (*accessor)(ViewImage *)) const {
+	ensureHydrated();
 
 	static QHash<qulonglong, ViewLayer::ViewLayerID> ToLayerIDs;
 
@@ -761,6 +783,7 @@ LayerList ModelPartShared::viewLayersAux(ViewLayer::ViewID viewID, qulonglong (*
 
 
 bool ModelPartShared::canFlipHorizontal(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return false;
 
@@ -768,6 +791,7 @@ bool ModelPartShared::canFlipHorizontal(ViewLayer::ViewID viewID) {
 }
 
 bool ModelPartShared::canFlipVertical(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return false;
 
@@ -775,6 +799,7 @@ bool ModelPartShared::canFlipVertical(ViewLayer::ViewID viewID) {
 }
 
 bool ModelPartShared::anySticky(ViewLayer::ViewID viewID) {
+	ensureHydrated();
 	ViewImage * viewImage = m_viewImages.value(viewID);
 	if (viewImage == nullptr) return false;
 
@@ -783,6 +808,7 @@ bool ModelPartShared::anySticky(ViewLayer::ViewID viewID) {
 
 void ModelPartShared::addConnector(ConnectorShared * connectorShared)
 {
+	ensureHydrated();
 	m_connectorSharedHash.insert(connectorShared->id(), connectorShared);
 }
 
@@ -807,6 +833,7 @@ void ModelPartShared::copyPins(ViewLayer::ViewLayerID from, ViewLayer::ViewLayer
 }
 
 void ModelPartShared::insertBus(BusShared * busShared) {
+	ensureHydrated();
 	m_buses.insert(busShared->id(), busShared);
 }
 
@@ -877,3 +904,22 @@ QPointF ModelPartShared::subpartOffset() const {
 void ModelPartShared::setSubpartOffset(QPointF p) {
 	m_subpartOffset = p;
 }
+
+void ModelPartShared::setLoader(ModelPartSharedLoader * loader, qulonglong key) {
+	m_loader = loader;
+	m_loaderKey = key;
+}
+
+bool ModelPartShared::isHydrated() const {
+	return m_loader == nullptr;
+}
+
+void ModelPartShared::ensureHydrated() const {
+	if (m_loader == nullptr) return;
+
+	// clear the loader first: it fills this object in through the same accessors that call ensureHydrated()
+	auto * self = const_cast<ModelPartShared *>(this);
+	ModelPartSharedLoader * loader = m_loader;
+	self->m_loader = nullptr;
+	loader->hydrate(self, m_loaderKey);
+}
@@ -43,6 +43,15 @@ struct ViewImage {
 	ViewImage(ViewLayer::ViewID);
 };
 
+class ModelPartSharedLoader
+{
+	// Fills in the connectors, buses and view images of a ModelPartShared the first time any of them is needed.
+	// Only called from the gui thread.
+public:
+	virtual ~ModelPartSharedLoader() = default;
+	virtual void hydrate(class ModelPartShared *, qulonglong key) = 0;
+};
+
 class ModelPartShared : public QObject
 {
 	Q_OBJECT
@@ -147,6 +156,9 @@ public:
 	void addOwner(QObject *);
 	void setSubpartOffset(QPointF);
 	QPointF subpartOffset() const;
+	void setLoader(ModelPartSharedLoader *, qulonglong key);
+	bool isHydrated() const;
+	void ensureHydrated() const;
 
 protected:
 	void loadTagText(QDomElement parent, QString tagName, QString &field);
@@ -208,6 +220,8 @@ protected:
 	QPointer<ModelPartShared> m_superpart;
 	QString m_subpartID;
 	QPointF m_subpartOffset;
+	ModelPartSharedLoader * m_loader = nullptr;
+	qulonglong m_loaderKey = 0;
 };
 
 class ModelPartSharedRoot : public ModelPartShared
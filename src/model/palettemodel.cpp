@@ -24,6 +24,11 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QApplication>
 #include <QDir>
 #include <QDomElement>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrentRun>
 
 #include "modelpart.h"
 #include "../utils/folderutils.h"
@@ -76,6 +81,7 @@ PaletteModel::~PaletteModel()
 	Q_FOREACH (ModelPart * modelPart, m_partHash.values()) {
 		delete modelPart;
 	}
+	delete m_searchIndex;
 }
 
 void PaletteModel::initParts(bool dbExists) {
@@ -108,91 +114,115 @@ void PaletteModel::loadParts(bool dbExists) {
 	QStringList nameFilters;
 	nameFilters << "*" + FritzingPartExtension;
 
-	int totalPartCount = 0;
-	Q_EMIT loadedPart(0, totalPartCount);
+	Q_EMIT loadedPart(0, 0);
 
 	QDir dir1 = FolderUtils::getAppPartsSubFolder("");
 	QDir dir2(FolderUtils::getUserPartsPath());
 	QDir dir3(":/resources/parts");
 	QDir dir4(s_fzpOverrideFolder);
 
+	// a single scan gives both the total for the progress bar and the list to load
+	QList<FzpFile> fzpFiles;
 	if (m_fullLoad || !dbExists) {
 		// otherwise these will already be in the database
-		countParts(dir1, nameFilters, totalPartCount);
-		countParts(dir3, nameFilters, totalPartCount);
+		collectParts(dir1, nameFilters, fzpFiles, false);
+		collectParts(dir3, nameFilters, fzpFiles, false);
 	}
 
 	if (!m_fullLoad) {
 		// don't include local parts when doing full load
-		countParts(dir2, nameFilters, totalPartCount);
+		collectParts(dir2, nameFilters, fzpFiles, false);
 		if (!s_fzpOverrideFolder.isEmpty()) {
-			countParts(dir4, nameFilters, totalPartCount);
+			collectParts(dir4, nameFilters, fzpFiles, false);
 		}
 	}
 
-	Q_EMIT partsToLoad(totalPartCount);
+	Q_EMIT partsToLoad(fzpFiles.count());
 
-	int loadingPart = 0;
-	if (m_fullLoad || !dbExists) {
-		// otherwise these will already be in the database
-		loadPartsAux(dir1, nameFilters, loadingPart, totalPartCount);
-		loadPartsAux(dir3, nameFilters, loadingPart, totalPartCount);
-	}
-
-	if (!m_fullLoad) {
-		loadPartsAux(dir2, nameFilters, loadingPart, totalPartCount);
-		if (!s_fzpOverrideFolder.isEmpty()) {
-			loadPartsAux(dir4, nameFilters, loadingPart, totalPartCount);
-		}
-	}
+	loadFzpFiles(fzpFiles);
 }
 
-void PaletteModel::countParts(QDir & dir, QStringList & nameFilters, int & partCount) {
-	QStringList list = dir.entryList(nameFilters, QDir::Files | QDir::NoSymLinks);
-	partCount += list.size();
+void PaletteModel::collectParts(QDir & dir, QStringList & nameFilters, QList<FzpFile> & fzpFiles, bool contrib) {
+	QFileInfoList list = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
+	for (auto fileInfo : list) {
+		FzpFile fzpFile;
+		fzpFile.path = fileInfo.absoluteFilePath();
+		fzpFile.contrib = contrib;
+		fzpFiles.append(fzpFile);
+	}
 
 	QStringList dirs = dir.entryList(QDir::AllDirs | QDir::NoSymLinks | QDir::NoDotAndDotDot);
 	for (int i = 0; i < dirs.size(); ++i) {
 		QString temp2 = dirs[i];
 		dir.cd(temp2);
 
-		countParts(dir, nameFilters, partCount);
+		collectParts(dir, nameFilters, fzpFiles, temp2 == "contrib");
 		dir.cdUp();
 	}
 }
 
-void PaletteModel::loadPartsAux(QDir & dir, QStringList & nameFilters, int & loadingPart, int totalPartCount) {
-	//QString temp = dir.absolutePath();
-	QFileInfoList list = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
-	for (auto fileInfo : list) {
-			QString path = fileInfo.absoluteFilePath ();
-		//DebugDialog::debug(QString("part path:%1 core? %2").arg(path).arg(m_loadingCore? "true" : "false"));
-		PaletteModel::loadPart(path, false);
-		Q_EMIT loadedPart(++loadingPart, totalPartCount);
-		//DebugDialog::debug("loadedok");
+void PaletteModel::loadFzpFiles(QList<FzpFile> & fzpFiles) {
+	// The fzp files are parsed on worker threads. They are merged into m_partHash and the tree here,
+	// in scan order, so duplicate module ids resolve exactly as when parts were loaded one at a time.
+	int total = fzpFiles.count();
+	if (total == 0) return;
+
+	FzpFile * files = fzpFiles.data();
+	QVector<bool> parsed(total, false);
+	QMutex mutex;
+	QWaitCondition parsedOne;
+	QAtomicInt next(0);
+
+	int workerCount = qMax(1, qMin(QThread::idealThreadCount(), total));
+	QList< QFuture<void> > futures;
+	for (int i = 0; i < workerCount; i++) {
+		futures << QtConcurrent::run([files, total, &next, &parsed, &mutex, &parsedOne]() {
+			while (true) {
+				int index = next.fetchAndAddRelaxed(1);
+				if (index >= total) break;
+
+				parseFzp(files[index]);
+				QMutexLocker locker(&mutex);
+				parsed[index] = true;
+				parsedOne.wakeAll();
+			}
+		});
 	}
 
-	QStringList dirs = dir.entryList(QDir::AllDirs | QDir::NoSymLinks | QDir::NoDotAndDotDot);
-	for (int i = 0; i < dirs.size(); ++i) {
-		QString temp2 = dirs[i];
-		dir.cd(temp2);
+	for (int i = 0; i < total; i++) {
+		mutex.lock();
+		while (!parsed.at(i)) {
+			parsedOne.wait(&mutex);
+		}
+		mutex.unlock();
 
-		m_loadingContrib = (temp2 == "contrib");
+		//DebugDialog::debug(QString("part path:%1 contrib? %2").arg(files[i].path).arg(files[i].contrib ? "true" : "false"));
+		addFzp(files[i], false);
+		files[i].domDocument.clear();
+		Q_EMIT loadedPart(i + 1, total);
+	}
 
-		loadPartsAux(dir, nameFilters, loadingPart, totalPartCount);
-		dir.cdUp();
+	Q_FOREACH (QFuture<void> future, futures) {
+		future.waitForFinished();
 	}
 }
 
 ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
+	FzpFile fzpFile;
+	fzpFile.path = path;
+	fzpFile.contrib = m_loadingContrib;
+	parseFzp(fzpFile);
+	return addFzp(fzpFile, update);
+}
+
+bool PaletteModel::parseFzp(FzpFile & fzpFile) {
+	// safe to call from a worker thread: no message boxes and no shared state;
+	// the ModelPartShared is handed over to the gui thread before returning
 
-	QFile file(path);
+	QFile file(fzpFile.path);
 	if (!file.open(QFile::ReadOnly | QFile::Text)) {
-		FMessageBox::warning(nullptr, QObject::tr("Fritzing"),
-		                     QObject::tr("Cannot read file %1:\n%2.")
-		                     .arg(path)
-		                     .arg(file.errorString()));
-		return nullptr;
+		fzpFile.readError = file.errorString();
+		return false;
 	}
 
 	//DebugDialog::debug(QString("loading %2 %1").arg(path).arg(QTime::currentTime().toString("HH:mm:ss.zzz")));
@@ -205,32 +235,31 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 	QString errorStr;
 	int errorLine;
 	int errorColumn;
-	QDomDocument domDocument;
+	QDomDocument & domDocument = fzpFile.domDocument;
 	if (!domDocument.setContent(&file, true, &errorStr, &errorLine, &errorColumn)) {
-		FMessageBox::information(nullptr, QObject::tr("Fritzing"),
-		                         QObject::tr("Parse error (2) at line %1, column %2:\n%3\n%4")
-		                         .arg(errorLine)
-		                         .arg(errorColumn)
-		                         .arg(errorStr)
-		                         .arg(path));
-		return nullptr;
+		fzpFile.parseError = QObject::tr("Parse error (2) at line %1, column %2:\n%3\n%4")
+		                     .arg(errorLine)
+		                     .arg(errorColumn)
+		                     .arg(errorStr)
+		                     .arg(fzpFile.path);
+		return false;
 	}
 
 	QDomElement root = domDocument.documentElement();
 	if (root.isNull()) {
 		//QMessageBox::information(NULL, QObject::tr("Fritzing"), QObject::tr("The file is not a Fritzing file (8)."));
-		return nullptr;
+		return false;
 	}
 
 	if (root.tagName() != "module") {
 		//QMessageBox::information(NULL, QObject::tr("Fritzing"), QObject::tr("The file is not a Fritzing file (9)."));
-		return nullptr;
+		return false;
 	}
 
 	moduleID = root.attribute("moduleId");
 	if (moduleID.isNull() || moduleID.isEmpty()) {
 		//QMessageBox::information(NULL, QObject::tr("Fritzing"), QObject::tr("The file is not a Fritzing file (10)."));
-		return nullptr;
+		return false;
 	}
 
 	// check if it's a wire
@@ -306,8 +335,40 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 		}
 	}
 
-	auto * modelPart = new ModelPart(domDocument, path, type);
-	if (!modelPart) return nullptr;
+	fzpFile.type = type;
+	fzpFile.modelPartShared = new ModelPartShared(domDocument, fzpFile.path);
+	if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+		fzpFile.modelPartShared->moveToThread(QCoreApplication::instance()->thread());
+	}
+
+	if (root.firstChildElement("schematic-subparts").isNull()) {
+		// only subparts need the document after this
+		domDocument.clear();
+	}
+
+	return true;
+}
+
+ModelPart * PaletteModel::addFzp(FzpFile & fzpFile, bool update) {
+	const QString & path = fzpFile.path;
+	if (!fzpFile.readError.isEmpty()) {
+		FMessageBox::warning(nullptr, QObject::tr("Fritzing"),
+		                     QObject::tr("Cannot read file %1:\n%2.")
+		                     .arg(path)
+		                     .arg(fzpFile.readError));
+		return nullptr;
+	}
+
+	if (!fzpFile.parseError.isEmpty()) {
+		FMessageBox::information(nullptr, QObject::tr("Fritzing"), fzpFile.parseError);
+		return nullptr;
+	}
+
+	if (fzpFile.modelPartShared == nullptr) return nullptr;
+
+	auto * modelPart = new ModelPart(fzpFile.modelPartShared, fzpFile.type);
+	fzpFile.modelPartShared = nullptr;
+	QString moduleID = modelPart->moduleID();
 
 	if (path.startsWith(ResourcePath)) {
 		modelPart->setCore(true);
@@ -317,12 +378,12 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 		modelPart->setCore(true);
 	}
 
-	modelPart->setContrib(m_loadingContrib);
+	modelPart->setContrib(fzpFile.contrib);
 
-	QDomElement subparts = root.firstChildElement("schematic-subparts");
+	QDomElement subparts = fzpFile.domDocument.documentElement().firstChildElement("schematic-subparts");
 	QDomElement subpart = subparts.firstChildElement("subpart");
 	while (!subpart.isNull()) {
-		ModelPart * subModelPart = makeSubpart(modelPart, subpart.attribute("id"), domDocument);
+		ModelPart * subModelPart = makeSubpart(modelPart, subpart.attribute("id"), fzpFile.domDocument);
 		m_partHash.insert(subModelPart->moduleID(), subModelPart);
 		subpart = subpart.nextSiblingElement("subpart");
 	}
@@ -348,6 +409,7 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 	else {
 		modelPart->setParent(m_root);
 	}
+	indexPart(modelPart);
 
 	return modelPart;
 }
@@ -411,6 +473,7 @@ void PaletteModel::removePart(const QString &moduleID) {
 	}
 	//DebugDialog::debug(QString("part hash count %1").arg(m_partHash.count()));
 	m_partHash.remove(moduleID);
+	if (m_searchIndex) m_searchIndex->remove(moduleID);
 	//DebugDialog::debug(QString("part hash count %1").arg(m_partHash.count()));
 }
 
@@ -426,6 +489,7 @@ void PaletteModel::removeParts() {
 	Q_FOREACH(ModelPart * modelPart, modelParts) {
 		modelPart->setParent(nullptr);
 		m_partHash.remove(modelPart->moduleID());
+		if (m_searchIndex) m_searchIndex->remove(modelPart->moduleID());
 		delete modelPart;
 	}
 }
@@ -441,6 +505,7 @@ void PaletteModel::clearPartHash() {
 		delete modelPart;
 	}
 	m_partHash.clear();
+	clearSearchIndex();
 }
 
 void PaletteModel::setOrdererChildren(QList<QObject*> children) {
@@ -448,17 +513,66 @@ void PaletteModel::setOrdererChildren(QList<QObject*> children) {
 }
 
 QList<ModelPart *> PaletteModel::search(const QString & searchText, bool allowObsolete) {
-	QList<ModelPart *> modelParts;
+	if (m_searchIndex == nullptr) {
+		m_searchIndex = new PartSearchIndex;
+		if (m_root) buildSearchIndex(m_root);
+	}
 
+	QList<ModelPart *> modelParts;
 	QStringList strings = searchText.split(" ");
-	search(m_root, strings, modelParts, allowObsolete);
+	Q_FOREACH (QString moduleID, m_searchIndex->search(strings)) {
+		ModelPart * modelPart = m_partHash.value(moduleID, nullptr);
+		if (modelPart == nullptr) continue;
+		if (!allowObsolete && modelPart->isObsolete()) continue;
+
+		modelParts.append(modelPart);
+	}
+
+	Q_EMIT addSearchMaximum(modelParts.count());
 	return modelParts;
 }
 
+void PaletteModel::buildSearchIndex(ModelPart * modelPart) {
+	indexPart(modelPart);
+	Q_FOREACH (QObject * child, modelPart->children()) {
+		auto * mp = qobject_cast<ModelPart *>(child);
+		if (mp == nullptr) continue;
+
+		buildSearchIndex(mp);
+	}
+}
+
+void PaletteModel::indexPart(ModelPart * modelPart) {
+	if (m_searchIndex == nullptr) return;
+
+	QString moduleID = modelPart->moduleID();
+	if (moduleID.isEmpty()) return;
+
+	// the same fields search(ModelPart *, ...) looks at
+	m_searchIndex->remove(moduleID);
+	m_searchIndex->insert(moduleID, modelPart->title(), PartSearchIndex::TitleWeight);
+	m_searchIndex->insert(moduleID, modelPart->description(), PartSearchIndex::DescriptionWeight);
+	m_searchIndex->insert(moduleID, modelPart->url(), PartSearchIndex::UrlWeight);
+	m_searchIndex->insert(moduleID, modelPart->author(), PartSearchIndex::AuthorWeight);
+	m_searchIndex->insert(moduleID, moduleID, PartSearchIndex::ModuleIDWeight);
+	Q_FOREACH (QString tag, modelPart->tags()) {
+		m_searchIndex->insert(moduleID, tag, PartSearchIndex::TagWeight);
+	}
+	const QHash<QString, QString> & properties = modelPart->properties();
+	for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+		m_searchIndex->insert(moduleID, it.key(), PartSearchIndex::PropertyWeight);
+		m_searchIndex->insert(moduleID, it.value(), PartSearchIndex::PropertyWeight);
+	}
+}
+
+void PaletteModel::clearSearchIndex() {
+	// rebuilt from the tree on the next search
+	delete m_searchIndex;
+	m_searchIndex = nullptr;
+}
+
 void PaletteModel::search(ModelPart * modelPart, const QStringList & searchStrings, QList<ModelPart *> & modelParts, bool allowObsolete) {
-	// TODO: eventually move all this into the database?
-	// or use lucene
-	// or google search api
+	// walks a single part and its children; searching the whole library goes through m_searchIndex
 
 	int count = 0;
 	Q_FOREACH (QString searchString, searchStrings) {
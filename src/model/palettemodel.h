@@ -23,6 +23,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "modelpart.h"
 #include "modelbase.h"
+#include "partsearchindex.h"
 
 #include <QDomDocument>
 #include <QList>
@@ -30,6 +31,17 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStringList>
 #include <QHash>
 
+struct FzpFile {
+	// one .fzp on its way from the parts folders into the model; filled in by PaletteModel::parseFzp
+	QString path;
+	bool contrib = false;
+	QDomDocument domDocument;
+	ModelPart::ItemType type = ModelPart::Part;
+	ModelPartShared * modelPartShared = nullptr;
+	QString readError;
+	QString parseError;
+};
+
 class PaletteModel : public ModelBase
 {
 	Q_OBJECT
@@ -62,6 +74,7 @@ protected:
 
 	bool m_loadingContrib;
 	bool m_fullLoad;
+	PartSearchIndex * m_searchIndex = nullptr;		// built on the first search
 
 Q_SIGNALS:
 	void loadedPart(int i, int total);
@@ -72,8 +85,12 @@ Q_SIGNALS:
 protected:
 	virtual void initParts(bool dbExists);
 	void loadParts(bool dbExists);
-	void loadPartsAux(QDir & dir, QStringList & nameFilters, int & loadedPart, int totalParts);
-	void countParts(QDir & dir, QStringList & nameFilters, int & partCount);
+	void loadFzpFiles(QList<FzpFile> & fzpFiles);
+	void collectParts(QDir & dir, QStringList & nameFilters, QList<FzpFile> & fzpFiles, bool contrib);
+	ModelPart * addFzp(FzpFile &, bool update);
+	void buildSearchIndex(ModelPart *);
+	void indexPart(ModelPart *);
+	void clearSearchIndex();
 	ModelPart * makeSubpart(ModelPart * originalModelPart, const QString & newSubID, const QDomDocument & superpartDoc);
 
 public:
@@ -81,6 +98,7 @@ public:
 	static QDomDocument makeSubpartDoc(const QString & newSubID, const QDomDocument & superpartDoc);
 	static void initNames();
 	static void setFzpOverrideFolder(const QString &);
+	static bool parseFzp(FzpFile &);
 
 protected:
 	static QString s_fzpOverrideFolder;
@@ -0,0 +1,200 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "partsearchindex.h"
+
+#include <algorithm>
+
+void PartSearchIndex::insert(const QString & key, const QString & text, int weight) {
+	if (key.isEmpty()) return;
+
+	int slot = slotFor(key);
+	Q_FOREACH (QString word, words(text)) {
+		QHash<int, int> & postings = m_words[word];
+		auto it = postings.find(slot);
+		if (it == postings.end()) {
+			postings.insert(slot, weight);
+			m_slotWords[slot].append(word);
+		}
+		else if (it.value() < weight) {
+			it.value() = weight;
+		}
+	}
+}
+
+void PartSearchIndex::remove(const QString & key) {
+	int slot = m_slots.value(key, -1);
+	if (slot < 0) return;
+
+	Q_FOREACH (QString word, m_slotWords.at(slot)) {
+		auto it = m_words.find(word);
+		if (it == m_words.end()) continue;
+
+		it.value().remove(slot);
+		if (it.value().isEmpty()) {
+			m_words.erase(it);
+		}
+	}
+
+	m_slotWords[slot].clear();
+	m_keys[slot].clear();
+	m_slots.remove(key);
+	m_freeSlots.append(slot);
+}
+
+void PartSearchIndex::clear() {
+	m_slots.clear();
+	m_keys.clear();
+	m_freeSlots.clear();
+	m_slotWords.clear();
+	m_words.clear();
+}
+
+bool PartSearchIndex::contains(const QString & key) const {
+	return m_slots.contains(key);
+}
+
+int PartSearchIndex::count() const {
+	return m_slots.count();
+}
+
+QStringList PartSearchIndex::search(const QStringList & searchStrings) const {
+	// every term has to match somewhere in a part, as before; a part scores the sum over terms
+	// of its best match: an exact word beats a prefix, which beats a substring, weighted by field
+
+	QHash<int, int> scores;
+	bool first = true;
+	Q_FOREACH (QString searchString, searchStrings) {
+		QString term = searchString.toCaseFolded();
+		if (term.isEmpty()) continue;				// contains("") is always true
+
+		QHash<int, int> termScores;
+		auto addHits = [&termScores](const QHash<int, int> & postings, int quality) {
+			for (auto it = postings.constBegin(); it != postings.constEnd(); ++it) {
+				int score = quality * it.value();
+				auto found = termScores.find(it.key());
+				if (found == termScores.end()) {
+					termScores.insert(it.key(), score);
+				}
+				else if (found.value() < score) {
+					found.value() = score;
+				}
+			}
+		};
+
+		// words starting with the term are contiguous in the map
+		auto prefixEnd = m_words.constEnd();
+		for (auto it = m_words.lowerBound(term); it != m_words.constEnd(); ++it) {
+			if (!it.key().startsWith(term)) {
+				prefixEnd = it;
+				break;
+			}
+			addHits(it.value(), it.key().length() == term.length() ? 4 : 2);
+		}
+		auto prefixBegin = m_words.lowerBound(term);
+		for (auto it = m_words.constBegin(); it != m_words.constEnd(); ++it) {
+			if (it == prefixBegin) {
+				it = prefixEnd;
+				if (it == m_words.constEnd()) break;
+			}
+			if (it.key().contains(term)) {
+				addHits(it.value(), 1);
+			}
+		}
+
+		if (first) {
+			scores = termScores;
+			first = false;
+		}
+		else {
+			for (auto it = scores.begin(); it != scores.end(); ) {
+				int score = termScores.value(it.key(), 0);
+				if (score == 0) {
+					it = scores.erase(it);
+				}
+				else {
+					it.value() += score;
+					++it;
+				}
+			}
+		}
+
+		if (scores.isEmpty()) return QStringList();
+	}
+
+	if (first) {
+		// no real terms: everything matches
+		for (auto it = m_slots.constBegin(); it != m_slots.constEnd(); ++it) {
+			scores.insert(it.value(), 0);
+		}
+	}
+
+	QList<int> slots = scores.keys();
+	std::sort(slots.begin(), slots.end(), [&scores](int a, int b) {
+		int sa = scores.value(a);
+		int sb = scores.value(b);
+		if (sa != sb) return sa > sb;
+		return a < b;
+	});
+
+	QStringList keys;
+	keys.reserve(slots.count());
+	Q_FOREACH (int slot, slots) {
+		keys << m_keys.at(slot);
+	}
+	return keys;
+}
+
+QStringList PartSearchIndex::words(const QString & text) {
+	// split on whitespace only, so a term with punctuation in it ("1/4w", "tip120-") still lands inside one word
+	QStringList result;
+	QString folded = text.toCaseFolded();
+	int start = -1;
+	for (int i = 0; i <= folded.length(); i++) {
+		bool space = (i == folded.length()) || folded.at(i).isSpace();
+		if (space) {
+			if (start >= 0) {
+				result << folded.mid(start, i - start);
+				start = -1;
+			}
+		}
+		else if (start < 0) {
+			start = i;
+		}
+	}
+	return result;
+}
+
+int PartSearchIndex::slotFor(const QString & key) {
+	int slot = m_slots.value(key, -1);
+	if (slot >= 0) return slot;
+
+	if (m_freeSlots.isEmpty()) {
+		slot = m_keys.count();
+		m_keys.append(key);
+		m_slotWords.append(QStringList());
+	}
+	else {
+		slot = m_freeSlots.takeLast();
+		m_keys[slot] = key;
+	}
+	m_slots.insert(key, slot);
+	return slot;
+}
@@ -0,0 +1,70 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef PARTSEARCHINDEX_H
+#define PARTSEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+class PartSearchIndex
+{
+	// Inverted index from case-folded words to the parts whose text contains them.
+	// A search term has no spaces, so any part text that contains it contains it inside a single word:
+	// matching terms against the word list gives the same hits as running contains() over every field,
+	// while only touching each distinct word once.
+
+public:
+	enum Weight {
+		DescriptionWeight = 1,
+		UrlWeight = 1,
+		AuthorWeight = 2,
+		PropertyWeight = 3,
+		ModuleIDWeight = 3,
+		TagWeight = 5,
+		TitleWeight = 8
+	};
+
+public:
+	void insert(const QString & key, const QString & text, int weight);
+	void remove(const QString & key);
+	void clear();
+	bool contains(const QString & key) const;
+	int count() const;
+	QStringList search(const QStringList & searchStrings) const;
+
+public:
+	static QStringList words(const QString & text);
+
+protected:
+	int slotFor(const QString & key);
+
+protected:
+	QHash<QString, int> m_slots;
+	QStringList m_keys;								// indexed by slot; empty when the slot is free
+	QList<int> m_freeSlots;
+	QVector<QStringList> m_slotWords;				// so a key can be removed without a scan
+	QMap<QString, QHash<int, int> > m_words;		// word -> slot -> best weight; sorted, so prefixes are adjacent
+};
+
+#endif
@@ -52,6 +52,7 @@ public:
 	virtual void setSha(const QString & sha) = 0;
 	virtual const QString & sha() const = 0;
 	virtual const QString error() const = 0;
+	virtual void closePartsDatabase() = 0;
 };
 
 #endif /* REFERENCEMODEL_H_ */
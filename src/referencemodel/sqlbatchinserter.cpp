@@ -0,0 +1,135 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "sqlbatchinserter.h"
+#include "../debugdialog.h"
+
+#include <QSqlError>
+
+// SQLite's default SQLITE_MAX_VARIABLE_NUMBER is 999 before 3.32
+static const int MaxVariables = 999;
+
+SqlBatchInserter::SqlBatchInserter(QSqlDatabase & db, const QString & table, const QStringList & columns, const QStringList & required)
+	: m_database(db)
+	, m_table(table)
+	, m_columns(columns)
+	, m_batchQuery(db)
+{
+	Q_FOREACH (QString column, required) {
+		int ix = columns.indexOf(column);
+		if (ix >= 0) m_required.append(ix);
+	}
+	m_batchRows = qMax(1, MaxVariables / qMax(1, (int) columns.count()));
+	m_values.reserve(m_batchRows * columns.count());
+}
+
+bool SqlBatchInserter::addRow(const QVariantList & values) {
+	if (values.count() != m_columns.count()) {
+		DebugDialog::debug(QString("SQLITE: wrong column count for %1: %2").arg(m_table).arg(values.count()));
+		return false;
+	}
+
+	Q_FOREACH (int ix, m_required) {
+		if (isNullValue(values.at(ix))) {
+			DebugDialog::debug(QString("SQLITE: null %1 in %2").arg(m_columns.at(ix), m_table));
+			return false;
+		}
+	}
+
+	m_values.append(values);
+	if (m_values.count() < m_batchRows * m_columns.count()) return true;
+
+	if (!m_batchPrepared) {
+		m_batchPrepared = m_batchQuery.prepare(insertStatement(m_table, m_columns, m_batchRows));
+		if (!m_batchPrepared) {
+			DebugDialog::debug(QString("SQLITE: couldn't prepare batch for %1: %2").arg(m_table, m_batchQuery.lastError().text()));
+		}
+	}
+	if (m_batchPrepared) {
+		exec(m_batchQuery, m_batchRows);
+	}
+	else {
+		m_failed = true;
+		m_values.clear();
+	}
+	return true;
+}
+
+bool SqlBatchInserter::flush() {
+	if (m_values.isEmpty()) return !m_failed;
+
+	int rows = m_values.count() / m_columns.count();
+	QSqlQuery query(m_database);
+	if (query.prepare(insertStatement(m_table, m_columns, rows))) {
+		exec(query, rows);
+	}
+	else {
+		DebugDialog::debug(QString("SQLITE: couldn't prepare batch for %1: %2").arg(m_table, query.lastError().text()));
+		m_failed = true;
+		m_values.clear();
+	}
+
+	return !m_failed;
+}
+
+bool SqlBatchInserter::exec(QSqlQuery & query, int rows) {
+	for (int i = 0; i < m_values.count(); i++) {
+		query.bindValue(i, m_values.at(i));
+	}
+	bool result = query.exec();
+	if (!result) {
+		DebugDialog::debug(QString("SQLITE: couldn't insert %1 rows into %2: %3").arg(rows).arg(m_table, query.lastError().text()));
+		m_failed = true;
+	}
+	m_values.clear();
+	return result;
+}
+
+bool SqlBatchInserter::failed() const {
+	return m_failed;
+}
+
+const QString & SqlBatchInserter::table() const {
+	return m_table;
+}
+
+int SqlBatchInserter::batchRows() const {
+	return m_batchRows;
+}
+
+QString SqlBatchInserter::insertStatement(const QString & table, const QStringList & columns, int rows) {
+	QString row = "(" + QString("?,").repeated(columns.count());
+	row.chop(1);
+	row += ")";
+
+	QString statement = QString("INSERT INTO %1(%2) VALUES ").arg(table, columns.join(", "));
+	statement.reserve(statement.length() + (rows * (row.length() + 1)));
+	for (int i = 0; i < rows; i++) {
+		if (i > 0) statement += ",";
+		statement += row;
+	}
+	return statement;
+}
+
+bool SqlBatchInserter::isNullValue(const QVariant & value) {
+	// a null QString wrapped in a QVariant is not a null QVariant in Qt 6
+	if (value.typeId() == QMetaType::QString) return value.toString().isNull();
+	return value.isNull();
+}
@@ -0,0 +1,62 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SQLBATCHINSERTER_H
+#define SQLBATCHINSERTER_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantList>
+
+// Collects rows for one table and writes them as multi-row INSERT statements with positional
+// parameters. Every full batch goes through the same prepared statement; only the final partial
+// batch needs a statement of its own. Meant for bulk loads inside a single transaction.
+
+class SqlBatchInserter
+{
+public:
+	SqlBatchInserter(QSqlDatabase & db, const QString & table, const QStringList & columns, const QStringList & required = QStringList());
+
+	bool addRow(const QVariantList & values);		// false if a required (NOT NULL) column is null; the row is dropped
+	bool flush();
+	bool failed() const;
+	const QString & table() const;
+	int batchRows() const;
+
+	static QString insertStatement(const QString & table, const QStringList & columns, int rows);
+
+protected:
+	bool exec(QSqlQuery & query, int rows);
+	static bool isNullValue(const QVariant &);
+
+protected:
+	QSqlDatabase m_database;
+	QString m_table;
+	QStringList m_columns;
+	QList<int> m_required;
+	int m_batchRows = 1;
+	bool m_batchPrepared = false;
+	bool m_failed = false;
+	QSqlQuery m_batchQuery;
+	QVariantList m_values;
+};
+
+#endif
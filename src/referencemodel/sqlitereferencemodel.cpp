@@ -27,12 +27,14 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QSqlResult>
 #include <QSqlDriver>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtGlobal>
 #include <limits>
 
 #include "qbuffer.h"
 #include "sqlitereferencemodel.h"
 #include "serviceiconfetcher.h"
+#include "sqlbatchinserter.h"
 #include "../debugdialog.h"
 #include "../connectors/svgidlayer.h"
 #include "../connectors/connector.h"
@@ -72,23 +74,91 @@ void debugExec(const QString & msg, QSqlQuery & query) {
 #endif
 }
 
-void killConnectors(QVector<Connector *> & connectors) {
-	Q_FOREACH (Connector * connector, connectors) {
-		delete connector->connectorShared();
-		delete connector;
-	}
-	connectors.clear();
+QStringList FailurePartMessages;
+QStringList FailurePropertyMessages;
+
+// a full build of a database file writes its rows in multi-row batches;
+// row ids are handed out here instead of being read back with lastInsertId()
+struct BulkBuild {
+	BulkBuild(QSqlDatabase & db)
+		: parts(db, "parts",
+		        { "id", "moduleID", "family", "version", "replacedby", "fritzingversion", "author", "title", "label",
+		          "date", "description", "spice", "spicemodel", "taxonomy", "itemtype", "path" },
+		        { "moduleID", "family" })
+		, properties(db, "properties", { "name", "value", "part_id", "show_in_label" }, { "name", "value" })
+		, tags(db, "tags", { "tag", "part_id" }, { "tag" })
+		, viewImages(db, "viewimages", { "viewid", "image", "layers", "sticky", "flipvertical", "fliphorizontal", "part_id" }, { "image" })
+		, connectors(db, "connectors", { "id", "connectorid", "type", "name", "description", "replacedby", "part_id" }, { "connectorid", "name" })
+		, connectorLayers(db, "connectorlayers", { "view", "layer", "svgid", "hybrid", "terminalid", "legid", "connector_id" }, { "svgid" })
+		, buses(db, "buses", { "id", "name", "part_id" }, { "name" })
+		, busMembers(db, "busmembers", { "connectorid", "bus_id" }, { "connectorid" })
+		, subparts(db, "schematic_subparts", { "label", "subpart_id", "part_id" }, { "label", "subpart_id" })
+	{
+	}
+
+	QList<SqlBatchInserter *> inserters() {
+		return { &parts, &properties, &tags, &viewImages, &connectors, &connectorLayers, &buses, &busMembers, &subparts };
+	}
+
+	SqlBatchInserter parts;
+	SqlBatchInserter properties;
+	SqlBatchInserter tags;
+	SqlBatchInserter viewImages;
+	SqlBatchInserter connectors;
+	SqlBatchInserter connectorLayers;
+	SqlBatchInserter buses;
+	SqlBatchInserter busMembers;
+	SqlBatchInserter subparts;
+	qulonglong nextPartID = 1;
+	qulonglong nextConnectorID = 1;
+	qulonglong nextBusID = 1;
+};
+
+static void removeBuildFiles(const QString & buildName) {
+	QFile::remove(buildName);
+	QFile::remove(buildName + "-wal");
+	QFile::remove(buildName + "-shm");
+}
+
+static void createModuleIDTrigger() {
+	QSqlQuery query;
+	bool result = query.exec("CREATE TRIGGER unique_part__moduleID \n"
+	                         "BEFORE INSERT ON parts \n"
+	                         "FOR EACH ROW BEGIN \n"
+	                         "SELECT RAISE(ROLLBACK, 'insert on table \"parts\" violates unique constraint \"unique_part__moduleID\"') \n"
+	                         "WHERE (SELECT count(*) FROM parts WHERE moduleID = NEW.moduleID) > 0; \n"
+	                         "END; "
+	                        );
+	debugError(result, query);
 }
 
-void killBuses(QVector<BusShared *> & buses) {
-	Q_FOREACH (BusShared * bus, buses) {
-		delete bus;
+static bool partsFolderPath(ModelPart * modelPart, QString & path) {
+	// returns false if the part doesn't belong in the database
+	path = modelPart->path();
+	QString prefix = FolderUtils::getAppPartsSubFolderPath("");
+
+	if (path.startsWith(ResourcePath)) {
 	}
-	buses.clear();
-}
+	else if (path.startsWith(prefix)) {
+		path = path.mid(prefix.length() + 1);  // + 1 to remove the beginning "/"
+	}
+	else {
+		bool bail = true;
+		if (modelPart->itemType() == ModelPart::SchematicSubpart) {
+			ModelPartShared * mps = modelPart->modelPartShared();
+			if ((mps != nullptr) && (mps->superpart() != nullptr) && mps->superpart()->path().startsWith(prefix)) {
+				bail = false;
+			}
+		}
 
-QStringList FailurePartMessages;
-QStringList FailurePropertyMessages;
+		if (bail) {
+			DebugDialog::debug(QString("part path not in parts:%1 %2").arg(path, prefix));
+			return false;
+		}
+	}
+
+	return true;
+}
 
 void noSwappingMessage(int n)
 {
@@ -185,16 +255,130 @@ bool SqliteReferenceModel::loadFromDB(const QString & databaseName)
 	}
 	*/
 
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
 	m_swappingEnabled = loadFromDB(m_database, db);
-	if (db.isOpen()) db.close();
+	DebugDialog::debug(QString("load from db %1 ms").arg(elapsedTimer.elapsed()));
 	if (!m_swappingEnabled) {
+		if (db.isOpen()) db.close();
 		killParts();
 		noSwappingMessage(2);
 	}
+	else {
+		// stays open so parts can be filled in on first use
+		m_partsDatabase = db;
+	}
 
 	return m_swappingEnabled;
 }
 
+void SqliteReferenceModel::hydrate(ModelPartShared * modelPartShared, qulonglong dbid)
+{
+	if (!m_partsDatabase.isOpen()) return;
+
+	QSqlQuery query(m_partsDatabase);
+	query.prepare("SELECT viewid, image, layers, sticky, flipvertical, fliphorizontal FROM viewimages WHERE part_id = :part_id");
+	query.bindValue(":part_id", dbid);
+	bool result = query.exec();
+	debugError(result, query);
+	while (query.next()) {
+		int ix = 0;
+		auto * viewImage = new ViewImage(ViewLayer::BreadboardView);
+		viewImage->viewID = (ViewLayer::ViewID) query.value(ix++).toInt();
+		viewImage->image = query.value(ix++).toString();
+		viewImage->layers = query.value(ix++).toULongLong();
+		viewImage->sticky = query.value(ix++).toULongLong();
+		viewImage->canFlipVertical = query.value(ix++).toInt() == 0 ? false : true;
+		viewImage->canFlipHorizontal = query.value(ix++).toInt() == 0 ? false : true;
+		modelPartShared->setViewImage(viewImage);
+	}
+
+	QHash<qulonglong, ConnectorShared *> connectors;
+	query.prepare("SELECT id, connectorid, type, name, description, replacedby FROM connectors WHERE part_id = :part_id");
+	query.bindValue(":part_id", dbid);
+	result = query.exec();
+	debugError(result, query);
+	while (query.next()) {
+		int ix = 0;
+		qulonglong cid = query.value(ix++).toULongLong();
+		auto * connectorShared = new ConnectorShared();
+		connectorShared->setId(query.value(ix++).toString());
+		connectorShared->setConnectorType((Connector::ConnectorType) query.value(ix++).toInt());
+		connectorShared->setSharedName(query.value(ix++).toString());
+		connectorShared->setDescription(query.value(ix++).toString());
+		connectorShared->setReplacedby(query.value(ix++).toString());
+		modelPartShared->addConnector(connectorShared);
+		connectors.insert(cid, connectorShared);
+	}
+
+	query.prepare("SELECT cl.view, cl.layer, cl.svgid, cl.hybrid, cl.terminalid, cl.legid, cl.connector_id FROM connectorlayers cl "
+	              "JOIN connectors c ON cl.connector_id = c.id WHERE c.part_id = :part_id");
+	query.bindValue(":part_id", dbid);
+	result = query.exec();
+	debugError(result, query);
+	while (query.next()) {
+		int ix = 0;
+		ViewLayer::ViewID viewID = (ViewLayer::ViewID) query.value(ix++).toInt();
+		ViewLayer::ViewLayerID viewLayerID = (ViewLayer::ViewLayerID) query.value(ix++).toInt();
+		QString svgID = query.value(ix++).toString();
+		bool hybrid = query.value(ix++).toInt() == 0 ? false : true;
+		QString terminalID = query.value(ix++).toString();
+		QString legID = query.value(ix++).toString();
+		ConnectorShared * connectorShared = connectors.value(query.value(ix++).toULongLong());
+		if (connectorShared != nullptr) {
+			connectorShared->addPin(viewID, svgID, viewLayerID, terminalID, legID, hybrid);
+		}
+	}
+
+	QHash<qulonglong, BusShared *> buses;
+	query.prepare("SELECT id, name FROM buses WHERE part_id = :part_id");
+	query.bindValue(":part_id", dbid);
+	result = query.exec();
+	debugError(result, query);
+	while (query.next()) {
+		qulonglong bid = query.value(0).toULongLong();
+		auto * busShared = new BusShared(query.value(1).toString());
+		modelPartShared->insertBus(busShared);
+		buses.insert(bid, busShared);
+	}
+
+	if (!buses.isEmpty()) {
+		query.prepare("SELECT bm.connectorid, bm.bus_id FROM busmembers bm JOIN buses b ON bm.bus_id = b.id WHERE b.part_id = :part_id");
+		query.bindValue(":part_id", dbid);
+		result = query.exec();
+		debugError(result, query);
+		while (query.next()) {
+			ConnectorShared * connectorShared = modelPartShared->getConnectorShared(query.value(0).toString());
+			BusShared * busShared = buses.value(query.value(1).toULongLong());
+			if (busShared != nullptr && connectorShared != nullptr) {
+				busShared->addConnectorShared(connectorShared);
+			}
+		}
+	}
+
+	modelPartShared->setConnectorsInitialized(true);
+
+	ModelPart * modelPart = m_partHash.value(modelPartShared->moduleID());
+	if (modelPart != nullptr && modelPart->modelPartShared() == modelPartShared) {
+		modelPart->initConnectors();
+		modelPart->flipSMDAnd();
+	}
+	else {
+		modelPartShared->flipSMDAnd();
+	}
+}
+
+void SqliteReferenceModel::closePartsDatabase()
+{
+	if (!m_partsDatabase.isOpen()) return;
+
+	// parts.db is about to be replaced, so fill in whatever hasn't been used yet
+	Q_FOREACH (ModelPart * modelPart, m_partHash.values()) {
+		modelPart->modelPartShared()->ensureHydrated();
+	}
+	m_partsDatabase.close();
+}
+
 bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 {
 	bool opened = false;
@@ -286,7 +470,7 @@ bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 		modelPartShared->setPath(path);
 		modelPart->setCore(true);
 
-		modelPartShared->setConnectorsInitialized(true);
+		modelPartShared->setLoader(this, dbid);
 
 		m_partHash.insert(modelPartShared->moduleID(), modelPart);
 		parts[dbid] = modelPart;
@@ -303,27 +487,6 @@ bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 		oldToNew[dbid] = newid;
 	}
 
-	query = db.exec("SELECT viewid, image, layers, sticky, flipvertical, fliphorizontal, part_id FROM viewimages");
-	debugError(query.isActive(), query);
-	if (!query.isActive()) return false;
-
-	while (query.next()) {
-		int ix = 0;
-		auto * viewImage = new ViewImage(ViewLayer::BreadboardView);
-		viewImage->viewID = (ViewLayer::ViewID) query.value(ix++).toInt();
-		viewImage->image = query.value(ix++).toString();
-		viewImage->layers = query.value(ix++).toULongLong();
-		viewImage->sticky = query.value(ix++).toULongLong();
-		viewImage->canFlipVertical = query.value(ix++).toInt() == 0 ? false : true;
-		viewImage->canFlipHorizontal = query.value(ix++).toInt() == 0 ? false : true;
-		qulonglong dbid = query.value(ix++).toULongLong();
-
-		ModelPart * modelPart = parts.at(dbid);
-		if (modelPart != nullptr) {
-			parts.at(dbid)->setViewImage(viewImage);
-		}
-	}
-
 	query = db.exec("SELECT tag, part_id FROM tags");
 	debugError(query.isActive(), query);
 	if (!query.isActive()) return false;
@@ -364,126 +527,17 @@ bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 		}
 	}
 
+	// view images, connectors and buses are read per part in hydrate(), the first time a part is used;
+	// just make sure the tables are there
 	query = db.exec("SELECT COUNT(*) FROM connectors");
 	debugError(query.isActive(), query);
 	if (!query.isActive() || !query.next()) return false;
-
-	int connectorCount = query.value(0).toInt();
-	if (connectorCount == 0) return false;
-
-	QVector<Connector *> connectors(connectorCount + 1, NULL);
-
-	query = db.exec("SELECT id, connectorid, type, name, description, replacedby, part_id FROM connectors");
-	debugError(query.isActive(), query);
-	if (!query.isActive()) {
-		killConnectors(connectors);
-		return false;
-	}
-
-	while (query.next()) {
-		int ix = 0;
-		qulonglong cid = query.value(ix++).toULongLong();
-		QString connectorid = query.value(ix++).toString();
-		Connector::ConnectorType type = (Connector::ConnectorType) query.value(ix++).toInt();
-		QString name = query.value(ix++).toString();
-		QString description = query.value(ix++).toString();
-		QString replacedby = query.value(ix++).toString();
-		qulonglong dbid = query.value(ix++).toULongLong();
-		ModelPart * modelPart = parts.at(dbid);
-		if (modelPart != nullptr) {
-			auto * connectorShared = new ConnectorShared();
-			connectorShared->setConnectorType(type);
-			connectorShared->setDescription(description);
-			connectorShared->setReplacedby(replacedby);
-			connectorShared->setSharedName(name);
-			connectorShared->setId(connectorid);
-
-			auto * connector = new Connector(connectorShared, modelPart);
-			modelPart->addConnector(connector);
-
-			connectors[cid] = connector;
-		}
-	}
-
-	query = db.exec("SELECT view, layer, svgid, hybrid, terminalid, legid, connector_id FROM connectorlayers");
-	debugError(query.isActive(), query);
-	if (!query.isActive()) {
-		killConnectors(connectors);
-		return false;
-	}
-
-	while (query.next()) {
-		int ix = 0;
-		ViewLayer::ViewID viewID = (ViewLayer::ViewID) query.value(ix++).toInt();
-		ViewLayer::ViewLayerID viewLayerID = (ViewLayer::ViewLayerID) query.value(ix++).toInt();
-		QString svgID = query.value(ix++).toString();
-		bool hybrid = query.value(ix++).toInt() == 0 ? false : true;
-		QString terminalID = query.value(ix++).toString();
-		QString legID = query.value(ix++).toString();
-		qulonglong cid = query.value(ix++).toULongLong();
-		Connector * connector = connectors.at(cid);
-		if (connector != nullptr) {
-			connectors[cid]->addPin(viewID, svgID, viewLayerID, terminalID, legID, hybrid);
-		}
-	}
+	if (query.value(0).toInt() == 0) return false;
 
 	query = db.exec("SELECT COUNT(*) FROM buses");
 	debugError(query.isActive(), query);
 	if (!query.isActive() || !query.next()) return false;
-
-	int busCount = query.value(0).toInt();
-	if (busCount == 0) return false;
-
-	QVector<BusShared *> buses(busCount + 1, NULL);
-	QHash<BusShared *, qulonglong> busids;
-
-	query = db.exec("SELECT id, name, part_id FROM buses");
-	debugError(query.isActive(), query);
-	if (!query.isActive()) {
-		killConnectors(connectors);
-		killBuses(buses);
-		return false;
-	}
-
-	while (query.next()) {
-		int ix = 0;
-		qulonglong bid = query.value(ix++).toULongLong();
-		QString name = query.value(ix++).toString();
-		qulonglong dbid = query.value(ix++).toULongLong();
-		ModelPart * modelPart = parts.at(dbid);
-		if (modelPart != nullptr) {
-			auto * busShared = new BusShared(name);
-			ModelPart * modelPart = parts.at(dbid);
-			modelPart->modelPartShared()->insertBus(busShared);
-
-			buses[bid] = busShared;
-			busids.insert(busShared, dbid);
-		}
-	}
-
-	query = db.exec("SELECT connectorid, bus_id FROM busmembers");
-	debugError(query.isActive(), query);
-	if (!query.isActive()) {
-		killConnectors(connectors);
-		killBuses(buses);
-		return false;
-	}
-
-	while (query.next()) {
-		int ix = 0;
-
-		QString connectorid = query.value(ix++).toString();
-		qulonglong bid = query.value(ix++).toULongLong();
-		BusShared * busShared = buses[bid];
-		if (busShared != nullptr) {
-			qulonglong dbid = busids.value(busShared);
-			ModelPart * modelPart = parts.at(dbid);
-			if (modelPart != nullptr) {
-				ConnectorShared * connectorShared = modelPart->modelPartShared()->getConnectorShared(connectorid);
-				busShared->addConnectorShared(connectorShared);
-			}
-		}
-	}
+	if (query.value(0).toInt() == 0) return false;
 
 	query = db.exec("SELECT subpart_id, part_id FROM schematic_subparts");
 	debugError(query.isActive(), query);
@@ -509,15 +563,18 @@ bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 	}
 	Q_FOREACH (ModelPart * modelPart, m_partHash.values()) {
 		if (modelPart->dbid() != 0) {
-			// initConnectors is not redundant here
-			// there may be parts in m_partHash loaded from a file rather from the database
-			//
-			modelPart->initConnectors();
-			modelPart->flipSMDAnd();
-			modelPart->initBuses();
+			if (modelPart->modelPartShared()->isHydrated()) {
+				// initConnectors is not redundant here
+				// there may be parts in m_partHash loaded from a file rather from the database
+				//
+				modelPart->initConnectors();
+				modelPart->flipSMDAnd();
+				modelPart->initBuses();
+			}
 			modelPart->setParent(m_root);
 		}
 	}
+	clearSearchIndex();
 
 	QSqlQuery queryFrom(db);
 	queryFrom.prepare("SELECT id, name, data FROM icons");
@@ -542,6 +599,14 @@ bool SqliteReferenceModel::loadFromDB(QSqlDatabase & keep_db, QSqlDatabase & db)
 
 
 SqliteReferenceModel::~SqliteReferenceModel() {
+	Q_FOREACH (ModelPart * modelPart, m_partHash.values()) {
+		ModelPartShared * modelPartShared = modelPart->modelPartShared();
+		if (!modelPartShared->isHydrated()) {
+			modelPartShared->setLoader(nullptr, 0);
+		}
+	}
+	if (m_partsDatabase.isOpen()) m_partsDatabase.close();
+	delete m_bulkBuild;
 	deleteConnection();
 }
 
@@ -553,12 +618,25 @@ void SqliteReferenceModel::initParts(bool dbExists) {
 
 bool SqliteReferenceModel::createDatabase(const QString & databaseName, bool fullLoad) {
 	m_swappingEnabled = true;
+
+	// a full build of a database file goes into a side file which replaces databaseName when it is complete,
+	// so readers of databaseName never see a partial database
+	bool bulkBuild = fullLoad && !databaseName.isEmpty();
+	QString buildName = bulkBuild ? databaseName + ".building" : databaseName;
+	if (m_database.isOpen()) m_database.close();
+	if (bulkBuild) removeBuildFiles(buildName);
+
+	QElapsedTimer elapsedTimer;
+	elapsedTimer.start();
 	m_database = QSqlDatabase::addDatabase("QSQLITE");
-	m_database.setDatabaseName(databaseName.isEmpty() ? ":memory:" : databaseName);
+	m_database.setDatabaseName(buildName.isEmpty() ? ":memory:" : buildName);
 	if (!m_database.open()) {
 		m_swappingEnabled = false;
 	}
 	else {
+		if (bulkBuild) {
+			beginBulkBuild();
+		}
 		if (fullLoad) {
 			DebugDialog::debug("Fetching icons from server");
 			ServiceIconFetcher::instance()->fetchIcons();
@@ -661,14 +739,10 @@ bool SqliteReferenceModel::createDatabase(const QString & databaseName, bool ful
 			DebugDialog::debug("SqliteReferenceModel::createProperties failed.");
 		}
 
-		result = query.exec("CREATE TRIGGER unique_part__moduleID \n"
-		                    "BEFORE INSERT ON parts \n"
-		                    "FOR EACH ROW BEGIN \n"
-		                    "SELECT RAISE(ROLLBACK, 'insert on table \"parts\" violates unique constraint \"unique_part__moduleID\"') \n"
-		                    "WHERE (SELECT count(*) FROM parts WHERE moduleID = NEW.moduleID) > 0; \n"
-		                    "END; "
-		                   );
-		debugError(result, query);
+		if (m_bulkBuild == nullptr) {
+			// a bulk build adds the trigger after its rows, which come from unique m_partHash keys
+			createModuleIDTrigger();
+		}
 
 		if (fullLoad) {
 			QSqlQuery query;
@@ -687,6 +761,11 @@ bool SqliteReferenceModel::createDatabase(const QString & databaseName, bool ful
 			addPartAux(mp, fullLoad);
 		}
 
+		if (m_bulkBuild != nullptr) {
+			flushBulkBuild();
+			createModuleIDTrigger();
+		}
+
 		if (fullLoad) {
 			DebugDialog::debug("Writing any icons from server into database");
 			ServiceIconFetcher::instance()->waitForIcons();
@@ -709,12 +788,78 @@ bool SqliteReferenceModel::createDatabase(const QString & databaseName, bool ful
 		createIndexes();
 		createMoreIndexes(m_database);
 
-		m_database.commit();
+		bool committed = m_database.commit();
+		if (bulkBuild) {
+			finishBulkBuild(buildName, databaseName, committed);
+		}
 
+		if (fullLoad) {
+			DebugDialog::debug(QString("create database %1 ms").arg(elapsedTimer.elapsed()));
+		}
 	}
 	return m_swappingEnabled;
 }
 
+void SqliteReferenceModel::beginBulkBuild()
+{
+	// nothing else reads the side file while it is built, and a crash just means building it again,
+	// so trade durability for speed; the single transaction in createDatabase does the rest
+	QSqlQuery query(m_database);
+	bool result = query.exec("PRAGMA journal_mode = WAL");
+	debugError(result, query);
+	result = query.exec("PRAGMA synchronous = OFF");
+	debugError(result, query);
+	result = query.exec("PRAGMA temp_store = MEMORY");
+	debugError(result, query);
+	result = query.exec("PRAGMA cache_size = -65536");		// KiB
+	debugError(result, query);
+
+	m_bulkBuild = new BulkBuild(m_database);
+}
+
+void SqliteReferenceModel::flushBulkBuild()
+{
+	Q_FOREACH (SqlBatchInserter * inserter, m_bulkBuild->inserters()) {
+		if (!inserter->flush()) {
+			DebugDialog::debug(QString("SqliteReferenceModel: bulk insert into %1 failed").arg(inserter->table()));
+			m_swappingEnabled = false;
+		}
+	}
+}
+
+bool SqliteReferenceModel::finishBulkBuild(const QString & buildName, const QString & databaseName, bool committed)
+{
+	delete m_bulkBuild;
+	m_bulkBuild = nullptr;
+
+	{
+		// fold the WAL back in and go back to a rollback journal, so the result is a single self-contained file
+		QSqlQuery query(m_database);
+		bool result = query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+		debugError(result, query);
+		result = query.exec("PRAGMA journal_mode = DELETE");
+		debugError(result, query);
+	}
+	m_database.close();
+
+	// a batch or row that failed during the build clears m_swappingEnabled; the commit alone doesn't make the file complete
+	bool replaced = committed && m_swappingEnabled && FolderUtils::replaceFile(buildName, databaseName);
+	if (!replaced) {
+		DebugDialog::debug(QString("SqliteReferenceModel: unable to finish building %1").arg(databaseName));
+		m_swappingEnabled = false;
+		removeBuildFiles(buildName);
+		return false;
+	}
+
+	m_database.setDatabaseName(databaseName);
+	if (!m_database.open()) {
+		m_swappingEnabled = false;
+		return false;
+	}
+
+	return true;
+}
+
 void SqliteReferenceModel::deleteConnection() {
 	QSqlDatabase::removeDatabase("SQLITE");
 }
@@ -949,6 +1094,10 @@ bool SqliteReferenceModel::updatePart(ModelPart * newModel) {
 }
 
 bool SqliteReferenceModel::insertPart(ModelPart * modelPart, bool fullLoad) {
+	if (fullLoad && m_bulkBuild != nullptr) {
+		return insertPartBulk(modelPart);
+	}
+
 	DebugModelPart = modelPart;
 
 	QHash<QString, QString> properties = modelPart->properties();
@@ -967,30 +1116,12 @@ bool SqliteReferenceModel::insertPart(ModelPart * modelPart, bool fullLoad) {
 	query.bindValue(":moduleID", modelPart->moduleID());
 	query.bindValue(":family", properties.value("family").toLower().trimmed());
 	if (fullLoad) {
-		QString path = modelPart->path();
-		QString prefix = FolderUtils::getAppPartsSubFolderPath("");
-
-		if (path.startsWith(ResourcePath)) {
-		}
-		else if (path.startsWith(prefix)) {
-			path = path.mid(prefix.length() + 1);  // + 1 to remove the beginning "/"
-		}
-		else {
-			bool bail = true;
-			if (modelPart->itemType() == ModelPart::SchematicSubpart) {
-				ModelPartShared * mps = modelPart->modelPartShared();
-				if ((mps != nullptr) && (mps->superpart() != nullptr) && mps->superpart()->path().startsWith(prefix)) {
-					bail = false;
-				}
-			}
-
-			if (bail) {
-				DebugDialog::debug(QString("part path not in parts:%1 %2 %3").arg(path, prefix).arg(static_cast<int>(fullLoad)));
-				return true;
-			}
+		QString path;
+		if (!partsFolderPath(modelPart, path)) {
+			DebugModelPart = nullptr;
+			return true;
 		}
 
-
 		query.bindValue(":version", modelPart->version());
 		query.bindValue(":replacedby", modelPart->replacedby());
 		query.bindValue(":fritzingversion", modelPart->fritzingVersion());
@@ -1063,6 +1194,108 @@ bool SqliteReferenceModel::insertPart(ModelPart * modelPart, bool fullLoad) {
 	return true;
 }
 
+bool SqliteReferenceModel::insertPartBulk(ModelPart * modelPart) {
+	// same rows as insertPart(modelPart, true), queued on m_bulkBuild; a NOT NULL violation would
+	// fail a whole batch, so those rows are caught here and reported the way insertPart reports them
+	QString path;
+	if (!partsFolderPath(modelPart, path)) return true;
+
+	QHash<QString, QString> properties = modelPart->properties();
+	qulonglong id = m_bulkBuild->nextPartID;
+	QVariantList row;
+	row << id << modelPart->moduleID() << properties.value("family").toLower().trimmed()
+	    << modelPart->version() << modelPart->replacedby() << modelPart->fritzingVersion()
+	    << modelPart->author() << modelPart->title() << modelPart->label() << modelPart->date()
+	    << modelPart->description() << modelPart->spice() << modelPart->spiceModel() << modelPart->taxonomy()
+	    << static_cast<int>(modelPart->itemType()) << path;
+	if (!m_bulkBuild->parts.addRow(row)) {
+		FailurePartMessages << tr("part '%1' with id '%2' error '%3'; possibly because it has no 'family' property.")
+							.arg(modelPart->path(), modelPart->moduleID(), "NOT NULL constraint failed");
+		return true;
+	}
+
+	m_bulkBuild->nextPartID++;
+	modelPart->setDBID(id);
+
+	Q_FOREACH (QString prop, properties.keys()) {
+		if (prop == "family") continue;
+
+		row.clear();
+		row << prop.toLower().trimmed() << properties.value(prop) << id << (modelPart->showInLabel(prop) ? 1 : 0);
+		if (!m_bulkBuild->properties.addRow(row)) {
+			m_swappingEnabled = false;
+			FailurePropertyMessages << tr("property '%1' in part '%2' with id '%3'.")
+									.arg(prop, modelPart->path(), modelPart->moduleID());
+		}
+	}
+
+	Q_FOREACH (QString tag, modelPart->tags()) {
+		if (!m_bulkBuild->tags.addRow(QVariantList() << tag.toLower().trimmed() << id)) {
+			m_swappingEnabled = false;
+		}
+	}
+
+	Q_FOREACH (ViewImage * viewImage, modelPart->viewImages()) {
+		if (viewImage->image.isEmpty() && viewImage->layers == 0) continue;
+
+		row.clear();
+		row << viewImage->viewID << viewImage->image << viewImage->layers << viewImage->sticky
+		    << (viewImage->canFlipVertical ? 1 : 0) << (viewImage->canFlipHorizontal ? 1 : 0) << id;
+		if (!m_bulkBuild->viewImages.addRow(row)) {
+			m_swappingEnabled = false;
+		}
+	}
+
+	Q_FOREACH (Connector * connector, modelPart->connectors().values()) {
+		qulonglong cid = m_bulkBuild->nextConnectorID;
+		row.clear();
+		row << cid << connector->connectorSharedID() << static_cast<int>(connector->connectorType())
+		    << connector->connectorSharedName() << connector->connectorSharedDescription()
+		    << connector->connectorSharedReplacedby() << id;
+		if (!m_bulkBuild->connectors.addRow(row)) {
+			m_swappingEnabled = false;
+			continue;
+		}
+
+		m_bulkBuild->nextConnectorID++;
+		Q_FOREACH (SvgIdLayer * svgIdLayer, connector->svgIdLayers()) {
+			row.clear();
+			row << svgIdLayer->m_viewID << svgIdLayer->m_svgViewLayerID << svgIdLayer->m_svgId
+			    << (svgIdLayer->m_hybrid ? 1 : 0) << svgIdLayer->m_terminalId << svgIdLayer->m_legId << cid;
+			if (!m_bulkBuild->connectorLayers.addRow(row)) {
+				m_swappingEnabled = false;
+			}
+		}
+	}
+
+	Q_FOREACH (Bus * bus, modelPart->buses().values()) {
+		qulonglong bid = m_bulkBuild->nextBusID;
+		if (!m_bulkBuild->buses.addRow(QVariantList() << bid << bus->id() << id)) {
+			m_swappingEnabled = false;
+			continue;
+		}
+
+		m_bulkBuild->nextBusID++;
+		Q_FOREACH (Connector * connector, bus->connectors()) {
+			if (!m_bulkBuild->busMembers.addRow(QVariantList() << connector->connectorSharedID() << bid)) {
+				m_swappingEnabled = false;
+			}
+		}
+	}
+
+	ModelPartShared * mps = modelPart->modelPartShared();
+	if (mps != nullptr) {
+		Q_FOREACH (ModelPartShared * sub, mps->subparts()) {
+			if (!m_bulkBuild->subparts.addRow(QVariantList() << sub->label() << sub->subpartID() << id)) {
+				FailurePartMessages << QString("Problem with subpart in " + sub->path());
+				m_swappingEnabled = false;
+			}
+		}
+	}
+
+	return true;
+}
+
 bool SqliteReferenceModel::insertProperty(const QString & name, const QString & value, qulonglong id, bool showInLabel) {
 	QSqlQuery query;
 	query.prepare("INSERT INTO properties(name, value, part_id, show_in_label) VALUES (:name, :value, :part_id, :show_in_label)");
@@ -1348,6 +1581,7 @@ void SqliteReferenceModel::killParts()
 		delete modelPart;
 	}
 	m_partHash.clear();
+	clearSearchIndex();
 }
 
 bool SqliteReferenceModel::createProperties(QSqlDatabase & db) {
@@ -29,7 +29,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "referencemodel.h"
 
-class SqliteReferenceModel : public ReferenceModel {
+class SqliteReferenceModel : public ReferenceModel, public ModelPartSharedLoader {
 	Q_OBJECT
 public:
 	SqliteReferenceModel();
@@ -67,6 +67,9 @@ public:
 	bool insertIcon(const QString &name, const QPixmap &icon);
 	QStringList getAllServiceIconNames() const;
 
+	void hydrate(ModelPartShared *, qulonglong dbid) override;
+	void closePartsDatabase() override;
+
 
 protected:
 	void initParts(bool dbExists);
@@ -82,6 +85,10 @@ protected:
 	bool createDatabase(const QString & databaseName, bool fullLoad);
 	void deleteConnection();
 	bool insertPart(ModelPart *, bool fullLoad);
+	bool insertPartBulk(ModelPart *);
+	void beginBulkBuild();
+	void flushBulkBuild();
+	bool finishBulkBuild(const QString & buildName, const QString & databaseName, bool committed);
 	bool insertProperty(const QString & name, const QString & value, qulonglong id, bool showInLabel);
 	bool insertTag(const QString & tag, qulonglong id);
 	bool insertViewImage(const struct ViewImage *, qulonglong id);
@@ -115,6 +122,8 @@ protected:
 	volatile bool m_keepGoing = false;
 	bool m_init = false;
 	QSqlDatabase m_database;
+	QSqlDatabase m_partsDatabase;		// parts.db, for hydrating parts on first use
+	struct BulkBuild * m_bulkBuild = nullptr;
 	QMultiHash<QString /*name*/, QString /*value*/> m_recordedProperties;
 	QString m_sha;
 };
@@ -27,6 +27,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdexcept>
 
 #include <QCoreApplication>
+#include <QMetaObject>
+#include <QObject>
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QDir>
@@ -53,7 +55,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 NgSpiceSimulator::NgSpiceSimulator()
 	: m_isInitialized(false)
 	, m_isBGThreadRunning(false)
-	, m_errorTitle(std::nullopt) {
+	, m_errorTitle(std::nullopt)
+	, m_notifyPending(false) {
 }
 
 std::shared_ptr<NgSpiceSimulator> NgSpiceSimulator::getInstance() {
@@ -137,7 +140,7 @@ void NgSpiceSimulator::init()
 		throw std::runtime_error(errorMsg.toStdString());
 	}
 
-	GET_FUNC(ngSpice_Init)(&SendCharFunc, &SendStatFunc, &ControlledExitFunc, nullptr, nullptr, &BGThreadRunningFunc, nullptr);
+	GET_FUNC(ngSpice_Init)(&SendCharFunc, &SendStatFunc, &ControlledExitFunc, &SendDataFunc, &SendInitDataFunc, &BGThreadRunningFunc, nullptr);
 
 	m_isBGThreadRunning = true;
 	m_isInitialized = true;
@@ -176,6 +179,7 @@ void NgSpiceSimulator::loadCircuit(const std::string& netList) {
 		garbageCollector.push_back(shared);
 	}
 	components.push_back(nullptr);
+	m_vectorSpans.clear();
 	GET_FUNC(ngSpice_Circ)(components.data());
 
 }
@@ -194,6 +198,7 @@ void NgSpiceSimulator::command(const std::string& command) {
 		init();
 	}
 
+	m_vectorSpans.clear();
 	GET_FUNC(ngSpice_Command)(UNIQ(command));
 
 }
@@ -203,16 +208,134 @@ std::vector<double> NgSpiceSimulator::getVecInfo(const std::string& vecName) {
 
 	if (!vecInfo) return std::vector<double>();
 
-	std::vector<double> realValues;
 	if (vecInfo->v_realdata) {
-		for(int i=0; i<vecInfo->v_length; i++)
-			realValues.push_back(vecInfo->v_realdata[i]);
-		return realValues;
+		return std::vector<double>(vecInfo->v_realdata, vecInfo->v_realdata + vecInfo->v_length);
 	}
 
 	return std::vector<double>();
 }
 
+NgSpiceSimulator::VectorSpan NgSpiceSimulator::vectorSpan(const std::string& vecName) {
+	std::string key = QString::fromStdString(vecName).toLower().toStdString();
+
+	if (m_isBGThreadRunning) {
+		// ngspice may still reallocate its vectors, so never point into them now
+		auto streamed = m_streamedVectors.find(key);
+		if (streamed != m_streamedVectors.end()) {
+			return VectorSpan{streamed->second.data(), streamed->second.size()};
+		}
+
+		auto & copy = m_vectorCopies[key];
+		if (copy.second.empty() || copy.first != m_streamPosition) {
+			copy.first = m_streamPosition;
+			copy.second = getVecInfo(key);
+		}
+		return VectorSpan{copy.second.data(), copy.second.size()};
+	}
+
+	auto cached = m_vectorSpans.find(key);
+	if (cached != m_vectorSpans.end()) return cached->second;
+
+	VectorSpan span;
+	vector_info* vecInfo = GET_FUNC(ngGet_Vec_Info)(UNIQ(key));
+	if (vecInfo && vecInfo->v_realdata) {
+		span.data = vecInfo->v_realdata;
+		span.size = vecInfo->v_length;
+	}
+	m_vectorSpans.insert({key, span});
+	return span;
+}
+
+void NgSpiceSimulator::setListener(QObject * listener, std::function<void()> callback) {
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+	m_listener = listener;
+	m_listenerCallback = callback;
+	m_notifyPending = false;
+}
+
+void NgSpiceSimulator::notifyListener() {
+	if (m_notifyPending.exchange(true)) return;
+
+	std::lock_guard<std::mutex> lock(m_listenerMutex);
+	if (!m_listener) {
+		m_notifyPending = false;
+		return;
+	}
+
+	QMetaObject::invokeMethod(m_listener, [this]() {
+		m_notifyPending = false;
+		std::function<void()> callback;
+		{
+			std::lock_guard<std::mutex> lock(m_listenerMutex);
+			callback = m_listenerCallback;
+		}
+		if (callback) callback();
+	}, Qt::QueuedConnection);
+}
+
+void NgSpiceSimulator::resetStream() {
+	std::lock_guard<std::mutex> lock(m_layoutMutex);
+	m_streamPosition = m_samples.discard();
+	m_droppedAtReset = m_samples.dropped();
+	// rows arriving before the next SendInitDataFunc belong to an earlier run
+	m_streamGeneration = m_layoutGeneration;
+	m_streamedNames.clear();
+	m_streamedVectors.clear();
+	m_streamReloaded = false;
+	m_vectorSpans.clear();
+	m_vectorCopies.clear();
+}
+
+void NgSpiceSimulator::drainStream() {
+	std::lock_guard<std::mutex> lock(m_layoutMutex);
+	std::size_t start = m_streamPosition;
+	m_drained.clear();
+	m_streamPosition += m_samples.pop(m_drained);
+
+	std::size_t offset = 0;
+	if (m_streamGeneration != m_layoutGeneration) {
+		// a new plot: anything before its first row belongs to the previous one
+		m_streamGeneration = m_layoutGeneration;
+		m_streamedNames = m_layoutNames;
+		m_streamedVectors.clear();
+		offset = (m_layoutStart > start) ? m_layoutStart - start : 0;
+	}
+
+	if (m_samples.dropped() != m_droppedAtReset) {
+		// the ring overflowed, so appending more rows would leave a gap and shift later samples to the
+		// wrong timestep. Keep the rows already streamed, which the animation goes on showing, and read
+		// the vectors back from ngspice only once its background thread has stopped extending them
+		if (!m_streamReloaded && !m_isBGThreadRunning) {
+			for (const auto & name : m_streamedNames) {
+				m_streamedVectors[name] = getVecInfo(name);
+			}
+			m_streamReloaded = true;
+		}
+		return;
+	}
+
+	std::size_t width = m_streamedNames.size();
+	if (width > 0) {
+		std::vector<std::vector<double> *> columns;
+		for (const auto & name : m_streamedNames) {
+			columns.push_back(&m_streamedVectors[name]);
+		}
+		for (std::size_t row = offset; row + width <= m_drained.size(); row += width) {
+			for (std::size_t column = 0; column < width; column++) {
+				columns[column]->push_back(m_drained[row + column]);
+			}
+		}
+	}
+}
+
+const std::vector<double> & NgSpiceSimulator::streamedVector(const std::string& vecName) {
+	static const std::vector<double> empty;
+	auto it = m_streamedVectors.find(QString::fromStdString(vecName).toLower().toStdString());
+	if (it == m_streamedVectors.end()) return empty;
+
+	return it->second;
+}
+
 stdx::optional<std::string> NgSpiceSimulator::errorOccured() {
 	return m_errorTitle;
 }
@@ -265,13 +388,29 @@ int NgSpiceSimulator::ControlledExitFunc(int exitStatus, bool, bool, int libId,
 	return 0;
 }
 
-int NgSpiceSimulator::SendDataFunc(pvecvaluesall, int numStructs, int libId, void*) {
-	std::cout << "SendDataFunc numStructs (libId:" << libId << "): " << numStructs << std::endl;
+int NgSpiceSimulator::SendDataFunc(pvecvaluesall allVecValues, int, int, void*) {
+	// called on the background thread for every point, so no logging here
+	auto simulator = getInstance();
+	std::vector<double> & row = simulator->m_row;
+	row.resize(allVecValues->veccount);
+	for (int i = 0; i < allVecValues->veccount; i++) {
+		row[i] = allVecValues->vecsa[i]->creal;
+	}
+	simulator->m_samples.push(row.data(), row.size());
+	simulator->notifyListener();
 	return 0;
 }
 
-int NgSpiceSimulator::SendInitDataFunc(pvecinfoall, int libId, void*) {
-	std::cout << "SendInitDataFunc (libId:" << libId << "): " << std::endl;
+int NgSpiceSimulator::SendInitDataFunc(pvecinfoall allVecInitInfo, int libId, void*) {
+	std::cout << "SendInitDataFunc (libId:" << libId << "): " << allVecInitInfo->veccount << " vectors" << std::endl;
+	auto simulator = getInstance();
+	std::lock_guard<std::mutex> lock(simulator->m_layoutMutex);
+	simulator->m_layoutNames.clear();
+	for (int i = 0; i < allVecInitInfo->veccount; i++) {
+		simulator->m_layoutNames.push_back(QString(allVecInitInfo->vecs[i]->vecname).toLower().toStdString());
+	}
+	simulator->m_layoutStart = simulator->m_samples.written();
+	simulator->m_layoutGeneration++;
 	return 0;
 }
 
@@ -279,5 +418,6 @@ int NgSpiceSimulator::BGThreadRunningFunc(bool notRunning, int libId, void*) {
 	std::cout << "BGThreadRunningFunc (libId:" << libId << "): " << std::endl;
 	auto simulator = getInstance();
 	simulator->m_isBGThreadRunning = !notRunning;
+	simulator->notifyListener();
 	return 0;
 }
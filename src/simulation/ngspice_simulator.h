@@ -23,9 +23,15 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <ngspice/sharedspice.h>
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#include "sampleringbuffer.h"
 
 #pragma once
 
@@ -62,6 +68,8 @@ namespace stdx {
 
 #include <QLibrary>
 
+class QObject;
+
 /**
  * @brief The NgSpiceSimulator class is an interface for ngspice electronics simulation library.
  *
@@ -75,6 +83,18 @@ private:
 	NgSpiceSimulator();
 
 public:
+	/**
+	 * @brief Non-owning view of the values of a vector.
+	 */
+	struct VectorSpan {
+		const double * data = nullptr;
+		std::size_t size = 0;
+
+		bool empty() const { return size == 0; }
+		double operator[](std::size_t i) const { return data[i]; }
+		double valueOr(std::size_t i, double defaultValue) const { return i < size ? data[i] : defaultValue; }
+	};
+
 	/**
 	 * @brief Return the singleton instance of NgSpiceSimulator.
 	 * @return singleton instance of NgSpiceSimulator
@@ -118,6 +138,47 @@ public:
 	 */
 	std::vector<double> getVecInfo(const std::string& vecName);
 
+	/**
+	 * @brief Return the values of a vector without copying them.
+	 *
+	 * Once the background thread has stopped, the span points into ngspice's own storage and is
+	 * resolved only once per name until the next command() or loadCircuit(). While the thread runs,
+	 * it points to the streamed vector, or to a copy refreshed at most once per drainStream() for
+	 * vectors that are not streamed. Do not keep a span across drainStream(), command() or loadCircuit().
+	 * @param[in] vecName name of the vector (case insensitive)
+	 * @return the values, empty if the vector is unknown
+	 */
+	VectorSpan vectorSpan(const std::string& vecName);
+
+	/**
+	 * @brief Call back on the listener's thread whenever new samples arrive or the background thread stops.
+	 *
+	 * Notifications are coalesced: however many points ngspice sends, at most one call is queued at a time.
+	 * @param[in] listener object whose thread runs the callback, or nullptr to stop notifying
+	 * @param[in] callback function to run
+	 */
+	void setListener(QObject * listener, std::function<void()> callback);
+
+	/**
+	 * @brief Forget streamed samples; call before starting a new background run.
+	 */
+	void resetStream();
+
+	/**
+	 * @brief Move the samples streamed by the background thread so far into the streamed vectors.
+	 *
+	 * Call from the listener's thread. Once the stream has dropped samples, the vectors are read
+	 * back from ngspice on every call instead, so they never hold rows at the wrong timestep.
+	 */
+	void drainStream();
+
+	/**
+	 * @brief Return the samples of a vector streamed so far, as of the last drainStream().
+	 * @param[in] vecName name of the vector, as ngspice reports it (case insensitive)
+	 * @return the values received so far, empty if the vector is unknown
+	 */
+	const std::vector<double> & streamedVector(const std::string& vecName);
+
 	/**
 	 * @brief Return optional error title if an error occurred.
 	 * @return optional error title if an error occurred
@@ -164,6 +225,11 @@ private:
 	static int SendInitDataFunc(pvecinfoall allVecInitInfo, int libId, void* userData);
 	static int BGThreadRunningFunc(bool notRunning, int libId, void* userData);
 
+	/**
+	 * @brief Queue a call to the listener unless one is already pending.
+	 */
+	void notifyListener();
+
 	/**
 	 * @brief Map for handles of ngspice library functions.
 	 *
@@ -184,7 +250,54 @@ private:
 	/**
 	 * @brief Flag that indicates if the ngspice library background thread is running.
 	 */
-	bool m_isBGThreadRunning;
+	std::atomic<bool> m_isBGThreadRunning;
+
+	/**
+	 * @brief Rows of vector values, pushed by SendDataFunc on the background thread.
+	 */
+	SampleRingBuffer m_samples;
+
+	/**
+	 * @brief Scratch row used by SendDataFunc.
+	 */
+	std::vector<double> m_row;
+
+	/**
+	 * @brief Vector names of the current plot, as sent by SendInitDataFunc.
+	 *
+	 * The layout is written by the background thread and read by drainStream(), both under m_layoutMutex.
+	 * m_layoutStart is the ring position of the first row in this layout.
+	 */
+	std::mutex m_layoutMutex;
+	std::vector<std::string> m_layoutNames;
+	std::size_t m_layoutStart = 0;
+	int m_layoutGeneration = 0;
+
+	/**
+	 * @brief Streamed vectors, owned by the thread calling drainStream().
+	 */
+	std::map<std::string, std::vector<double>> m_streamedVectors;
+	std::vector<std::string> m_streamedNames;
+	std::vector<double> m_drained;
+	std::size_t m_streamPosition = 0;
+	int m_streamGeneration = 0;
+	std::size_t m_droppedAtReset = 0;
+	bool m_streamReloaded = false;
+
+	/**
+	 * @brief Object and function to notify, and whether a notification is already queued.
+	 */
+	std::mutex m_listenerMutex;
+	QObject * m_listener = nullptr;
+	std::function<void()> m_listenerCallback;
+	std::atomic<bool> m_notifyPending;
+
+	/**
+	 * @brief Spans into ngspice's storage resolved since the last command, and copies of
+	 * vectors that are not streamed, taken while the background thread runs.
+	 */
+	std::map<std::string, VectorSpan> m_vectorSpans;
+	std::map<std::string, std::pair<std::size_t, std::vector<double>>> m_vectorCopies;
 
 	/**
 	 * @brief Current error title if an error occurred and otherwise std::nullopt.
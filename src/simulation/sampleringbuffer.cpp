@@ -0,0 +1,73 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2021-2022 Fritzing GmbH
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "sampleringbuffer.h"
+
+SampleRingBuffer::SampleRingBuffer(std::size_t capacity)
+	: m_head(0)
+	, m_tail(0)
+	, m_dropped(0) {
+	std::size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	m_values.resize(size);
+	m_mask = size - 1;
+}
+
+bool SampleRingBuffer::push(const double * values, std::size_t count) {
+	std::size_t head = m_head.load(std::memory_order_relaxed);
+	std::size_t tail = m_tail.load(std::memory_order_acquire);
+	if (m_values.size() - (head - tail) < count) {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	for (std::size_t i = 0; i < count; i++) {
+		m_values[(head + i) & m_mask] = values[i];
+	}
+	m_head.store(head + count, std::memory_order_release);
+	return true;
+}
+
+std::size_t SampleRingBuffer::pop(std::vector<double> & values) {
+	std::size_t tail = m_tail.load(std::memory_order_relaxed);
+	std::size_t head = m_head.load(std::memory_order_acquire);
+	values.reserve(values.size() + (head - tail));
+	for (std::size_t i = tail; i != head; i++) {
+		values.push_back(m_values[i & m_mask]);
+	}
+	m_tail.store(head, std::memory_order_release);
+	return head - tail;
+}
+
+std::size_t SampleRingBuffer::discard() {
+	std::size_t head = m_head.load(std::memory_order_acquire);
+	m_tail.store(head, std::memory_order_release);
+	return head;
+}
+
+std::size_t SampleRingBuffer::written() const {
+	return m_head.load(std::memory_order_acquire);
+}
+
+std::size_t SampleRingBuffer::dropped() const {
+	return m_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,84 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2021-2022 Fritzing GmbH
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SAMPLERINGBUFFER_H
+#define SAMPLERINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Lock-free single-producer, single-consumer ring of fixed-width sample rows.
+ *
+ * The ngspice background thread pushes one row per simulated point and the GUI thread pops them.
+ * Neither side ever waits: a row that does not fit is dropped and counted, so the consumer knows
+ * to fetch the full vectors another way.
+ */
+class SampleRingBuffer {
+public:
+	/**
+	 * @brief Create a ring holding at least capacity values.
+	 * @param[in] capacity number of doubles, rounded up to a power of two
+	 */
+	explicit SampleRingBuffer(std::size_t capacity = DefaultCapacity);
+
+	/**
+	 * @brief Producer side: append a row of values, or drop it if the ring is full.
+	 * @param[in] values first value of the row
+	 * @param[in] count number of values in the row
+	 * @return true if the row was stored
+	 */
+	bool push(const double * values, std::size_t count);
+
+	/**
+	 * @brief Consumer side: copy out everything written since the last pop.
+	 * @param[out] values values are appended here
+	 * @return number of values appended
+	 */
+	std::size_t pop(std::vector<double> & values);
+
+	/**
+	 * @brief Consumer side: drop everything written so far.
+	 * @return the position reading continues from, in values since the ring was created
+	 */
+	std::size_t discard();
+
+	/**
+	 * @brief Total number of values written so far; rows never straddle a read, so this marks a row boundary.
+	 */
+	std::size_t written() const;
+
+	/**
+	 * @brief Number of rows dropped because the ring was full.
+	 */
+	std::size_t dropped() const;
+
+	static constexpr std::size_t DefaultCapacity = 1 << 18;
+
+private:
+	std::vector<double> m_values;
+	std::size_t m_mask;
+	std::atomic<std::size_t> m_head;		// next value the producer writes
+	std::atomic<std::size_t> m_tail;		// next value the consumer reads
+	std::atomic<std::size_t> m_dropped;
+};
+
+#endif // SAMPLERINGBUFFER_H
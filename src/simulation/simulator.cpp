@@ -72,11 +72,20 @@ Simulator::Simulator(MainWindow *mainWindow) : QObject(mainWindow) {
 	m_showResultsTimer = new QTimer(this);
 	connect(m_showResultsTimer, &QTimer::timeout, this, &Simulator::showSimulationResults);
 
+	// Abort a simulation whose results do not arrive in time
+	m_simTimeOutTimer = new QTimer(this);
+	m_simTimeOutTimer->setSingleShot(true);
+	m_simTimeOutTimer->setInterval(SimTimeOut);
+	connect(m_simTimeOutTimer, &QTimer::timeout, this, &Simulator::simulationTimedOut);
+
 	enable(true);
 	m_simulating = false;
 }
 
 Simulator::~Simulator() {
+	if (m_simulator) {
+		m_simulator->setListener(nullptr, nullptr);
+	}
 }
 
 /**
@@ -88,10 +97,29 @@ Simulator::~Simulator() {
 void Simulator::triggerSimulation()
 {
 	if(m_simulating) {
+		dropPendingResults();
 		resetTimer();
 	}
 }
 
+/**
+ * The circuit has changed, so results still on their way (or still being animated) refer to parts
+ * that may no longer exist: itemBases is only refilled by the next simulate(). Stop listening for them,
+ * halt the background run, and forget the parts.
+ */
+void Simulator::dropPendingResults() {
+	m_showResultsTimer->stop();
+	if (m_waitingForResults) {
+		m_simTimeOutTimer->stop();
+		m_waitingForResults = false;
+		if (m_simulator && m_simulator->isBGThreadRunning()) {
+			m_simulator->command("bg_halt");
+		}
+	}
+	itemBases.clear();
+	m_sch2bbItemHash.clear();
+}
+
 /**
  * This function resets the timer of the simulation, which triggers a simulation after
  * the timeout. Several commands can trigger the simulation, and each of them will reset
@@ -152,6 +180,8 @@ void Simulator::startSimulation()
  */
 void Simulator::stopSimulation() {
 	m_showResultsTimer->stop();
+	m_simTimeOutTimer->stop();
+	m_waitingForResults = false;
 	m_simulating = false;
 	removeSimItems();
 	emit simulationStartedOrStopped(m_simulating);
@@ -169,7 +199,7 @@ void Simulator::stopSimulation() {
  * - Runs a operating point analysis in a background thread
  * - Remove all previous items placed by the simulator (smokes, messages in the multimeters, etc.)
  * - Grey out the parts that are not being simulated
- * - Wait until the simulation has finished (timeout of 3s)
+ * - Return to the event loop; simulationDataAvailable() continues once results arrive (timeout of 3s)
  * - Iterate for all parts being simulated to
  *     - Check if they work within specifications, add smoke if needed
  *     - Update display messages in the multimeters
@@ -183,10 +213,13 @@ void Simulator::simulate() {
 		DebugDialog::stream() << "The simulator is not enabled or simulating";
 		return;
 	}
+	m_simTimeOutTimer->stop();
+	m_waitingForResults = false;
 
 	m_simulator = NgSpiceSimulator::getInstance();
 	try {
 		m_simulator->init();
+		m_simulator->setListener(this, [this]() { simulationDataAvailable(); });
 	}
 	catch (std::exception& e) {
 		FMessageBox::warning(nullptr, tr("Simulator Error"), tr("An error occurred when starting the simulation."));
@@ -295,6 +328,7 @@ void Simulator::simulate() {
 	DebugDialog::stream() << "-----------------------------------";
 	DebugDialog::stream() << "Running m_simulator->command(bg_run):";
 	m_simulator->resetIsBGThreadRunning();
+	m_simulator->resetStream();
 	m_elapsedAnimationTimer.start();
 	m_elapsedSimTotalTimer.start();
 	m_simulator->command("bg_run");
@@ -311,6 +345,12 @@ void Simulator::simulate() {
 			m_connector2netHash.insert(ci, i);
 		}
 	}
+
+	//Delete the pointers
+	foreach (QList<ConnectorItem *> * net, netList) {
+		delete net;
+	}
+	netList.clear();
 	DebugDialog::stream() << "-----------------------------------";
 	DebugDialog::stream() << "Generating a hash table to find the breadboard parts from parts in the schematic view:";
 
@@ -341,25 +381,32 @@ void Simulator::simulate() {
 	DebugDialog::stream() << "-----------------------------------";
 
 	DebugDialog::stream() << "Waiting for simulator thread to stop";
-	int elapsedTime = 0, simTimeOut = 3000; // in ms
-	while (m_simulator->isBGThreadRunning() && elapsedTime < simTimeOut) {
-		auto timeInfo = m_simulator->getVecInfo(QString("time").toStdString());
-		QThread::usleep(100);
-		elapsedTime++;
-		//If this a transitory simulation and we have partial results, start the animation
-		if (m_simEndTime > 0 && timeInfo.size() > 0)
-			break;
-	}
-	DebugDialog::stream() << "-------- SIM END or TRANS SIM WITH PARTIAL RESULTS ------------";
+	//The simulator notifies us through simulationDataAvailable() as results arrive
+	m_spiceNetlist = spiceNetlist;
+	m_waitingForResults = true;
+	m_simTimeOutTimer->start();
+	simulationDataAvailable();
+}
 
-	if (elapsedTime >= simTimeOut) {
-		m_simulator->command("bg_halt");
-		stopSimulation();
-		FMessageBox::warning(m_mainWindow, tr("Simulator Timeout"), tr("The spice simulator did not finish after %1 ms. Aborting simulation.").arg(simTimeOut));
-		return;
-	} else {
-		DebugDialog::stream() << "The spice simulator has finished. ElapsedTime: " << m_elapsedAnimationTimer.elapsed() <<std::endl;
-	}
+/**
+ * Called on the GUI thread whenever ngspice has streamed new results or its background thread stopped.
+ * Once the simulation has finished, or a transient simulation has partial results, checks for errors,
+ * updates the parts and starts the animation.
+ */
+void Simulator::simulationDataAvailable() {
+	if (!m_simulator) return;
+
+	m_simulator->drainStream();
+	if (!m_waitingForResults) return;
+
+	//If this a transitory simulation and we have partial results, start the animation
+	bool partialResults = m_simEndTime > 0 && m_simulator->streamedVector("time").size() > 0;
+	if (m_simulator->isBGThreadRunning() && !partialResults) return;
+
+	m_simTimeOutTimer->stop();
+	m_waitingForResults = false;
+	DebugDialog::stream() << "-------- SIM END or TRANS SIM WITH PARTIAL RESULTS ------------";
+	DebugDialog::stream() << "The spice simulator has finished. ElapsedTime: " << m_elapsedAnimationTimer.elapsed() <<std::endl;
 	DebugDialog::stream() << "-----------------------------------";
 
 	if (m_simulator->errorOccured() ||
@@ -369,7 +416,7 @@ void Simulator::simulate() {
 		removeSimItems();
 		QString errorHint = tr("The simulator gave an error when trying to simulate this circuit. "
 								"Please, check the wiring and try again.");
-		showSimulatorError(nullptr, errorHint, spiceNetlist, m_simulator);
+		showSimulatorError(nullptr, errorHint, m_spiceNetlist, m_simulator);
 		stopSimulation();
 		return;
 	}
@@ -377,14 +424,6 @@ void Simulator::simulate() {
 
 	//m_simulator->command("bg_halt");
 
-	//Delete the pointers
-	foreach (QList<ConnectorItem *> * net, netList) {
-		delete net;
-	}
-	netList.clear();
-
-
-
 	//The spice simulation has finished, iterate over each part being simulated and update it (if it is necessary).
 	updateParts(itemBases, 0);
 
@@ -396,6 +435,15 @@ void Simulator::simulate() {
 
 }
 
+void Simulator::simulationTimedOut() {
+	if (!m_waitingForResults) return;
+
+	m_waitingForResults = false;
+	m_simulator->command("bg_halt");
+	stopSimulation();
+	FMessageBox::warning(m_mainWindow, tr("Simulator Timeout"), tr("The spice simulator did not finish after %1 ms. Aborting simulation.").arg(SimTimeOut));
+}
+
 
 void Simulator::showSimulatorError(QWidget* parent, const QString& errorHint, const QString& spiceNetlist, const std::shared_ptr<NgSpiceSimulator>& simulator) {
 	FMessageBox* msgBox = FMessageBox::createCustom(
@@ -419,7 +467,8 @@ void Simulator::showSimulatorError(QWidget* parent, const QString& errorHint, co
 
 void Simulator::showSimulationResults() {
 	//Check that we have the sim results for this time step
-	auto timeInfo = m_simulator->getVecInfo(QString("time").toStdString());
+	m_simulator->drainStream();
+	const auto & timeInfo = m_simulator->streamedVector("time");
 	auto elapsedAnimationTime = m_elapsedAnimationTimer.elapsed();
 	m_elapsedAnimationTimer.restart();
 
@@ -730,14 +779,7 @@ void Simulator::removeSimItems(QList<QGraphicsItem *> items) {
  * @returns the first vector element or the given default value
  */
 double Simulator::getVectorValueOrDefault(unsigned long timeStep, const std::string & vecName, double defaultValue) {
-	auto vecInfo = m_simulator->getVecInfo(vecName);
-	if (vecInfo.empty()) {
-		return defaultValue;
-	} else {
-		if (timeStep < 0 || timeStep >= vecInfo.size())
-			return defaultValue;
-		return vecInfo[timeStep];
-	}
+	return m_simulator->vectorSpan(vecName).valueOr(timeStep, defaultValue);
 }
 
 /**
@@ -757,33 +799,35 @@ double Simulator::calculateVoltage(unsigned long timeStep, ConnectorItem * c0, C
 
 	double volt0 = 0.0, volt1 = 0.0;
 	if (net0 != 0) {
-		auto vecInfo = m_simulator->getVecInfo(net0str.toStdString());
+		auto vecInfo = m_simulator->vectorSpan(net0str.toStdString());
 		if (vecInfo.empty()) return 0.0;
-		volt0 = vecInfo[timeStep];
+		volt0 = vecInfo.valueOr(timeStep, 0.0);
 	}
 	if (net1 != 0) {
-		auto vecInfo = m_simulator->getVecInfo(net1str.toStdString());
+		auto vecInfo = m_simulator->vectorSpan(net1str.toStdString());
 		if (vecInfo.empty()) return 0.0;
-		volt1 = vecInfo[timeStep];
+		volt1 = vecInfo.valueOr(timeStep, 0.0);
 	}
 	return volt0-volt1;
 }
 
-std::vector<double> Simulator::voltageVector(ConnectorItem * c0) {
+NgSpiceSimulator::VectorSpan Simulator::voltageVector(ConnectorItem * c0) {
 	int net0 = m_connector2netHash.value(c0);
 	QString net0str = QString("v(%1)").arg(net0);
 
 	if (net0 != 0) {
-		return m_simulator->getVecInfo(net0str.toStdString());
+		return m_simulator->vectorSpan(net0str.toStdString());
 	}
 
 	//This is the ground (node 0), return a vector with 0s, same size as the time vector
-	auto timeInfo = m_simulator->getVecInfo(QString("time").toStdString());
-	std::vector<double> voltageVector(timeInfo.size(), 0.0);
-	return voltageVector;
+	std::size_t timeSteps = m_simulator->vectorSpan("time").size;
+	if (m_groundVector.size() < timeSteps) {
+		m_groundVector.resize(timeSteps, 0.0);
+	}
+	return NgSpiceSimulator::VectorSpan{m_groundVector.data(), timeSteps};
 }
 
-QString Simulator::generateSvgPath(std::vector<double> proveVector, std::vector<double> comVector, int currTimeStep, QString nameId, double simStartTime, double simTimeStep, double timePos, double timeScale, double verticalScale, double verOffset, double screenHeight, double screenWidth, QString color, QString strokeWidth ) {
+QString Simulator::generateSvgPath(const NgSpiceSimulator::VectorSpan & proveVector, const NgSpiceSimulator::VectorSpan & comVector, int currTimeStep, QString nameId, double simStartTime, double simTimeStep, double timePos, double timeScale, double verticalScale, double verOffset, double screenHeight, double screenWidth, QString color, QString strokeWidth ) {
 	if(m_debugSimResult) {
 		DebugDialog::stream() << "OSCILLOSCOPE: pos " << timePos << ", timeScale: " << timeScale;
 		DebugDialog::stream() << "OSCILLOSCOPE: VOLTAGE VALUES " << nameId.toStdString() << ": ";
@@ -799,7 +843,7 @@ QString Simulator::generateSvgPath(std::vector<double> proveVector, std::vector<
 	double vScale = -1*verticalScale;
 	double y_0 = screenOffset + screenHeight/2; // the center of the screen
 
-	int points = std::min( proveVector.size(), comVector.size() );
+	int points = std::min( proveVector.size, comVector.size );
 	double oscEndTime = timePos + timeScale * 10;
 	double nSampleInScreen = (oscEndTime - timePos)/simTimeStep + 1;
 	double horScale = screenWidth/(nSampleInScreen-1);
@@ -1606,16 +1650,19 @@ void Simulator::updateOscilloscope(unsigned long timeStep, ItemBase * part) {
 
 		//Get the signal and com voltages
 		auto v = voltageVector(probesArray[channel]);
-		std::vector<double> vCom(v.size(), 0.0);
+		NgSpiceSimulator::VectorSpan vCom;
+		std::vector<double> noise;
 		if (!comProbe->connectedToWires()) {
 			//There is no com probe connected, we need to generate noise
 			std::random_device rd;
 			std::mt19937 gen(rd());
 			std::normal_distribution<> dist(0.0, voltsDiv[channel]);
 			// Generate random doubles and fill the vector
-			for(auto& val : vCom) {
+			noise.resize(v.size);
+			for(auto& val : noise) {
 				val = dist(gen);
 			}
+			vCom = NgSpiceSimulator::VectorSpan{noise.data(), noise.size()};
 		} else {
 			vCom = voltageVector(comProbe);
 		}
@@ -45,12 +45,14 @@ private:
 	void resetTimer();
 
 	void showSimulatorError(QWidget *parent, const QString &errorHint, const QString &spiceNetlist, const std::shared_ptr<NgSpiceSimulator>& simulator);
+	void simulationDataAvailable();
 public slots:
 	void enable(bool);
 	void enableTransientSimulation(bool);
 	void stopSimulation();
 	void startSimulation();
 	void showSimulationResults();
+	void simulationTimedOut();
 
 
 signals:
@@ -59,6 +61,7 @@ signals:
 
 protected:
 	void updateParts(QSet<ItemBase *>, int);
+	void dropPendingResults();
 	void drawSmoke(ItemBase* part);
 	void updateMultimeterScreen(ItemBase *, QString);
 	void updateLabPowerSupplyScreen(ItemBase *, double, double);
@@ -74,8 +77,8 @@ protected:
 	QString getSymbol(ItemBase*, QString);
 	double getVectorValueOrDefault(unsigned long timeStep, const std::string & vecName,  double defaultValue);
 	double calculateVoltage(unsigned long, ConnectorItem *, ConnectorItem *);
-	std::vector<double> voltageVector(ConnectorItem *);
-	QString generateSvgPath(std::vector<double>, std::vector<double>, int, QString, double, double, double, double, double, double, double, double, QString, QString);
+	NgSpiceSimulator::VectorSpan voltageVector(ConnectorItem *);
+	QString generateSvgPath(const NgSpiceSimulator::VectorSpan &, const NgSpiceSimulator::VectorSpan &, int, QString, double, double, double, double, double, double, double, double, QString, QString);
 	double getCurrent(unsigned long, ItemBase*, QString subpartName="");
 	double getTransistorCurrent(unsigned long timeStep, QString spicePartName, TransistorLeg leg);
 	double getPower(unsigned long, ItemBase*, QString subpartName="");
@@ -106,14 +109,18 @@ protected:
 	QSet<ItemBase *> itemBases;
 	QHash<ItemBase *, ItemBase *> m_sch2bbItemHash;
 	QHash<ConnectorItem *, int> m_connector2netHash;
+	std::vector<double> m_groundVector;
 
-	QTimer *m_simTimer, *m_showResultsTimer;
+	QTimer *m_simTimer, *m_showResultsTimer, *m_simTimeOutTimer;
+	bool m_waitingForResults = false;
+	QString m_spiceNetlist;
 	unsigned long m_currSimStep, m_previousRenderedStep;
 	double m_showResultsTimerInterval;
 	QElapsedTimer m_elapsedAnimationTimer;
 	QElapsedTimer m_elapsedSimTotalTimer;
 
 	static constexpr int SimDelay = 200;
+	static constexpr int SimTimeOut = 3000; // in ms
 	static constexpr double HarmfulNegativeVoltage = -0.5;
 
 };
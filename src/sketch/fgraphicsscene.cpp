@@ -23,7 +23,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QToolTip>
 
-FGraphicsScene::FGraphicsScene( QObject * parent) : QGraphicsScene(parent)
+FGraphicsScene::FGraphicsScene( QObject * parent) : QGraphicsScene(parent), m_netConnectivity(m_connectorItemGraph)
 {
 	m_displayHandles = true;
 	//setItemIndexMethod(QGraphicsScene::NoIndex);
@@ -87,3 +87,111 @@ QList<ItemBase *> FGraphicsScene::lockedSelectedItems() {
 	}
 	return items;
 }
+
+void FGraphicsScene::addConnectorItem(ConnectorItem * connectorItem) {
+	m_connectorItems.insert(connectorItem);
+	m_dirtyConnectorItems.insert(connectorItem);
+	m_netConnectivity.addConnectorItem(connectorItem);
+}
+
+void FGraphicsScene::removeConnectorItem(ConnectorItem * connectorItem) {
+	m_connectorItems.remove(connectorItem);
+	m_dirtyConnectorItems.remove(connectorItem);
+	m_legConnectorItems.remove(connectorItem);
+	m_connectorGrid.remove(connectorItem);
+	m_netConnectivity.removeConnectorItem(connectorItem);
+}
+
+NetConnectivity & FGraphicsScene::netConnectivity() {
+	return m_netConnectivity;
+}
+
+void FGraphicsScene::connectorItemChanged(ConnectorItem * connectorItem) {
+	if (m_connectorItems.contains(connectorItem)) {
+		m_dirtyConnectorItems.insert(connectorItem);
+	}
+}
+
+void FGraphicsScene::itemGeometryChanged(ItemBase * itemBase) {
+	// called for every step of a drag, so just note it; the grid catches up on the next lookup
+	if (!m_movedItems.contains(itemBase)) {
+		m_movedItems.insert(itemBase, itemBase);
+	}
+}
+
+void FGraphicsScene::updateConnectorGrid() {
+	for (auto it = m_movedItems.cbegin(); it != m_movedItems.cend(); ++it) {
+		if (it.value().isNull()) continue;
+
+		Q_FOREACH (QGraphicsItem * child, it.value()->childItems()) {
+			auto * connectorItem = dynamic_cast<ConnectorItem *>(child);
+			if (connectorItem != nullptr && m_connectorItems.contains(connectorItem)) {
+				m_dirtyConnectorItems.insert(connectorItem);
+			}
+		}
+	}
+	m_movedItems.clear();
+
+	Q_FOREACH (ConnectorItem * connectorItem, m_dirtyConnectorItems) {
+		if (connectorItem->hasRubberBandLeg()) {
+			m_connectorGrid.remove(connectorItem);
+			m_legConnectorItems.insert(connectorItem);
+		}
+		else {
+			m_legConnectorItems.remove(connectorItem);
+			m_connectorGrid.insert(connectorItem, connectorItem->sceneBoundingRect());
+		}
+	}
+	m_dirtyConnectorItems.clear();
+}
+
+bool FGraphicsScene::isHittable(ConnectorItem * connectorItem) {
+	// same visibility rule QGraphicsScene::items() applies
+	return connectorItem->isVisible() && (connectorItem->effectiveOpacity() >= 0.001 || !connectorItem->childItems().isEmpty());
+}
+
+QList<ConnectorItem *> FGraphicsScene::connectorItemsAt(const QPointF & scenePos) {
+	updateConnectorGrid();
+
+	QList<ConnectorItem *> connectorItems;
+	Q_FOREACH (QGraphicsItem * item, m_connectorGrid.items(scenePos)) {
+		auto * connectorItem = static_cast<ConnectorItem *>(item);
+		if (!isHittable(connectorItem)) continue;
+		if (!connectorItem->contains(connectorItem->mapFromScene(scenePos))) continue;
+
+		connectorItems.append(connectorItem);
+	}
+	Q_FOREACH (ConnectorItem * connectorItem, m_legConnectorItems) {
+		if (!isHittable(connectorItem)) continue;
+		if (!connectorItem->sceneBoundingRect().contains(scenePos)) continue;
+		if (!connectorItem->contains(connectorItem->mapFromScene(scenePos))) continue;
+
+		connectorItems.append(connectorItem);
+	}
+	return connectorItems;
+}
+
+QList<ConnectorItem *> FGraphicsScene::connectorItemsIn(const QPolygonF & scenePolygon) {
+	updateConnectorGrid();
+
+	QPainterPath path;
+	path.addPolygon(scenePolygon);
+	path.closeSubpath();
+	QRectF bounds = scenePolygon.boundingRect();
+
+	QList<ConnectorItem *> connectorItems;
+	Q_FOREACH (QGraphicsItem * item, m_connectorGrid.items(bounds)) {
+		auto * connectorItem = static_cast<ConnectorItem *>(item);
+		if (!isHittable(connectorItem)) continue;
+		if (!connectorItem->collidesWithPath(connectorItem->mapFromScene(path), Qt::IntersectsItemShape)) continue;
+
+		connectorItems.append(connectorItem);
+	}
+	Q_FOREACH (ConnectorItem * connectorItem, m_legConnectorItems) {
+		if (!isHittable(connectorItem)) continue;
+		if (!connectorItem->collidesWithPath(connectorItem->mapFromScene(path), Qt::IntersectsItemShape)) continue;
+
+		connectorItems.append(connectorItem);
+	}
+	return connectorItems;
+}
@@ -24,7 +24,12 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QGraphicsScene>
 #include <QPainter>
 #include <QGraphicsSceneHelpEvent>
+#include <QPointer>
+#include <QSet>
 #include "../items/itembase.h"
+#include "itemgrid.h"
+#include "../connectors/connectoritemgraph.h"
+#include "../connectors/netconnectivity.h"
 
 class FGraphicsScene : public QGraphicsScene
 {
@@ -39,9 +44,29 @@ public:
 	bool displayHandles();
 	QList<ItemBase *> lockedSelectedItems();
 
+	// connector lookup for hover and drop detection, kept up to date as items move
+	void addConnectorItem(ConnectorItem *);
+	void removeConnectorItem(ConnectorItem *);
+	void connectorItemChanged(ConnectorItem *);
+	void itemGeometryChanged(ItemBase *);
+	QList<ConnectorItem *> connectorItemsAt(const QPointF & scenePos);
+	QList<ConnectorItem *> connectorItemsIn(const QPolygonF & scenePolygon);
+	NetConnectivity & netConnectivity();
+
+protected:
+	void updateConnectorGrid();
+	static bool isHittable(ConnectorItem *);
+
 protected:
 	QPointF m_lastContextMenuPos;
 	bool m_displayHandles;
+	ItemGrid m_connectorGrid;
+	QSet<ConnectorItem *> m_connectorItems;
+	QSet<ConnectorItem *> m_dirtyConnectorItems;
+	QSet<ConnectorItem *> m_legConnectorItems;		// rubber-band legs reshape without moving, so every query checks them
+	QHash<ItemBase *, QPointer<ItemBase> > m_movedItems;
+	ConnectorItemGraph m_connectorItemGraph;
+	NetConnectivity m_netConnectivity;
 
 };
 
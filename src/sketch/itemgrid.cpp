@@ -0,0 +1,183 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "itemgrid.h"
+
+#include <QSet>
+#include <cmath>
+
+ItemGrid::ItemGrid(double cellSize) : m_cellSize(cellSize > 0 ? cellSize : DefaultCellSize)
+{
+}
+
+void ItemGrid::insert(QGraphicsItem * item, const QRectF & sceneRect)
+{
+	auto it = m_rects.find(item);
+	if (it != m_rects.end()) {
+		if (it.value() == sceneRect) return;
+
+		removeFromCells(item, it.value());
+		it.value() = sceneRect;
+	}
+	else {
+		m_rects.insert(item, sceneRect);
+	}
+	addToCells(item, sceneRect);
+}
+
+void ItemGrid::remove(QGraphicsItem * item)
+{
+	auto it = m_rects.find(item);
+	if (it == m_rects.end()) return;
+
+	removeFromCells(item, it.value());
+	m_rects.erase(it);
+}
+
+void ItemGrid::clear()
+{
+	m_cells.clear();
+	m_rects.clear();
+	m_large.clear();
+}
+
+bool ItemGrid::contains(QGraphicsItem * item) const
+{
+	return m_rects.contains(item);
+}
+
+QRectF ItemGrid::rect(QGraphicsItem * item) const
+{
+	return m_rects.value(item);
+}
+
+int ItemGrid::count() const
+{
+	return m_rects.count();
+}
+
+double ItemGrid::cellSize() const
+{
+	return m_cellSize;
+}
+
+QList<QGraphicsItem *> ItemGrid::items(const QPointF & scenePos) const
+{
+	QList<QGraphicsItem *> result;
+	Q_FOREACH (QGraphicsItem * item, m_cells.value(cellKey(cellIndex(scenePos.x()), cellIndex(scenePos.y())))) {
+		const QRectF & r = m_rects.find(item).value();
+		if (scenePos.x() >= r.left() && scenePos.x() <= r.right() && scenePos.y() >= r.top() && scenePos.y() <= r.bottom()) {
+			result.append(item);
+		}
+	}
+	Q_FOREACH (QGraphicsItem * item, m_large) {
+		const QRectF & r = m_rects.find(item).value();
+		if (scenePos.x() >= r.left() && scenePos.x() <= r.right() && scenePos.y() >= r.top() && scenePos.y() <= r.bottom()) {
+			result.append(item);
+		}
+	}
+	return result;
+}
+
+QList<QGraphicsItem *> ItemGrid::items(const QRectF & sceneRect) const
+{
+	QRectF query = sceneRect.normalized();
+	int x0 = cellIndex(query.left());
+	int x1 = cellIndex(query.right());
+	int y0 = cellIndex(query.top());
+	int y1 = cellIndex(query.bottom());
+
+	// an item spanning several cells is listed in each of them
+	QSet<QGraphicsItem *> already;
+	bool oneCell = (x0 == x1) && (y0 == y1);
+	QList<QGraphicsItem *> result;
+	for (int x = x0; x <= x1; x++) {
+		for (int y = y0; y <= y1; y++) {
+			auto it = m_cells.find(cellKey(x, y));
+			if (it == m_cells.end()) continue;
+
+			Q_FOREACH (QGraphicsItem * item, it.value()) {
+				const QRectF & r = m_rects.find(item).value();
+				if (r.left() > query.right() || r.right() < query.left() || r.top() > query.bottom() || r.bottom() < query.top()) continue;
+				if (!oneCell) {
+					if (already.contains(item)) continue;
+					already.insert(item);
+				}
+				result.append(item);
+			}
+		}
+	}
+	Q_FOREACH (QGraphicsItem * item, m_large) {
+		const QRectF & r = m_rects.find(item).value();
+		if (r.left() > query.right() || r.right() < query.left() || r.top() > query.bottom() || r.bottom() < query.top()) continue;
+		result.append(item);
+	}
+	return result;
+}
+
+int ItemGrid::cellIndex(double coordinate) const
+{
+	return static_cast<int>(std::floor(coordinate / m_cellSize));
+}
+
+quint64 ItemGrid::cellKey(int x, int y)
+{
+	return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+void ItemGrid::addToCells(QGraphicsItem * item, const QRectF & r)
+{
+	int x0 = cellIndex(r.left());
+	int x1 = cellIndex(r.right());
+	int y0 = cellIndex(r.top());
+	int y1 = cellIndex(r.bottom());
+	if ((static_cast<qint64>(x1 - x0 + 1) * (y1 - y0 + 1)) > MaxCellsPerItem) {
+		m_large.append(item);
+		return;
+	}
+
+	for (int x = x0; x <= x1; x++) {
+		for (int y = y0; y <= y1; y++) {
+			m_cells[cellKey(x, y)].append(item);
+		}
+	}
+}
+
+void ItemGrid::removeFromCells(QGraphicsItem * item, const QRectF & r)
+{
+	int x0 = cellIndex(r.left());
+	int x1 = cellIndex(r.right());
+	int y0 = cellIndex(r.top());
+	int y1 = cellIndex(r.bottom());
+	if ((static_cast<qint64>(x1 - x0 + 1) * (y1 - y0 + 1)) > MaxCellsPerItem) {
+		m_large.removeOne(item);
+		return;
+	}
+
+	for (int x = x0; x <= x1; x++) {
+		for (int y = y0; y <= y1; y++) {
+			auto it = m_cells.find(cellKey(x, y));
+			if (it == m_cells.end()) continue;
+
+			it.value().removeOne(item);
+			if (it.value().isEmpty()) m_cells.erase(it);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef ITEMGRID_H
+#define ITEMGRID_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+
+class QGraphicsItem;
+
+// A uniform grid over scene rects, for finding the few items near a point without asking the scene
+// for everything under it. The grid only stores the rects it was given; callers re-insert an item
+// when it moves and do any exact hit testing themselves.
+
+class ItemGrid
+{
+public:
+	ItemGrid(double cellSize = DefaultCellSize);
+
+	void insert(QGraphicsItem *, const QRectF & sceneRect);		// also moves an item already in the grid
+	void remove(QGraphicsItem *);
+	void clear();
+	bool contains(QGraphicsItem *) const;
+	QRectF rect(QGraphicsItem *) const;
+	int count() const;
+	double cellSize() const;
+
+	QList<QGraphicsItem *> items(const QPointF & scenePos) const;
+	QList<QGraphicsItem *> items(const QRectF & sceneRect) const;
+
+public:
+	static constexpr double DefaultCellSize = 32;		// a few breadboard holes, in pixels
+	static constexpr int MaxCellsPerItem = 256;		// bigger items go on a list that every query checks
+
+protected:
+	int cellIndex(double coordinate) const;
+	static quint64 cellKey(int x, int y);
+	void addToCells(QGraphicsItem *, const QRectF &);
+	void removeFromCells(QGraphicsItem *, const QRectF &);
+
+protected:
+	double m_cellSize;
+	QHash<quint64, QList<QGraphicsItem *> > m_cells;
+	QHash<QGraphicsItem *, QRectF> m_rects;
+	QList<QGraphicsItem *> m_large;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "routingnetcache.h"
+
+RoutingNetCache::RoutingNetCache()
+{
+	m_total.zero();
+}
+
+void RoutingNetCache::clear()
+{
+	m_netOf.clear();
+	m_nets.clear();
+	m_total.zero();
+}
+
+void RoutingNetCache::retire(ConnectorItem * connectorItem, QList<ConnectorItem *> & members)
+{
+	int net = m_netOf.value(connectorItem, -1);
+	if (net < 0) return;
+
+	RoutingNet routingNet = m_nets.take(net);
+	m_total -= routingNet.routingStatus;
+	Q_FOREACH (ConnectorItem * ci, routingNet.connectorItems) {
+		// a deleted connector's address may have been reused by a connector in a newer net
+		if (m_netOf.value(ci, -1) == net) {
+			m_netOf.remove(ci);
+		}
+		members.append(ci);
+	}
+}
+
+void RoutingNetCache::score(const QList<ConnectorItem *> & seeds, QSet<ConnectorItem *> & visited, const ContainsFunction & contains, const ScoreFunction & scoreFunction)
+{
+	// a net may swallow other cached nets, e.g. a second ground symbol joins them through a bus while only the
+	// edited item's own connectors were reported as changed; members of those that end up elsewhere go on the worklist
+	QList<ConnectorItem *> work = seeds;
+	for (int i = 0; i < work.count(); i++) {
+		ConnectorItem * connectorItem = work.at(i);
+		if (visited.contains(connectorItem) || !contains(connectorItem)) continue;
+
+		QList<ConnectorItem *> net;
+		RoutingStatus routingStatus;
+		routingStatus.zero();
+		bool scored = scoreFunction(connectorItem, net, routingStatus);
+		visited.insert(connectorItem);
+		Q_FOREACH (ConnectorItem * ci, net) {
+			visited.insert(ci);
+		}
+		Q_FOREACH (ConnectorItem * ci, net) {
+			retire(ci, work);
+		}
+		if (!scored) continue;
+
+		int index = m_nextNet++;
+		RoutingNet routingNet;
+		routingNet.routingStatus = routingStatus;
+		routingNet.connectorItems = net;
+		Q_FOREACH (ConnectorItem * ci, net) {
+			m_netOf.insert(ci, index);
+		}
+		m_total += routingStatus;
+		m_nets.insert(index, routingNet);
+	}
+}
+
+const RoutingStatus & RoutingNetCache::total() const
+{
+	return m_total;
+}
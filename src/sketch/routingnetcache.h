@@ -0,0 +1,66 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef ROUTINGNETCACHE_H
+#define ROUTINGNETCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <functional>
+
+#include "../routingstatus.h"
+
+class ConnectorItem;
+
+// The routing score of each net of a sketch, so an edit only re-scores the nets it touched.
+// Connectors are only used as keys; cached ones may have been deleted since.
+
+class RoutingNetCache
+{
+public:
+	// collects the connectors connectorItem stands for into net, and scores them; false leaves the net out of the cache
+	typedef std::function<bool (ConnectorItem * connectorItem, QList<ConnectorItem *> & net, RoutingStatus &)> ScoreFunction;
+	// whether a connector is still in the sketch
+	typedef std::function<bool (ConnectorItem *)> ContainsFunction;
+
+	RoutingNetCache();
+
+	void clear();
+	// drops the cached net connectorItem is in, and appends its members
+	void retire(ConnectorItem * connectorItem, QList<ConnectorItem *> & members);
+	// scores and caches the net of each seed not yet visited
+	void score(const QList<ConnectorItem *> & seeds, QSet<ConnectorItem *> & visited, const ContainsFunction &, const ScoreFunction &);
+	const RoutingStatus & total() const;
+
+protected:
+	struct RoutingNet {
+		RoutingStatus routingStatus;
+		QList<ConnectorItem *> connectorItems;
+	};
+
+	QHash<ConnectorItem *, int> m_netOf;
+	QHash<int, RoutingNet> m_nets;
+	int m_nextNet = 0;
+	RoutingStatus m_total;				// sum over m_nets
+};
+
+#endif
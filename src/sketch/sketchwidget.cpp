@@ -6973,82 +6973,49 @@ void SketchWidget::updateRoutingStatus(RoutingStatus & routingStatus, bool manua
 	//	.arg(m_ratsnestUpdateDisconnect.count())
 	//	);
 
-	// TODO: think about ways to optimize this...
+	NetConnectivity & netConnectivity = qobject_cast<FGraphicsScene *>(scene())->netConnectivity();
+	QSet<ConnectorItem *> changed;
+	bool allChanged = netConnectivity.takeChanged(changed);
 
-	QList< QPointer<VirtualWire> > ratsToDelete;
+	QSet<ConnectorItem *> ratsnestUpdate;
+	Q_FOREACH (ConnectorItem * ci, m_ratsnestUpdateConnect) {
+		if (ci) ratsnestUpdate.insert(ci);
+	}
+	Q_FOREACH (ConnectorItem * ci, m_ratsnestUpdateDisconnect) {
+		if (ci) ratsnestUpdate.insert(ci);
+	}
 
+	QList< QPointer<VirtualWire> > ratsToDelete;
 	QList< QList<ConnectorItem *> > ratnestsToUpdate;
-	QList<ConnectorItem *> visited;
-	Q_FOREACH (QGraphicsItem * item, scene()->items()) {
-		auto * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItem) continue;
-		if (visited.contains(connectorItem)) continue;
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    connectorItem->debugInfo("testing urs");
-		//}
-
-		auto * vw = qobject_cast<VirtualWire *>(connectorItem->attachedTo());
-		if (vw) {
-			if (vw->connector0()->connectionsCount() == 0 || vw->connector1()->connectionsCount() == 0) {
-				ratsToDelete.append(vw);
-			}
-			visited << vw->connector0() << vw->connector1();
-			continue;
-		}
-
-
-		QList<ConnectorItem *> connectorItems;
-		connectorItems.append(connectorItem);
-		ConnectorItem::collectEqualPotential(connectorItems, true, ViewGeometry::RatsnestFlag);
-		visited.append(connectorItems);
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//	DebugDialog::debug("________________________");
-		//	foreach (ConnectorItem * ci, connectorItems) ci->debugInfo("cep");
-		//}
-
-		bool doRatsnest = manual || checkUpdateRatsnest(connectorItems);
-		if (!doRatsnest && connectorItems.count() <= 1) continue;
-
-		QList<ConnectorItem *> partConnectorItems;
-		ConnectorItem::collectParts(connectorItems, partConnectorItems, includeSymbols(), ViewLayer::NewTopAndBottom);
-		if (partConnectorItems.count() < 1) continue;
-		if (!doRatsnest && partConnectorItems.count() <= 1) continue;
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    DebugDialog::debug("________________________");
-		//    foreach (ConnectorItem * pci, partConnectorItems) {
-		//		pci->debugInfo("pc 1");
-		//	}
-		//}
-
-		for (int i = partConnectorItems.count() - 1; i >= 0; i--) {
-			ConnectorItem * ci = partConnectorItems[i];
-
-			if (!ci->attachedTo()->isEverVisible()) {
-				partConnectorItems.removeAt(i);
-			}
+	QSet<ConnectorItem *> visited;
+	RoutingNetCache::ContainsFunction contains = [&netConnectivity](ConnectorItem * connectorItem) {
+		// deleted connectors are only keys; the engine knows which ones are still in the scene
+		return netConnectivity.contains(connectorItem);
+	};
+	RoutingNetCache::ScoreFunction score = [&](ConnectorItem * connectorItem, QList<ConnectorItem *> & net, RoutingStatus & netStatus) {
+		return scoreRoutingNet(connectorItem, manual, ratsnestUpdate, ratsToDelete, ratnestsToUpdate, net, netStatus);
+	};
+	QList<ConnectorItem *> seeds;
+	if (manual || allChanged) {
+		m_routingNets.clear();
+		Q_FOREACH (QGraphicsItem * item, scene()->items()) {
+			auto * connectorItem = dynamic_cast<ConnectorItem *>(item);
+			if (!connectorItem) continue;
+
+			seeds.append(connectorItem);
 		}
-
-		if (partConnectorItems.count() < 1) continue;
-
-		if (doRatsnest) {
-			ratnestsToUpdate.append(partConnectorItems);
+	}
+	else {
+		// drop the cached score of every net a changed connector was in, then re-score what is left of those nets
+		changed.unite(ratsnestUpdate);
+		Q_FOREACH (ConnectorItem * connectorItem, changed) {
+			m_routingNets.retire(connectorItem, seeds);
+			seeds.append(connectorItem);
 		}
-
-		if (partConnectorItems.count() <= 1) continue;
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    DebugDialog::debug("________________________");
-		//    foreach (ConnectorItem * pci, partConnectorItems) {
-		//		pci->debugInfo("pc 2");
-		//	}
-		//}
-
-		GraphUtils::scoreOneNet(partConnectorItems, this->getTraceFlag(), routingStatus);
 	}
+	m_routingNets.score(seeds, visited, contains, score);
 
+	routingStatus += m_routingNets.total();
 	routingStatus.m_jumperItemCount /= 4;			// since we counted each connector twice on two layers (4 connectors per jumper item)
 
 	// can't do this in the above loop since VirtualWires and ConnectorItems are added and deleted
@@ -7085,6 +7052,74 @@ void SketchWidget::updateRoutingStatus(RoutingStatus & routingStatus, bool manua
 }
 
 
+bool SketchWidget::scoreRoutingNet(ConnectorItem * connectorItem, bool manual, const QSet<ConnectorItem *> & ratsnestUpdate,
+                                   QList< QPointer<VirtualWire> > & ratsToDelete, QList< QList<ConnectorItem *> > & ratsnestsToUpdate,
+                                   QList<ConnectorItem *> & connectorItems, RoutingStatus & routingStatus)
+{
+	//if (this->viewID() == ViewLayer::SchematicView) {
+	//    connectorItem->debugInfo("testing urs");
+	//}
+
+	auto * vw = qobject_cast<VirtualWire *>(connectorItem->attachedTo());
+	if (vw) {
+		if (vw->connector0()->connectionsCount() == 0 || vw->connector1()->connectionsCount() == 0) {
+			ratsToDelete.append(vw);
+		}
+		connectorItems << vw->connector0() << vw->connector1();
+		return false;
+	}
+
+	connectorItems.append(connectorItem);
+	ConnectorItem::collectEqualPotential(connectorItems, true, ViewGeometry::RatsnestFlag);
+
+	//if (this->viewID() == ViewLayer::SchematicView) {
+	//	DebugDialog::debug("________________________");
+	//	foreach (ConnectorItem * ci, connectorItems) ci->debugInfo("cep");
+	//}
+
+	bool doRatsnest = manual || checkUpdateRatsnest(connectorItems, ratsnestUpdate);
+	if (!doRatsnest && connectorItems.count() <= 1) return false;
+
+	QList<ConnectorItem *> partConnectorItems;
+	ConnectorItem::collectParts(connectorItems, partConnectorItems, includeSymbols(), ViewLayer::NewTopAndBottom);
+	if (partConnectorItems.count() < 1) return false;
+	if (!doRatsnest && partConnectorItems.count() <= 1) return false;
+
+	//if (this->viewID() == ViewLayer::SchematicView) {
+	//    DebugDialog::debug("________________________");
+	//    foreach (ConnectorItem * pci, partConnectorItems) {
+	//		pci->debugInfo("pc 1");
+	//	}
+	//}
+
+	for (int i = partConnectorItems.count() - 1; i >= 0; i--) {
+		ConnectorItem * ci = partConnectorItems[i];
+
+		if (!ci->attachedTo()->isEverVisible()) {
+			partConnectorItems.removeAt(i);
+		}
+	}
+
+	if (partConnectorItems.count() < 1) return false;
+
+	if (doRatsnest) {
+		ratsnestsToUpdate.append(partConnectorItems);
+	}
+
+	if (partConnectorItems.count() <= 1) return false;
+
+	//if (this->viewID() == ViewLayer::SchematicView) {
+	//    DebugDialog::debug("________________________");
+	//    foreach (ConnectorItem * pci, partConnectorItems) {
+	//		pci->debugInfo("pc 2");
+	//	}
+	//}
+
+	// nets that don't score are left out of the cache; any change that could make them score touches one of their connectors
+	return GraphUtils::scoreOneNet(partConnectorItems, this->getTraceFlag(), routingStatus);
+}
+
+
 void SketchWidget::ensureLayerVisible(ViewLayer::ViewLayerID viewLayerID)
 {
 	ViewLayer * viewLayer = m_viewLayers.value(viewLayerID, nullptr);
@@ -8754,9 +8789,10 @@ void SketchWidget::collectAllNets(
 	}
 
 	// find all the nets and make a list of nodes (i.e. part ConnectorItems) for each net
-	while (allConnectors.count() > 0) {
+	QSet<ConnectorItem *> collected;
+	Q_FOREACH (ConnectorItem * connectorItem, allConnectors) {
+		if (collected.contains(connectorItem)) continue;
 
-		ConnectorItem * connectorItem = allConnectors.takeFirst();
 		QList<ConnectorItem *> connectorItems;
 		connectorItems.append(connectorItem);
 		ConnectorItem::collectEqualPotential(connectorItems, bothSides, skipFlags, skipBuses);
@@ -8769,7 +8805,7 @@ void SketchWidget::collectAllNets(
 			//DebugDialog::debug("collect equal potential bug");
 			//}
 			//DebugDialog::debug(QString("from in equal potential %1 %2").arg(ci->connectorSharedName()).arg(ci->attachedToInstanceTitle()));
-			allConnectors.removeOne(ci);
+			collected.insert(ci);
 		}
 
 		if (!includeSingletons && (connectorItems.count() <= 1)) {
@@ -9409,14 +9445,11 @@ void SketchWidget::renamePinsForCommand(long id, const QStringList & labels)
 	paletteItem->renamePins(labels);
 }
 
-bool SketchWidget::checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems) {
-	Q_FOREACH (ConnectorItem * ci, m_ratsnestUpdateConnect) {
-		if (!ci) continue;
-		if (connectorItems.contains(ci)) return true;
-	}
-	Q_FOREACH (ConnectorItem * ci, m_ratsnestUpdateDisconnect) {
-		if (!ci) continue;
-		if (connectorItems.contains(ci)) return true;
+bool SketchWidget::checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems, const QSet<ConnectorItem *> & ratsnestUpdate) {
+	if (ratsnestUpdate.isEmpty()) return false;
+
+	Q_FOREACH (ConnectorItem * ci, connectorItems) {
+		if (ratsnestUpdate.contains(ci)) return true;
 	}
 
 	return false;
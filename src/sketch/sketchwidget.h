@@ -44,6 +44,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "renderthing.h"
 #include "swapthing.h"
+#include "routingnetcache.h"
 #include "utils/fpsmonitor.h"
 
 class SubpartSwapManager;
@@ -493,7 +494,10 @@ protected:
 	void moveLegBendpoints(bool undoOnly, QUndoCommand * parentCommand);
 	void moveLegBendpointsAux(ConnectorItem * connectorItem, bool undoOnly, QUndoCommand * parentCommand);
 	virtual void rotatePartLabels(double degrees, QTransform &, QPointF center, QUndoCommand * parentCommand);
-	bool checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems);
+	bool checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems, const QSet<ConnectorItem *> & ratsnestUpdate);
+	bool scoreRoutingNet(ConnectorItem *, bool manual, const QSet<ConnectorItem *> & ratsnestUpdate,
+	                     QList< QPointer<class VirtualWire> > & ratsToDelete, QList< QList<ConnectorItem *> > & ratsnestsToUpdate,
+	                     QList<ConnectorItem *> & net, RoutingStatus &);
 	void makeRatsnestViewGeometry(ViewGeometry & viewGeometry, ConnectorItem * source, ConnectorItem * dest);
 	virtual double getTraceWidth();
 	virtual void setLastTraceWidth(double lastTraceWidth);
@@ -754,6 +758,8 @@ protected:
 	bool m_curvyWires = false;
 	bool m_rubberBandLegWasEnabled = false;
 	RoutingStatus m_routingStatus;
+
+	RoutingNetCache m_routingNets;				// jumper connectors in its total are not yet divided by 4
 	bool m_anyInRotation;
 	bool m_pasting = false;
 	QPointer<class ResizableBoard> m_resizingBoard;
@@ -18,10 +18,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 ********************************************************************/
 
-#include <QBuffer>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSvgRenderer>
+#include <QtConcurrentRun>
 #include <qmath.h>
 
 #include "gerbergenerator.h"
@@ -30,6 +30,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../connectors/svgidlayer.h"
 #include "../debugdialog.h"
 #include "../fsvgrenderer.h"
+#include "../processeventblocker.h"
 #include "../sketch/pcbsketchwidget.h"
 #include "../utils/folderutils.h"
 #include "../utils/graphicsutils.h"
@@ -39,6 +40,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "groundplanegeneratorold.h"
 #include "svgfilesplitter.h"
 #include "svgpathregex.h"
+#include "svgrasterizer.h"
 
 const QString GerberGenerator::SilkTopSuffix = "_silkTop.gto";
 const QString GerberGenerator::SilkBottomSuffix = "_silkBottom.gbo";
@@ -92,61 +94,107 @@ void GerberGenerator::exportToGerber(const QString & prefix, const QString & exp
 		}
 	}
 
-	exportPickAndPlace(prefix, exportDir, board, sketchWidget, displayMessageBoxes);
+	// everything that touches the scene happens here on the GUI thread;
+	// the snapshots are then clipped, converted and written in parallel
+	int boardLayers = sketchWidget->boardLayers();
 
+	QList<GerberLayer *> coppers;
 	LayerList viewLayerIDs = ViewLayer::copperLayers(ViewLayer::NewBottom);
-	int copperInvalidCount = doCopper(board, sketchWidget, viewLayerIDs, "Copper0", CopperBottomSuffix, prefix, exportDir, displayMessageBoxes);
-
-	if (sketchWidget->boardLayers() == 2) {
+	coppers << snapshotCopper(board, sketchWidget, viewLayerIDs, "Copper0", CopperBottomSuffix, displayMessageBoxes);
+	if (boardLayers == 2) {
 		viewLayerIDs = ViewLayer::copperLayers(ViewLayer::NewTop);
-		copperInvalidCount += doCopper(board, sketchWidget, viewLayerIDs, "Copper1", CopperTopSuffix, prefix, exportDir, displayMessageBoxes);
+		coppers << snapshotCopper(board, sketchWidget, viewLayerIDs, "Copper1", CopperTopSuffix, displayMessageBoxes);
 	}
 
 	LayerList maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewBottom);
-	QString maskBottom, maskTop;
-	int maskInvalidCount = doMask(maskLayerIDs, "Mask0", MaskBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskBottom);
-
-	if (sketchWidget->boardLayers() == 2) {
+	GerberLayer * maskBottom = snapshotMask(maskLayerIDs, "Mask0", MaskBottomSuffix, board, sketchWidget, displayMessageBoxes);
+	GerberLayer * maskTop = nullptr;
+	if (boardLayers == 2) {
 		maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewTop);
-		maskInvalidCount += doMask(maskLayerIDs, "Mask1", MaskTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskTop);
+		maskTop = snapshotMask(maskLayerIDs, "Mask1", MaskTopSuffix, board, sketchWidget, displayMessageBoxes);
 	}
 
+	QList<GerberLayer *> pasteMasks;
 	maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewBottom);
-	int pasteMaskInvalidCount = doPasteMask(maskLayerIDs, "PasteMask0", PasteMaskBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes);
-
-	if (sketchWidget->boardLayers() == 2) {
+	pasteMasks << snapshotPasteMask(maskLayerIDs, "PasteMask0", PasteMaskBottomSuffix, board, sketchWidget, displayMessageBoxes);
+	if (boardLayers == 2) {
 		maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewTop);
-		pasteMaskInvalidCount += doPasteMask(maskLayerIDs, "PasteMask1", PasteMaskTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes);
+		pasteMasks << snapshotPasteMask(maskLayerIDs, "PasteMask1", PasteMaskTopSuffix, board, sketchWidget, displayMessageBoxes);
 	}
 
 	LayerList silkLayerIDs = ViewLayer::silkLayers(ViewLayer::NewTop);
-	int silkInvalidCount = doSilk(silkLayerIDs, "Silk1", SilkTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskTop);
+	GerberLayer * silkTop = snapshotSilk(silkLayerIDs, "Silk1", SilkTopSuffix, board, sketchWidget, displayMessageBoxes, maskTop);
 	silkLayerIDs = ViewLayer::silkLayers(ViewLayer::NewBottom);
-	silkInvalidCount += doSilk(silkLayerIDs, "Silk0", SilkBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskBottom);
+	GerberLayer * silkBottom = snapshotSilk(silkLayerIDs, "Silk0", SilkBottomSuffix, board, sketchWidget, displayMessageBoxes, maskBottom);
+
+	GerberLayer * outline = snapshotOutline(board, sketchWidget, displayMessageBoxes);
+	GerberLayer * drill = nullptr;
+	if (outline != nullptr) {
+		drill = snapshotDrill(board, sketchWidget, displayMessageBoxes);
+		Q_FOREACH (GerberLayer * layer, coppers + pasteMasks + (QList<GerberLayer *>() << maskBottom << maskTop << silkTop << silkBottom)) {
+			if (layer != nullptr) layer->boardOutline = outline->svg;
+		}
+	}
 
-	// now do it for the outline/contour
-	LayerList outlineLayerIDs = ViewLayer::outlineLayers();
-	bool empty;
-	QString svgOutline = renderTo(outlineLayerIDs, board, sketchWidget, empty);
-	if (empty || svgOutline.isEmpty()) {
-		displayMessage(QObject::tr("outline is empty"), displayMessageBoxes);
-		return;
+	// silk is clipped by the finished mask on the same side, so each pair runs as one job
+	QList< QList<GerberLayer *> > jobs;
+	jobs << (QList<GerberLayer *>() << maskBottom << silkBottom);
+	jobs << (QList<GerberLayer *>() << maskTop << silkTop);
+	Q_FOREACH (GerberLayer * layer, coppers + pasteMasks + (QList<GerberLayer *>() << outline << drill)) {
+		jobs << (QList<GerberLayer *>() << layer);
 	}
 
-	svgOutline = cleanOutline(svgOutline);
-	// at this point svgOutline must be a single element; a path element may contain cutouts
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgOutline = clipToBoard(svgOutline, board, "board", SVG2gerber::ForOutline, "", displayMessageBoxes, treatAsCircle);
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgOutline);
+	QRectF boardRect = board->sceneBoundingRect();
+	boardRect.moveTo(0, 0);
+
+	QList<GerberLayer *> layers;
+	QList< QFuture<void> > futures;
+	Q_FOREACH (QList<GerberLayer *> job, jobs) {
+		job.removeAll(nullptr);
+		if (job.isEmpty()) continue;
+
+		layers << job;
+		futures << QtConcurrent::run([job, boardRect, boardLayers, exportDir, prefix]() {
+			Q_FOREACH (GerberLayer * layer, job) {
+				convertLayer(layer, boardRect, boardLayers, exportDir, prefix);
+			}
+		});
+	}
 
-	// create outline gerber from svg
-	SVG2gerber outlineGerber;
-	int outlineInvalidCount = outlineGerber.convert(svgOutline, sketchWidget->boardLayers() == 2, "contour", SVG2gerber::ForOutline, svgSize * GraphicsUtils::StandardFritzingDPI);
+	exportPickAndPlace(prefix, exportDir, board, sketchWidget, displayMessageBoxes);
 
-	//DebugDialog::debug(QString("outline output: %1").arg(outlineGerber.getGerber()));
-	saveEnd("contour", exportDir, prefix, OutlineSuffix, displayMessageBoxes, outlineGerber);
+	Q_FOREACH (QFuture<void> future, futures) {
+		while (!future.isFinished()) {
+			ProcessEventBlocker::processEvents(200);
+		}
+	}
 
-	doDrill(board, sketchWidget, prefix, exportDir, displayMessageBoxes);
+	Q_FOREACH (GerberLayer * layer, layers) {
+		Q_FOREACH (QString message, layer->messages) {
+			displayMessage(message, displayMessageBoxes);
+		}
+	}
+
+	int copperInvalidCount = 0;
+	int maskInvalidCount = 0;
+	int pasteMaskInvalidCount = 0;
+	int silkInvalidCount = 0;
+	int outlineInvalidCount = 0;
+	Q_FOREACH (GerberLayer * layer, layers) {
+		if (layer == outline) outlineInvalidCount += layer->invalidCount;
+		else if (layer == silkTop || layer == silkBottom) silkInvalidCount += layer->invalidCount;
+		else if (layer == maskTop || layer == maskBottom) maskInvalidCount += layer->invalidCount;
+		else if (pasteMasks.contains(layer)) pasteMaskInvalidCount += layer->invalidCount;
+		else if (coppers.contains(layer)) copperInvalidCount += layer->invalidCount;
+	}
+
+	Q_FOREACH (GerberLayer * layer, layers) {
+		delete layer;
+	}
+
+	if (outline == nullptr) {
+		return;
+	}
 
 	QStringList messages;
 	if (outlineInvalidCount > 0) messages << QObject::tr("%n path(s) in board outline layer", "", outlineInvalidCount);
@@ -161,38 +209,91 @@ void GerberGenerator::exportToGerber(const QString & prefix, const QString & exp
 	}
 }
 
-int GerberGenerator::doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+GerberLayer * GerberGenerator::newLayer(const QString & name, const QString & clipName, const QString & suffix, SVG2gerber::ForWhy forWhy, const QString & svg, const QString & failureMessage)
 {
-	bool empty;
-	QString svg = renderTo(viewLayerIDs, board, sketchWidget, empty);
-	if (empty || svg.isEmpty()) {
-		displayMessage(QObject::tr("%1 layer export is empty.").arg(copperName), displayMessageBoxes);
-		return 0;
+	auto * layer = new GerberLayer;
+	layer->name = name;
+	layer->clipName = clipName;
+	layer->suffix = suffix;
+	layer->forWhy = forWhy;
+	layer->svg = svg;
+	layer->svgSize = TextUtils::parseForWidthAndHeight(svg);
+	layer->failureMessage = failureMessage;
+	layer->clipSource = nullptr;
+	layer->invalidCount = 0;
+	return layer;
+}
+
+void GerberGenerator::convertLayer(GerberLayer * layer, const QRectF & boardRect, int boardLayers, const QString & exportDir, const QString & prefix)
+{
+	// runs on a worker thread: no scene access and no message boxes
+	QString clipString;
+	if (layer->clipSource != nullptr) {
+		clipString = layer->clipSource->clipped;
 	}
 
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
+	// layers may share a clip name (drill clips like Copper0), so debug dumps go by the layer's own name
+	QString svg = clipToBoardAux(layer->svg, boardRect, layer->clipName, layer->forWhy, clipString, layer->treatAsCircle, layer->boardOutline, layer->messages, layer->name);
+	layer->svg.clear();
+	if (svg.isEmpty()) {
+		if (!layer->failureMessage.isEmpty()) {
+			layer->messages << layer->failureMessage;
+		}
+		return;
+	}
+
+	if (layer->forWhy == SVG2gerber::ForMask) {
+		layer->clipped = svg;
+	}
+
+	SVG2gerber gerber;
+	layer->invalidCount = gerber.convert(svg, boardLayers == 2, layer->name, layer->forWhy, layer->svgSize * GraphicsUtils::StandardFritzingDPI);
+
+	QString outname = exportDir + "/" +  prefix + layer->suffix;
+	if (!writeGerber(outname, gerber)) {
+		layer->messages << QObject::tr("%1 layer: unable to save to '%2'").arg(layer->name, outname);
+	}
+}
+
+void GerberGenerator::collectDonuts(ItemBase * board, PCBSketchWidget * sketchWidget, QMultiHash<long, GerberDonut> & donuts)
+{
 	Q_FOREACH (QGraphicsItem * item, sketchWidget->scene()->collidingItems(board)) {
 		auto * connectorItem = dynamic_cast<ConnectorItem *>(item);
 		if (connectorItem == nullptr) continue;
 		if (!connectorItem->isPath()) continue;
 		if (connectorItem->radius() == 0) continue;
 
-		treatAsCircle.insert(connectorItem->attachedToID(), connectorItem);
+		donuts.insert(connectorItem->attachedToID(), makeDonut(connectorItem));
 	}
+}
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svg);
+GerberDonut GerberGenerator::makeDonut(ConnectorItem * connectorItem)
+{
+	ItemBase * itemBase = connectorItem->attachedTo();
+	SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+	GerberDonut donut;
+	donut.svgId = svgIdLayer->m_svgId;
+	donut.radius = connectorItem->radius();
+	donut.strokeWidth = connectorItem->strokeWidth();
+	return donut;
+}
 
-	svg = clipToBoard(svg, board, copperName, SVG2gerber::ForCopper, "", displayMessageBoxes, treatAsCircle);
-	if (svg.isEmpty()) {
-		displayMessage(QObject::tr("%1 layer export is empty (case 2).").arg(copperName), displayMessageBoxes);
-		return 0;
+GerberLayer * GerberGenerator::snapshotCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, bool displayMessageBoxes)
+{
+	bool empty;
+	QString svg = renderTo(viewLayerIDs, board, sketchWidget, empty);
+	if (empty || svg.isEmpty()) {
+		displayMessage(QObject::tr("%1 layer export is empty.").arg(copperName), displayMessageBoxes);
+		return nullptr;
 	}
 
-	return doEnd(svg, sketchWidget->boardLayers(), copperName, SVG2gerber::ForCopper, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, copperSuffix, displayMessageBoxes);
+	GerberLayer * layer = newLayer(copperName, copperName, copperSuffix, SVG2gerber::ForCopper, svg, QObject::tr("%1 layer export is empty (case 2).").arg(copperName));
+	collectDonuts(board, sketchWidget, layer->treatAsCircle);
+	return layer;
 }
 
 
-int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, const QString & clipString)
+GerberLayer * GerberGenerator::snapshotSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, GerberLayer * mask)
 {
 
 	bool empty;
@@ -201,35 +302,16 @@ int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, co
 		if (silkLayerIDs.contains(ViewLayer::Silkscreen1)) {
 			displayMessage(QObject::tr("silk layer %1 export is empty").arg(silkName), displayMessageBoxes);
 		}
-		return 0;
+		return nullptr;
 	}
 
-	//QFile f(silkName + "original.svg");
-	//f.open(QFile::WriteOnly);
-	//QTextStream fs(&f);
-	//fs << svgSilk;
-	//f.close();
-
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgSilk);
-
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgSilk = clipToBoard(svgSilk, board, silkName, SVG2gerber::ForSilk, clipString, displayMessageBoxes, treatAsCircle);
-	if (svgSilk.isEmpty()) {
-		displayMessage(QObject::tr("silk export failure"), displayMessageBoxes);
-		return 0;
-	}
-
-	//QFile f2(silkName + "clipped.svg");
-	//f2.open(QFile::WriteOnly);
-	//QTextStream fs2(&f2);
-	//fs2 << svgSilk;
-	//f2.close();
-
-	return doEnd(svgSilk, sketchWidget->boardLayers(), silkName, SVG2gerber::ForSilk, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	GerberLayer * layer = newLayer(silkName, silkName, gerberSuffix, SVG2gerber::ForSilk, svgSilk, QObject::tr("silk export failure"));
+	layer->clipSource = mask;
+	return layer;
 }
 
 
-int GerberGenerator::doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+GerberLayer * GerberGenerator::snapshotDrill(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
 {
 	LayerList drillLayerIDs;
 	drillLayerIDs << ViewLayer::drillLayers();
@@ -238,30 +320,30 @@ int GerberGenerator::doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, c
 	QString svgDrill = renderTo(drillLayerIDs, board, sketchWidget, empty);
 	if (empty || svgDrill.isEmpty()) {
 		displayMessage(QObject::tr("exported drill file is empty"), displayMessageBoxes);
-		return 0;
+		return nullptr;
 	}
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgDrill);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	Q_FOREACH (QGraphicsItem * item, sketchWidget->scene()->collidingItems(board)) {
-		auto * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (connectorItem == nullptr) continue;
-		if (!connectorItem->isPath()) continue;
-		if (connectorItem->radius() == 0) continue;
-
-		treatAsCircle.insert(connectorItem->attachedToID(), connectorItem);
-	}
+	GerberLayer * layer = newLayer("drill", "Copper0", DrillSuffix, SVG2gerber::ForDrill, svgDrill, QObject::tr("drill export failure"));
+	collectDonuts(board, sketchWidget, layer->treatAsCircle);
+	return layer;
+}
 
-	svgDrill = clipToBoard(svgDrill, board, "Copper0", SVG2gerber::ForDrill, "", displayMessageBoxes, treatAsCircle);
-	if (svgDrill.isEmpty()) {
-		displayMessage(QObject::tr("drill export failure"), displayMessageBoxes);
-		return 0;
+GerberLayer * GerberGenerator::snapshotOutline(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
+{
+	LayerList outlineLayerIDs = ViewLayer::outlineLayers();
+	bool empty;
+	QString svgOutline = renderTo(outlineLayerIDs, board, sketchWidget, empty);
+	if (empty || svgOutline.isEmpty()) {
+		displayMessage(QObject::tr("outline is empty"), displayMessageBoxes);
+		return nullptr;
 	}
 
-	return doEnd(svgDrill, sketchWidget->boardLayers(), "drill", SVG2gerber::ForDrill, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, DrillSuffix, displayMessageBoxes);
+	// at this point svgOutline must be a single element; a path element may contain cutouts
+	svgOutline = cleanOutline(svgOutline);
+	return newLayer("contour", "board", OutlineSuffix, SVG2gerber::ForOutline, svgOutline, "");
 }
 
-int GerberGenerator::doMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, QString & clipString)
+GerberLayer * GerberGenerator::snapshotMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
 {
 	// don't want these in the mask laqyer
 	QList<ItemBase *> copperLogoItems;
@@ -273,30 +355,19 @@ int GerberGenerator::doMask(LayerList maskLayerIDs, const QString &maskName, con
 
 	if (empty || svgMask.isEmpty()) {
 		displayMessage(QObject::tr("exported mask layer %1 is empty").arg(maskName), displayMessageBoxes);
-		return 0;
+		return nullptr;
 	}
 
 	svgMask = TextUtils::expandAndFill(svgMask, "black", MaskClearanceMils * 2);
 	if (svgMask.isEmpty()) {
 		displayMessage(QObject::tr("%1 mask export failure (2)").arg(maskName), displayMessageBoxes);
-		return 0;
-	}
-
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgMask);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-
-	svgMask = clipToBoard(svgMask, board, maskName, SVG2gerber::ForMask, "", displayMessageBoxes, treatAsCircle);
-	if (svgMask.isEmpty()) {
-		displayMessage(QObject::tr("mask export failure"), displayMessageBoxes);
-		return 0;
+		return nullptr;
 	}
 
-	clipString = svgMask;
-
-	return doEnd(svgMask, sketchWidget->boardLayers(), maskName, SVG2gerber::ForMask, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	return newLayer(maskName, maskName, gerberSuffix, SVG2gerber::ForMask, svgMask, QObject::tr("mask export failure"));
 }
 
-int GerberGenerator::doPasteMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+GerberLayer * GerberGenerator::snapshotPasteMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
 {
 	// don't want these in the mask laqyer
 	QList<ItemBase *> copperLogoItems;
@@ -311,21 +382,13 @@ int GerberGenerator::doPasteMask(LayerList maskLayerIDs, const QString &maskName
 
 	if (empty || svgMask.isEmpty()) {
 		displayMessage(QObject::tr("exported paste mask layer is empty"), displayMessageBoxes);
-		return 0;
+		return nullptr;
 	}
 
 	svgMask = sketchWidget->makePasteMask(svgMask, board, GraphicsUtils::StandardFritzingDPI, maskLayerIDs);
-	if (svgMask.isEmpty()) return 0;
+	if (svgMask.isEmpty()) return nullptr;
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgMask);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgMask = clipToBoard(svgMask, board, maskName, SVG2gerber::ForCopper, "", displayMessageBoxes, treatAsCircle);
-	if (svgMask.isEmpty()) {
-		displayMessage(QObject::tr("mask export failure"), displayMessageBoxes);
-		return 0;
-	}
-
-	return doEnd(svgMask, sketchWidget->boardLayers(), maskName, SVG2gerber::ForCopper, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	return newLayer(maskName, maskName, gerberSuffix, SVG2gerber::ForCopper, svgMask, QObject::tr("mask export failure"));
 }
 
 int GerberGenerator::doEnd(const QString & svg, int boardLayers, const QString & layerName, SVG2gerber::ForWhy forWhy, QSizeF svgSize,
@@ -344,9 +407,18 @@ bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportD
 {
 
 	QString outname = exportDir + "/" +  prefix + suffix;
+	if (!writeGerber(outname, gerber)) {
+		displayMessage(QObject::tr("%1 layer: unable to save to '%2'").arg(layerName, outname), displayMessageBoxes);
+		return false;
+	}
+
+	return true;
+}
+
+bool GerberGenerator::writeGerber(const QString & outname, SVG2gerber & gerber)
+{
 	QFile out(outname);
 	if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
-		displayMessage(QObject::tr("%1 layer: unable to save to '%2'").arg(layerName, outname), displayMessageBoxes);
 		return false;
 	}
 
@@ -355,7 +427,6 @@ bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportD
 	stream.flush();
 	out.close();
 	return true;
-
 }
 
 void GerberGenerator::displayMessage(const QString & message, bool displayMessageBoxes) {
@@ -368,55 +439,6 @@ void GerberGenerator::displayMessage(const QString & message, bool displayMessag
 	DebugDialog::debug(message);
 }
 
-QString GerberGenerator::imageToHash(const QImage& image) {
-	QElapsedTimer timer;
-	timer.start();
-
-	QByteArray arr;
-	QBuffer buffer(&arr);
-	buffer.open(QIODevice::WriteOnly);
-	image.save(&buffer, "PNG"); // PNG is lossless and this turned out to be MUCH faster than a pixel loop.
-
-	QByteArray hash = QCryptographicHash::hash(arr, QCryptographicHash::Md5);
-	return hash.toHex();
-};
-
-void GerberGenerator::repeatedImageRender(QImage & image, const QByteArray& svg, QRectF & target) {
-	QHash<QString, QImage> hashMap;
-	int counter = 0;
-	QString hash;
-
-	// Tests show that the rendered images have sometimes gaps of one to roughly eight consecutive pixel on one scanline.
-	// This seems to happen more often on high CPU load.
-	// If we find two identical images, we assume the bug did not occure and continue.
-	// With large images (100 Megapixel) the likelihood increases, and 5 tries might not be enough, in which case we currently ignore the issue and just use one of the images.
-	while (true) {
-		QImage tempImage = image;
-		QSvgRenderer renderer(svg);
-		QPainter painter;
-		painter.begin(&tempImage);
-		renderer.render(&painter, target);
-		painter.end();
-		tempImage.invertPixels(); // need white pixels on a black background for GroundPlaneGenerator
-		hash = imageToHash(tempImage);
-		if (hashMap.contains(hash)) {
-			break;
-		} else {
-			if (counter > 0) {
-				DebugDialog::debug(QString("Gerbergenerator: Image not in hash. count: %1 hash: %2").arg(counter).arg(hash));
-			}
-			hashMap.insert(hash, tempImage);
-			if (counter >= 5) {
-				DebugDialog::debug(QString("Gerbergenerator: Too many tries to find identical image. Aborting loop. count: %1 hash: %2").arg(counter).arg(hash));
-				break;
-			}
-			counter++;
-		}
-	}
-
-	image = hashMap.value(hash);
-}
-
 QString GerberGenerator::clipToBoard(QString svgString, ItemBase * board, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
 	QRectF source = board->sceneBoundingRect();
 	source.moveTo(0, 0);
@@ -424,6 +446,35 @@ QString GerberGenerator::clipToBoard(QString svgString, ItemBase * board, const
 }
 
 QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
+	QMultiHash<long, GerberDonut> donuts;
+	Q_FOREACH (long id, treatAsCircle.uniqueKeys()) {
+		Q_FOREACH (ConnectorItem * connectorItem, treatAsCircle.values(id)) {
+			donuts.insert(id, makeDonut(connectorItem));
+		}
+	}
+
+	QStringList messages;
+	QString result = clipToBoardAux(svgString, boardRect, layerName, forWhy, clipString, donuts, QString(), messages, layerName);
+	Q_FOREACH (QString message, messages) {
+		displayMessage(message, displayMessageBoxes);
+	}
+
+	return result;
+}
+
+static QByteArray placeOutline(const QString & boardOutline, const QDomElement & root) {
+	// the board outline with the same size and viewBox as the layer being clipped, so both render into the same target
+	QDomDocument outlineDocument;
+	if (boardOutline.isEmpty() || !outlineDocument.setContent(boardOutline)) return QByteArray();
+
+	QDomElement outlineRoot = outlineDocument.documentElement();
+	Q_FOREACH (QString name, QStringList() << "width" << "height" << "viewBox") {
+		outlineRoot.setAttribute(name, root.attribute(name));
+	}
+	return TextUtils::removeXMLEntities(outlineDocument.toString()).toUtf8();
+}
+
+QString GerberGenerator::clipToBoardAux(QString svgString, const QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, const QMultiHash<long, GerberDonut> & treatAsCircle, const QString & boardOutline, QStringList & messages, const QString & dumpName) {
 	// document 1 will contain svg that is easy to convert to gerber
 	QDomDocument domDocument1;
 	QString errorStr;
@@ -460,7 +511,7 @@ QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, cons
 
 	bool multipleContours = false;
 	if (forWhy == SVG2gerber::ForOutline) {
-		multipleContours = dealWithMultipleContours(root1, displayMessageBoxes);
+		multipleContours = dealWithMultipleContours(root1, messages);
 	}
 	(void)multipleContours;
 
@@ -569,7 +620,7 @@ QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, cons
 		painter.end();
 
 #ifndef QT_NO_DEBUG
-		clipImage->save(FolderUtils::getTopLevelUserDataStorePath() + "/clip.png");
+		clipImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/clip_%1.png").arg(dumpName));
 #endif
 
 	}
@@ -740,32 +791,29 @@ QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, cons
 		}
 		else {
 			QByteArray svg = TextUtils::removeXMLEntities(domDocument2.toString()).toUtf8();
-			image.fill(0xffffffff);
-
-			repeatedImageRender(image, svg, target);
+			QList<QPolygonF> polygons;
+			if (clipImage == nullptr && forWhy != SVG2gerber::ForDrill && SvgRasterizer::renderPolygonsInside(svg, placeOutline(boardOutline, root2), target, res, polygons)) {
+				// nothing but the board clips this layer and all of it is on the board, so keep the geometry and skip the raster round trip
+				svgString.replace("</svg>", makePolygons(polygons, "#000000") + "</svg>");
+			}
+			else {
+				SvgRasterizer::renderMono(image, svg, target);		// need white pixels on a black background for GroundPlaneGenerator
 
 #ifndef QT_NO_DEBUG
-			image.save(FolderUtils::getTopLevelUserDataStorePath() + "/preclip_output.png");
+				image.save(FolderUtils::getTopLevelUserDataStorePath() + QString("/preclip_output_%1.png").arg(dumpName));
 #endif
 
-			if (clipImage != nullptr) {
-				// can this be done with a single blt using composition mode
-				// if not, grab a scanline instead of testing every pixel
-				for (int y = 0; y < theight; y++) {
-					for (int x = 0; x < twidth; x++) {
-						if (clipImage->pixel(x, y) != 0xffffffff) {
-							image.setPixel(x, y, 0);
-						}
-					}
+				if (clipImage != nullptr) {
+					SvgRasterizer::applyMask(image, *clipImage, twidth, theight);
 				}
-			}
 
 #ifndef QT_NO_DEBUG
-			image.save(FolderUtils::getTopLevelUserDataStorePath() + "/output.png");
+				image.save(FolderUtils::getTopLevelUserDataStorePath() + QString("/output_%1.png").arg(dumpName));
 #endif
 
-			QString path = makePath(image, res / GraphicsUtils::StandardFritzingDPI, "#000000");
-			svgString.replace("</svg>", path + "</svg>");
+				QString path = makePath(image, res / GraphicsUtils::StandardFritzingDPI, "#000000");
+				svgString.replace("</svg>", path + "</svg>");
+			}
 
 			/*
 
@@ -824,10 +872,9 @@ QString GerberGenerator::cleanOutline(const QString & outlineSvg)
 
 void GerberGenerator::mergeOutlineElement(QImage & image, QRectF & target, double res, QDomDocument & document, QString & svgString, int ix, const QString & layerName) {
 
-	image.fill(0xffffffff);
 	QByteArray svg = TextUtils::removeXMLEntities(document.toString()).toUtf8();
 
-	repeatedImageRender(image, svg, target);		// need white pixels on a black background for GroundPlaneGenerator
+	SvgRasterizer::renderMono(image, svg, target);		// need white pixels on a black background for GroundPlaneGenerator
 
 #ifndef QT_NO_DEBUG
 	image.save(QString("%2/output%1.png").arg(ix).arg(FolderUtils::getTopLevelUserDataStorePath()));
@@ -893,7 +940,23 @@ QString GerberGenerator::makePath(QImage & image, double unit, const QString & c
 	return path + paths + "' />\n";
 }
 
-bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayMessageBoxes) {
+QString GerberGenerator::makePolygons(const QList<QPolygonF> & polygons, const QString & colorString)
+{
+	QString elements;
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		if (polygon.count() < 3) continue;
+
+		QString points;
+		Q_FOREACH (QPointF p, polygon) {
+			points += QString("%1,%2 ").arg(p.x()).arg(p.y());
+		}
+		elements += QString("<polygon fill='%1' stroke='none' points='%2' />\n").arg(colorString, points.trimmed());
+	}
+
+	return elements;
+}
+
+bool GerberGenerator::dealWithMultipleContours(QDomElement & root, QStringList & messages) {
 	bool multipleContours = false;
 	bool contoursOK = true;
 
@@ -922,7 +985,7 @@ bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayM
 		    QObject::tr("Fritzing is unable to process the cutouts in this custom PCB shape. ") +
 		    QObject::tr("You may need to reload the shape SVG. ") +
 		    QObject::tr("Fritzing requires that you make cutouts using a shape 'subtraction' or 'difference' operation in your vector graphics editor.");
-		displayMessage(msg, displayMessageBoxes);
+		messages << msg;
 		return false;
 	}
 
@@ -1084,7 +1147,7 @@ void GerberGenerator::exportPickAndPlace(const QString & prefix, const QString &
 	out.close();
 }
 
-void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
+void GerberGenerator::handleDonuts(QDomElement & root1, const QMultiHash<long, GerberDonut> & treatAsCircle) {
 	// most of this would not be necessary if we cached cleaned SVGs
 
 	static const QString unique("%%%%%%%%%%%%%%%%%%%%%%%%_________________________________%%%%%%%%%%%%%%%%%%%%%%%%%%%%%");
@@ -1092,11 +1155,9 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 	QDomNodeList nodeList = root1.elementsByTagName("path");
 	if (treatAsCircle.count() > 0) {
 		QStringList ids;
-		Q_FOREACH (ConnectorItem * connectorItem, treatAsCircle.values()) {
-			ItemBase * itemBase = connectorItem->attachedTo();
-			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-			DebugDialog::debug(QString("treat as circle %1").arg(svgIdLayer->m_svgId));
-			ids << svgIdLayer->m_svgId;
+		Q_FOREACH (GerberDonut donut, treatAsCircle.values()) {
+			DebugDialog::debug(QString("treat as circle %1").arg(donut.svgId));
+			ids << donut.svgId;
 		}
 
 		for (int n = 0; n < nodeList.count(); n++) {
@@ -1108,33 +1169,33 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 			if (!ids.contains(id)) continue;
 
 			QString pid;
-			ConnectorItem * connectorItem = nullptr;
+			GerberDonut donut;
+			bool found = false;
 			for (QDomElement parent = path.parentNode().toElement(); !parent.isNull(); parent = parent.parentNode().toElement()) {
 				pid = parent.attribute("partID");
 				if (pid.isEmpty()) continue;
 
-				QList<ConnectorItem *> connectorItems = treatAsCircle.values(pid.toLong());
-				if (connectorItems.count() == 0) break;
+				QList<GerberDonut> donuts = treatAsCircle.values(pid.toLong());
+				if (donuts.count() == 0) break;
 
-				Q_FOREACH (ConnectorItem * candidate, connectorItems) {
-					ItemBase * itemBase = candidate->attachedTo();
-					SvgIdLayer * svgIdLayer = candidate->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-					if (svgIdLayer->m_svgId == id) {
-						connectorItem = candidate;
+				Q_FOREACH (GerberDonut candidate, donuts) {
+					if (candidate.svgId == id) {
+						donut = candidate;
+						found = true;
 						break;
 					}
 				}
 
-				if (connectorItem != nullptr) break;
+				if (found) break;
 			}
-			if (connectorItem == nullptr) continue;
+			if (!found) continue;
 
 			//QString string;
 			//QTextStream stream(&string);
 			//path.save(stream, 0);
 			//DebugDialog::debug("path " + string);
 
-			connectorItem->debugInfo("make path");
+			DebugDialog::debug(QString("make path %1 %2").arg(pid).arg(id));
 			path.setAttribute("id", unique);
 			QSvgRenderer renderer;
 			renderer.load(root1.ownerDocument().toByteArray());
@@ -1147,8 +1208,8 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 			QPointF p = bounds.center();
 			circle.setAttribute("cx", QString::number(p.x()));
 			circle.setAttribute("cy", QString::number(p.y()));
-			circle.setAttribute("r", QString::number(connectorItem->radius() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
-			circle.setAttribute("stroke-width", QString::number(connectorItem->strokeWidth() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
+			circle.setAttribute("r", QString::number(donut.radius * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
+			circle.setAttribute("stroke-width", QString::number(donut.strokeWidth * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
 
 		}
 	}
@@ -21,11 +21,36 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef GERBERGENERATOR_H
 #define GERBERGENERATOR_H
 
+#include <QPolygonF>
 #include <QString>
+#include <QStringList>
+#include <QMultiHash>
 
 #include "../viewlayer.h"
 #include "svg2gerber.h"
 
+struct GerberDonut {
+	QString svgId;
+	double radius;
+	double strokeWidth;
+};
+
+struct GerberLayer {
+	QString name;						// used for the gerber conversion and the output messages
+	QString clipName;
+	QString suffix;
+	SVG2gerber::ForWhy forWhy;
+	QString svg;
+	QSizeF svgSize;
+	QMultiHash<long, GerberDonut> treatAsCircle;
+	QString failureMessage;
+	struct GerberLayer * clipSource;	// a mask layer whose clipped output clips this layer
+	QString boardOutline;				// the outline layer's svg, if any; lets a layer inside a plain board skip the raster clip
+	QString clipped;
+	int invalidCount;
+	QStringList messages;
+};
+
 class GerberGenerator
 {
 
@@ -54,21 +79,27 @@ public:
 	static const double MaskClearanceMils;
 
 protected:
-	static int doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, const QString & clipString);
-	static int doMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, QString & clipString);
-	static int doPasteMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
-	static int doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
-	static int doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
+	static GerberLayer * snapshotSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, GerberLayer * mask);
+	static GerberLayer * snapshotMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
+	static GerberLayer * snapshotPasteMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
+	static GerberLayer * snapshotCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, bool displayMessageBoxes);
+	static GerberLayer * snapshotDrill(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
+	static GerberLayer * snapshotOutline(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
+	static GerberLayer * newLayer(const QString & name, const QString & clipName, const QString & suffix, SVG2gerber::ForWhy, const QString & svg, const QString & failureMessage);
+	static void convertLayer(GerberLayer *, const QRectF & boardRect, int boardLayers, const QString & exportDir, const QString & prefix);
 	static void displayMessage(const QString & message, bool displayMessageBoxes);
 	static bool saveEnd(const QString & layerName, const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes, SVG2gerber & gerber);
+	static bool writeGerber(const QString & outname, SVG2gerber & gerber);
+	static QString clipToBoardAux(QString svgString, const QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy, const QString & clipString, const QMultiHash<long, GerberDonut> & treatAsCircle, const QString & boardOutline, QStringList & messages, const QString & dumpName);
 	static void mergeOutlineElement(QImage & image, QRectF & target, double res, QDomDocument & document, QString & svgString, int ix, const QString & layerName);
 	static QString makePath(QImage & image, double unit, const QString & colorString);
-	static bool dealWithMultipleContours(QDomElement & root, bool displayMessageBoxes);
+	static QString makePolygons(const QList<QPolygonF> & polygons, const QString & colorString);
+	static bool dealWithMultipleContours(QDomElement & root, QStringList & messages);
 	static void exportPickAndPlace(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
-	static void handleDonuts(QDomElement & root1, QMultiHash<long, ConnectorItem *> & treatAsCircle);
+	static void handleDonuts(QDomElement & root1, const QMultiHash<long, GerberDonut> & treatAsCircle);
+	static void collectDonuts(ItemBase * board, PCBSketchWidget * sketchWidget, QMultiHash<long, GerberDonut> & donuts);
+	static GerberDonut makeDonut(ConnectorItem *);
 	static QString renderTo(const LayerList &, ItemBase * board, PCBSketchWidget * sketchWidget, bool & empty);
-	static QString imageToHash(const QImage& image);
-	static void repeatedImageRender(QImage & image, const QByteArray& svg, QRectF & target);
 
 };
 
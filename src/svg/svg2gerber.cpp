@@ -549,7 +549,7 @@ int SVG2gerber::allPaths2gerber(ForWhy forWhy) {
 
 		QString data = path.attribute("d").trimmed();
 
-		const char * slot = SLOT(path2gerbCommandSlot(QChar, bool, QList<double> &, void *));
+		PathCommandCallback callback = pathCommandCallback(this, &SVG2gerber::path2gerbCommandSlot);
 
 		PathUserData pathUserData;
 		pathUserData.x = 0;
@@ -560,7 +560,7 @@ int SVG2gerber::allPaths2gerber(ForWhy forWhy) {
 		SvgFlattener flattener;
 		bool invalid = false;
 		try {
-			flattener.parsePath(data, slot, pathUserData, this, true);
+			flattener.parsePath(data, callback, pathUserData, true);
 		}
 		catch (const QString & msg) {
 			DebugDialog::debug("flattener.parsePath failed " + msg);
@@ -777,7 +777,7 @@ QString SVG2gerber::path2gerber(QDomElement pathElement) {
 	return d;
 }
 
-void SVG2gerber::path2gerbCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SVG2gerber::path2gerbCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 	QString gerb_path;
 	double x, y;
 
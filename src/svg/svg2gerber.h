@@ -27,6 +27,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QTransform>
 #include <QMultiHash>
 
+class SVGPathArgs;
+
 class SVG2gerber : public QObject
 {
 	Q_OBJECT
@@ -91,8 +93,8 @@ protected:
 
 
 
-protected Q_SLOTS:
-	void path2gerbCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
+protected:
+	void path2gerbCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData);
 
 
 };
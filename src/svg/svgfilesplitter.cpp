@@ -26,6 +26,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "svgpathparser.h"
 #include "svgpathlexer.h"
 #include "svgpathrunner.h"
+#include "svgpathscanner.h"
+#include "svgstreamrewriter.h"
 
 #include <QDomDocument>
 #include <QFile>
@@ -299,11 +301,11 @@ void SvgFileSplitter::painterPathChild(QDomElement & element, QPainterPath & ppa
 	else if (element.nodeName().compare("polygon") == 0 || element.nodeName().compare("polyline") == 0) {
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(painterPathCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::painterPathCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.painterPath = &ppath;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath(data, callback, pathUserData, false)) {
 			}
 		}
 	}
@@ -311,14 +313,14 @@ void SvgFileSplitter::painterPathChild(QDomElement & element, QPainterPath & ppa
 		/*
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::normalizeCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-		    if (parsePath(data, slot, pathUserData, this, true)) {
+		    if (parsePath(data, callback, pathUserData, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -417,14 +419,14 @@ void SvgFileSplitter::normalizeChild(QDomElement & element,
 		normalizeAttribute(element, "stroke-width", sNewWidth, vbWidth);
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::normalizeCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath(data, callback, pathUserData, false)) {
 				pathUserData.string.remove(0, 1);			// get rid of the "M"
 				element.setAttribute("points", pathUserData.string);
 			}
@@ -437,14 +439,14 @@ void SvgFileSplitter::normalizeChild(QDomElement & element,
 		setStrokeOrFill(element, blackOnly, "black", false);
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::normalizeCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-			if (parsePath(data, slot, pathUserData, this, true)) {
+			if (parsePath(data, callback, pathUserData, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -662,12 +664,12 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	else if (nodeName.compare("polygon") == 0 || nodeName.compare("polyline") == 0) {
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(shiftCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::shiftCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.x = x;
 			pathUserData.y = y;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath(data, callback, pathUserData, false)) {
 				pathUserData.string.remove(0, 1);			// get rid of the "M"
 				element.setAttribute("points", pathUserData.string);
 			}
@@ -676,12 +678,12 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	else if (nodeName.compare("path") == 0) {
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(shiftCommandSlot(QChar, bool, QList<double> &, void *));
+			PathCommandCallback callback = pathCommandCallback(this, &SvgFileSplitter::shiftCommandSlot);
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.x = x;
 			pathUserData.y = y;
-			if (parsePath(data, slot, pathUserData, this, true)) {
+			if (parsePath(data, callback, pathUserData, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -695,7 +697,7 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	}
 }
 
-void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -771,7 +773,7 @@ void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, QList<d
 	}
 }
 
-void SvgFileSplitter::painterPathCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::painterPathCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 	Q_UNUSED(command)			// note: painterPathCommandSlot is only partially implemented
@@ -794,7 +796,7 @@ void SvgFileSplitter::painterPathCommandSlot(QChar command, bool relative, QList
 
 }
 
-void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -863,7 +865,7 @@ void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, QList<doubl
 	}
 }
 
-void SvgFileSplitter::standardArgs(bool relative, bool starting, QList<double> & args, PathUserData * pathUserData) {
+void SvgFileSplitter::standardArgs(bool relative, bool starting, const SVGPathArgs & args, PathUserData * pathUserData) {
 	for (int i = 0; i < args.count(); i++) {
 		double d = args[i];
 		if (i % 2 == 0) {
@@ -910,28 +912,30 @@ QVector<QVariant> SvgFileSplitter::simpleParsePath(const QString & data) {
 }
 
 
-bool SvgFileSplitter::parsePath(const QString & dataString, const char * slot, PathUserData & pathUserData, QObject * slotTarget, bool convertHV) {
-	QVector<QVariant> symStack = simpleParsePath(dataString);
+bool SvgFileSplitter::parsePath(const QString & dataString, const PathCommandCallback & callback, PathUserData & pathUserData, bool convertHV) {
+	SVGPathData pathData;
+	if (!SVGPathScanner::parse(dataString, pathData, true)) {
+		// as with simpleParsePath, a path that doesn't parse runs as an empty path
+		pathData.clear();
+	}
 
 	if (convertHV && (dataString.contains("h", Qt::CaseInsensitive) || dataString.contains("v",  Qt::CaseInsensitive)))
 	{
-		SVGPathRunner svgPathRunner;
 		HVConvertData data;
 		data.x = data.y = data.subX = data.subY = 0;
 		data.path = "";
-		connect(&svgPathRunner, SIGNAL(commandSignal(QChar, bool, QList<double> &, void *)),
-		        this, SLOT(convertHVSlot(QChar, bool, QList<double> &, void *)),
-		        Qt::DirectConnection);
-		svgPathRunner.runPath(symStack, &data);
-		return parsePath(data.path, slot, pathUserData, slotTarget, false);
+		SVGPathRunner::run(pathData, [this, &data](QChar command, bool relative, const SVGPathArgs & args) {
+			convertHVSlot(command, relative, args, &data);
+		});
+		return parsePath(data.path, callback, pathUserData, false);
 	}
 
-	SVGPathRunner svgPathRunner;
-	connect(&svgPathRunner, SIGNAL(commandSignal(QChar, bool, QList<double> &, void *)), slotTarget, slot, Qt::DirectConnection);
-	return svgPathRunner.runPath(symStack, &pathUserData);
+	return SVGPathRunner::run(pathData, [&callback, &pathUserData](QChar command, bool relative, const SVGPathArgs & args) {
+		callback(command, relative, args, &pathUserData);
+	});
 }
 
-void SvgFileSplitter::convertHVSlot(QChar command, bool /* relative */, QList<double> & args, void * userData) {
+void SvgFileSplitter::convertHVSlot(QChar command, bool /* relative */, const SVGPathArgs & args, void * userData) {
 	auto * data = (HVConvertData *) userData;
 
 	switch(command.toLatin1()) {
@@ -1100,6 +1104,124 @@ void SvgFileSplitter::convertHVSlot(QChar command, bool /* relative */, QList<do
 	}
 }
 
+/////////////////////////////////////////////
+
+static void resetOpacity(QXmlStreamAttributes & attributes) {
+	if (!attributes.value("fill-opacity").isEmpty()) {
+		SvgStreamRewriter::setAttribute(attributes, "fill-opacity", "1.0");
+	}
+	if (!attributes.value("stroke-opacity").isEmpty()) {
+		SvgStreamRewriter::setAttribute(attributes, "stroke-opacity", "1.0");
+	}
+}
+
+class StrokeWidthFilter : public SvgStreamFilter
+{
+public:
+	StrokeWidthFilter(double delta, bool absolute, bool changeOpacity) : m_delta(delta), m_absolute(absolute), m_changeOpacity(changeOpacity) {}
+
+	bool startElement(SvgStreamElement & element) override {
+		if (element.depth == 0 && SvgStreamRewriter::localName(element.name) != "svg") return false;
+
+		bool ok;
+		double sw = element.attributes.value("stroke-width").toDouble(&ok);
+		if (ok) {
+			SvgStreamRewriter::setAttribute(element.attributes, "stroke-width", QString::number((m_absolute) ? m_delta : sw + m_delta));
+		}
+		if (m_changeOpacity) {
+			resetOpacity(element.attributes);
+		}
+		return true;
+	}
+
+protected:
+	double m_delta;
+	bool m_absolute;
+	bool m_changeOpacity;
+};
+
+class ColorFilter : public SvgStreamFilter
+{
+public:
+	ColorFilter(const QString & toColor, const QStringList & exceptions) : m_toColor(toColor), m_exceptions(exceptions) {}
+
+	bool startElement(SvgStreamElement & element) override {
+		if (element.depth == 0 && SvgStreamRewriter::localName(element.name) != "svg") return false;
+
+		if (!m_exceptions.contains(element.attributes.value("stroke").toString())) {
+			SvgStreamRewriter::setAttribute(element.attributes, "stroke", m_toColor);
+		}
+		if (!m_exceptions.contains(element.attributes.value("fill").toString())) {
+			SvgStreamRewriter::setAttribute(element.attributes, "fill", m_toColor);
+		}
+		resetOpacity(element.attributes);
+		return true;
+	}
+
+protected:
+	const QString & m_toColor;
+	const QStringList & m_exceptions;
+};
+
+static QString renamedKeepingPrefix(const QString & qualifiedName, const QString & localName)
+{
+	// so that <svg:text> becomes <svg:g> and stays in the svg namespace
+	int colon = qualifiedName.indexOf(':');
+	return (colon < 0) ? localName : qualifiedName.left(colon + 1) + localName;
+}
+
+class HideTextFilter : public SvgStreamFilter
+{
+	// <text> and everything inside it becomes <g>
+public:
+	bool startElement(SvgStreamElement & element) override {
+		if (m_textDepth < 0 && SvgStreamRewriter::localName(element.name) == "text") {
+			m_textDepth = element.depth;
+		}
+		if (m_textDepth >= 0) {
+			element.name = renamedKeepingPrefix(element.name, "g");
+		}
+		return true;
+	}
+
+	void endElement(const SvgStreamElement & element, QXmlStreamWriter &) override {
+		if (element.depth == m_textDepth) m_textDepth = -1;
+	}
+
+protected:
+	int m_textDepth = -1;
+};
+
+class ShowTextFilter : public SvgStreamFilter
+{
+	// everything but <text> (and what's inside it) and the root becomes <g>
+public:
+	ShowTextFilter(bool & hasText) : m_hasText(hasText) {}
+
+	bool startElement(SvgStreamElement & element) override {
+		if (m_textDepth >= 0) return true;
+
+		if (SvgStreamRewriter::localName(element.name) == "text") {
+			m_hasText = true;
+			m_textDepth = element.depth;
+		}
+		else if (element.depth > 0) {
+			element.name = renamedKeepingPrefix(element.name, "g");
+		}
+		return true;
+	}
+
+	void endElement(const SvgStreamElement & element, QXmlStreamWriter &) override {
+		if (element.depth == m_textDepth) m_textDepth = -1;
+	}
+
+protected:
+	bool & m_hasText;
+	int m_textDepth = -1;
+};
+
+/////////////////////////////////////////////
+
 void SvgFileSplitter::setStrokeOrFill(QDomElement & element, bool blackOnly, const QString & color, bool force)
 {
 	if (!blackOnly) return;
@@ -1195,27 +1317,13 @@ bool SvgFileSplitter::getSvgSizeAttributes(const QString & svg, QString & width,
 }
 
 bool SvgFileSplitter::changeStrokeWidth(const QString & svg, double delta, bool absolute, bool changeOpacity, QByteArray & byteArray) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-
-	QDomDocument domDocument;
-
-	if (!domDocument.setContent(svg, true, &errorStr, &errorLine, &errorColumn)) {
-		return false;
-	}
-
-	QDomElement root = domDocument.documentElement();
-	if (root.isNull()) {
-		return false;
-	}
-
-	if (root.tagName() != "svg") {
-		return false;
-	}
+	StrokeWidthFilter filter(delta, absolute, changeOpacity);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result)) return false;
 
-	changeStrokeWidth(root, delta, absolute, changeOpacity);
-	byteArray = domDocument.toByteArray();
+	byteArray = result.toUtf8();
 	return true;
 }
 
@@ -1276,27 +1384,13 @@ void SvgFileSplitter::forceStrokeWidth(QDomElement & element, double delta, cons
 }
 
 bool SvgFileSplitter::changeColors(const QString & svg, QString & toColor, QStringList & exceptions, QByteArray & byteArray) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-
-	QDomDocument domDocument;
-
-	if (!domDocument.setContent(svg, true, &errorStr, &errorLine, &errorColumn)) {
-		return false;
-	}
-
-	QDomElement root = domDocument.documentElement();
-	if (root.isNull()) {
-		return false;
-	}
+	ColorFilter filter(toColor, exceptions);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result)) return false;
 
-	if (root.tagName() != "svg") {
-		return false;
-	}
-
-	changeColors(root, toColor, exceptions);
-	byteArray = domDocument.toByteArray();
+	byteArray = result.toUtf8();
 	return true;
 }
 
@@ -1380,145 +1474,85 @@ void SvgFileSplitter::gReplace(const QString & id)
 }
 
 QByteArray SvgFileSplitter::hideText(const QString & filename) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
 	QFile file(filename);
 	if (!file.open(QIODevice::ReadOnly)) {
 		DebugDialog::debug(QString("Unable to open :%1").arg(filename));
-	}
-	if (!doc.setContent(&file, true, &errorStr, &errorLine, &errorColumn)) {
 		return QByteArray();
 	}
 
-	QDomElement root = doc.documentElement();
-	hideTextAux(root, false);
+	HideTextFilter filter;
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QByteArray result;
+	if (!rewriter.rewrite(&file, result)) {
+		return QByteArray();
+	}
 
-	return TextUtils::removeXMLEntities(doc.toString()).toUtf8();
+	return TextUtils::removeXMLEntities(QString::fromUtf8(result)).toUtf8();
 }
 
 QByteArray SvgFileSplitter::hideText2(const QByteArray & svg) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) {
+	HideTextFilter filter;
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QByteArray result;
+	if (!rewriter.rewrite(svg, result)) {
 		return QByteArray();
 	}
 
-	QDomElement root = doc.documentElement();
-	hideTextAux(root, false);
-
-	return TextUtils::removeXMLEntities(doc.toString()).toUtf8();
+	return TextUtils::removeXMLEntities(QString::fromUtf8(result)).toUtf8();
 }
 
 QString SvgFileSplitter::hideText3(const QString & svg) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) {
+	HideTextFilter filter;
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result)) {
 		return "";
 	}
 
-	QDomElement root = doc.documentElement();
-	hideTextAux(root, false);
-
-	return TextUtils::removeXMLEntities(doc.toString());
-}
-
-
-void SvgFileSplitter::hideTextAux(QDomElement & parent, bool hideChildren) {
-	if (hideChildren || parent.tagName() == "text") {
-		parent.setTagName("g");
-		hideChildren = true;
-	}
-
-	QDomElement child = parent.firstChildElement();
-	while (!child.isNull()) {
-		hideTextAux(child, hideChildren);
-		child = child.nextSiblingElement();
-	}
+	return TextUtils::removeXMLEntities(result);
 }
 
 QByteArray SvgFileSplitter::showText(const QString & filename, bool & hasText) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
 	QFile file(filename);
 	if (!file.open(QIODevice::ReadOnly)) {
 		DebugDialog::debug(QString("Unable to open :%1").arg(filename));
-	}
-	if (!doc.setContent(&file, true, &errorStr, &errorLine, &errorColumn)) {
 		return QByteArray();
 	}
 
-	QDomElement root = doc.documentElement();
-	showTextAux(root, hasText, true);
-	if (!hasText) {
+	ShowTextFilter filter(hasText);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QByteArray result;
+	if (!rewriter.rewrite(&file, result) || !hasText) {
 		return QByteArray();
 	}
 
-	return TextUtils::removeXMLEntities(doc.toString()).toUtf8();
+	return TextUtils::removeXMLEntities(QString::fromUtf8(result)).toUtf8();
 }
 
 QByteArray SvgFileSplitter::showText2(const QByteArray & svg, bool & hasText) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) {
-		return QByteArray();
-	}
-
-	QDomElement root = doc.documentElement();
-	showTextAux(root, hasText, true);
-	if (!hasText) {
+	ShowTextFilter filter(hasText);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QByteArray result;
+	if (!rewriter.rewrite(svg, result) || !hasText) {
 		return QByteArray();
 	}
 
-	return TextUtils::removeXMLEntities(doc.toString()).toUtf8();
+	return TextUtils::removeXMLEntities(QString::fromUtf8(result)).toUtf8();
 }
 
 QString SvgFileSplitter::showText3(const QString & svg, bool & hasText) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) {
+	ShowTextFilter filter(hasText);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result) || !hasText) {
 		return "";
 	}
 
-	QDomElement root = doc.documentElement();
-	showTextAux(root, hasText, true);
-	if (!hasText) {
-		return "";
-	}
-
-	return TextUtils::removeXMLEntities(doc.toString());
-}
-
-void SvgFileSplitter::showTextAux(QDomElement & parent, bool & hasText, bool root) {
-	if (parent.tagName() == "text") {
-		hasText = true;
-		return;
-	}
-
-	if (!root) {
-		parent.setTagName("g");
-	}
-
-	QDomElement child = parent.firstChildElement();
-	while (!child.isNull()) {
-		showTextAux(child, hasText, false);
-		child = child.nextSiblingElement();
-	}
+	return TextUtils::removeXMLEntities(result);
 }
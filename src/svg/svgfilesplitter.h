@@ -30,6 +30,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPainterPath>
 #include <QFile>
 
+#include "svgpathrunner.h"
+
 struct PathUserData {
 	QString string;
 	QTransform transform;
@@ -55,7 +57,7 @@ public:
 	bool normalize(double dpi, const QString & elementID, bool blackOnly, double & factor);
 	QString shift(double x, double y, const QString & elementID, bool shiftTransforms);
 	QString elementString(const QString & elementID);
-	virtual bool parsePath(const QString & data, const char * slot, PathUserData &, QObject * slotTarget, bool convertHV);
+	virtual bool parsePath(const QString & data, const PathCommandCallback &, PathUserData &, bool convertHV);
 	QVector<QVariant> simpleParsePath(const QString & data);
 	QPainterPath painterPath(double dpi, const QString & elementID);			// note: only partially implemented
 	void shiftChild(QDomElement & element, double x, double y, bool shiftTransforms);
@@ -94,20 +96,18 @@ protected:
 	                          double sNewWidth, double sNewHeight,
 	                          double vbWidth, double vbHeight);
 	bool shiftTranslation(QDomElement & element, double x, double y);
-	void standardArgs(bool relative, bool starting, QList<double> & args, PathUserData * pathUserData);
+	void standardArgs(bool relative, bool starting, const SVGPathArgs & args, PathUserData * pathUserData);
 
 protected:
 	static bool shiftAttribute(QDomElement & element, const char * attributeName, double d);
 	static void setStrokeOrFill(QDomElement & element, bool doIt, const QString & color, bool force);
-	static void hideTextAux(QDomElement & parent, bool hideChildren);
-	static void showTextAux(QDomElement & parent, bool & hasText, bool root);
-
-protected Q_SLOTS:
-	void normalizeCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	void shiftCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	virtual void rotateCommandSlot(QChar, bool, QList<double> &, void *) {}
-	void painterPathCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	void convertHVSlot(QChar command, bool relative, QList<double> & args, void * userData);
+
+protected:
+	void normalizeCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	void shiftCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	virtual void rotateCommandSlot(QChar, bool, const SVGPathArgs &, void *) {}
+	void painterPathCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	void convertHVSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData);
 
 protected:
 	QByteArray m_byteArray;
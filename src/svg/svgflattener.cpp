@@ -129,10 +129,10 @@ void SvgFlattener::unRotateChild(QDomElement & element, QTransform transform, co
 		if(tag == "path") {
 			QString data = element.attribute("d").trimmed();
 			if (!data.isEmpty()) {
-				const char * slot = SLOT(rotateCommandSlot(QChar, bool, QList<double> &, void *));
+				PathCommandCallback callback = pathCommandCallback(this, &SvgFlattener::rotateCommandSlot);
 				PathUserData pathUserData;
 				pathUserData.transform = transform;
-				if (parsePath(data, slot, pathUserData, this, true)) {
+				if (parsePath(data, callback, pathUserData, true)) {
 					element.setAttribute("d", pathUserData.string);
 				}
 			}
@@ -140,10 +140,10 @@ void SvgFlattener::unRotateChild(QDomElement & element, QTransform transform, co
 		else if ((tag == "polygon") || (tag == "polyline")) {
 			QString data = element.attribute("points");
 			if (!data.isEmpty()) {
-				const char * slot = SLOT(rotateCommandSlot(QChar, bool, QList<double> &, void *));
+				PathCommandCallback callback = pathCommandCallback(this, &SvgFlattener::rotateCommandSlot);
 				PathUserData pathUserData;
 				pathUserData.transform = transform;
-				if (parsePath(data, slot, pathUserData, this, false)) {
+				if (parsePath(data, callback, pathUserData, false)) {
 					pathUserData.string.remove(0, 1);			// get rid of the "M"
 					element.setAttribute("points", pathUserData.string);
 				}
@@ -243,7 +243,7 @@ bool SvgFlattener::hasOtherTransform(QDomElement & element)
 	return (!transform.contains("translate"));
 }
 
-void SvgFlattener::rotateCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFlattener::rotateCommandSlot(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -21,13 +21,34 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include "svgpathrunner.h"
 
-QHash<QChar, PathCommand *> SVGPathRunner::pathCommands;
+void SVGPathData::clear() {
+	segments.clear();
+	args.clear();
+	complete = true;
+}
+
+void SVGPathData::append(const PathCommand * pathCommand, const double * data, int count) {
+	int argIndex = args.count();
+	for (int i = 0; i < count; i++) {
+		args.append(data[i]);
+	}
+	appendSegment(pathCommand, argIndex, count);
+}
+
+void SVGPathData::appendSegment(const PathCommand * pathCommand, int argIndex, int argCount) {
+	// the arguments are already in args
+	SVGPathSegment segment;
+	segment.command = pathCommand->command;
+	segment.relative = pathCommand->relative;
+	segment.argIndex = argIndex;
+	segment.argCount = argCount;
+	segments.append(segment);
+}
+
+/////////////////////////////////////////////
 
 SVGPathRunner::SVGPathRunner()
 {
-	if (pathCommands.empty()) {
-		initStates();
-	}
 }
 
 SVGPathRunner::~SVGPathRunner()
@@ -40,7 +61,7 @@ bool SVGPathRunner::runPath(QVector<QVariant> & pathData, void * userData) {
 
 	Q_FOREACH (QVariant variant, pathData) {
 		if (variant.type() == QVariant::Char) {
-			PathCommand * newCommand = pathCommands.value(variant.toChar(), nullptr);
+			PathCommand * newCommand = pathCommands().value(variant.toChar(), nullptr);
 			if (newCommand == nullptr) return false;
 
 			if (currentCommand != nullptr) {
@@ -73,8 +94,67 @@ bool SVGPathRunner::runPath(QVector<QVariant> & pathData, void * userData) {
 	return true;
 }
 
-void SVGPathRunner::initStates() {
-	pathCommands.clear();
+bool SVGPathRunner::toPathData(const QVector<QVariant> & symStack, SVGPathData & pathData) {
+	// same validation as runPath, so running the result emits exactly what runPath would have
+	pathData.clear();
+	pathData.args.reserve(symStack.count());
+
+	const PathCommand * currentCommand = nullptr;
+	QVector<double> args;
+	Q_FOREACH (QVariant variant, symStack) {
+		if (variant.type() == QVariant::Char) {
+			const PathCommand * newCommand = pathCommands().value(variant.toChar(), nullptr);
+			if (newCommand == nullptr) {
+				pathData.complete = false;
+				return false;
+			}
+
+			if (currentCommand != nullptr) {
+				if (currentCommand->argCount == 0 ? args.count() != 0 : args.count() % currentCommand->argCount != 0) {
+					pathData.complete = false;
+					return false;
+				}
+
+				pathData.append(currentCommand, args.constData(), args.count());
+			}
+
+			args.clear();
+			currentCommand = newCommand;
+		}
+		else if (variant.type() == QVariant::Double) {
+			if (currentCommand == nullptr) {
+				pathData.complete = false;
+				return false;
+			}
+			args.append(variant.toDouble());
+		}
+	}
+
+	if (currentCommand != nullptr) {
+		if (currentCommand->argCount == 0 ? args.count() != 0 : args.count() % currentCommand->argCount != 0) {
+			pathData.complete = false;
+			return false;
+		}
+
+		pathData.append(currentCommand, args.constData(), args.count());
+	}
+
+	return true;
+}
+
+const PathCommand * SVGPathRunner::pathCommand(QChar command) {
+	return pathCommands().value(command, nullptr);
+}
+
+const QHash<QChar, PathCommand *> & SVGPathRunner::pathCommands() {
+	// gerber layers are generated on worker threads: the table is built once, on first use from
+	// whichever thread gets there first, and is read-only from then on
+	static const QHash<QChar, PathCommand *> commands = initStates();
+	return commands;
+}
+
+QHash<QChar, PathCommand *> SVGPathRunner::initStates() {
+	QHash<QChar, PathCommand *> pathCommands;
 
 	auto * pathCommand = new PathCommand;
 	pathCommand->command = 'M';
@@ -196,4 +276,5 @@ void SVGPathRunner::initStates() {
 	pathCommand->argCount = 2;
 	pathCommands.insert(pathCommand->command, pathCommand);
 
+	return pathCommands;
 }
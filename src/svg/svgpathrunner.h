@@ -24,12 +24,59 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QVariant>
 #include <QVector>
 
+#include <functional>
+
 struct PathCommand {
 	bool relative;
 	int argCount;
 	QChar command;
 };
 
+class SVGPathArgs {
+	// a view onto the numbers belonging to one path command; valid only for the duration of the callback
+
+public:
+	SVGPathArgs(const double * data, int count) : m_data(data), m_count(count) { }
+
+	constexpr int count() const noexcept { return m_count; }
+	constexpr bool isEmpty() const noexcept { return m_count == 0; }
+	const double & at(int i) const { return m_data[i]; }
+	const double & operator[](int i) const { return m_data[i]; }
+	const double * begin() const noexcept { return m_data; }
+	const double * end() const noexcept { return m_data + m_count; }
+
+protected:
+	const double * m_data;
+	int m_count;
+};
+
+struct SVGPathSegment {
+	QChar command;
+	bool relative;
+	int argIndex;			// first argument in SVGPathData::args
+	int argCount;
+};
+
+struct SVGPathData {
+	QVector<SVGPathSegment> segments;
+	QVector<double> args;
+	bool complete = true;		// false if the parsed path was malformed; segments holds what SVGPathRunner::runPath would have emitted before failing
+
+	void clear();
+	bool isEmpty() const { return segments.isEmpty(); }
+	void append(const PathCommand * pathCommand, const double * data, int count);
+	void appendSegment(const PathCommand * pathCommand, int argIndex, int argCount);
+};
+
+typedef std::function<void (QChar command, bool relative, const SVGPathArgs & args, void * userData)> PathCommandCallback;
+
+template <class Target, class Handler>
+PathCommandCallback pathCommandCallback(Target * target, void (Handler::*handler)(QChar, bool, const SVGPathArgs &, void *)) {
+	return [target, handler](QChar command, bool relative, const SVGPathArgs & args, void * userData) {
+		(target->*handler)(command, relative, args, userData);
+	};
+}
+
 class SVGPathRunner : public QObject
 {
 	Q_OBJECT
@@ -41,15 +88,27 @@ public:
 public:
 	bool runPath(QVector<QVariant> & pathData, void * userData);
 
+public:
+	static bool toPathData(const QVector<QVariant> & symStack, SVGPathData & pathData);
+	static const PathCommand * pathCommand(QChar command);
+
+	template <class Visitor>
+	static bool run(const SVGPathData & pathData, Visitor && visitor) {
+		// calls visitor(QChar command, bool relative, const SVGPathArgs & args) for each command, with no signal dispatch or boxing
+		const double * args = pathData.args.constData();
+		for (const SVGPathSegment & segment : pathData.segments) {
+			visitor(segment.command, segment.relative, SVGPathArgs(args + segment.argIndex, segment.argCount));
+		}
+		return pathData.complete;
+	}
+
 Q_SIGNALS:
 	// note: must connect to this signal via Qt::DirectConnection since args is modified immediately after the signal
 	void commandSignal(QChar command, bool relative, QList<double> & args, void * userData);
 
 protected:
-	static void initStates();
-
-protected:
-	static QHash<QChar, PathCommand *> pathCommands;
+	static const QHash<QChar, PathCommand *> & pathCommands();
+	static QHash<QChar, PathCommand *> initStates();
 
 };
 
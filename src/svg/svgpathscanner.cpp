@@ -0,0 +1,203 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "svgpathscanner.h"
+#include "svgpathlexer.h"
+
+static const double Pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(const QChar * pos, const QChar * end) {
+	return pos < end && pos->unicode() >= '0' && pos->unicode() <= '9';
+}
+
+static inline bool isSpace(ushort c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/**
+ * Parse one number in the form accepted by TextUtils::RegexFloatDetector,
+ * i.e. [-+]?[0-9]*\.?[0-9]+([eE][-+]?[0-9]+)?, leaving pos just past it.
+ *
+ * Numbers with at most 15 significant digits and a small exponent (nearly all svg coordinates)
+ * are converted with a single exact multiply or divide, which rounds correctly; anything longer
+ * falls back to QStringView::toDouble so the result always matches QString::toDouble.
+ */
+bool SVGPathScanner::parseNumber(const QChar * & pos, const QChar * end, double & value) {
+	const QChar * start = pos;
+	bool negative = false;
+	if (pos < end && (*pos == QLatin1Char('-') || *pos == QLatin1Char('+'))) {
+		negative = (*pos == QLatin1Char('-'));
+		pos++;
+	}
+
+	quint64 mantissa = 0;
+	int significant = 0;
+	int exponent = 0;
+	bool gotDigits = false;
+	while (isDigit(pos, end)) {
+		if (significant < 19) {
+			mantissa = (mantissa * 10) + (pos->unicode() - '0');
+			if (mantissa != 0) significant++;
+		}
+		else {
+			significant++;
+			exponent++;
+		}
+		gotDigits = true;
+		pos++;
+	}
+
+	if (pos < end && *pos == QLatin1Char('.') && isDigit(pos + 1, end)) {
+		pos++;
+		while (isDigit(pos, end)) {
+			if (significant < 19) {
+				mantissa = (mantissa * 10) + (pos->unicode() - '0');
+				if (mantissa != 0) significant++;
+				exponent--;
+			}
+			else {
+				significant++;
+			}
+			pos++;
+		}
+		gotDigits = true;
+	}
+
+	if (!gotDigits) {
+		pos = start;
+		return false;
+	}
+
+	if (pos < end && (*pos == QLatin1Char('e') || *pos == QLatin1Char('E'))) {
+		const QChar * e = pos + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == QLatin1Char('-') || *e == QLatin1Char('+'))) {
+			negativeExponent = (*e == QLatin1Char('-'));
+			e++;
+		}
+		if (isDigit(e, end)) {
+			int explicitExponent = 0;
+			while (isDigit(e, end)) {
+				if (explicitExponent < 10000) {
+					explicitExponent = (explicitExponent * 10) + (e->unicode() - '0');
+				}
+				e++;
+			}
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			pos = e;
+		}
+		// otherwise the 'e' is not part of the number, just as with the regex
+	}
+
+	if (significant <= 15 && exponent >= -22 && exponent <= 22) {
+		value = (double) mantissa;
+		if (exponent < 0) value /= Pow10[-exponent];
+		else value *= Pow10[exponent];
+		if (negative) value = -value;
+		return true;
+	}
+
+	value = QStringView(start, pos - start).toDouble();
+	return true;
+}
+
+bool SVGPathScanner::finishSegment(const PathCommand * pathCommand, int argIndex, SVGPathData & pathData) {
+	if (pathCommand == nullptr) return true;
+
+	int count = pathData.args.count() - argIndex;
+	if (pathCommand->argCount == 0) {
+		if (count != 0) return false;
+	}
+	else if (count == 0 || count % pathCommand->argCount != 0) return false;
+
+	pathData.appendSegment(pathCommand, argIndex, count);
+	return true;
+}
+
+/**
+ * Parse svg path data (or polygon/polyline points, with implicitMoveTo) into pathData.
+ *
+ * On failure pathData is left incomplete; callers that need the old all-or-nothing
+ * behavior of SvgFileSplitter::simpleParsePath should clear it.
+ */
+bool SVGPathScanner::parse(QStringView data, SVGPathData & pathData, bool implicitMoveTo) {
+	pathData.clear();
+	pathData.segments.reserve(data.size() / 8);
+	pathData.args.reserve(data.size() / 3);
+
+	const QChar * pos = data.begin();
+	const QChar * end = data.end();
+	while (pos < end && isSpace(pos->unicode())) pos++;
+
+	const PathCommand * currentCommand = nullptr;
+	int argIndex = 0;
+	bool started = false;
+	bool afterComma = false;
+	if (implicitMoveTo && pos < end && *pos != QLatin1Char('M') && *pos != QLatin1Char('m')) {
+		currentCommand = SVGPathRunner::pathCommand(QLatin1Char('M'));
+		started = true;
+	}
+
+	bool ok = true;
+	while (ok && pos < end) {
+		ushort c = pos->unicode();
+		if (isSpace(c)) {
+			pos++;
+		}
+		else if (c == ',') {
+			// a comma may only separate two numbers
+			ok = currentCommand != nullptr && !afterComma && pathData.args.count() > argIndex;
+			afterComma = true;
+			pos++;
+		}
+		else if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+') {
+			double value;
+			ok = currentCommand != nullptr && currentCommand->argCount > 0 && parseNumber(pos, end, value);
+			if (ok) {
+				pathData.args.append(value);
+				afterComma = false;
+			}
+		}
+		else {
+			ok = !afterComma && finishSegment(currentCommand, argIndex, pathData);
+			argIndex = pathData.args.count();
+			pos++;
+			if (c == SVGPathLexer::FakeClosePathChar) {
+				ok = ok && started;
+				currentCommand = nullptr;			// marks the end of the path; nothing to emit
+			}
+			else {
+				currentCommand = SVGPathRunner::pathCommand(QChar(c));
+				ok = ok && currentCommand != nullptr && (started || c == 'M' || c == 'm');	// path data must begin with a moveto
+				started = true;
+			}
+		}
+	}
+
+	if (!ok || afterComma || !started || !finishSegment(currentCommand, argIndex, pathData)) {
+		pathData.complete = false;
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,42 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SVGPATHSCANNER_H
+#define SVGPATHSCANNER_H
+
+#include <QStringView>
+
+#include "svgpathrunner.h"
+
+class SVGPathScanner
+{
+	// Single pass over path data straight into SVGPathData: no cleaned copy of the source,
+	// no QVariant stack, and numbers are converted in place.
+	// Accepts the same paths as SVGPathLexer + SVGPathParser, which are kept for compatibility.
+
+public:
+	static bool parse(QStringView data, SVGPathData & pathData, bool implicitMoveTo);
+	static bool parseNumber(const QChar * & pos, const QChar * end, double & value);
+
+protected:
+	static bool finishSegment(const PathCommand * pathCommand, int argIndex, SVGPathData & pathData);
+};
+
+#endif // SVGPATHSCANNER_H
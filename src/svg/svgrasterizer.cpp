@@ -0,0 +1,346 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "svgrasterizer.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+#include <clipper.hpp>
+#include <algorithm>
+#include <cstring>
+
+const int SvgRasterizer::BandHeight = 256;
+const double SvgRasterizer::PolygonScale = 64;		// clipper works in integers, so keep some sub-pixel precision
+
+////////////////////////////////////////////
+
+class PolygonPaintEngine : public QPaintEngine {
+
+public:
+	PolygonPaintEngine() : QPaintEngine((QPaintEngine::PaintEngineFeatures) (QPaintEngine::AllFeatures
+			& ~QPaintEngine::PatternBrush
+			& ~QPaintEngine::PerspectiveTransform
+			& ~QPaintEngine::ConicalGradientFill
+			& ~QPaintEngine::PorterDuff)), unsupported(false) {
+	}
+
+	virtual bool begin(QPaintDevice * /*pdev*/) override {
+		return true;
+	}
+
+	virtual bool end() override {
+		return true;
+	}
+
+	virtual void updateState(const QPaintEngineState & /*state*/) override {
+	}
+
+	virtual void drawPixmap(const QRectF & /*r*/, const QPixmap & /*pm*/, const QRectF & /*sr*/) override {
+		unsupported = true;
+	}
+
+	virtual void drawImage(const QRectF & /*r*/, const QImage & /*pm*/, const QRectF & /*sr*/, Qt::ImageConversionFlags /*flags*/) override {
+		unsupported = true;
+	}
+
+	virtual void drawPath(const QPainterPath & path) override {
+		addShape(path, true);
+	}
+
+	virtual void drawPolygon(const QPointF * points, int pointCount, PolygonDrawMode mode) override {
+		if (pointCount <= 0) return;
+
+		QPainterPath path;
+		path.moveTo(points[0]);
+		for (int i = 1; i < pointCount; i++) {
+			path.lineTo(points[i]);
+		}
+		if (mode != QPaintEngine::PolylineMode) {
+			path.closeSubpath();
+		}
+		path.setFillRule(mode == QPaintEngine::OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+		addShape(path, mode != QPaintEngine::PolylineMode);
+	}
+
+	virtual QPaintEngine::Type type() const override {
+		return User;
+	}
+
+	ClipperLib::Paths paths;
+	bool unsupported;
+
+protected:
+	void addShape(const QPainterPath & path, bool fill) {
+		if (fill && state->brush().style() != Qt::NoBrush) {
+			addPolygons(path.toSubpathPolygons(state->transform()), path.fillRule());
+		}
+		if (state->pen().style() != Qt::NoPen && state->pen().widthF() != 0) {
+			QPainterPath stroke = QPainterPathStroker(state->pen()).createStroke(path);
+			addPolygons(stroke.toSubpathPolygons(state->transform()), stroke.fillRule());
+		}
+	}
+
+	void addPolygons(const QList<QPolygonF> & polygons, Qt::FillRule fillRule) {
+		// normalize each shape under its own fill rule so that everything can be merged as non-zero later
+		ClipperLib::Paths shape;
+		Q_FOREACH (QPolygonF polygon, polygons) {
+			ClipperLib::Path clipperPath;
+			Q_FOREACH (QPointF p, polygon) {
+				clipperPath << ClipperLib::IntPoint(qRound64(p.x() * SvgRasterizer::PolygonScale), qRound64(p.y() * SvgRasterizer::PolygonScale));
+			}
+			shape << clipperPath;
+		}
+
+		ClipperLib::PolyFillType fillType = (fillRule == Qt::OddEvenFill) ? ClipperLib::pftEvenOdd : ClipperLib::pftNonZero;
+		ClipperLib::Clipper clipper;
+		clipper.AddPaths(shape, ClipperLib::ptSubject, true);
+		ClipperLib::Paths normalized;
+		clipper.Execute(ClipperLib::ctUnion, normalized, fillType, fillType);
+		paths.insert(paths.end(), normalized.begin(), normalized.end());
+	}
+};
+
+class PolygonPaintDevice : public QPaintDevice {
+
+public:
+	PolygonPaintDevice(int width, int height, double dpi) : QPaintDevice(), m_width(width), m_height(height), m_dpi(dpi) {
+	}
+
+	virtual QPaintEngine * paintEngine() const override {
+		return &m_engine;
+	}
+
+	PolygonPaintEngine & engine() {
+		return m_engine;
+	}
+
+protected:
+	virtual int metric(QPaintDevice::PaintDeviceMetric metric) const override {
+		switch (metric) {
+			case PdmWidth:
+				return m_width;
+			case PdmHeight:
+				return m_height;
+			case PdmWidthMM:
+				return qRound(m_width * 25.4 / m_dpi);
+			case PdmHeightMM:
+				return qRound(m_height * 25.4 / m_dpi);
+			case PdmDepth:
+				return 1;
+			case PdmNumColors:
+				return 2;
+			case PdmDpiX:
+			case PdmDpiY:
+			case PdmPhysicalDpiX:
+			case PdmPhysicalDpiY:
+				return qRound(m_dpi);
+			case PdmDevicePixelRatio:
+			case PdmDevicePixelRatioScaled:
+				return 1;
+			default:
+				return 0;
+		}
+	}
+
+private:
+	int m_width;
+	int m_height;
+	double m_dpi;
+	mutable PolygonPaintEngine m_engine;
+};
+
+static ClipperLib::Path clipperRect(double left, double top, double right, double bottom) {
+	ClipperLib::Path rect;
+	rect << ClipperLib::IntPoint(qRound64(left * SvgRasterizer::PolygonScale), qRound64(top * SvgRasterizer::PolygonScale))
+	     << ClipperLib::IntPoint(qRound64(right * SvgRasterizer::PolygonScale), qRound64(top * SvgRasterizer::PolygonScale))
+	     << ClipperLib::IntPoint(qRound64(right * SvgRasterizer::PolygonScale), qRound64(bottom * SvgRasterizer::PolygonScale))
+	     << ClipperLib::IntPoint(qRound64(left * SvgRasterizer::PolygonScale), qRound64(bottom * SvgRasterizer::PolygonScale));
+	return rect;
+}
+
+static bool hasHoles(const ClipperLib::Paths & paths) {
+	for (size_t i = 0; i < paths.size(); i++) {
+		if (!ClipperLib::Orientation(paths[i])) return true;
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////
+
+void SvgRasterizer::renderMono(QImage & image, const QByteArray & svg, const QRectF & target) {
+	// Painting directly into a large Format_Mono image was seen to drop short runs of pixels now and then,
+	// more often under load.  Instead render bands into a 32-bit buffer with a fixed, non-antialiased painter
+	// and threshold each band into the mono image.  A band is the full image offset by a whole number of rows,
+	// so the banded result is the same as one big render would be.
+	Q_ASSERT(image.format() == QImage::Format_Mono);
+
+	const int width = image.width();
+	const int height = image.height();
+	if (width <= 0 || height <= 0) return;
+
+	QSvgRenderer renderer(svg);
+	QImage band(width, qMin(BandHeight, height), QImage::Format_RGB32);
+	for (int top = 0; top < height; top += band.height()) {
+		band.fill(0xffffffff);
+		QPainter painter;
+		painter.begin(&band);
+		painter.setRenderHint(QPainter::Antialiasing, false);
+		painter.setRenderHint(QPainter::TextAntialiasing, false);
+		painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+		painter.translate(0, -top);
+		renderer.render(&painter, target);
+		painter.end();
+
+		const int rows = qMin(band.height(), height - top);
+		for (int y = 0; y < rows; y++) {
+			const QRgb * from = reinterpret_cast<const QRgb *>(band.constScanLine(y));
+			uchar * to = image.scanLine(top + y);
+			memset(to, 0, image.bytesPerLine());
+			for (int x = 0; x < width; x++) {
+				if (qGray(from[x]) < 128) {
+					to[x >> 3] |= 0x80 >> (x & 7);
+				}
+			}
+		}
+	}
+}
+
+void SvgRasterizer::applyMask(QImage & image, const QImage & mask, int width, int height) {
+	// in Format_Mono the leftmost pixel is the high bit, so ANDing whole bytes clears exactly the masked pixels
+	Q_ASSERT(image.format() == QImage::Format_Mono && mask.format() == QImage::Format_Mono);
+
+	width = qMin(width, qMin(image.width(), mask.width()));
+	height = qMin(height, qMin(image.height(), mask.height()));
+	if (width <= 0 || height <= 0) return;
+
+	const int fullBytes = width >> 3;
+	const uchar keep = (uchar) ~(0xff00 >> (width & 7));		// the bits past width in the last partial byte
+	for (int y = 0; y < height; y++) {
+		uchar * to = image.scanLine(y);
+		const uchar * from = mask.constScanLine(y);
+		for (int i = 0; i < fullBytes; i++) {
+			to[i] &= from[i];
+		}
+		if (width & 7) {
+			to[fullBytes] &= from[fullBytes] | keep;
+		}
+	}
+}
+
+static bool toPolygons(ClipperLib::Paths & result, const QRectF & target, QList<QPolygonF> & polygons) {
+	if (hasHoles(result)) {
+		// a vertical cut through the middle of every hole opens each one up into its neighboring slices
+		QList<double> cuts;
+		cuts << target.left() << target.right();
+		for (size_t i = 0; i < result.size(); i++) {
+			if (ClipperLib::Orientation(result[i])) continue;
+
+			ClipperLib::cInt minX = result[i][0].X;
+			ClipperLib::cInt maxX = minX;
+			for (size_t j = 1; j < result[i].size(); j++) {
+				minX = qMin(minX, result[i][j].X);
+				maxX = qMax(maxX, result[i][j].X);
+			}
+			cuts << (minX + maxX) / 2.0 / SvgRasterizer::PolygonScale;
+		}
+		std::sort(cuts.begin(), cuts.end());
+
+		ClipperLib::Paths slices;
+		for (int c = 1; c < cuts.count(); c++) {
+			if (cuts.at(c) <= cuts.at(c - 1)) continue;
+
+			ClipperLib::Clipper slicer;
+			slicer.AddPaths(result, ClipperLib::ptSubject, true);
+			slicer.AddPath(clipperRect(cuts.at(c - 1), target.top(), cuts.at(c), target.bottom()), ClipperLib::ptClip, true);
+			ClipperLib::Paths slice;
+			slicer.Execute(ClipperLib::ctIntersection, slice, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+			slices.insert(slices.end(), slice.begin(), slice.end());
+		}
+
+		if (hasHoles(slices)) return false;
+
+		result = slices;
+	}
+
+	for (size_t i = 0; i < result.size(); i++) {
+		QPolygonF polygon;
+		for (size_t j = 0; j < result[i].size(); j++) {
+			polygon << QPointF(result[i][j].X / SvgRasterizer::PolygonScale, result[i][j].Y / SvgRasterizer::PolygonScale);
+		}
+		polygons << polygon;
+	}
+
+	return true;
+}
+
+static bool renderPaths(const QByteArray & svg, const QRectF & target, double dpi, ClipperLib::Paths & result) {
+	// whatever the svg draws, merged and clipped to target
+	PolygonPaintDevice device(qCeil(target.right()), qCeil(target.bottom()), dpi);
+	QSvgRenderer renderer(svg);
+	QPainter painter;
+	painter.begin(&device);
+	renderer.render(&painter, target);
+	painter.end();
+
+	if (device.engine().unsupported) return false;
+
+	ClipperLib::Clipper clipper;
+	clipper.AddPaths(device.engine().paths, ClipperLib::ptSubject, true);
+	clipper.AddPath(clipperRect(target.left(), target.top(), target.right(), target.bottom()), ClipperLib::ptClip, true);
+	clipper.Execute(ClipperLib::ctIntersection, result, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+	return true;
+}
+
+bool SvgRasterizer::renderPolygons(const QByteArray & svg, const QRectF & target, double dpi, QList<QPolygonF> & polygons) {
+	ClipperLib::Paths result;
+	if (!renderPaths(svg, target, dpi, result)) return false;
+
+	return toPolygons(result, target, polygons);
+}
+
+bool SvgRasterizer::renderPolygonsInside(const QByteArray & svg, const QByteArray & outline, const QRectF & target, double dpi, QList<QPolygonF> & polygons) {
+	if (outline.isEmpty()) return false;
+
+	ClipperLib::Paths board;
+	if (!renderPaths(outline, target, dpi, board)) return false;
+	if (board.size() != 1 || hasHoles(board)) return false;		// cutouts, or more than one piece
+
+	ClipperLib::Paths result;
+	if (!renderPaths(svg, target, dpi, result)) return false;
+
+	ClipperLib::Clipper clipper;
+	clipper.AddPaths(result, ClipperLib::ptSubject, true);
+	clipper.AddPaths(board, ClipperLib::ptClip, true);
+	ClipperLib::Paths outside;
+	clipper.Execute(ClipperLib::ctDifference, outside, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+
+	double outsideArea = 0;
+	for (size_t i = 0; i < outside.size(); i++) {
+		outsideArea += qAbs(ClipperLib::Area(outside[i]));
+	}
+	if (outsideArea > PolygonScale * PolygonScale / 2) return false;		// more than half a pixel hangs over the edge
+
+	return toPolygons(result, target, polygons);
+}
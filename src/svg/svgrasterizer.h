@@ -0,0 +1,57 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SVGRASTERIZER_H
+#define SVGRASTERIZER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPolygonF>
+#include <QRectF>
+
+class SvgRasterizer
+{
+
+public:
+	// Renders svg into target within a Format_Mono image, with whatever the svg draws set to white (1) and everything else black (0).
+	// The result depends only on the svg and the target rect, so rendering twice gives identical images.
+	static void renderMono(QImage & image, const QByteArray & svg, const QRectF & target);
+
+	// Clears every pixel in the top-left width x height of image that is black (0) in mask; both are Format_Mono.
+	static void applyMask(QImage & image, const QImage & mask, int width, int height);
+
+	// The vector counterpart of renderMono: flattens whatever the svg draws into polygons in target coordinates, clipped to target.
+	// The polygons never have holes--a shape with holes is cut into vertical slices--so each can become a single gerber region.
+	// Returns false if the svg draws something that can't be kept as vectors, such as an image.
+	static bool renderPolygons(const QByteArray & svg, const QRectF & target, double dpi, QList<QPolygonF> & polygons);
+
+	// renderPolygons for a layer that would otherwise be rendered and clipped to the board: only succeeds when the outline,
+	// rendered into the same target, is a single polygon without cutouts and the whole layer lies inside it,
+	// so that the geometry and the raster round trip cover the same area
+	static bool renderPolygonsInside(const QByteArray & svg, const QByteArray & outline, const QRectF & target, double dpi, QList<QPolygonF> & polygons);
+
+public:
+	static const int BandHeight;
+	static const double PolygonScale;
+
+};
+
+#endif // SVGRASTERIZER_H
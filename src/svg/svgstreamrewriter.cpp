@@ -0,0 +1,230 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "svgstreamrewriter.h"
+
+#include <QIODevice>
+
+static const SvgStreamElement NoParent;
+
+void SvgStreamRewriter::addFilter(SvgStreamFilter * filter) {
+	m_filters.append(filter);
+}
+
+bool SvgStreamRewriter::rewrite(const QByteArray & source, QByteArray & result) {
+	result.clear();
+	QXmlStreamReader reader(source);
+	QXmlStreamWriter writer(&result);
+	if (rewriteAux(reader, writer)) return true;
+
+	result.clear();
+	return false;
+}
+
+bool SvgStreamRewriter::rewrite(const QString & source, QString & result) {
+	result.clear();
+	QXmlStreamReader reader(source);
+	QXmlStreamWriter writer(&result);
+	if (rewriteAux(reader, writer)) return true;
+
+	result.clear();
+	return false;
+}
+
+bool SvgStreamRewriter::rewrite(QIODevice * source, QByteArray & result) {
+	result.clear();
+	QXmlStreamReader reader(source);
+	QXmlStreamWriter writer(&result);
+	if (rewriteAux(reader, writer)) return true;
+
+	result.clear();
+	return false;
+}
+
+bool SvgStreamRewriter::rewriteAux(QXmlStreamReader & reader, QXmlStreamWriter & writer) {
+	// names are copied exactly as written, so namespace prefixes and declarations pass through untouched
+	reader.setNamespaceProcessing(false);
+	writer.setAutoFormatting(false);
+	m_errorString.clear();
+
+	QList<SvgStreamElement> stack;
+	QString pending;
+	bool gotRoot = false;
+	while (!reader.atEnd()) {
+		QXmlStreamReader::TokenType tokenType = reader.readNext();
+		if (tokenType == QXmlStreamReader::Characters && !reader.isCDATA()) {
+			pending.append(reader.text());
+			continue;
+		}
+
+		flushCharacters(writer, stack, pending);
+		switch (tokenType) {
+		case QXmlStreamReader::StartElement: {
+			SvgStreamElement element;
+			element.name = reader.qualifiedName().toString();
+			element.attributes = reader.attributes();
+			element.depth = stack.count();
+			Q_FOREACH (SvgStreamFilter * filter, m_filters) {
+				if (!filter->startElement(element)) {
+					m_errorString = QString("rewrite abandoned at <%1>").arg(element.name);
+					return false;
+				}
+			}
+			writer.writeStartElement(element.name);
+			writeAttributes(writer, element.attributes);
+			Q_FOREACH (SvgStreamFilter * filter, m_filters) {
+				filter->startedElement(element, writer);
+			}
+			stack.append(element);
+			gotRoot = true;
+			break;
+		}
+		case QXmlStreamReader::EndElement: {
+			SvgStreamElement element = stack.takeLast();
+			Q_FOREACH (SvgStreamFilter * filter, m_filters) {
+				filter->endElement(element, writer);
+			}
+			writer.writeEndElement();
+			break;
+		}
+		default:
+			copyToken(reader, writer);
+			break;
+		}
+	}
+
+	if (reader.hasError()) {
+		m_errorString = reader.errorString();
+		return false;
+	}
+
+	if (!gotRoot) {
+		m_errorString = "no document element";
+		return false;
+	}
+
+	return true;
+}
+
+void SvgStreamRewriter::flushCharacters(QXmlStreamWriter & writer, const QList<SvgStreamElement> & stack, QString & pending) {
+	if (pending.isEmpty()) return;
+
+	const SvgStreamElement & parent = stack.isEmpty() ? NoParent : stack.last();
+	Q_FOREACH (SvgStreamFilter * filter, m_filters) {
+		filter->characters(parent, pending);
+	}
+	if (!pending.isEmpty()) {
+		writer.writeCharacters(pending);
+	}
+	pending.clear();
+}
+
+void SvgStreamRewriter::copyToken(QXmlStreamReader & reader, QXmlStreamWriter & writer) {
+	switch (reader.tokenType()) {
+	case QXmlStreamReader::StartDocument:
+		if (!reader.documentVersion().isEmpty()) {
+			writer.writeStartDocument(reader.documentVersion().toString());
+		}
+		break;
+	case QXmlStreamReader::EndDocument:
+		writer.writeEndDocument();
+		break;
+	case QXmlStreamReader::StartElement:
+		writer.writeStartElement(reader.qualifiedName().toString());
+		writeAttributes(writer, reader.attributes());
+		break;
+	case QXmlStreamReader::EndElement:
+		writer.writeEndElement();
+		break;
+	case QXmlStreamReader::Characters:
+		if (reader.isCDATA()) {
+			writer.writeCDATA(reader.text().toString());
+		}
+		else {
+			writer.writeCharacters(reader.text().toString());
+		}
+		break;
+	case QXmlStreamReader::Comment:
+		writer.writeComment(reader.text().toString());
+		break;
+	case QXmlStreamReader::DTD:
+		writer.writeDTD(reader.text().toString());
+		break;
+	case QXmlStreamReader::EntityReference:
+		writer.writeEntityReference(reader.name().toString());
+		break;
+	case QXmlStreamReader::ProcessingInstruction:
+		writer.writeProcessingInstruction(reader.processingInstructionTarget().toString(), reader.processingInstructionData().toString());
+		break;
+	default:
+		break;
+	}
+}
+
+void SvgStreamRewriter::copyChildren(QXmlStreamReader & reader, QXmlStreamWriter & writer) {
+	// reader is sitting on a start element; copy everything up to (not including) its end element
+	int depth = 0;
+	while (!reader.atEnd()) {
+		QXmlStreamReader::TokenType tokenType = reader.readNext();
+		if (tokenType == QXmlStreamReader::StartElement) {
+			depth++;
+		}
+		else if (tokenType == QXmlStreamReader::EndElement) {
+			if (depth-- == 0) return;
+		}
+		copyToken(reader, writer);
+	}
+}
+
+bool SvgStreamRewriter::findElement(const QString & svg, const QString & attribute, const QString & value) {
+	QXmlStreamReader reader(svg);
+	reader.setNamespaceProcessing(false);
+	while (!reader.atEnd()) {
+		if (reader.readNext() != QXmlStreamReader::StartElement) continue;
+
+		QXmlStreamAttributes attributes = reader.attributes();
+		if (attributes.hasAttribute(attribute) && attributes.value(attribute) == value) return true;
+	}
+
+	return false;
+}
+
+QString SvgStreamRewriter::localName(const QString & qualifiedName) {
+	int ix = qualifiedName.indexOf(':');
+	return (ix < 0) ? qualifiedName : qualifiedName.mid(ix + 1);
+}
+
+void SvgStreamRewriter::setAttribute(QXmlStreamAttributes & attributes, const QString & qualifiedName, const QString & value) {
+	for (int i = 0; i < attributes.count(); i++) {
+		if (attributes.at(i).qualifiedName() == qualifiedName) {
+			attributes.replace(i, QXmlStreamAttribute(qualifiedName, value));
+			return;
+		}
+	}
+
+	attributes.append(qualifiedName, value);
+}
+
+void SvgStreamRewriter::writeAttributes(QXmlStreamWriter & writer, const QXmlStreamAttributes & attributes) {
+	// by qualified name, so the writer never invents namespace declarations of its own
+	for (const QXmlStreamAttribute & attribute : attributes) {
+		writer.writeAttribute(attribute.qualifiedName().toString(), attribute.value().toString());
+	}
+}
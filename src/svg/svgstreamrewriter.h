@@ -0,0 +1,85 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SVGSTREAMREWRITER_H
+#define SVGSTREAMREWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+class QIODevice;
+
+struct SvgStreamElement {
+	QString name;						// qualified name; a filter may rename the element
+	QXmlStreamAttributes attributes;	// a filter may add, change or remove attributes
+	int depth = 0;						// 0 for the document element
+};
+
+class SvgStreamFilter
+{
+	// Hooks for SvgStreamRewriter; the default implementations pass everything through unchanged.
+
+public:
+	virtual ~SvgStreamFilter() = default;
+
+	// return false to abandon the rewrite, e.g. when the document element is not <svg>
+	virtual bool startElement(SvgStreamElement &) { return true; }
+	// called after the start tag is written, so a filter can prepend children
+	virtual void startedElement(const SvgStreamElement &, QXmlStreamWriter &) {}
+	// text directly inside parent, with adjacent runs already merged; change or clear it as needed
+	virtual void characters(const SvgStreamElement & /* parent */, QString & /* text */) {}
+	// called before the end tag is written, so a filter can append children
+	virtual void endElement(const SvgStreamElement &, QXmlStreamWriter &) {}
+};
+
+class SvgStreamRewriter
+{
+	// Copies an svg from a QXmlStreamReader to a QXmlStreamWriter in one pass, letting filters edit
+	// element names, attributes and text on the way through. Memory use is bounded by the nesting depth,
+	// so this replaces QDomDocument round-trips wherever no real tree edit is needed.
+
+public:
+	void addFilter(SvgStreamFilter *);
+	bool rewrite(const QByteArray & source, QByteArray & result);
+	bool rewrite(const QString & source, QString & result);
+	bool rewrite(QIODevice * source, QByteArray & result);
+	const QString & errorString() const { return m_errorString; }
+
+public:
+	static void copyChildren(QXmlStreamReader & reader, QXmlStreamWriter & writer);
+	static void copyToken(QXmlStreamReader & reader, QXmlStreamWriter & writer);
+	static bool findElement(const QString & svg, const QString & attribute, const QString & value);
+	static QString localName(const QString & qualifiedName);
+	static void setAttribute(QXmlStreamAttributes &, const QString & qualifiedName, const QString & value);
+	static void writeAttributes(QXmlStreamWriter &, const QXmlStreamAttributes &);
+
+protected:
+	bool rewriteAux(QXmlStreamReader & reader, QXmlStreamWriter & writer);
+	void flushCharacters(QXmlStreamWriter & writer, const QList<SvgStreamElement> & stack, QString & pending);
+
+protected:
+	QList<SvgStreamFilter *> m_filters;
+	QString m_errorString;
+};
+
+#endif // SVGSTREAMREWRITER_H
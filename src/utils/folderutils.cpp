@@ -33,6 +33,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFileInfo>
 #include <QStandardPaths>
 
+#include <filesystem>
+
 #include "../debugdialog.h"
 #include "utils/misc.h"
 #include "fmessagebox.h"
@@ -717,6 +719,25 @@ bool FolderUtils::slamCopy(QFile & file, const QString & dest) {
 	return file.copy(dest);
 }
 
+bool FolderUtils::replaceFile(const QString & source, const QString & dest) {
+	// source and dest should be on the same volume; the rename then swaps dest in one step,
+	// so a reader never sees a missing or half-written file
+	// QFile::rename() refuses to overwrite, so go through std::filesystem with native path encodings
+	std::error_code error;
+#ifdef Q_OS_WIN
+	std::filesystem::path sourcePath(source.toStdWString());
+	std::filesystem::path destPath(dest.toStdWString());
+#else
+	std::filesystem::path sourcePath(QFile::encodeName(source).toStdString());
+	std::filesystem::path destPath(QFile::encodeName(dest).toStdString());
+#endif
+	std::filesystem::rename(sourcePath, destPath, error);
+	if (!error) return true;
+
+	DebugDialog::debug(QString("unable to replace %1 with %2: %3").arg(dest, source, QString::fromStdString(error.message())));
+	return false;
+}
+
 void FolderUtils::showInFolder(const QString & path)
 {
 	// http://stackoverflow.com/questions/3490336/how-to-reveal-in-finder-or-show-in-explorer-with-qt
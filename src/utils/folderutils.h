@@ -61,6 +61,7 @@ public:
 	static void makePartFolderHierarchy(const QString & prefixFolder, const QString & destFolder);
   	static void copyBin(const QString & dest, const QString & source);
 	static bool slamCopy(QFile &, const QString & dest);
+	static bool replaceFile(const QString & source, const QString & dest);
 	static void showInFolder(const QString & path);
 	static void createUserDataStoreFolders();
 	static QString addToBasename(const QString &filePath, const QString &addition);
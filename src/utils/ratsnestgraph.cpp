@@ -0,0 +1,193 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "ratsnestgraph.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <boost/polygon/voronoi.hpp>
+
+namespace {
+
+struct Site {
+	int x;
+	int y;
+};
+
+struct Candidate {
+	double weight;
+	int from;
+	int to;
+};
+
+int find(std::vector<int> & parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+double squaredDistance(const QPointF & p1, const QPointF & p2) {
+	double dx = p1.x() - p2.x();
+	double dy = p1.y() - p2.y();
+	return (dx * dx) + (dy * dy);
+}
+
+}
+
+namespace boost {
+namespace polygon {
+
+template <>
+struct geometry_concept<Site> {
+	typedef point_concept type;
+};
+
+template <>
+struct point_traits<Site> {
+	typedef int coordinate_type;
+
+	static inline coordinate_type get(const Site & site, orientation_2d orient) {
+		return (orient == HORIZONTAL) ? site.x : site.y;
+	}
+};
+
+}
+}
+
+QList< QPair<int, int> > RatsnestGraph::delaunayEdges(const QList<QPointF> & points)
+{
+	QList< QPair<int, int> > edges;
+	if (points.count() < 2) return edges;
+
+	// identical points are joined to the first of them; distinct points that round to the same site share it,
+	// and each Delaunay edge between two sites stands for every pair of their points
+	std::vector<Site> sites;
+	std::vector< QList<int> > members;
+	QHash<quint64, int> siteAt;
+	sites.reserve(points.count());
+	members.reserve(points.count());
+	for (int i = 0; i < points.count(); i++) {
+		Site site;
+		site.x = static_cast<int>(std::lround(points.at(i).x() * Resolution));
+		site.y = static_cast<int>(std::lround(points.at(i).y() * Resolution));
+		quint64 key = (static_cast<quint64>(static_cast<quint32>(site.x)) << 32) | static_cast<quint32>(site.y);
+		int s = siteAt.value(key, -1);
+		if (s < 0) {
+			siteAt.insert(key, static_cast<int>(sites.size()));
+			sites.push_back(site);
+			members.push_back(QList<int>() << i);
+			continue;
+		}
+
+		bool identical = false;
+		Q_FOREACH (int member, members[s]) {
+			if (points.at(member) == points.at(i)) {
+				edges.append(QPair<int, int>(member, i));
+				identical = true;
+				break;
+			}
+		}
+		if (identical) continue;
+
+		Q_FOREACH (int member, members[s]) {
+			edges.append(QPair<int, int>(member, i));
+		}
+		members[s].append(i);
+	}
+
+	if (sites.size() < 2) return edges;
+
+	// the Voronoi diagram is the dual of the Delaunay triangulation: cells sharing an edge are Delaunay neighbors
+	boost::polygon::voronoi_diagram<double> diagram;
+	boost::polygon::construct_voronoi(sites.begin(), sites.end(), &diagram);
+	for (const auto & edge : diagram.edges()) {
+		if (!edge.is_primary()) continue;
+
+		std::size_t from = edge.cell()->source_index();
+		std::size_t to = edge.twin()->cell()->source_index();
+		if (from >= to) continue;				// each edge comes with its twin
+
+		Q_FOREACH (int member1, members[from]) {
+			Q_FOREACH (int member2, members[to]) {
+				edges.append(QPair<int, int>(member1, member2));
+			}
+		}
+	}
+
+	return edges;
+}
+
+QList< QPair<int, int> > RatsnestGraph::spanningTree(const QList<QPointF> & points, const QVector<int> & groups)
+{
+	QList< QPair<int, int> > tree;
+	int count = points.count();
+	if (count < 2) return tree;
+
+	// Kruskal over the candidates, starting with each group already joined
+	std::vector<int> parent(count);
+	std::iota(parent.begin(), parent.end(), 0);
+	QHash<int, int> firstInGroup;
+	for (int i = 0; i < count; i++) {
+		int first = firstInGroup.value(groups.at(i), -1);
+		if (first < 0) {
+			firstInGroup.insert(groups.at(i), i);
+			continue;
+		}
+
+		parent[i] = find(parent, first);
+	}
+	int components = firstInGroup.count();
+	if (components < 2) return tree;
+
+	QList< QPair<int, int> > edges = delaunayEdges(points);
+	std::vector<Candidate> candidates;
+	candidates.reserve(edges.count());
+	Q_FOREACH (const auto & edge, edges) {
+		Candidate candidate;
+		candidate.weight = squaredDistance(points.at(edge.first), points.at(edge.second));
+		candidate.from = edge.first;
+		candidate.to = edge.second;
+		candidates.push_back(candidate);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate & c1, const Candidate & c2) {
+		return c1.weight < c2.weight;
+	});
+
+	for (const auto & candidate : candidates) {
+		int root1 = find(parent, candidate.from);
+		int root2 = find(parent, candidate.to);
+		if (root1 == root2) continue;
+
+		parent[root2] = root1;
+		if (candidate.weight != 0) {
+			tree.append(QPair<int, int>(candidate.from, candidate.to));
+		}
+		if (--components == 1) break;
+	}
+
+	return tree;
+}
@@ -0,0 +1,47 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef RATSNESTGRAPH_H
+#define RATSNESTGRAPH_H
+
+#include <QList>
+#include <QPair>
+#include <QPointF>
+#include <QVector>
+
+// Minimum spanning tree for drawing a ratsnest. A minimum spanning tree over points in the plane only
+// ever uses edges of their Delaunay triangulation, so the tree is built from those O(n) candidates
+// rather than from every pair of points.
+
+class RatsnestGraph
+{
+public:
+	// points in the same group are already connected (wired, or on one bus) and cost nothing to join.
+	// returns the pairs of indexes into points that still need a ratsnest line; coincident points need none
+	static QList< QPair<int, int> > spanningTree(const QList<QPointF> & points, const QVector<int> & groups);
+
+	// each Delaunay edge once, as pairs of indexes into points
+	static QList< QPair<int, int> > delaunayEdges(const QList<QPointF> & points);
+
+public:
+	static constexpr double Resolution = 64;		// the triangulation works on integer coordinates, 1/64 pixel apart
+};
+
+#endif
@@ -26,6 +26,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "textutils.h"
 #include "misc.h"
 #include "../installedfonts.h"
+#include "../svg/svgstreamrewriter.h"
 
 #include <QRegularExpression>
 #include <QRegularExpression>
@@ -345,75 +346,167 @@ bool TextUtils::squashElement(QDomDocument & doc, const QString & elementName, c
 	return result;
 }
 
-QString TextUtils::replaceTextElement(const QString & svg, const QString & id, const QString & newValue) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) return svg;
+/////////////////////////////////////////////
 
-	QDomElement root = doc.documentElement();
-	QDomNodeList domNodeList = root.elementsByTagName("text");
-	for (int i = 0; i < domNodeList.count(); i++) {
-		QDomElement node = domNodeList.item(i).toElement();
-		if (node.isNull()) continue;
+class ReplaceTextFilter : public SvgStreamFilter
+{
+	// replaces the first run of text directly inside <text id=...> (or appends one), as replaceChildText does
+public:
+	ReplaceTextFilter(const QHash<QString, QString> & values, bool firstOnly) : m_values(values), m_firstOnly(firstOnly) {}
 
-		if (node.attribute("id").compare(id) != 0) continue;
+	bool startElement(SvgStreamElement & element) override {
+		if (m_targetDepth >= 0 || element.name != "text") return true;
+		if (m_firstOnly && m_changed) return true;
 
-		replaceChildText(node, newValue);
-		return doc.toString();
+		QString id = element.attributes.value("id").toString();
+		if (!m_values.contains(id)) return true;
+
+		m_targetDepth = element.depth;
+		m_value = m_values.value(id);
+		m_replaced = false;
+		m_changed = true;
+		return true;
 	}
 
-	return svg;
-}
+	void characters(const SvgStreamElement & parent, QString & text) override {
+		// whitespace-only runs don't count, since QDomDocument drops them
+		if (m_replaced || parent.depth != m_targetDepth || text.trimmed().isEmpty()) return;
 
-QByteArray TextUtils::replaceTextElement(const QByteArray & svg, const QString & id, const QString & newValue) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) return svg;
+		text = m_value;
+		m_replaced = true;
+	}
 
-	QDomElement root = doc.documentElement();
-	QDomNodeList domNodeList = root.elementsByTagName("text");
-	for (int i = 0; i < domNodeList.count(); i++) {
-		QDomElement node = domNodeList.item(i).toElement();
-		if (node.isNull()) continue;
+	void endElement(const SvgStreamElement & element, QXmlStreamWriter & writer) override {
+		if (element.depth != m_targetDepth) return;
+
+		if (!m_replaced) {
+			writer.writeCharacters(m_value);
+		}
+		m_targetDepth = -1;
+	}
+
+	bool changed() const { return m_changed; }
+
+protected:
+	const QHash<QString, QString> & m_values;
+	bool m_firstOnly;
+	bool m_changed = false;
+	bool m_replaced = false;
+	int m_targetDepth = -1;
+	QString m_value;
+};
+
+class MergeFilter : public SvgStreamFilter
+{
+	// appends the children of svg2's element with the given id (or of its root) to the same element
+	// in the document being copied (or to its root), optionally wrapping the root's children in a
+	// mirroring <g> as gWrap does
+public:
+	MergeFilter(const QString & svg2, const QString & id, bool flip) : m_svg2(svg2), m_id(id), m_flip(flip) {}
+
+	bool startElement(SvgStreamElement & element) override {
+		if (m_svg2.isEmpty()) return true;
 
-		if (node.attribute("id").compare(id) != 0) continue;
+		if (element.depth == 0 && element.name != "svg") return false;
 
-		replaceChildText(node, newValue);
-		return doc.toByteArray();
+		if (m_targetDepth < 0 && !m_merged && !m_id.isEmpty() && element.attributes.value("id") == m_id) {
+			m_targetDepth = element.depth;
+		}
+		return true;
 	}
 
-	return svg;
-}
+	void startedElement(const SvgStreamElement & element, QXmlStreamWriter & writer) override {
+		if (element.depth != 0 || !m_flip) return;
 
-QString TextUtils::replaceTextElements(const QString & svg, const QHash<QString, QString> & hash) {
-	QString errorStr;
-	int errorLine;
-	int errorColumn;
-	QDomDocument doc;
-	if (!doc.setContent(svg, &errorStr, &errorLine, &errorColumn)) return svg;
+		QStringList coords = element.attributes.value("viewBox").toString().split(" ", Qt::SkipEmptyParts);
+		double width = (coords.count() > 2) ? coords[2].toDouble() : 0;
+		QTransform matrix;
+		matrix.translate(width / 2, 0);
+		matrix.scale(-1, 1);
+		matrix.translate(-width / 2, 0);
+		writer.writeStartElement("g");
+		writer.writeAttribute("transform", TextUtils::svgMatrix(matrix));
+	}
 
-	bool changed = false;
-	QDomElement root = doc.documentElement();
-	QDomNodeList domNodeList = root.elementsByTagName("text");
-	for (int i = 0; i < domNodeList.count(); i++) {
-		QDomElement node = domNodeList.item(i).toElement();
-		if (node.isNull()) continue;
-		Q_FOREACH (QString id, hash.keys()) {
-			if (node.attribute("id").compare(id) != 0) continue;
+	void endElement(const SvgStreamElement & element, QXmlStreamWriter & writer) override {
+		if (!m_merged && !m_svg2.isEmpty() && (element.depth == m_targetDepth || element.depth == 0)) {
+			m_merged = true;
+			m_failed = !mergeChildren(writer);
+		}
+		if (element.depth == 0 && m_flip) {
+			writer.writeEndElement();
+		}
+	}
 
-			replaceChildText(node, hash.value(id));
-			changed = true;
-			break;
+	bool failed() const { return m_failed; }
+
+protected:
+	bool mergeChildren(QXmlStreamWriter & writer) {
+		bool hasId = !m_id.isEmpty() && SvgStreamRewriter::findElement(m_svg2, "id", m_id);
+
+		QXmlStreamReader reader(m_svg2);
+		reader.setNamespaceProcessing(false);
+		bool gotRoot = false;
+		while (!reader.atEnd()) {
+			if (reader.readNext() != QXmlStreamReader::StartElement) continue;
+
+			if (!gotRoot) {
+				if (reader.qualifiedName() != QLatin1String("svg")) return false;
+				gotRoot = true;
+			}
+
+			if (!hasId || reader.attributes().value("id") == m_id) {
+				SvgStreamRewriter::copyChildren(reader, writer);
+				break;
+			}
 		}
+
+		return gotRoot && !reader.hasError();
 	}
 
-	if (!changed) return svg;
+protected:
+	const QString & m_svg2;
+	const QString & m_id;
+	bool m_flip;
+	int m_targetDepth = -1;
+	bool m_merged = false;
+	bool m_failed = false;
+};
+
+/////////////////////////////////////////////
+
+QString TextUtils::replaceTextElement(const QString & svg, const QString & id, const QString & newValue) {
+	QHash<QString, QString> values;
+	values.insert(id, newValue);
+	ReplaceTextFilter filter(values, true);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result) || !filter.changed()) return svg;
 
-	return doc.toString();
+	return result;
+}
+
+QByteArray TextUtils::replaceTextElement(const QByteArray & svg, const QString & id, const QString & newValue) {
+	QHash<QString, QString> values;
+	values.insert(id, newValue);
+	ReplaceTextFilter filter(values, true);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QByteArray result;
+	if (!rewriter.rewrite(svg, result) || !filter.changed()) return svg;
+
+	return result;
+}
+
+QString TextUtils::replaceTextElements(const QString & svg, const QHash<QString, QString> & hash) {
+	ReplaceTextFilter filter(hash, false);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg, result) || !filter.changed()) return svg;
+
+	return result;
 }
 
 
@@ -488,29 +581,15 @@ QString TextUtils::mergeSvgFinish(QDomDocument & doc) {
 }
 
 QString TextUtils::mergeSvg(const QString & svg1, const QString & svg2, const QString & id, bool flip) {
+	// streams svg1 (or svg2 alone, if svg1 is empty) and splices svg2 in on the way through
+	static const QString NoMerge;
+	MergeFilter filter(svg1.isEmpty() ? NoMerge : svg2, id, flip);
+	SvgStreamRewriter rewriter;
+	rewriter.addFilter(&filter);
+	QString result;
+	if (!rewriter.rewrite(svg1.isEmpty() ? svg2 : svg1, result) || filter.failed()) return ___emptyString___;
 
-	QDomDocument doc1;
-	if (!svg1.isEmpty()) {
-		if (!TextUtils::mergeSvg(doc1, svg1, id)) return ___emptyString___;
-	}
-
-	if (!TextUtils::mergeSvg(doc1, svg2, id)) return ___emptyString___;
-
-	if (flip) {
-		QDomElement svg = doc1.documentElement();
-		QString viewBox = svg.attribute("viewBox");
-		QStringList coords = viewBox.split(" ", Qt::SkipEmptyParts);
-		double width = coords[2].toDouble();
-		QTransform matrix;
-		matrix.translate(width / 2, 0);
-		matrix.scale(-1, 1);
-		matrix.translate(-width / 2, 0);
-		QHash<QString, QString> attributes;
-		attributes.insert("transform", svgMatrix(matrix));
-		gWrap(doc1, attributes);
-	}
-
-	return mergeSvgFinish(doc1);
+	return removeXMLEntities(result);
 }
 
 QString TextUtils::makeSVGHeader(double printerScale, double dpi, double width, double height) {
@@ -0,0 +1,169 @@
+#include <boost/test/unit_test.hpp>
+
+#include "autoroute/drcvector.h"
+
+#include <QDomDocument>
+#include <QRandomGenerator>
+
+#include <cmath>
+
+/*
+Checks what the vector DRC engine sees after tagging: copper at its real size
+whichever way its fill and stroke are given, and overlaps only where copper
+really comes within the keepout.
+*/
+
+static const QSize DeviceSize(VectorDPI, VectorDPI);		// the test documents are an inch square, one unit per mil
+
+static QDomElement byID(const QDomElement & root, const QString & id) {
+	QList<QDomElement> elements;
+	elements << root;
+	while (!elements.isEmpty()) {
+		QDomElement element = elements.takeLast();
+		if (element.attribute("id") == id) return element;
+
+		for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+			elements.append(child);
+		}
+	}
+	return QDomElement();
+}
+
+static double area(const ClipperLib::Paths & paths) {
+	double result = 0;
+	for (const ClipperLib::Path & path : paths) {
+		result += ClipperLib::Area(path);
+	}
+	return std::fabs(result);
+}
+
+static double milsToArea(double squareMils) {
+	double unitsPerMil = VectorDPI / 1000;
+	return squareMils * unitsPerMil * unitsPerMil;
+}
+
+struct TaggedCopper {
+	QDomDocument doc;
+	VectorCopper vectorCopper;
+
+	TaggedCopper(const QString & svg, double keepoutMils) {
+		BOOST_REQUIRE(doc.setContent(svg));
+		QDomElement root = doc.documentElement();
+		int count = tagCopper(root);
+		vectorCopper.render(doc.toByteArray(), count, DeviceSize, keepoutMils * VectorDPI / 1000);
+	}
+
+	int index(const QString & id) const {
+		QDomElement element = byID(doc.documentElement(), id);
+		BOOST_REQUIRE(!element.isNull());
+		bool ok;
+		int ix = element.attribute("drcindex").toInt(&ok);
+		BOOST_REQUIRE(ok);
+		return ix;
+	}
+
+	const ClipperLib::Paths & copper(const QString & id) const {
+		return vectorCopper.copper.at(index(id));
+	}
+
+	double overlap(const QString & netID, const QString & otherID) const {
+		ClipperLib::Paths paths = vectorCopper.overlap(QList<int>() << index(netID), QSet<int>() << index(otherID));
+		removeNoise(paths);
+		return area(paths);
+	}
+};
+
+static QString padAndTrace(double traceLeft) {
+	// a round pad with stroke="none" under a group stroke-width it must not draw,
+	// next to a trace that is only colored through its style attribute
+	return QString("<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	               "<g stroke-width='100'><circle id='pad' cx='300' cy='500' r='100' fill='black' stroke='none'/></g>"
+	               "<path id='trace' d='M%1,480 L%2,480 L%2,520 L%1,520 Z' style='fill:#000000;stroke:none'/>"
+	               "</svg>").arg(traceLeft).arg(traceLeft + 200);
+}
+
+BOOST_AUTO_TEST_CASE( test_tagged_copper_keeps_its_real_size )
+{
+	TaggedCopper tagged(padAndTrace(600), 10);
+	BOOST_CHECK_CLOSE(area(tagged.copper("pad")), milsToArea(M_PI * 100 * 100), 1.0);
+	BOOST_CHECK_CLOSE(area(tagged.copper("trace")), milsToArea(200 * 40), 1.0);
+
+	QDomElement trace = byID(tagged.doc.documentElement(), "trace");
+	BOOST_CHECK(!trace.attribute("style").contains("fill"));
+	BOOST_CHECK_EQUAL(byID(tagged.doc.documentElement(), "pad").attribute("stroke"), QString("none"));
+}
+
+BOOST_AUTO_TEST_CASE( test_style_stroke_is_recolored )
+{
+	// the style's stroke wins over the attribute, and its butt ends stay square
+	QString svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	              "<line id='wire' x1='100' y1='100' x2='500' y2='100' stroke='none' style='stroke:#ff0000;stroke-width:20'/>"
+	              "</svg>";
+	TaggedCopper tagged(svg, 10);
+	BOOST_CHECK_CLOSE(area(tagged.copper("wire")), milsToArea(400 * 20), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_overlap_against_clearance )
+{
+	// the pad's right edge is at x = 400
+	BOOST_CHECK_EQUAL(TaggedCopper(padAndTrace(440), 10).overlap("pad", "trace"), 0.0);		// 40 mil gap
+	BOOST_CHECK_GT(TaggedCopper(padAndTrace(405), 10).overlap("pad", "trace"), 0.0);		// inside the keepout
+	BOOST_CHECK_GT(TaggedCopper(padAndTrace(380), 10).overlap("pad", "trace"), 0.0);		// touching copper
+	BOOST_CHECK_EQUAL(TaggedCopper(padAndTrace(405), 2).overlap("pad", "trace"), 0.0);		// clear of a smaller keepout
+}
+
+static void referenceFill(const QList<QPolygonF> & polygons, QImage * image, uint clr) {
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		QRect bounds = polygon.boundingRect().toAlignedRect().intersected(image->rect());
+		if (bounds.isEmpty()) continue;
+
+		bool gotOne = false;
+		for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+			for (int x = bounds.left(); x <= bounds.right(); x++) {
+				if (!polygon.containsPoint(QPointF(x + 0.5, y + 0.5), Qt::OddEvenFill)) continue;
+
+				image->setPixel(x, y, clr);
+				gotOne = true;
+			}
+		}
+		if (!gotOne) {
+			image->setPixel(bounds.center(), clr);
+		}
+	}
+}
+
+static QImage displayImage() {
+	QImage image(200, 150, QImage::Format_Indexed8);
+	image.setColor(0, 0);
+	image.setColor(1, 0x80ff0000);
+	image.fill(0);
+	return image;
+}
+
+BOOST_AUTO_TEST_CASE( test_fillPolygons_matches_containsPoint )
+{
+	QRandomGenerator random(5);
+	for (int round = 0; round < 20; round++) {
+		QList<QPolygonF> polygons;
+		for (int p = 0; p < 4; p++) {
+			QPolygonF polygon;
+			int points = 3 + random.bounded(6);
+			for (int i = 0; i < points; i++) {
+				polygon << QPointF(random.bounded(230.0) - 15, random.bounded(180.0) - 15);
+			}
+			polygons << polygon;
+		}
+		// thinner than a pixel
+		polygons << QPolygonF(QRectF(40.6, 20.2, 0.2, 0.5));
+
+		QImage expected = displayImage();
+		referenceFill(polygons, &expected, 1);
+
+		QImage image = displayImage();
+		QList<QPointF> points;
+		fillPolygons(polygons, &image, 1, points);
+		BOOST_CHECK(image == expected);
+		BOOST_CHECK(!points.isEmpty());
+		BOOST_CHECK_LE(points.count(), 1000 + polygons.count());
+	}
+}
@@ -0,0 +1,122 @@
+#define BOOST_TEST_MODULE DRC Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "autoroute/pixelcollide.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+/*
+Compares the word-at-a-time DRC collision kernel against a plain
+bit-at-a-time scan, and times both on a board-sized image.
+*/
+
+static bool referenceCollide(const QImage * image1, const QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points) {
+	bool result = false;
+	for (int y = y1; y < y2; y++) {
+		for (int x = x1; x < x2; x++) {
+			if (image1->pixelIndex(x, y) != 0) continue;
+			if (image2->pixelIndex(x, y) != 0) continue;
+
+			image3->setPixel(x, y, clr);
+			result = true;
+			if (points.count() < 1000) {
+				points.append(QPointF(x, y));
+			}
+		}
+	}
+	return result;
+}
+
+static QImage makeMono(QSize size, int blackRects, quint32 seed) {
+	QImage image(size, QImage::Format_Mono);
+	image.fill(0xffffffff);
+	QRandomGenerator random(seed);
+	for (int i = 0; i < blackRects; i++) {
+		int x = random.bounded(size.width());
+		int y = random.bounded(size.height());
+		int w = 1 + random.bounded(40);
+		int h = 1 + random.bounded(40);
+		for (int iy = y; iy < qMin(y + h, size.height()); iy++) {
+			for (int ix = x; ix < qMin(x + w, size.width()); ix++) {
+				image.setPixel(ix, iy, 0);
+			}
+		}
+	}
+	return image;
+}
+
+static QImage makeDisplay(QSize size) {
+	QImage image(size, QImage::Format_Indexed8);
+	image.setColor(0, 0);
+	image.setColor(1, 0x80ff0000);
+	image.fill(0);
+	return image;
+}
+
+BOOST_AUTO_TEST_CASE( test_pixelsCollide_matches_reference )
+{
+	QSize size(333, 97);			// deliberately not a multiple of 64
+	QImage image1 = makeMono(size, 60, 1);
+	QImage image2 = makeMono(size, 60, 2);
+
+	QList<QRect> spans;
+	spans << QRect(QPoint(0, 0), size)
+		  << QRect(3, 5, 4, 10)				// inside a single byte
+		  << QRect(7, 0, 2, 97)				// straddling a byte boundary
+		  << QRect(13, 11, 150, 40)
+		  << QRect(64, 0, 128, 97)
+		  << QRect(200, 50, 133, 47);
+
+	Q_FOREACH (QRect span, spans) {
+		QImage display1 = makeDisplay(size);
+		QImage display2 = makeDisplay(size);
+		QList<QPointF> points1;
+		QList<QPointF> points2;
+		bool result1 = referenceCollide(&image1, &image2, &display1, span.left(), span.top(), span.right() + 1, span.bottom() + 1, 1, points1);
+		bool result2 = pixelsCollide(&image1, &image2, &display2, span.left(), span.top(), span.right() + 1, span.bottom() + 1, 1, points2);
+		BOOST_CHECK_EQUAL(result1, result2);
+		BOOST_CHECK(points1 == points2);
+		BOOST_CHECK(display1 == display2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_pixelsCollide_no_collision )
+{
+	QSize size(200, 50);
+	QImage image1 = makeMono(size, 40, 3);
+	QImage image2(size, QImage::Format_Mono);
+	image2.fill(0xffffffff);
+	QImage display = makeDisplay(size);
+	QList<QPointF> points;
+	BOOST_CHECK(!pixelsCollide(&image1, &image2, &display, 0, 0, size.width(), size.height(), 1, points));
+	BOOST_CHECK(points.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_pixelsCollide )
+{
+	// roughly a 4 x 3 inch board at the 1000 dpi a 1 mil keepout implies
+	QSize size(4000, 3000);
+	QImage image1 = makeMono(size, 2000, 4);
+	QImage image2 = makeMono(size, 2000, 5);
+
+	QImage display1 = makeDisplay(size);
+	QList<QPointF> points1;
+	QElapsedTimer timer;
+	timer.start();
+	referenceCollide(&image1, &image2, &display1, 0, 0, size.width(), size.height(), 1, points1);
+	qint64 referenceTime = timer.elapsed();
+
+	QImage display2 = makeDisplay(size);
+	QList<QPointF> points2;
+	const int repeats = 10;
+	timer.restart();
+	for (int i = 0; i < repeats; i++) {
+		points2.clear();
+		pixelsCollide(&image1, &image2, &display2, 0, 0, size.width(), size.height(), 1, points2);
+	}
+	double wordTime = timer.elapsed() / (double) repeats;
+
+	BOOST_CHECK(display1 == display2);
+	BOOST_TEST_MESSAGE("pixelsCollide " << size.width() << "x" << size.height() << ": bitwise " << referenceTime << " ms, word-at-a-time " << wordTime << " ms");
+}
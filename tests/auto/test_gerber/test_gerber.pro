@@ -19,6 +19,7 @@ CONFIG += c++17
 absolute_boost = 1
 include($$absolute_path(../../../pri/boostdetect.pri))
 include($$absolute_path(../../../pri/svgppdetect.pri))
+include($$absolute_path(../../../pri/clipper1detect.pri))
 
 QT += core xml svg widgets
 equals(QT_MAJOR_VERSION, 6) {
@@ -38,6 +39,9 @@ HEADERS += $$files(../../../src/svg/svgpathgrammar_p.h)
 HEADERS += $$files(../../../src/svg/svgpathlexer.h)
 HEADERS += $$files(../../../src/svg/svgpathparser.h)
 HEADERS += $$files(../../../src/svg/svgpathrunner.h)
+HEADERS += $$files(../../../src/svg/svgpathscanner.h)
+HEADERS += $$files(../../../src/svg/svgstreamrewriter.h)
+HEADERS += $$files(../../../src/svg/svgrasterizer.h)
 HEADERS += $$files(../../../src/svg/svgtext.h)
 HEADERS += $$files(../../../src/utils/graphicsutils.h)
 HEADERS += $$files(../../../src/utils/textutils.h)
@@ -51,6 +55,9 @@ SOURCES += $$files(../../../src/svg/svgpathlexer.cpp)
 SOURCES += $$files(../../../src/svg/svgpathparser.cpp)
 SOURCES += $$files(../../../src/svg/svgpathgrammar.cpp)
 SOURCES += $$files(../../../src/svg/svgpathrunner.cpp)
+SOURCES += $$files(../../../src/svg/svgpathscanner.cpp)
+SOURCES += $$files(../../../src/svg/svgstreamrewriter.cpp)
+SOURCES += $$files(../../../src/svg/svgrasterizer.cpp)
 SOURCES += $$files(../../../src/utils/graphicsutils.cpp)
 SOURCES += $$files(../../../src/utils/textutils.cpp)
 #INCLUDEPATH += $$top_srcdir
@@ -0,0 +1,303 @@
+#include <boost/test/unit_test.hpp>
+
+#include "svg/svgrasterizer.h"
+
+#include <QBuffer>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QSvgRenderer>
+
+#include <cmath>
+
+/*
+SvgRasterizer::renderMono replaces the old "render until two renders hash the same"
+loop in GerberGenerator, so its output has to be stable from run to run and must not
+show seams where the render bands meet.
+*/
+
+static const QByteArray TestSvg =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	"<circle cx='300' cy='280' r='120' fill='black' stroke='black' stroke-width='20'/>"
+	"<rect x='450' y='100' width='400' height='90' fill='black' transform='rotate(17 650 145)'/>"
+	"<path d='M100,600 C300,400 500,900 900,650' fill='none' stroke='black' stroke-width='31'/>"
+	"<polygon points='200,950 480,700 760,980' fill='black'/>"
+	"<line x1='50' y1='255' x2='950' y2='257' stroke='black' stroke-width='3'/>"
+	"<line x1='50' y1='511' x2='950' y2='513' stroke='black' stroke-width='7'/>"
+	"</svg>";
+
+static QImage render(const QSize & size) {
+	QImage image(size, QImage::Format_Mono);
+	image.fill(0);
+	SvgRasterizer::renderMono(image, TestSvg, QRectF(0, 0, size.width() - 2, size.height() - 2));
+	return image;
+}
+
+BOOST_AUTO_TEST_CASE( test_renderMono_is_stable )
+{
+	QSize size(1002, 1002);			// several render bands tall
+	QImage first = render(size);
+	for (int i = 0; i < 5; i++) {
+		BOOST_CHECK(render(size) == first);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_renderMono_matches_single_render )
+{
+	QSize size(1002, 1002);
+	QRectF target(0, 0, size.width() - 2, size.height() - 2);
+
+	QImage whole(size, QImage::Format_RGB32);
+	whole.fill(0xffffffff);
+	QSvgRenderer renderer(TestSvg);
+	QPainter painter;
+	painter.begin(&whole);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setRenderHint(QPainter::TextAntialiasing, false);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	renderer.render(&painter, target);
+	painter.end();
+
+	QImage banded = render(size);
+	int drawn = 0;
+	int mismatches = 0;
+	for (int y = 0; y < size.height(); y++) {
+		for (int x = 0; x < size.width(); x++) {
+			bool expected = qGray(whole.pixel(x, y)) < 128;
+			bool got = banded.pixelIndex(x, y) == 1;
+			if (got) drawn++;
+			if (expected != got) mismatches++;
+		}
+	}
+
+	BOOST_CHECK_GT(drawn, 0);
+	BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_renderMono_clears_previous_content )
+{
+	QSize size(300, 300);
+	QImage image(size, QImage::Format_Mono);
+	image.fill(1);
+	SvgRasterizer::renderMono(image, "<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 100 100'/>", QRectF(0, 0, 300, 300));
+	for (int y = 0; y < size.height(); y++) {
+		for (int x = 0; x < size.width(); x++) {
+			BOOST_REQUIRE_EQUAL(image.pixelIndex(x, y), 0);
+		}
+	}
+}
+
+static QImage randomMono(const QSize & size, quint32 seed) {
+	QRandomGenerator random(seed);
+	QImage image(size, QImage::Format_Mono);
+	for (int y = 0; y < size.height(); y++) {
+		uchar * line = image.scanLine(y);
+		for (int i = 0; i < image.bytesPerLine(); i++) {
+			line[i] = (uchar) random.bounded(256);
+		}
+	}
+	return image;
+}
+
+BOOST_AUTO_TEST_CASE( test_applyMask_matches_pixel_loop )
+{
+	// odd widths so the last byte of each row is only partly inside the clip
+	Q_FOREACH (int width, QList<int>() << 1 << 7 << 8 << 9 << 63 << 197 << 203) {
+		QSize size(width + 2, 37);
+		QImage mask = randomMono(size, 17 + width);
+		QImage expected = randomMono(size, 91 + width);
+		QImage image = expected.copy();
+
+		for (int y = 0; y < size.height() - 2; y++) {
+			for (int x = 0; x < width; x++) {
+				if (mask.pixel(x, y) != 0xffffffff) {
+					expected.setPixel(x, y, 0);
+				}
+			}
+		}
+
+		SvgRasterizer::applyMask(image, mask, width, size.height() - 2);
+		BOOST_CHECK(image == expected);
+	}
+}
+
+static double polygonArea(const QPolygonF & polygon) {
+	double area = 0;
+	for (int i = 0; i < polygon.count(); i++) {
+		QPointF p = polygon.at(i);
+		QPointF q = polygon.at((i + 1) % polygon.count());
+		area += p.x() * q.y() - q.x() * p.y();
+	}
+	return area / 2;
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygons_clips_to_target )
+{
+	QByteArray svg =
+		"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<rect x='-200' y='100' width='500' height='300' fill='black'/>"
+		"<line x1='600' y1='500' x2='1400' y2='500' stroke='black' stroke-width='40'/>"
+		"</svg>";
+	QRectF target(0, 0, 1000, 1000);
+	QList<QPolygonF> polygons;
+	BOOST_REQUIRE(SvgRasterizer::renderPolygons(svg, target, 1000, polygons));
+	BOOST_REQUIRE(!polygons.isEmpty());
+
+	double area = 0;
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		QRectF bounds = polygon.boundingRect();
+		BOOST_CHECK(bounds.left() >= target.left() && bounds.right() <= target.right());
+		BOOST_CHECK(bounds.top() >= target.top() && bounds.bottom() <= target.bottom());
+		area += std::fabs(polygonArea(polygon));
+	}
+
+	// 300 x 300 of the rect and 400 x 40 of the line stay on the board
+	BOOST_CHECK_CLOSE(area, 300.0 * 300 + 400.0 * 40, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygons_slices_holes )
+{
+	// a ring has a hole, which a single gerber region can't have
+	QByteArray svg =
+		"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<circle cx='500' cy='500' r='200' fill='none' stroke='black' stroke-width='100'/>"
+		"</svg>";
+	QList<QPolygonF> polygons;
+	BOOST_REQUIRE(SvgRasterizer::renderPolygons(svg, QRectF(0, 0, 1000, 1000), 1000, polygons));
+	BOOST_CHECK_GT(polygons.count(), 1);
+
+	double area = 0;
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		double a = polygonArea(polygon);
+		BOOST_CHECK_GT(a, 0);				// every polygon is an outline, none is a hole
+		area += a;
+	}
+
+	double expected = M_PI * (250.0 * 250 - 150.0 * 150);
+	BOOST_CHECK_CLOSE(area, expected, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygons_rejects_images )
+{
+	QImage pixel(1, 1, QImage::Format_RGB32);
+	pixel.fill(0xff000000);
+	QByteArray png;
+	QBuffer buffer(&png);
+	buffer.open(QIODevice::WriteOnly);
+	pixel.save(&buffer, "PNG");
+
+	QByteArray svg =
+		"<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<image x='100' y='100' width='200' height='200' xlink:href='data:image/png;base64," + png.toBase64() + "'/>"
+		"</svg>";
+	QList<QPolygonF> polygons;
+	BOOST_CHECK(!SvgRasterizer::renderPolygons(svg, QRectF(0, 0, 1000, 1000), 1000, polygons));
+}
+
+/*
+clipToBoardAux only emits the board-clipped geometry instead of a traced render when the
+board is one simple polygon holding the whole layer; in that case the two have to cover
+the same pixels, give or take the edges.
+*/
+
+static const QByteArray BoardOutline =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	"<polygon points='100,0 900,0 1000,100 1000,900 900,1000 100,1000 0,900 0,100' fill='#338040' stroke='none'/>"
+	"</svg>";
+
+static const QByteArray CopperLayer =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	"<circle cx='250' cy='250' r='60' fill='none' stroke='black' stroke-width='40'/>"
+	"<circle cx='750' cy='250' r='80' fill='black'/>"
+	"<rect x='200' y='600' width='120' height='80' fill='black'/>"
+	"<line x1='250' y1='310' x2='260' y2='600' stroke='black' stroke-width='24'/>"
+	"<path d='M330,640 L600,640 L750,330' fill='none' stroke='black' stroke-width='24'/>"
+	"</svg>";
+
+static const QByteArray MaskLayer =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	"<circle cx='250' cy='250' r='90' fill='black'/>"
+	"<circle cx='750' cy='250' r='90' fill='black'/>"
+	"<rect x='190' y='590' width='140' height='100' fill='black'/>"
+	"</svg>";
+
+static QImage rasterize(const QList<QPolygonF> & polygons, const QSize & size) {
+	QImage image(size, QImage::Format_RGB32);
+	image.fill(0xffffffff);
+	QPainter painter;
+	painter.begin(&image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setPen(Qt::NoPen);
+	painter.setBrush(Qt::black);
+	Q_FOREACH (QPolygonF polygon, polygons) {
+		painter.drawPolygon(polygon);
+	}
+	painter.end();
+	return image;
+}
+
+static void compareWithRaster(const QByteArray & layer) {
+	QSize size(1002, 1002);
+	QRectF target(0, 0, 1000, 1000);
+	QList<QPolygonF> polygons;
+	BOOST_REQUIRE(SvgRasterizer::renderPolygonsInside(layer, BoardOutline, target, 1000, polygons));
+	BOOST_REQUIRE(!polygons.isEmpty());
+
+	// what the raster round trip traces: the layer rendered, then clipped to the board rectangle
+	QImage raster(size, QImage::Format_Mono);
+	SvgRasterizer::renderMono(raster, layer, target);
+	QImage geometry = rasterize(polygons, size);
+
+	int drawn = 0;
+	int mismatches = 0;
+	for (int y = 0; y < target.height(); y++) {
+		for (int x = 0; x < target.width(); x++) {
+			bool expected = raster.pixelIndex(x, y) == 1;
+			bool got = qGray(geometry.pixel(x, y)) < 128;
+			if (expected) drawn++;
+			if (expected != got) mismatches++;
+		}
+	}
+
+	BOOST_CHECK_GT(drawn, 0);
+	BOOST_CHECK_LT(mismatches, drawn / 50);		// only along the edges
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygonsInside_matches_raster_copper )
+{
+	compareWithRaster(CopperLayer);
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygonsInside_matches_raster_mask )
+{
+	compareWithRaster(MaskLayer);
+}
+
+BOOST_AUTO_TEST_CASE( test_renderPolygonsInside_needs_layer_on_plain_board )
+{
+	QRectF target(0, 0, 1000, 1000);
+	QList<QPolygonF> polygons;
+
+	// a pad over the cut-off corner, which the raster path would keep
+	QByteArray overhang =
+		"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<circle cx='40' cy='40' r='30' fill='black'/>"
+		"</svg>";
+	BOOST_CHECK(!SvgRasterizer::renderPolygonsInside(overhang, BoardOutline, target, 1000, polygons));
+
+	// a board with a cutout
+	QByteArray cutout =
+		"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<path d='M0,0 L1000,0 L1000,1000 L0,1000 Z M450,450 L550,450 L550,550 L450,550 Z' fill='black' fill-rule='evenodd'/>"
+		"</svg>";
+	BOOST_CHECK(!SvgRasterizer::renderPolygonsInside(MaskLayer, cutout, target, 1000, polygons));
+
+	// two boards
+	QByteArray twoBoards =
+		"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+		"<rect x='0' y='0' width='400' height='1000' fill='black'/><rect x='600' y='0' width='400' height='1000' fill='black'/>"
+		"</svg>";
+	BOOST_CHECK(!SvgRasterizer::renderPolygonsInside(MaskLayer, twoBoards, target, 1000, polygons));
+
+	// no outline at all
+	BOOST_CHECK(!SvgRasterizer::renderPolygonsInside(MaskLayer, QByteArray(), target, 1000, polygons));
+}
@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE Item Grid Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <QElapsedTimer>
+#include <QGraphicsRectItem>
+
+#include "itemgrid.h"
+
+BOOST_AUTO_TEST_CASE( point_lookup_finds_only_covering_items )
+{
+	QGraphicsRectItem a, b, c;
+	ItemGrid grid(10);
+	grid.insert(&a, QRectF(0, 0, 5, 5));
+	grid.insert(&b, QRectF(4, 4, 20, 20));		// spans several cells
+	grid.insert(&c, QRectF(-15, -15, 5, 5));		// negative coordinates
+
+	BOOST_CHECK(grid.items(QPointF(1, 1)) == QList<QGraphicsItem *>() << &a);
+	BOOST_CHECK_EQUAL(grid.items(QPointF(4.5, 4.5)).count(), 2);
+	BOOST_CHECK(grid.items(QPointF(22, 22)) == QList<QGraphicsItem *>() << &b);
+	BOOST_CHECK(grid.items(QPointF(-12, -12)) == QList<QGraphicsItem *>() << &c);
+	BOOST_CHECK(grid.items(QPointF(50, 50)).isEmpty());
+	BOOST_CHECK(grid.items(QPointF(7, 1)).isEmpty());		// same cell as a, outside its rect
+}
+
+BOOST_AUTO_TEST_CASE( rect_lookup_has_no_duplicates )
+{
+	QGraphicsRectItem a, b;
+	ItemGrid grid(10);
+	grid.insert(&a, QRectF(0, 0, 35, 35));
+	grid.insert(&b, QRectF(100, 100, 2, 2));
+
+	QList<QGraphicsItem *> items = grid.items(QRectF(-5, -5, 50, 50));
+	BOOST_CHECK(items == QList<QGraphicsItem *>() << &a);
+	BOOST_CHECK_EQUAL(grid.items(QRectF(-5, -5, 200, 200)).count(), 2);
+	BOOST_CHECK(grid.items(QRectF(40, 40, 5, 5)).isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE( moving_and_removing_items )
+{
+	QGraphicsRectItem a;
+	ItemGrid grid(10);
+	grid.insert(&a, QRectF(0, 0, 5, 5));
+	grid.insert(&a, QRectF(100, 100, 5, 5));
+	BOOST_CHECK_EQUAL(grid.count(), 1);
+	BOOST_CHECK(grid.items(QPointF(1, 1)).isEmpty());
+	BOOST_CHECK(grid.items(QPointF(101, 101)) == QList<QGraphicsItem *>() << &a);
+	BOOST_CHECK(grid.rect(&a) == QRectF(100, 100, 5, 5));
+
+	grid.remove(&a);
+	BOOST_CHECK(!grid.contains(&a));
+	BOOST_CHECK(grid.items(QPointF(101, 101)).isEmpty());
+	grid.remove(&a);
+	BOOST_CHECK_EQUAL(grid.count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( large_items_are_still_found )
+{
+	QGraphicsRectItem a, b;
+	ItemGrid grid(1);
+	grid.insert(&a, QRectF(0, 0, 1000, 1000));
+	grid.insert(&b, QRectF(3, 3, 1, 1));
+	BOOST_CHECK_EQUAL(grid.items(QPointF(3.5, 3.5)).count(), 2);
+	BOOST_CHECK(grid.items(QPointF(900, 900)) == QList<QGraphicsItem *>() << &a);
+
+	grid.insert(&a, QRectF(2000, 2000, 1, 1));
+	BOOST_CHECK(grid.items(QPointF(900, 900)).isEmpty());
+	BOOST_CHECK(grid.items(QPointF(2000.5, 2000.5)) == QList<QGraphicsItem *>() << &a);
+}
+
+BOOST_AUTO_TEST_CASE( lookup_benchmark )
+{
+	// a dense perfboard: 100 x 100 connectors on a 0.1 inch pitch
+	QList<QGraphicsRectItem *> connectors;
+	ItemGrid grid;
+	for (int x = 0; x < 100; x++) {
+		for (int y = 0; y < 100; y++) {
+			auto * item = new QGraphicsRectItem();
+			connectors.append(item);
+			grid.insert(item, QRectF(x * 9, y * 9, 4, 4));
+		}
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	const int repeats = 100000;
+	int found = 0;
+	for (int i = 0; i < repeats; i++) {
+		int x = i % 100;
+		int y = (i / 100) % 100;
+		found += grid.items(QPointF(x * 9 + 2, y * 9 + 2)).count();
+	}
+	BOOST_TEST_MESSAGE("point lookup among 10000 connectors: " << timer.nsecsElapsed() / (double) repeats << " ns");
+	BOOST_CHECK_EQUAL(found, repeats);
+
+	timer.start();
+	for (int i = 0; i < repeats; i++) {
+		QGraphicsRectItem * item = connectors.at(i % connectors.count());
+		QRectF r = grid.rect(item);
+		grid.insert(item, r.translated(9, 0));
+		grid.insert(item, r);
+	}
+	BOOST_TEST_MESSAGE("move among 10000 connectors: " << timer.nsecsElapsed() / (double) repeats << " ns");
+
+	qDeleteAll(connectors);
+}
@@ -0,0 +1,174 @@
+#include <boost/test/unit_test.hpp>
+
+#include "autoroute/mazerouter/gridsearch.h"
+
+#include <QHash>
+#include <QStringList>
+
+/*
+Routes small grids with both search modes and checks that A* finds a route
+of the same cost as the default wavefront search, and as a plain
+breadth-first search over the free cells.
+*/
+
+static double chebyshevCost(const QPoint & p1, const QPoint & p2) {
+	// the router's manhattanCost()
+	return qMax(qAbs(p1.x() - p2.x()), qAbs(p1.y() - p2.y()));
+}
+
+struct Maze {
+	QList<QStringList> layers;		// '#' obstacle, 'S' source, 'T' target, anything else free
+
+	int width() const { return layers.first().first().length(); }
+	int height() const { return layers.first().count(); }
+	QChar at(int x, int y, int z) const { return layers.at(z).at(y).at(x); }
+};
+
+struct RouteResult {
+	int steps = -1;
+	int viaCount = 0;
+	SearchStats stats;
+};
+
+static RouteResult routeMaze(const Maze & maze, bool aStar) {
+	Grid grid(maze.width(), maze.height(), maze.layers.count());
+	SearchThing searchThing;
+	searchThing.aStar = aStar;
+	searchThing.bestDistanceToSource = searchThing.bestDistanceToTarget = std::numeric_limits<double>::max();
+	for (int z = 0; z < grid.z; z++) {
+		for (int y = 0; y < grid.y; y++) {
+			for (int x = 0; x < grid.x; x++) {
+				QChar c = maze.at(x, y, z);
+				if (c == '#') {
+					grid.setAt(x, y, z, GridPartObstacle);
+					continue;
+				}
+				if (c != 'S' && c != 'T') continue;
+
+				GridPoint gridPoint(QPoint(x, y), z);
+				gridPoint.qCost = gridPoint.baseCost = 0;
+				if (c == 'S') {
+					grid.setAt(x, y, z, GridSource);
+					searchThing.sourceQ.push(gridPoint);
+					searchThing.gridSourcePoint = QPoint(x, y);
+				}
+				else {
+					grid.setAt(x, y, z, GridTarget);
+					searchThing.targetQ.push(gridPoint);
+					searchThing.gridTargetPoint = QPoint(x, y);
+				}
+			}
+		}
+	}
+
+	RouteResult result;
+	GridSearch search(&grid, chebyshevCost, grid.z > 1, 0);
+	QList<GridPoint> points = search.route(searchThing, result.viaCount);
+	result.stats = search.stats();
+	if (points.isEmpty()) return result;
+
+	result.steps = 0;
+	for (int i = 1; i < points.count(); i++) {
+		const GridPoint & a = points.at(i - 1);
+		const GridPoint & b = points.at(i);
+		// consecutive points are neighbours and never on an obstacle
+		BOOST_CHECK_EQUAL(qAbs(a.x - b.x) + qAbs(a.y - b.y) + qAbs(a.z - b.z), 1);
+		BOOST_CHECK(maze.at(b.x, b.y, b.z) != '#');
+		if (a.z == b.z) result.steps++;
+	}
+	return result;
+}
+
+static int referenceSteps(const Maze & maze) {
+	// breadth-first search on one layer
+	QList<QPoint> queue;
+	QHash<int, int> distance;
+	for (int y = 0; y < maze.height(); y++) {
+		for (int x = 0; x < maze.width(); x++) {
+			if (maze.at(x, y, 0) == 'S') {
+				queue << QPoint(x, y);
+				distance.insert((y * maze.width()) + x, 0);
+			}
+		}
+	}
+	while (!queue.isEmpty()) {
+		QPoint p = queue.takeFirst();
+		int d = distance.value((p.y() * maze.width()) + p.x());
+		if (maze.at(p.x(), p.y(), 0) == 'T') return d;
+
+		QList<QPoint> neighbours;
+		neighbours << QPoint(p.x() - 1, p.y()) << QPoint(p.x() + 1, p.y()) << QPoint(p.x(), p.y() - 1) << QPoint(p.x(), p.y() + 1);
+		Q_FOREACH (QPoint n, neighbours) {
+			if (n.x() < 0 || n.y() < 0 || n.x() >= maze.width() || n.y() >= maze.height()) continue;
+			if (maze.at(n.x(), n.y(), 0) == '#') continue;
+
+			int key = (n.y() * maze.width()) + n.x();
+			if (distance.contains(key)) continue;
+
+			distance.insert(key, d + 1);
+			queue << n;
+		}
+	}
+	return -1;
+}
+
+BOOST_AUTO_TEST_CASE( test_astar_matches_wavefront_in_a_corridor )
+{
+	Maze maze;
+	maze.layers << (QStringList()
+		<< "######################"
+		<< "#S..................T#"
+		<< "######################");
+
+	RouteResult wavefront = routeMaze(maze, false);
+	RouteResult aStar = routeMaze(maze, true);
+	BOOST_CHECK_EQUAL(wavefront.steps, referenceSteps(maze));
+	BOOST_CHECK_EQUAL(aStar.steps, wavefront.steps);
+	BOOST_CHECK_EQUAL(aStar.viaCount, 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_astar_matches_wavefront_in_a_serpentine )
+{
+	Maze maze;
+	maze.layers << (QStringList()
+		<< "#####################"
+		<< "#S..................#"
+		<< "###################.#"
+		<< "#...................#"
+		<< "#.###################"
+		<< "#...................#"
+		<< "###################.#"
+		<< "#T..................#"
+		<< "#####################");
+
+	RouteResult wavefront = routeMaze(maze, false);
+	RouteResult aStar = routeMaze(maze, true);
+	BOOST_CHECK_EQUAL(referenceSteps(maze), 18 * 4 + 3 * 2);
+	BOOST_CHECK_EQUAL(wavefront.steps, referenceSteps(maze));
+	BOOST_CHECK_EQUAL(aStar.steps, wavefront.steps);
+}
+
+BOOST_AUTO_TEST_CASE( test_astar_matches_wavefront_through_a_via )
+{
+	// the layers only overlap at one free cell, so the route has to change layers there
+	Maze maze;
+	maze.layers << (QStringList()
+		<< "############"
+		<< "#S........##"
+		<< "#########.##"
+		<< "#########.##"
+		<< "############")
+	            << (QStringList()
+		<< "############"
+		<< "############"
+		<< "############"
+		<< "#T.......###"
+		<< "############");
+
+	RouteResult wavefront = routeMaze(maze, false);
+	RouteResult aStar = routeMaze(maze, true);
+	BOOST_CHECK_EQUAL(wavefront.viaCount, 1);
+	BOOST_CHECK_EQUAL(aStar.viaCount, 1);
+	BOOST_CHECK_EQUAL(wavefront.steps, 8 + 2 + 8);
+	BOOST_CHECK_EQUAL(aStar.steps, wavefront.steps);
+}
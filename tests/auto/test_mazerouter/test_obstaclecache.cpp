@@ -0,0 +1,183 @@
+#define BOOST_TEST_MODULE Maze Router Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "autoroute/mazerouter/obstaclecache.h"
+
+#include <QPainter>
+#include <QSvgRenderer>
+
+/*
+Checks that the obstacle image built from separately rendered top-level
+elements matches a render of the whole master document, as the maze router
+did before it cached fragments.
+*/
+
+static const QString MasterSvg =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='1in' height='1in' viewBox='0 0 1000 1000'>"
+	"<g id='part1'><rect id='pad1' x='100' y='100' width='120' height='80' fill='black'/>"
+	"<rect id='pad2' x='300' y='100' width='120' height='80' fill='black'/></g>"
+	"<g id='part2' transform='translate(500,400)'><circle id='pad3' cx='0' cy='0' r='90' fill='black'/>"
+	"<path id='leg' d='M0,0 L300,300' stroke='black' stroke-width='40' fill='none'/></g>"
+	"<line id='trace' x1='150' y1='140' x2='500' y2='400' stroke='black' stroke-width='30'/>"
+	"<g id='label'><rect id='box' x='60' y='800' width='400' height='100' fill='none' stroke='black' stroke-width='20'/></g>"
+	"</svg>";
+
+static const QRectF RenderRect(0, 0, 203, 203);
+static const QSize ImageSize(203, 203);
+
+static QImage renderWhole(const QDomDocument & doc) {
+	// what ItemBase::renderOne() does with a master document
+	QImage image(ImageSize, QImage::Format_Mono);
+	image.fill(0xffffffff);
+	QSvgRenderer renderer(doc.toByteArray());
+	QPainter painter;
+	painter.begin(&image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	renderer.render(&painter, RenderRect);
+	painter.end();
+	return image;
+}
+
+static int mismatches(const QImage & a, const QImage & b) {
+	int count = 0;
+	for (int y = 0; y < ImageSize.height(); y++) {
+		for (int x = 0; x < ImageSize.width(); x++) {
+			if (a.pixelIndex(x, y) != b.pixelIndex(x, y)) count++;
+		}
+	}
+	return count;
+}
+
+static int blackPixels(const QImage & image) {
+	int count = 0;
+	for (int y = 0; y < ImageSize.height(); y++) {
+		for (int x = 0; x < ImageSize.width(); x++) {
+			if (image.pixelIndex(x, y) == 0) count++;
+		}
+	}
+	return count;
+}
+
+static QDomElement byID(const QDomDocument & doc, const QString & id) {
+	QList<QDomElement> elements;
+	elements << doc.documentElement();
+	while (!elements.isEmpty()) {
+		QDomElement element = elements.takeLast();
+		if (element.attribute("id") == id) return element;
+
+		for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+			elements.append(child);
+		}
+	}
+	return QDomElement();
+}
+
+BOOST_AUTO_TEST_CASE( test_incremental_obstacles_match_full_render )
+{
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(MasterSvg));
+	QString before = doc.toString();
+
+	ObstacleCache cache;
+	BOOST_REQUIRE(cache.init(&doc, RenderRect, ImageSize));
+	BOOST_CHECK_EQUAL(doc.toString(), before);		// the document is not marked up
+
+	// one "net" after another, hiding its elements the way the router does, then putting them back
+	QList<QStringList> nets;
+	nets << (QStringList() << "pad1" << "trace")
+	     << (QStringList() << "pad3")
+	     << (QStringList() << "leg" << "pad2" << "box")
+	     << QStringList()
+	     << (QStringList() << "pad1");
+	Q_FOREACH (QStringList net, nets) {
+		QList<QDomElement> changed;
+		QStringList formerTags;
+		Q_FOREACH (QString id, net) {
+			QDomElement element = byID(doc, id);
+			BOOST_REQUIRE(!element.isNull());
+			formerTags << element.tagName();
+			element.setTagName("g");
+			changed << element;
+		}
+
+		const QImage * obstacles = cache.render(changed, RenderRect);
+		BOOST_REQUIRE(obstacles != nullptr);
+		QImage whole = renderWhole(doc);
+		BOOST_CHECK_GT(blackPixels(whole), 0);
+		BOOST_CHECK_EQUAL(mismatches(*obstacles, whole), 0);
+
+		for (int i = 0; i < changed.count(); i++) {
+			changed[i].setTagName(formerTags.at(i));
+		}
+	}
+
+	BOOST_CHECK_EQUAL(doc.toString(), before);
+}
+
+BOOST_AUTO_TEST_CASE( test_net_elements_render_alone )
+{
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(MasterSvg));
+	ObstacleCache cache;
+	BOOST_REQUIRE(cache.init(&doc, RenderRect, ImageSize));
+
+	// hide everything but part2, as renderSource() sees it, and compare with a whole render
+	QDomElement part2 = byID(doc, "part2");
+	for (QDomElement element = doc.documentElement().firstChildElement(); !element.isNull(); element = element.nextSiblingElement()) {
+		if (element != part2) element.setTagName("hidden");
+	}
+
+	QImage image(ImageSize, QImage::Format_Mono);
+	image.fill(0xffffffff);
+	BOOST_REQUIRE(cache.renderElements(QList<QDomElement>() << byID(doc, "pad3"), &image, RenderRect));
+	BOOST_CHECK_EQUAL(mismatches(image, renderWhole(doc)), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_shared_definitions_fall_back_to_whole_render )
+{
+	QStringList documents;
+	documents << "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 100 100'>"
+	             "<defs><rect id='r' width='10' height='10'/></defs><use xlink:href='#r' x='20' y='20'/></svg>"
+	          << "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 100 100'>"
+	             "<style>.pad { fill: black; }</style><rect class='pad' width='10' height='10'/></svg>"
+	          << "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 100 100'>"
+	             "<g><clipPath id='c'><rect width='5' height='5'/></clipPath></g><rect clip-path='url(#c)' width='10' height='10'/></svg>"
+	          << "<svg:svg xmlns:svg='http://www.w3.org/2000/svg' viewBox='0 0 100 100'>"
+	             "<svg:g><svg:defs/></svg:g></svg:svg>";
+
+	Q_FOREACH (QString svg, documents) {
+		QDomDocument doc;
+		BOOST_REQUIRE(doc.setContent(svg));
+		BOOST_CHECK(!ObstacleCache::isSplittable(doc.documentElement()));
+
+		ObstacleCache cache;
+		BOOST_CHECK(!cache.init(&doc, QRectF(0, 0, 50, 50), QSize(50, 50)));
+		BOOST_CHECK(cache.isEmpty());
+		BOOST_CHECK(cache.render(QList<QDomElement>(), QRectF(0, 0, 50, 50)) == nullptr);
+	}
+
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(MasterSvg));
+	BOOST_CHECK(ObstacleCache::isSplittable(doc.documentElement()));
+}
+
+BOOST_AUTO_TEST_CASE( test_bound_copy_follows_cloned_document )
+{
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(MasterSvg));
+	ObstacleCache cache;
+	BOOST_REQUIRE(cache.init(&doc, RenderRect, ImageSize));
+
+	// a worker router's copy must not touch the master's document
+	QDomDocument clone = doc.cloneNode(true).toDocument();
+	ObstacleCache copy = cache;
+	copy.bind(&clone);
+
+	QDomElement pad3 = byID(clone, "pad3");
+	pad3.setTagName("g");
+	const QImage * obstacles = copy.render(QList<QDomElement>() << pad3, RenderRect);
+	BOOST_REQUIRE(obstacles != nullptr);
+	BOOST_CHECK_EQUAL(mismatches(*obstacles, renderWhole(clone)), 0);
+	BOOST_CHECK_EQUAL(byID(doc, "pad3").tagName(), QString("circle"));
+}
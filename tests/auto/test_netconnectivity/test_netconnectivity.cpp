@@ -0,0 +1,382 @@
+#define BOOST_TEST_MODULE Net Connectivity Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <vector>
+
+#include "connectors/netconnectivity.h"
+
+/*
+Drives the cached nets through connection, bus, wire flag and scene membership
+changes on a stand-in circuit, and checks every answer against the uncached
+walk, which is what ConnectorItem::collectEqualPotentialAux() runs.
+
+The connector and part pointers are only ever used as keys, so they point
+into plain byte arrays.
+*/
+
+struct FakePart {
+	bool wire = false;
+	ViewGeometry::WireFlags flags = ViewGeometry::NoFlag;
+	QList<int> connectors;
+	QList< QList<int> > buses;
+};
+
+struct FakeConnector {
+	int part = -1;
+	int cross = -1;					// the same connector on the other copper layer
+	QList<int> connectedTo;
+};
+
+class FakeCircuit : public NetGraph
+{
+public:
+	QList<FakePart> parts;
+	QList<FakeConnector> connectors;
+	NetConnectivity nets;
+	QSet<int> inScene;
+
+	FakeCircuit() : nets(*this), m_connectorTokens(1000), m_partTokens(1000) {
+	}
+
+	ConnectorItem * item(int connector) const {
+		return reinterpret_cast<ConnectorItem *>(const_cast<char *>(&m_connectorTokens[connector]));
+	}
+
+	ItemBase * itemBase(int part) const {
+		return reinterpret_cast<ItemBase *>(const_cast<char *>(&m_partTokens[part]));
+	}
+
+	int index(ConnectorItem * connectorItem) const {
+		return static_cast<int>(reinterpret_cast<char *>(connectorItem) - &m_connectorTokens[0]);
+	}
+
+	int addPart(bool wire, int connectorCount) {
+		FakePart part;
+		part.wire = wire;
+		int p = parts.count();
+		for (int i = 0; i < connectorCount; i++) {
+			FakeConnector connector;
+			connector.part = p;
+			part.connectors << connectors.count();
+			connectors << connector;
+		}
+		if (wire) {
+			// a wire's two ends are always bused
+			part.buses << part.connectors;
+		}
+		parts << part;
+		addToScene(p);
+		return p;
+	}
+
+	void addToScene(int part) {
+		Q_FOREACH (int c, parts.at(part).connectors) {
+			inScene.insert(c);
+			nets.addConnectorItem(item(c));
+		}
+	}
+
+	void removeFromScene(int part) {
+		Q_FOREACH (int c, parts.at(part).connectors) {
+			inScene.remove(c);
+			nets.removeConnectorItem(item(c));
+		}
+	}
+
+	void setCross(int c1, int c2) {
+		connectors[c1].cross = c2;
+		connectors[c2].cross = c1;
+	}
+
+	// ConnectorItem::connectTo() and tempConnectTo() on both ends
+	void connect(int c1, int c2) {
+		if (connectors.at(c1).connectedTo.contains(c2)) return;
+
+		connectors[c1].connectedTo << c2;
+		nets.connected(item(c1), item(c2));
+		connectors[c2].connectedTo << c1;
+		nets.connected(item(c2), item(c1));
+	}
+
+	// ConnectorItem::removeConnection() and tempRemove() on both ends
+	void disconnect(int c1, int c2) {
+		if (connectors[c1].connectedTo.removeOne(c2)) nets.disconnected(item(c1), item(c2));
+		if (connectors[c2].connectedTo.removeOne(c1)) nets.disconnected(item(c2), item(c1));
+	}
+
+	void setBuses(int part, const QList< QList<int> > & buses) {
+		parts[part].buses = buses;
+		nets.busesChanged(itemBase(part));
+	}
+
+	void setWireFlags(int part, ViewGeometry::WireFlags flags) {
+		parts[part].flags = flags;
+		nets.invalidate();
+	}
+
+	// the rules of ConnectorItemGraph
+	bool skipped(ConnectorItem * connectorItem, ViewGeometry::WireFlags skipFlags) const override {
+		const FakePart & part = parts.at(connectors.at(index(connectorItem)).part);
+		return part.wire && (part.flags & skipFlags);
+	}
+
+	void collectNeighbors(ConnectorItem * connectorItem, bool crossLayers, ViewGeometry::WireFlags skipFlags, bool skipBuses, QList<ConnectorItem *> & neighbors) const override {
+		const FakeConnector & connector = connectors.at(index(connectorItem));
+		const FakePart & part = parts.at(connector.part);
+		if (skipped(connectorItem, skipFlags)) return;
+
+		if (!part.wire && crossLayers && connector.cross >= 0) {
+			neighbors << item(connector.cross);
+		}
+
+		Q_FOREACH (int cto, connector.connectedTo) {
+			if ((skipFlags & ViewGeometry::NormalFlag) && !part.wire && !parts.at(connectors.at(cto).part).wire) continue;
+			if (skipped(item(cto), skipFlags)) continue;
+
+			neighbors << item(cto);
+		}
+
+		if (part.wire || !skipBuses) {
+			Q_FOREACH (const QList<int> & bus, part.buses) {
+				if (!bus.contains(index(connectorItem))) continue;
+
+				Q_FOREACH (int other, bus) {
+					if (other == index(connectorItem)) continue;
+					if (skipped(item(other), skipFlags)) continue;
+
+					neighbors << item(other);
+				}
+			}
+		}
+	}
+
+	QList<ConnectorItem *> connectorItems(ItemBase * itemBase) const override {
+		QList<ConnectorItem *> result;
+		int part = static_cast<int>(reinterpret_cast<char *>(itemBase) - &m_partTokens[0]);
+		Q_FOREACH (int c, parts.at(part).connectors) {
+			result << item(c);
+		}
+		return result;
+	}
+
+protected:
+	std::vector<char> m_connectorTokens;
+	std::vector<char> m_partTokens;
+};
+
+static const ViewGeometry::WireFlags SkipFlags[] = {
+	ViewGeometry::NoFlag,
+	ViewGeometry::RatsnestFlag,
+	ViewGeometry::RatsnestFlag | ViewGeometry::NormalFlag,
+	ViewGeometry::RatsnestFlag | ViewGeometry::PCBTraceFlag,
+};
+
+static void checkNets(FakeCircuit & circuit, const QString & step) {
+	QList<int> scene = circuit.inScene.values();
+	std::sort(scene.begin(), scene.end());
+	for (int crossLayers = 0; crossLayers < 2; crossLayers++) {
+		for (ViewGeometry::WireFlags skipFlags : SkipFlags) {
+			for (int skipBuses = 0; skipBuses < 2; skipBuses++) {
+				Q_FOREACH (int c, scene) {
+					QList<ConnectorItem *> expected;
+					expected << circuit.item(c);
+					circuit.walk(expected, crossLayers, skipFlags, skipBuses);
+
+					QList<ConnectorItem *> cached;
+					cached << circuit.item(c);
+					circuit.nets.collectEqualPotential(cached, crossLayers, skipFlags, skipBuses);
+
+					bool same = (cached.count() == expected.count()) &&
+					            (QSet<ConnectorItem *>(cached.begin(), cached.end()) == QSet<ConnectorItem *>(expected.begin(), expected.end()));
+					BOOST_CHECK_MESSAGE(same, QString("%1: connector %2, crossLayers %3, skipFlags %4, skipBuses %5: %6 connectors instead of %7")
+					                    .arg(step).arg(c).arg(crossLayers).arg(skipFlags.toInt()).arg(skipBuses)
+					                    .arg(cached.count()).arg(expected.count()).toStdString());
+					if (!expected.isEmpty() && !cached.isEmpty()) {
+						BOOST_CHECK(cached.first() == expected.first());
+					}
+
+					int other = scene.at((c * 7) % scene.count());
+					BOOST_CHECK_EQUAL(circuit.nets.sameNet(circuit.item(c), circuit.item(other), crossLayers, skipFlags, skipBuses),
+					                  expected.contains(circuit.item(other)));
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_connect_and_disconnect )
+{
+	FakeCircuit circuit;
+	int part1 = circuit.addPart(false, 2);
+	int wire = circuit.addPart(true, 2);
+	int part2 = circuit.addPart(false, 2);
+	checkNets(circuit, "empty");
+
+	circuit.connect(circuit.parts.at(part1).connectors.at(0), circuit.parts.at(wire).connectors.at(0));
+	circuit.connect(circuit.parts.at(wire).connectors.at(1), circuit.parts.at(part2).connectors.at(0));
+	checkNets(circuit, "wired");
+
+	// a direct part-to-part connection only counts when NormalFlag isn't skipped
+	circuit.connect(circuit.parts.at(part1).connectors.at(1), circuit.parts.at(part2).connectors.at(1));
+	checkNets(circuit, "direct");
+
+	circuit.disconnect(circuit.parts.at(wire).connectors.at(1), circuit.parts.at(part2).connectors.at(0));
+	checkNets(circuit, "unwired");
+}
+
+BOOST_AUTO_TEST_CASE( test_buses_and_cross_layers )
+{
+	FakeCircuit circuit;
+	int part1 = circuit.addPart(false, 4);
+	int part2 = circuit.addPart(false, 2);
+	QList<int> c1 = circuit.parts.at(part1).connectors;
+	QList<int> c2 = circuit.parts.at(part2).connectors;
+	circuit.setCross(c1.at(0), c1.at(1));
+	circuit.connect(c1.at(1), c2.at(0));
+	checkNets(circuit, "cross layer");
+
+	circuit.setBuses(part1, QList< QList<int> >() << (QList<int>() << c1.at(0) << c1.at(2)));
+	checkNets(circuit, "bused");
+
+	circuit.setBuses(part1, QList< QList<int> >() << (QList<int>() << c1.at(2) << c1.at(3)));
+	checkNets(circuit, "rebused");
+
+	circuit.setBuses(part1, QList< QList<int> >());
+	checkNets(circuit, "unbused");
+}
+
+BOOST_AUTO_TEST_CASE( test_wire_flags )
+{
+	FakeCircuit circuit;
+	int part1 = circuit.addPart(false, 1);
+	int wire = circuit.addPart(true, 2);
+	int part2 = circuit.addPart(false, 1);
+	circuit.connect(circuit.parts.at(part1).connectors.at(0), circuit.parts.at(wire).connectors.at(0));
+	circuit.connect(circuit.parts.at(wire).connectors.at(1), circuit.parts.at(part2).connectors.at(0));
+	checkNets(circuit, "plain wire");
+
+	circuit.setWireFlags(wire, ViewGeometry::RatsnestFlag);
+	checkNets(circuit, "ratsnest");
+
+	circuit.setWireFlags(wire, ViewGeometry::PCBTraceFlag);
+	checkNets(circuit, "trace");
+}
+
+BOOST_AUTO_TEST_CASE( test_neighbors_outside_the_scene_are_followed )
+{
+	FakeCircuit circuit;
+	int part1 = circuit.addPart(false, 1);
+	int wire = circuit.addPart(true, 2);
+	int part2 = circuit.addPart(false, 1);
+	int c1 = circuit.parts.at(part1).connectors.at(0);
+	int w0 = circuit.parts.at(wire).connectors.at(0);
+	int w1 = circuit.parts.at(wire).connectors.at(1);
+	int c2 = circuit.parts.at(part2).connectors.at(0);
+	circuit.connect(c1, w0);
+	circuit.connect(w1, c2);
+	checkNets(circuit, "wired");
+
+	// the wire leaves the scene still connected, and the walk goes through it
+	circuit.removeFromScene(wire);
+	checkNets(circuit, "wire removed");
+	QList<ConnectorItem *> connectorItems;
+	connectorItems << circuit.item(c1);
+	circuit.nets.collectEqualPotential(connectorItems, false, ViewGeometry::NoFlag, false);
+	BOOST_CHECK_EQUAL(connectorItems.count(), 4);
+
+	circuit.addToScene(wire);
+	checkNets(circuit, "wire restored");
+
+	circuit.disconnect(c1, w0);
+	circuit.removeFromScene(wire);
+	checkNets(circuit, "wire disconnected and removed");
+
+	// connected before it comes into the scene
+	circuit.connect(c1, w0);
+	checkNets(circuit, "connected outside the scene");
+	circuit.addToScene(wire);
+	checkNets(circuit, "brought into the scene");
+}
+
+BOOST_AUTO_TEST_CASE( test_random_edits )
+{
+	QRandomGenerator random(21);
+	FakeCircuit circuit;
+	for (int i = 0; i < 24; i++) {
+		bool wire = (i % 3 == 0);
+		int part = circuit.addPart(wire, wire ? 2 : 2 + random.bounded(3));
+		QList<int> connectors = circuit.parts.at(part).connectors;
+		if (!wire && connectors.count() >= 4) {
+			circuit.setCross(connectors.at(0), connectors.at(1));
+		}
+	}
+	checkNets(circuit, "start");
+
+	QList<int> removed;
+	for (int step = 0; step < 300; step++) {
+		int c1 = random.bounded(circuit.connectors.count());
+		int c2 = random.bounded(circuit.connectors.count());
+		int part = random.bounded(circuit.parts.count());
+		QString what;
+		switch (random.bounded(8)) {
+		case 0:
+		case 1:
+		case 2:
+			if (c1 == c2 || circuit.connectors.at(c1).part == circuit.connectors.at(c2).part) continue;
+			if (!circuit.inScene.contains(c1) || !circuit.inScene.contains(c2)) continue;
+
+			circuit.connect(c1, c2);
+			what = "connect";
+			break;
+		case 3:
+			if (circuit.connectors.at(c1).connectedTo.isEmpty()) continue;
+
+			circuit.disconnect(c1, circuit.connectors.at(c1).connectedTo.first());
+			what = "disconnect";
+			break;
+		case 4:
+			if (circuit.parts.at(part).wire) {
+				ViewGeometry::WireFlags flags = (circuit.parts.at(part).flags == ViewGeometry::NoFlag)
+				                                ? ((step % 2) ? ViewGeometry::RatsnestFlag : ViewGeometry::PCBTraceFlag)
+				                                : ViewGeometry::NoFlag;
+				circuit.setWireFlags(part, flags);
+				what = "wire flags";
+			}
+			else {
+				QList<int> connectors = circuit.parts.at(part).connectors;
+				QList< QList<int> > buses;
+				if (random.bounded(2) == 0) {
+					buses << (QList<int>() << connectors.at(random.bounded(connectors.count())) << connectors.at(random.bounded(connectors.count())));
+				}
+				circuit.setBuses(part, buses);
+				what = "buses";
+			}
+			break;
+		case 5:
+			if (removed.contains(part)) continue;
+
+			if (random.bounded(2) == 0) {
+				// deleting a part disconnects it first
+				Q_FOREACH (int c, circuit.parts.at(part).connectors) {
+					while (!circuit.connectors.at(c).connectedTo.isEmpty()) {
+						circuit.disconnect(c, circuit.connectors.at(c).connectedTo.first());
+					}
+				}
+			}
+			circuit.removeFromScene(part);
+			removed << part;
+			what = "remove";
+			break;
+		default:
+			if (removed.isEmpty()) continue;
+
+			circuit.addToScene(removed.takeFirst());
+			what = "restore";
+			break;
+		}
+		checkNets(circuit, QString("step %1 (%2)").arg(step).arg(what));
+	}
+}
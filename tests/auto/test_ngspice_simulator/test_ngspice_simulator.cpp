@@ -2,6 +2,7 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include "simulation/ngspice_simulator.h"
+#include "simulation/sampleringbuffer.h"
 
 /*
 Testing ngspice_simulator.cpp, an interface for the ngspice library.
@@ -15,6 +16,8 @@ Testing ngspice_simulator.cpp, an interface for the ngspice library.
 
 #include <QThread>
 
+#include <thread>
+
 BOOST_AUTO_TEST_CASE( ngspice_simulator )
 {
 	std::string netlist = "NgSpice Simulation Netlist\n DLED1 1 0 LED_GENERIC\n R1 1 2 68\n VCC1 2 0 DC 3V\n \n *Typ RED,GREEN,YELLOW,AMBER GaAs LED: Vf=2.1V Vr=4V If=40mA trr=3uS\n .MODEL LED_GENERIC D (IS=93.1P RS=42M N=4.61 BV=4 IBV=10U CJO=2.97P VJ=.75 M=.333 TT=4.32U)\n \n .options savecurrents\n .OP\n *.TRAN 1ms 100ms\n * .AC DEC 100 100 1MEG\n .END\n";
@@ -32,4 +35,43 @@ BOOST_AUTO_TEST_CASE( ngspice_simulator )
 
 	int current = 1000000 * simulator->getVecInfo("@dled1[id]")[0];
 	BOOST_CHECK_EQUAL(current, 11447);
+
+	// the span points into ngspice's storage and is resolved once per name
+	auto span = simulator->vectorSpan("@DLED1[id]");
+	BOOST_REQUIRE_EQUAL(span.size, 1u);
+	BOOST_CHECK_EQUAL(span[0], simulator->getVecInfo("@dled1[id]")[0]);
+	BOOST_CHECK_EQUAL(simulator->vectorSpan("@dled1[id]").data, span.data);
+	BOOST_CHECK(simulator->vectorSpan("no_such_vector").empty());
+}
+
+BOOST_AUTO_TEST_CASE( sample_ring_buffer )
+{
+	// a small ring forces the producer to outrun the consumer now and then
+	SampleRingBuffer ring(64);
+	const std::size_t width = 3, rows = 100000;
+
+	std::thread producer([&ring]() {
+		for (std::size_t i = 0; i < rows; i++) {
+			double row[width] = { double(i), double(i) * 2, double(i) * 3 };
+			ring.push(row, width);
+		}
+	});
+
+	std::vector<double> values;
+	while (values.size() / width + ring.dropped() < rows) {
+		ring.pop(values);
+	}
+	producer.join();
+	ring.pop(values);
+
+	BOOST_CHECK_EQUAL(values.size() % width, 0u);
+	BOOST_CHECK_EQUAL(values.size() / width + ring.dropped(), rows);
+	double previous = -1;
+	for (std::size_t i = 0; i < values.size(); i += width) {
+		BOOST_CHECK(values[i] > previous);
+		BOOST_CHECK_EQUAL(values[i + 1], values[i] * 2);
+		BOOST_CHECK_EQUAL(values[i + 2], values[i] * 3);
+		previous = values[i];
+	}
+	BOOST_CHECK_EQUAL(ring.written(), values.size());
 }
@@ -28,9 +28,11 @@ SOURCES += $$files(*.cpp)
 INCLUDEPATH += $$absolute_path(../../../src)
 
 HEADERS += $$files(../../../src/simulation/ngspice_simulator.h)
+HEADERS += $$files(../../../src/simulation/sampleringbuffer.h)
 HEADERS += $$files(../../../src/debugdialog.h)
 
 SOURCES += $$files(../../../src/simulation/ngspice_simulator.cpp)
+SOURCES += $$files(../../../src/simulation/sampleringbuffer.cpp)
 SOURCES += $$files(../../../src/debugdialog.cpp)
 #INCLUDEPATH += $$top_srcdir
 # unix:QMAKE_POST_LINK = $$PWD/generated/test_svg
@@ -0,0 +1,87 @@
+#define BOOST_TEST_MODULE Part Search Index Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <QElapsedTimer>
+
+#include "partsearchindex.h"
+
+static void addPart(PartSearchIndex & index, const QString & moduleID, const QString & title, const QString & description, const QStringList & tags)
+{
+	index.insert(moduleID, title, PartSearchIndex::TitleWeight);
+	index.insert(moduleID, description, PartSearchIndex::DescriptionWeight);
+	index.insert(moduleID, moduleID, PartSearchIndex::ModuleIDWeight);
+	Q_FOREACH (QString tag, tags) {
+		index.insert(moduleID, tag, PartSearchIndex::TagWeight);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( search_matches_substrings_of_every_term )
+{
+	PartSearchIndex index;
+	addPart(index, "ArduinoUnoModuleID", "Arduino Uno (Rev3)", "The Arduino Uno is a microcontroller board", QStringList() << "arduino" << "atmega328");
+	addPart(index, "ResistorModuleID", "220Ω Resistor", "A 1/4W carbon film resistor", QStringList() << "resistor");
+	addPart(index, "LEDModuleID", "Red LED - 5mm", "a light emitting diode", QStringList() << "led" << "light");
+
+	BOOST_CHECK(index.search(QStringList() << "duino") == QStringList() << "ArduinoUnoModuleID");
+	BOOST_CHECK(index.search(QStringList() << "RESIST") == QStringList() << "ResistorModuleID");
+	BOOST_CHECK(index.search(QStringList() << "1/4w") == QStringList() << "ResistorModuleID");
+	BOOST_CHECK(index.search(QStringList() << "light" << "red") == QStringList() << "LEDModuleID");
+	BOOST_CHECK(index.search(QStringList() << "light" << "uno").isEmpty());
+
+	// empty terms match everything, like contains("")
+	BOOST_CHECK_EQUAL(index.search(QStringList() << "").count(), 3);
+	BOOST_CHECK(index.search(QStringList() << "" << "diode") == QStringList() << "LEDModuleID");
+}
+
+BOOST_AUTO_TEST_CASE( search_ranks_exact_words_and_titles_first )
+{
+	PartSearchIndex index;
+	addPart(index, "a", "Capacitor Kit", "holds a led strip", QStringList());
+	addPart(index, "b", "LED Matrix", "", QStringList());
+	addPart(index, "c", "Ledge", "", QStringList());
+
+	QStringList result = index.search(QStringList() << "led");
+	BOOST_REQUIRE_EQUAL(result.count(), 3);
+	BOOST_CHECK(result.at(0) == "b");		// exact word in the title
+	BOOST_CHECK(result.at(1) == "c");		// prefix in the title
+	BOOST_CHECK(result.at(2) == "a");		// exact word in the description
+}
+
+BOOST_AUTO_TEST_CASE( remove_and_reinsert )
+{
+	PartSearchIndex index;
+	addPart(index, "a", "Temperature Sensor", "", QStringList());
+	addPart(index, "b", "Light Sensor", "", QStringList());
+	BOOST_CHECK_EQUAL(index.search(QStringList() << "sensor").count(), 2);
+
+	index.remove("a");
+	BOOST_CHECK(!index.contains("a"));
+	BOOST_CHECK(index.search(QStringList() << "sensor") == QStringList() << "b");
+	BOOST_CHECK(index.search(QStringList() << "temperature").isEmpty());
+
+	addPart(index, "c", "Humidity Sensor", "", QStringList());
+	BOOST_CHECK_EQUAL(index.count(), 2);
+	BOOST_CHECK_EQUAL(index.search(QStringList() << "sensor").count(), 2);
+	BOOST_CHECK(index.search(QStringList() << "humid") == QStringList() << "c");
+}
+
+BOOST_AUTO_TEST_CASE( search_benchmark )
+{
+	PartSearchIndex index;
+	QStringList families = QStringList() << "resistor" << "capacitor" << "microcontroller" << "sensor" << "connector" << "led";
+	for (int i = 0; i < 10000; i++) {
+		QString moduleID = QString("Part%1ModuleID").arg(i);
+		QString family = families.at(i % families.count());
+		addPart(index, moduleID, QString("%1 %2").arg(family).arg(i), QString("A generic %1 with %2 pins, part number X%3").arg(family).arg(i % 40).arg(i * 7), QStringList() << family << QString("tag%1").arg(i % 100));
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	const int repeats = 20;
+	int found = 0;
+	for (int i = 0; i < repeats; i++) {
+		found = index.search(QStringList() << "sens" << "pins").count();
+	}
+	BOOST_TEST_MESSAGE("search over 10000 parts: " << timer.elapsed() / (double) repeats << " ms");
+	BOOST_CHECK_EQUAL(found, 10000 / families.count() + (10000 % families.count() > 3 ? 1 : 0));
+}
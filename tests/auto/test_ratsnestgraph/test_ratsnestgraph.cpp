@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE Ratsnest Graph Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ratsnestgraph.h"
+
+static double length(const QList<QPointF> & points, const QList< QPair<int, int> > & tree) {
+	double total = 0;
+	Q_FOREACH (const auto & edge, tree) {
+		QPointF d = points.at(edge.first) - points.at(edge.second);
+		total += std::sqrt((d.x() * d.x()) + (d.y() * d.y()));
+	}
+	return total;
+}
+
+// Prim's algorithm over every pair of points, the way the ratsnest used to be chosen
+static double completeGraphLength(const QList<QPointF> & points, const QVector<int> & groups) {
+	int count = points.count();
+	std::vector<double> distance(count, std::numeric_limits<double>::max());
+	std::vector<bool> inTree(count, false);
+	distance[0] = 0;
+	double total = 0;
+	for (int n = 0; n < count; n++) {
+		int best = -1;
+		for (int i = 0; i < count; i++) {
+			if (!inTree[i] && (best < 0 || distance[i] < distance[best])) best = i;
+		}
+		inTree[best] = true;
+		total += std::sqrt(distance[best]);
+		for (int i = 0; i < count; i++) {
+			if (inTree[i]) continue;
+
+			QPointF d = points.at(i) - points.at(best);
+			double weight = (groups.at(i) == groups.at(best)) ? 0 : (d.x() * d.x()) + (d.y() * d.y());
+			if (weight < distance[i]) distance[i] = weight;
+		}
+	}
+	return total;
+}
+
+static QVector<int> ungrouped(int count) {
+	QVector<int> groups(count);
+	for (int i = 0; i < count; i++) groups[i] = i;
+	return groups;
+}
+
+BOOST_AUTO_TEST_CASE( header_pins_chain_to_their_neighbors )
+{
+	QList<QPointF> points;
+	for (int i = 0; i < 20; i++) {
+		points << QPointF(((i * 7) % 20) * 9, 0);			// collinear, out of order
+	}
+
+	QList< QPair<int, int> > tree = RatsnestGraph::spanningTree(points, ungrouped(points.count()));
+	BOOST_CHECK_EQUAL(tree.count(), 19);
+	BOOST_CHECK_CLOSE(length(points, tree), 19 * 9.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE( wired_and_coincident_pins_need_no_line )
+{
+	QList<QPointF> points;
+	points << QPointF(0, 0) << QPointF(100, 0) << QPointF(100, 0) << QPointF(200, 0);
+	QVector<int> groups;
+	groups << 0 << 0 << 1 << 2;			// 0 and 1 are wired together; 1 and 2 sit on top of each other
+
+	QList< QPair<int, int> > tree = RatsnestGraph::spanningTree(points, groups);
+	BOOST_REQUIRE_EQUAL(tree.count(), 1);
+	BOOST_CHECK_CLOSE(length(points, tree), 100.0, 1e-9);
+
+	groups[3] = 0;
+	BOOST_CHECK(RatsnestGraph::spanningTree(points, groups).isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE( matches_the_complete_graph )
+{
+	QRandomGenerator random(7);
+	for (int trial = 0; trial < 500; trial++) {
+		int count = 2 + random.bounded(80);
+		QList<QPointF> points;
+		QVector<int> groups;
+		for (int i = 0; i < count; i++) {
+			if (trial % 2 == 0) {
+				points << QPointF(random.bounded(100000) / 7.0, random.bounded(100000) / 3.0);
+			}
+			else {
+				// pins on a 0.1 inch grid, with repeats and near-repeats
+				points << QPointF(random.bounded(8) * 9.0 + random.bounded(2) * 0.001, random.bounded(8) * 9.0);
+			}
+			groups << random.bounded(count / 2 + 1);
+		}
+
+		QList< QPair<int, int> > tree = RatsnestGraph::spanningTree(points, groups);
+		BOOST_CHECK_CLOSE(length(points, tree) + 1, completeGraphLength(points, groups) + 1, 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( spanning_tree_benchmark )
+{
+	QRandomGenerator random(11);
+	Q_FOREACH (int count, QList<int>() << 10 << 100 << 1000) {
+		QList<QPointF> points;
+		for (int i = 0; i < count; i++) {
+			points << QPointF(random.bounded(1000) * 9.0, random.bounded(1000) * 9.0);
+		}
+		QVector<int> groups = ungrouped(count);
+
+		const int repeats = 10000 / count;
+		QElapsedTimer timer;
+		timer.start();
+		double sparse = 0;
+		for (int r = 0; r < repeats; r++) {
+			sparse = length(points, RatsnestGraph::spanningTree(points, groups));
+		}
+		double sparseTime = timer.nsecsElapsed() / (1000.0 * repeats);
+
+		timer.start();
+		double complete = 0;
+		for (int r = 0; r < repeats; r++) {
+			complete = completeGraphLength(points, groups);
+		}
+		double completeTime = timer.nsecsElapsed() / (1000.0 * repeats);
+
+		BOOST_TEST_MESSAGE(count << " pins: delaunay " << sparseTime << " us, complete graph " << completeTime << " us");
+		BOOST_CHECK_CLOSE(sparse, complete, 1e-9);
+	}
+}
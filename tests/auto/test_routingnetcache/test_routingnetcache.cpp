@@ -0,0 +1,295 @@
+#define BOOST_TEST_MODULE Routing Net Cache Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <vector>
+
+#include "sketch/routingnetcache.h"
+
+/*
+Applies connect, disconnect, label and delete edits to a stand-in sketch and
+updates the cached routing status from only the connectors each edit reports,
+the way SketchWidget::updateRoutingStatus() does between full passes. After
+every edit the total has to match a full pass over the whole sketch, which is
+what updateRoutingStatus(..., manual = true) runs.
+
+Connectors are numbered; their pointers are only ever used as keys.
+*/
+
+class FakeSketch
+{
+public:
+	QList< QSet<int> > wires;			// direct connections of each connector
+	QList<QString> labels;				// connectors with the same label are one net, like net labels
+	QHash<QString, QSet<int> > labelled;
+	QSet<int> inSketch;
+	QSet<ConnectorItem *> changed;		// what the edits reported since the last update
+	RoutingNetCache cache;
+
+	FakeSketch(int count) : m_tokens(count) {
+		for (int i = 0; i < count; i++) {
+			wires << QSet<int>();
+			labels << QString();
+			inSketch.insert(i);
+		}
+	}
+
+	ConnectorItem * item(int connector) const {
+		return reinterpret_cast<ConnectorItem *>(const_cast<char *>(&m_tokens[connector]));
+	}
+
+	int index(ConnectorItem * connectorItem) const {
+		return static_cast<int>(reinterpret_cast<char *>(connectorItem) - &m_tokens[0]);
+	}
+
+	int count() const {
+		return static_cast<int>(m_tokens.size());
+	}
+
+	void connect(int c1, int c2) {
+		wires[c1].insert(c2);
+		wires[c2].insert(c1);
+		changed << item(c1) << item(c2);
+	}
+
+	void disconnect(int c1, int c2) {
+		wires[c1].remove(c2);
+		wires[c2].remove(c1);
+		changed << item(c1) << item(c2);
+	}
+
+	// only the edited connector is reported, even though the label can join or split other nets
+	void setLabel(int c, const QString & label) {
+		labelled[labels.at(c)].remove(c);
+		labels[c] = label;
+		if (!label.isEmpty()) labelled[label].insert(c);
+		changed << item(c);
+	}
+
+	void remove(int c) {
+		Q_FOREACH (int other, wires.at(c)) {
+			disconnect(c, other);
+		}
+		inSketch.remove(c);
+		changed << item(c);
+	}
+
+	void restore(int c) {
+		inSketch.insert(c);
+		changed << item(c);
+	}
+
+	QList<ConnectorItem *> net(int c, bool useLabels) const {
+		QList<int> members;
+		members << c;
+		QSet<int> reached;
+		reached << c;
+		for (int i = 0; i < members.count(); i++) {
+			int m = members.at(i);
+			QList<int> next = wires.at(m).values();
+			if (useLabels && !labels.at(m).isEmpty()) {
+				next << labelled.value(labels.at(m)).values();
+			}
+			Q_FOREACH (int n, next) {
+				if (reached.contains(n) || !inSketch.contains(n)) continue;
+
+				reached << n;
+				members << n;
+			}
+		}
+
+		QList<ConnectorItem *> result;
+		Q_FOREACH (int m, members) {
+			result << item(m);
+		}
+		return result;
+	}
+
+	// stands in for GraphUtils::scoreOneNet(): depends only on which connectors are in the net and how they are wired
+	bool score(ConnectorItem * connectorItem, QList<ConnectorItem *> & connectorItems, RoutingStatus & routingStatus) const {
+		connectorItems = net(index(connectorItem), true);
+		if (connectorItems.count() < 2) return false;
+
+		QSet<ConnectorItem *> unrouted(connectorItems.begin(), connectorItems.end());
+		int pieces = 0;
+		int labelCount = 0;
+		Q_FOREACH (ConnectorItem * ci, connectorItems) {
+			if (!labels.at(index(ci)).isEmpty()) labelCount++;
+			if (!unrouted.contains(ci)) continue;
+
+			pieces++;
+			Q_FOREACH (ConnectorItem * wired, net(index(ci), false)) {
+				unrouted.remove(wired);
+			}
+		}
+
+		routingStatus.m_netCount = 1;
+		routingStatus.m_netRoutedCount = (pieces == 1) ? 1 : 0;
+		routingStatus.m_connectorsLeftToRoute = (pieces == 1) ? 0 : connectorItems.count();
+		routingStatus.m_jumperItemCount = labelCount;
+		return true;
+	}
+
+	RoutingNetCache::ContainsFunction contains() const {
+		return [this](ConnectorItem * connectorItem) { return inSketch.contains(index(connectorItem)); };
+	}
+
+	RoutingNetCache::ScoreFunction scoreFunction() const {
+		return [this](ConnectorItem * connectorItem, QList<ConnectorItem *> & connectorItems, RoutingStatus & routingStatus) {
+			return score(connectorItem, connectorItems, routingStatus);
+		};
+	}
+
+	// the incremental update: retire the nets of what changed and re-score what is left of them
+	void update() {
+		QList<ConnectorItem *> seeds;
+		Q_FOREACH (ConnectorItem * connectorItem, changed) {
+			cache.retire(connectorItem, seeds);
+			seeds.append(connectorItem);
+		}
+		changed.clear();
+		QSet<ConnectorItem *> visited;
+		cache.score(seeds, visited, contains(), scoreFunction());
+	}
+
+	// the manual update: every connector in the sketch, from scratch
+	RoutingStatus fullPass() const {
+		RoutingNetCache full;
+		QList<int> connectors = inSketch.values();
+		std::sort(connectors.begin(), connectors.end());
+		QList<ConnectorItem *> seeds;
+		Q_FOREACH (int c, connectors) {
+			seeds << item(c);
+		}
+		QSet<ConnectorItem *> visited;
+		full.score(seeds, visited, contains(), scoreFunction());
+		return full.total();
+	}
+
+protected:
+	std::vector<char> m_tokens;
+};
+
+static void checkTotal(FakeSketch & sketch, const QString & step) {
+	sketch.update();
+	RoutingStatus expected = sketch.fullPass();
+	const RoutingStatus & actual = sketch.cache.total();
+	BOOST_CHECK_MESSAGE(!(actual != expected), QString("%1: nets %2/%3, routed %4/%5, left %6/%7, jumpers %8/%9")
+	                    .arg(step)
+	                    .arg(actual.m_netCount).arg(expected.m_netCount)
+	                    .arg(actual.m_netRoutedCount).arg(expected.m_netRoutedCount)
+	                    .arg(actual.m_connectorsLeftToRoute).arg(expected.m_connectorsLeftToRoute)
+	                    .arg(actual.m_jumperItemCount).arg(expected.m_jumperItemCount).toStdString());
+}
+
+BOOST_AUTO_TEST_CASE( test_connect_and_disconnect )
+{
+	FakeSketch sketch(6);
+	checkTotal(sketch, "empty");
+
+	sketch.connect(0, 1);
+	sketch.connect(2, 3);
+	checkTotal(sketch, "two nets");
+
+	sketch.connect(1, 2);
+	checkTotal(sketch, "joined");
+
+	sketch.disconnect(1, 2);
+	checkTotal(sketch, "split");
+}
+
+BOOST_AUTO_TEST_CASE( test_label_joins_nets_reported_elsewhere )
+{
+	// a second ground label joins two wired nets; only the relabelled connector is reported
+	FakeSketch sketch(6);
+	sketch.connect(0, 1);
+	sketch.connect(2, 3);
+	sketch.setLabel(1, "GND");
+	checkTotal(sketch, "one label");
+
+	sketch.setLabel(2, "GND");
+	checkTotal(sketch, "second label");
+
+	sketch.setLabel(1, QString());
+	checkTotal(sketch, "label removed");
+
+	sketch.connect(4, 5);
+	sketch.setLabel(4, "GND");
+	sketch.setLabel(1, "GND");
+	checkTotal(sketch, "three labels");
+
+	sketch.remove(2);
+	checkTotal(sketch, "labelled connector deleted");
+}
+
+BOOST_AUTO_TEST_CASE( test_long_chain_of_swallowed_nets )
+{
+	// every cached pair overlaps two new pairs, so each re-scored net strands members of the next one;
+	// scoring them recursively went as deep as the chain is long
+	const int Count = 20000;
+	FakeSketch sketch(Count);
+	for (int i = 0; i < Count; i++) {
+		sketch.setLabel(i, QString("n%1").arg(i / 2));
+	}
+	checkTotal(sketch, "pairs");
+
+	for (int i = 1; i < Count; i++) {
+		sketch.setLabel(i, QString("n%1").arg((i + 1) / 2));
+	}
+	checkTotal(sketch, "shifted pairs");
+}
+
+BOOST_AUTO_TEST_CASE( test_random_edits )
+{
+	QRandomGenerator random(22);
+	FakeSketch sketch(60);
+	checkTotal(sketch, "start");
+
+	QList<int> removed;
+	for (int step = 0; step < 400; step++) {
+		int c1 = random.bounded(sketch.count());
+		int c2 = random.bounded(sketch.count());
+		QString what;
+		switch (random.bounded(7)) {
+		case 0:
+		case 1:
+			if (c1 == c2 || !sketch.inSketch.contains(c1) || !sketch.inSketch.contains(c2)) continue;
+
+			sketch.connect(c1, c2);
+			what = "connect";
+			break;
+		case 2:
+			if (sketch.wires.at(c1).isEmpty()) continue;
+
+			sketch.disconnect(c1, sketch.wires.at(c1).values().first());
+			what = "disconnect";
+			break;
+		case 3:
+		case 4:
+			sketch.setLabel(c1, random.bounded(3) == 0 ? QString() : QString("L%1").arg(random.bounded(4)));
+			what = "label";
+			break;
+		case 5:
+			if (!sketch.inSketch.contains(c1)) continue;
+
+			sketch.remove(c1);
+			removed << c1;
+			what = "delete";
+			break;
+		default:
+			if (removed.isEmpty()) continue;
+
+			sketch.restore(removed.takeFirst());
+			what = "restore";
+			break;
+		}
+
+		// sometimes several edits land in one update
+		if (random.bounded(3) == 0) continue;
+
+		checkTotal(sketch, QString("step %1 (%2)").arg(step).arg(what));
+	}
+	checkTotal(sketch, "end");
+}
@@ -0,0 +1,107 @@
+#include "svg/svgpathrunner.h"
+#include "svg/svgpathparser.h"
+#include "svg/svgpathlexer.h"
+
+#include <QElapsedTimer>
+
+#include <boost/test/unit_test.hpp>
+
+/*
+Checks that SVGPathRunner::run visits exactly the commands that the
+signal-based SVGPathRunner::runPath emits, including on malformed stacks,
+and times both on a path the size of a dense footprint.
+*/
+
+struct RecordedCommand {
+	QChar command;
+	bool relative;
+	QList<double> args;
+
+	bool operator==(const RecordedCommand & other) const {
+		return command == other.command && relative == other.relative && args == other.args;
+	}
+};
+
+static bool runSignals(QVector<QVariant> & symStack, QList<RecordedCommand> & recorded) {
+	SVGPathRunner runner;
+	QObject::connect(&runner, &SVGPathRunner::commandSignal, [&recorded](QChar command, bool relative, QList<double> & args, void *) {
+		recorded.append(RecordedCommand { command, relative, args });
+	});
+	return runner.runPath(symStack, nullptr);
+}
+
+static bool runDirect(const QVector<QVariant> & symStack, QList<RecordedCommand> & recorded) {
+	SVGPathData pathData;
+	SVGPathRunner::toPathData(symStack, pathData);
+	return SVGPathRunner::run(pathData, [&recorded](QChar command, bool relative, const SVGPathArgs & args) {
+		QList<double> copy;
+		for (double d : args) copy.append(d);
+		recorded.append(RecordedCommand { command, relative, copy });
+	});
+}
+
+static QVector<QVariant> parse(const QString & data) {
+	QString dataCopy(data);
+	SVGPathLexer lexer(dataCopy);
+	SVGPathParser parser;
+	BOOST_REQUIRE(parser.parse(lexer));
+	return parser.symStack();
+}
+
+BOOST_AUTO_TEST_CASE( pathrunner_matches_signals )
+{
+	QList<QVector<QVariant>> stacks = {
+		parse("M1,2L3,4 5,6h7v8z"),
+		parse("m1-2a2.6,3.5,0,0,1,-5.2,0c1,2,3,4,5,6s1,2,3,4q1,2,3,4t5,6Z"),
+		{ QChar('M'), 1.0, 2.0, QChar('L'), 3.0 },							// odd argument count
+		{ QChar('M'), 1.0, 2.0, QChar('L'), 3.0, 4.0, QChar('Y'), 1.0 },		// unknown command
+		{ 1.0, QChar('M'), 1.0, 2.0 },										// number before any command
+		{ QChar('M'), 1.0, 2.0, QChar('z'), 1.0 },							// arguments after close
+	};
+
+	for (int i = 0; i < stacks.count(); i++) {
+		QList<RecordedCommand> viaSignals;
+		QList<RecordedCommand> viaDirect;
+		bool signalResult = runSignals(stacks[i], viaSignals);
+		bool directResult = runDirect(stacks[i], viaDirect);
+		BOOST_CHECK_MESSAGE(signalResult == directResult, "result differs for stack " << i);
+		BOOST_CHECK_MESSAGE(viaSignals == viaDirect, "commands differ for stack " << i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_pathrunner )
+{
+	QString data("M0,0");
+	for (int i = 0; i < 20000; i++) {
+		data.append(QString("L%1,%2c1,2,3,4,5,6").arg(i).arg(i % 97));
+	}
+	data.append("z");
+	QVector<QVariant> symStack = parse(data);
+
+	const int repeats = 10;
+	double signalSum = 0;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < repeats; i++) {
+		SVGPathRunner runner;
+		QObject::connect(&runner, &SVGPathRunner::commandSignal, [&signalSum](QChar, bool, QList<double> & args, void *) {
+			Q_FOREACH (double d, args) signalSum += d;
+		});
+		runner.runPath(symStack, nullptr);
+	}
+	double signalTime = timer.elapsed() / (double) repeats;
+
+	double directSum = 0;
+	timer.restart();
+	for (int i = 0; i < repeats; i++) {
+		SVGPathData pathData;
+		SVGPathRunner::toPathData(symStack, pathData);
+		SVGPathRunner::run(pathData, [&directSum](QChar, bool, const SVGPathArgs & args) {
+			for (double d : args) directSum += d;
+		});
+	}
+	double directTime = timer.elapsed() / (double) repeats;
+
+	BOOST_CHECK_EQUAL(signalSum, directSum);
+	BOOST_TEST_MESSAGE("path runner, 40002 commands: signals " << signalTime << " ms, direct " << directTime << " ms (including conversion)");
+}
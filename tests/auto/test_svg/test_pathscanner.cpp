@@ -0,0 +1,115 @@
+#include "svg/svgpathscanner.h"
+#include "svg/svgpathparser.h"
+#include "svg/svgpathlexer.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include <boost/test/unit_test.hpp>
+
+/*
+Checks that SVGPathScanner accepts and rejects the same path data as the
+SVGPathLexer/SVGPathParser grammar, yields the same commands and numbers
+(bit for bit), and times both on a path the size of a dense footprint.
+*/
+
+// what SvgFileSplitter::simpleParsePath did before handing the stack to SVGPathRunner
+static bool grammarParse(const QString & data, SVGPathData & pathData) {
+	QString dataCopy(data);
+	if (!dataCopy.startsWith('M', Qt::CaseInsensitive)) {
+		dataCopy.prepend('M');
+	}
+	while (dataCopy.at(dataCopy.length() - 1).isSpace()) {
+		dataCopy.remove(dataCopy.length() - 1, 1);
+	}
+	QChar last = dataCopy.at(dataCopy.length() - 1);
+	if (last != 'z' && last != 'Z' && last != SVGPathLexer::FakeClosePathChar) {
+		dataCopy.append(SVGPathLexer::FakeClosePathChar);
+	}
+
+	SVGPathLexer lexer(dataCopy);
+	SVGPathParser parser;
+	if (!parser.parse(lexer)) return false;
+
+	return SVGPathRunner::toPathData(parser.symStack(), pathData);
+}
+
+static void compare(const QString & data) {
+	SVGPathData expected;
+	SVGPathData scanned;
+	bool expectedResult = grammarParse(data, expected);
+	bool scannedResult = SVGPathScanner::parse(data, scanned, true);
+	BOOST_CHECK_MESSAGE(expectedResult == scannedResult, "acceptance differs for \"" << data.toStdString() << "\"");
+	if (!expectedResult || !scannedResult) return;
+
+	BOOST_CHECK_MESSAGE(expected.args == scanned.args, "numbers differ for \"" << data.toStdString() << "\"");
+	BOOST_REQUIRE_EQUAL(expected.segments.count(), scanned.segments.count());
+	for (int i = 0; i < expected.segments.count(); i++) {
+		const SVGPathSegment & e = expected.segments.at(i);
+		const SVGPathSegment & s = scanned.segments.at(i);
+		BOOST_CHECK_MESSAGE(e.command == s.command && e.relative == s.relative && e.argIndex == s.argIndex && e.argCount == s.argCount,
+		                    "segment " << i << " differs for \"" << data.toStdString() << "\"");
+	}
+}
+
+BOOST_AUTO_TEST_CASE( pathscanner_matches_grammar )
+{
+	const QStringList inputs = {
+		"m0,0x", "m5,9.9x", "m-5,-9.9x", "m-4 -9.8x", "m-3-9.7x", "m0,0z",
+		"m1,-2a2.6,3.5,0,0,1,-5.2,0x", "m2 -2a2.6 3.5 0 0 1 -5.2 0x", "m3-2a2.6 3.5 0 0 1-5.2 0x",
+		"m4-2a2.6-3.5 0 0 1-5.2 0x", "m-2+9.7x",
+		"M 10 20 L 30 40 H 50 V 60 Z", "M1,2 3,4 5,6", "M.5.5.5.5", "M1e-5,2E+3l1e2 3",
+		"M0,0C1,2,3,4,5,6S1,2,3,4Q1,2,3,4T5,6z", "M0 0\n\tL 1 1\r\nz M2 2 l 1,1",
+		"10,20 30,40 50,60",							// polygon points
+		"M 0.123456789012345678 98765432109876543210",	// beyond the fast float path
+	};
+	const QStringList malformed = {
+		"M1,2,", "M,1,2", "M1,2L", "M1 2 3", "M1,2z3", "M5.", "M1,2 Y", "M1,,2", "M1,2x3", "M1,2 L,3,4", "M1,2a1,1,0,0,1,2",
+	};
+
+	Q_FOREACH (QString input, inputs) {
+		SVGPathData scanned;
+		BOOST_CHECK_MESSAGE(SVGPathScanner::parse(input, scanned, true), "failed to parse \"" << input.toStdString() << "\"");
+		compare(input);
+	}
+	Q_FOREACH (QString input, malformed) {
+		SVGPathData scanned;
+		BOOST_CHECK_MESSAGE(!SVGPathScanner::parse(input, scanned, true), "accepted \"" << input.toStdString() << "\"");
+		compare(input);
+	}
+
+	QRandomGenerator generator(3);
+	for (int i = 0; i < 1000; i++) {
+		QString input = QString("M%1,%2").arg(generator.bounded(-1000.0, 1000.0), 0, 'g', 1 + generator.bounded(16)).arg(generator.bounded(1.0), 0, 'e', generator.bounded(12));
+		input.append(QString("l%1 %2").arg(generator.bounded(100000)).arg(-generator.bounded(1e-3), 0, 'f', generator.bounded(17)));
+		compare(input);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_pathscanner )
+{
+	QString data("M0,0");
+	for (int i = 0; i < 20000; i++) {
+		data.append(QString("L%1,%2 c1.5,-2.25,3,4e-1,5.125,6").arg(i * 0.37).arg(i % 97));
+	}
+	data.append("z");
+
+	const int repeats = 10;
+	SVGPathData grammarData;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < repeats; i++) {
+		grammarParse(data, grammarData);
+	}
+	double grammarTime = timer.elapsed() / (double) repeats;
+
+	SVGPathData scannedData;
+	timer.restart();
+	for (int i = 0; i < repeats; i++) {
+		SVGPathScanner::parse(data, scannedData, true);
+	}
+	double scanTime = timer.elapsed() / (double) repeats;
+
+	BOOST_CHECK(grammarData.args == scannedData.args);
+	BOOST_TEST_MESSAGE("path parse, " << data.length() << " chars: lexer/parser " << grammarTime << " ms, scanner " << scanTime << " ms");
+}
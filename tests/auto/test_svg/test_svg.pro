@@ -35,11 +35,17 @@ HEADERS += $$files(../../../src/svg/svgpathlexer.h)
 HEADERS += $$files(../../../src/utils/textutils.h)
 HEADERS += $$files(../../../src/svg/svgpathgrammar_p.h)
 HEADERS += $$files(../../../src/svg/svgpathparser.h)
+HEADERS += $$files(../../../src/svg/svgpathrunner.h)
+HEADERS += $$files(../../../src/svg/svgpathscanner.h)
+HEADERS += $$files(../../../src/svg/svgstreamrewriter.h)
 
 SOURCES += $$files(../../../src/svg/svgtext.cpp)
 SOURCES += $$files(../../../src/svg/svgpathlexer.cpp)
 SOURCES += $$files(../../../src/svg/svgpathparser.cpp)
 SOURCES += $$files(../../../src/svg/svgpathgrammar.cpp)
+SOURCES += $$files(../../../src/svg/svgpathrunner.cpp)
+SOURCES += $$files(../../../src/svg/svgpathscanner.cpp)
+SOURCES += $$files(../../../src/svg/svgstreamrewriter.cpp)
 SOURCES += $$files(../../../src/utils/textutils.cpp)
 #INCLUDEPATH += $$top_srcdir
 # unix:QMAKE_POST_LINK = $$PWD/generated/test_svg
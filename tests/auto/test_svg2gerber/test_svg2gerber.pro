@@ -36,6 +36,8 @@ HEADERS += $$files(../../../src/svg/svgpathgrammar_p.h)
 HEADERS += $$files(../../../src/svg/svgpathparser.h)
 HEADERS += $$files(../../../src/svg/svgfilesplitter.h)
 HEADERS += $$files(../../../src/svg/svgpathrunner.h)
+HEADERS += $$files(../../../src/svg/svgpathscanner.h)
+HEADERS += $$files(../../../src/svg/svgstreamrewriter.h)
 HEADERS += $$files(../../../src/svg/svgflattener.h)
 HEADERS += $$files(../../../src/svg/svg2gerber.h)
 HEADERS += $$files(../../../src/utils/textutils.h)
@@ -48,6 +50,8 @@ SOURCES += $$files(../../../src/svg/svgpathparser.cpp)
 SOURCES += $$files(../../../src/svg/svgpathgrammar.cpp)
 SOURCES += $$files(../../../src/svg/svgfilesplitter.cpp)
 SOURCES += $$files(../../../src/svg/svgpathrunner.cpp)
+SOURCES += $$files(../../../src/svg/svgpathscanner.cpp)
+SOURCES += $$files(../../../src/svg/svgstreamrewriter.cpp)
 SOURCES += $$files(../../../src/svg/svgflattener.cpp)
 SOURCES += $$files(../../../src/svg/svg2gerber.cpp)
 SOURCES += $$files(../../../src/utils/textutils.cpp)
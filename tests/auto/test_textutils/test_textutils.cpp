@@ -95,3 +95,71 @@ BOOST_AUTO_TEST_CASE( test_convertToInches )
 
 	BOOST_REQUIRE(epsilonCheck(*TextUtils::convertToInches("90.0", false), 1.0));
 }
+
+BOOST_AUTO_TEST_CASE( test_replaceTextElement )
+{
+	QString svg = R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 10 10"><g><text id="label" x="1">old</text><text id="other">keep</text></g></svg>)";
+
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(TextUtils::replaceTextElement(svg, "label", "new")));
+	QDomNodeList texts = doc.documentElement().elementsByTagName("text");
+	BOOST_REQUIRE_EQUAL(texts.count(), 2);
+	BOOST_CHECK(texts.item(0).toElement().text() == "new");
+	BOOST_CHECK(texts.item(0).toElement().attribute("x") == "1");
+	BOOST_CHECK(texts.item(1).toElement().text() == "keep");
+
+	// no match leaves the input alone
+	BOOST_CHECK(TextUtils::replaceTextElement(svg, "missing", "new") == svg);
+
+	// whitespace and tspans are not a text run, so the value is appended
+	QString spanned = R"(<svg><text id="label"> <tspan>a</tspan> </text></svg>)";
+	BOOST_REQUIRE(doc.setContent(TextUtils::replaceTextElement(spanned, "label", "b")));
+	QDomElement text = doc.documentElement().firstChildElement("text");
+	BOOST_CHECK(text.lastChild().isText());
+	BOOST_CHECK(text.lastChild().nodeValue() == "b");
+	BOOST_CHECK(text.firstChildElement("tspan").text() == "a");
+
+	QByteArray bytes = TextUtils::replaceTextElement(svg.toUtf8(), "label", "new");
+	BOOST_REQUIRE(doc.setContent(bytes));
+	BOOST_CHECK(doc.documentElement().elementsByTagName("text").item(0).toElement().text() == "new");
+
+	QHash<QString, QString> hash;
+	hash.insert("label", "1");
+	hash.insert("other", "2");
+	BOOST_REQUIRE(doc.setContent(TextUtils::replaceTextElements(svg, hash)));
+	texts = doc.documentElement().elementsByTagName("text");
+	BOOST_CHECK(texts.item(0).toElement().text() == "1");
+	BOOST_CHECK(texts.item(1).toElement().text() == "2");
+}
+
+BOOST_AUTO_TEST_CASE( test_mergeSvg )
+{
+	QString svg1 = R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 10 10"><g id="silkscreen"><rect id="r1"/></g><g id="copper0"/></svg>)";
+	QString svg2 = R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 10 10"><g id="silkscreen"><circle id="c1"/><line id="l1"/></g></svg>)";
+
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(TextUtils::mergeSvg(svg1, svg2, "silkscreen", false)));
+	QDomElement silkscreen = doc.documentElement().firstChildElement("g");
+	BOOST_CHECK(silkscreen.attribute("id") == "silkscreen");
+	QDomNodeList children = silkscreen.childNodes();
+	BOOST_REQUIRE_EQUAL(children.count(), 3);
+	BOOST_CHECK(children.item(0).toElement().attribute("id") == "r1");
+	BOOST_CHECK(children.item(1).toElement().attribute("id") == "c1");
+	BOOST_CHECK(children.item(2).toElement().attribute("id") == "l1");
+
+	// without an id, svg2's root children land at the end of svg1's root
+	BOOST_REQUIRE(doc.setContent(TextUtils::mergeSvg(svg1, svg2, "", false)));
+	QDomElement last = doc.documentElement().lastChildElement();
+	BOOST_CHECK(last.attribute("id") == "silkscreen");
+	BOOST_CHECK(last.firstChildElement().attribute("id") == "c1");
+
+	// flip wraps everything in a mirroring <g>
+	BOOST_REQUIRE(doc.setContent(TextUtils::mergeSvg(svg1, svg2, "silkscreen", true)));
+	QDomElement root = doc.documentElement();
+	BOOST_REQUIRE_EQUAL(root.childNodes().count(), 1);
+	QDomElement wrapper = root.firstChildElement("g");
+	BOOST_CHECK(!wrapper.attribute("transform").isEmpty());
+	BOOST_CHECK_EQUAL(wrapper.elementsByTagName("circle").count(), 1);
+
+	BOOST_CHECK(TextUtils::mergeSvg("<notsvg/>", svg2, "", false).isEmpty());
+}